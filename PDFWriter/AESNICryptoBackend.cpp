@@ -0,0 +1,267 @@
+/*
+   Source File : AESNICryptoBackend.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "AESNICryptoBackend.h"
+#include "PortableCryptoBackend.h"
+#include "Trace.h"
+
+#include <string.h>
+
+using namespace IOBasicTypes;
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PDFHUMMUS_AESNI_POSSIBLE
+#endif
+
+#ifdef PDFHUMMUS_AESNI_POSSIBLE
+
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AESNI_TARGET
+#else
+#include <cpuid.h>
+// compile the AES-NI functions for the instructions, without requiring them for the rest of the library
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+#endif
+
+#define AESNI_MAX_ROUNDS 14
+
+static bool DetectAESNI()
+{
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 1);
+	return (cpuInfo[2] & (1 << 25)) != 0; // ecx bit 25 - AES
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return false;
+	return (ecx & (1 << 25)) != 0; // ecx bit 25 - AES
+#endif
+}
+
+AESNI_TARGET static __m128i AES128KeyExpansionStep(__m128i inKey, __m128i inKeyGenerated)
+{
+	inKeyGenerated = _mm_shuffle_epi32(inKeyGenerated, 0xff);
+	inKey = _mm_xor_si128(inKey, _mm_slli_si128(inKey, 4));
+	inKey = _mm_xor_si128(inKey, _mm_slli_si128(inKey, 4));
+	inKey = _mm_xor_si128(inKey, _mm_slli_si128(inKey, 4));
+	return _mm_xor_si128(inKey, inKeyGenerated);
+}
+
+#define AES128_EXPAND(key, rcon) AES128KeyExpansionStep(key, _mm_aeskeygenassist_si128(key, rcon))
+
+AESNI_TARGET static __m128i AES256KeyExpansionSecondStep(__m128i inKey, __m128i inPreviousRoundKey)
+{
+	__m128i keyGenerated = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(inPreviousRoundKey, 0x00), 0xaa);
+	inKey = _mm_xor_si128(inKey, _mm_slli_si128(inKey, 4));
+	inKey = _mm_xor_si128(inKey, _mm_slli_si128(inKey, 4));
+	inKey = _mm_xor_si128(inKey, _mm_slli_si128(inKey, 4));
+	return _mm_xor_si128(inKey, keyGenerated);
+}
+
+// 256 bits keys expand two round keys per step. the first like a 128 bits step, from the last two round keys
+#define AES256_EXPAND(keys, i, rcon) \
+	keys[i] = AES128KeyExpansionStep(keys[i - 2], _mm_aeskeygenassist_si128(keys[i - 1], rcon)); \
+	keys[i + 1] = AES256KeyExpansionSecondStep(keys[i - 1], keys[i]);
+
+class AESNICipher : public IAESCipher
+{
+public:
+	AESNICipher(void) { mRounds = 0; }
+	virtual ~AESNICipher(void) {}
+
+	bool SetKey(const Byte* inKey, size_t inKeyLength);
+
+	virtual bool EncryptCBC(const Byte* inInput, Byte* outOutput, size_t inLength, Byte* ioIV);
+	virtual bool DecryptCBC(const Byte* inInput, Byte* outOutput, size_t inLength, Byte* ioIV);
+
+private:
+	// round keys are kept unaligned, and loaded to registers per call
+	Byte mEncryptKeys[(AESNI_MAX_ROUNDS + 1) * 16];
+	Byte mDecryptKeys[(AESNI_MAX_ROUNDS + 1) * 16];
+	int mRounds;
+};
+
+AESNI_TARGET bool AESNICipher::SetKey(const Byte* inKey, size_t inKeyLength)
+{
+	__m128i keys[AESNI_MAX_ROUNDS + 1];
+
+	if (16 == inKeyLength) {
+		mRounds = 10;
+		keys[0] = _mm_loadu_si128((const __m128i*)inKey);
+		keys[1] = AES128_EXPAND(keys[0], 0x01);
+		keys[2] = AES128_EXPAND(keys[1], 0x02);
+		keys[3] = AES128_EXPAND(keys[2], 0x04);
+		keys[4] = AES128_EXPAND(keys[3], 0x08);
+		keys[5] = AES128_EXPAND(keys[4], 0x10);
+		keys[6] = AES128_EXPAND(keys[5], 0x20);
+		keys[7] = AES128_EXPAND(keys[6], 0x40);
+		keys[8] = AES128_EXPAND(keys[7], 0x80);
+		keys[9] = AES128_EXPAND(keys[8], 0x1b);
+		keys[10] = AES128_EXPAND(keys[9], 0x36);
+	}
+	else if (32 == inKeyLength) {
+		mRounds = 14;
+		keys[0] = _mm_loadu_si128((const __m128i*)inKey);
+		keys[1] = _mm_loadu_si128((const __m128i*)(inKey + 16));
+		AES256_EXPAND(keys, 2, 0x01);
+		AES256_EXPAND(keys, 4, 0x02);
+		AES256_EXPAND(keys, 6, 0x04);
+		AES256_EXPAND(keys, 8, 0x08);
+		AES256_EXPAND(keys, 10, 0x10);
+		AES256_EXPAND(keys, 12, 0x20);
+		keys[14] = AES128KeyExpansionStep(keys[12], _mm_aeskeygenassist_si128(keys[13], 0x40));
+	}
+	else
+		return false;
+
+	// decryption uses the encryption round keys in reverse order, with the inner ones inverse mixed
+	for (int i = 0; i <= mRounds; ++i) {
+		_mm_storeu_si128((__m128i*)(mEncryptKeys + i * 16), keys[i]);
+		__m128i decryptKey = (0 == i || mRounds == i) ? keys[mRounds - i] : _mm_aesimc_si128(keys[mRounds - i]);
+		_mm_storeu_si128((__m128i*)(mDecryptKeys + i * 16), decryptKey);
+	}
+	return true;
+}
+
+AESNI_TARGET bool AESNICipher::EncryptCBC(const Byte* inInput, Byte* outOutput, size_t inLength, Byte* ioIV)
+{
+	if (inLength % 16 != 0)
+		return false;
+
+	__m128i keys[AESNI_MAX_ROUNDS + 1];
+	for (int i = 0; i <= mRounds; ++i)
+		keys[i] = _mm_loadu_si128((const __m128i*)(mEncryptKeys + i * 16));
+
+	// CBC encryption is sequential, each block depends on the previous cipher block
+	__m128i feedback = _mm_loadu_si128((const __m128i*)ioIV);
+	for (size_t offset = 0; offset < inLength; offset += 16) {
+		feedback = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(inInput + offset)), feedback);
+		feedback = _mm_xor_si128(feedback, keys[0]);
+		for (int round = 1; round < mRounds; ++round)
+			feedback = _mm_aesenc_si128(feedback, keys[round]);
+		feedback = _mm_aesenclast_si128(feedback, keys[mRounds]);
+		_mm_storeu_si128((__m128i*)(outOutput + offset), feedback);
+	}
+	_mm_storeu_si128((__m128i*)ioIV, feedback);
+	return true;
+}
+
+AESNI_TARGET bool AESNICipher::DecryptCBC(const Byte* inInput, Byte* outOutput, size_t inLength, Byte* ioIV)
+{
+	if (inLength % 16 != 0)
+		return false;
+
+	__m128i keys[AESNI_MAX_ROUNDS + 1];
+	for (int i = 0; i <= mRounds; ++i)
+		keys[i] = _mm_loadu_si128((const __m128i*)(mDecryptKeys + i * 16));
+
+	__m128i feedback = _mm_loadu_si128((const __m128i*)ioIV);
+	size_t offset = 0;
+
+	// CBC decryption blocks are independent, so decrypt 4 at a time to keep the AES unit busy
+	for (; offset + 64 <= inLength; offset += 64) {
+		__m128i in0 = _mm_loadu_si128((const __m128i*)(inInput + offset));
+		__m128i in1 = _mm_loadu_si128((const __m128i*)(inInput + offset + 16));
+		__m128i in2 = _mm_loadu_si128((const __m128i*)(inInput + offset + 32));
+		__m128i in3 = _mm_loadu_si128((const __m128i*)(inInput + offset + 48));
+		__m128i block0 = _mm_xor_si128(in0, keys[0]);
+		__m128i block1 = _mm_xor_si128(in1, keys[0]);
+		__m128i block2 = _mm_xor_si128(in2, keys[0]);
+		__m128i block3 = _mm_xor_si128(in3, keys[0]);
+		for (int round = 1; round < mRounds; ++round) {
+			block0 = _mm_aesdec_si128(block0, keys[round]);
+			block1 = _mm_aesdec_si128(block1, keys[round]);
+			block2 = _mm_aesdec_si128(block2, keys[round]);
+			block3 = _mm_aesdec_si128(block3, keys[round]);
+		}
+		block0 = _mm_xor_si128(_mm_aesdeclast_si128(block0, keys[mRounds]), feedback);
+		block1 = _mm_xor_si128(_mm_aesdeclast_si128(block1, keys[mRounds]), in0);
+		block2 = _mm_xor_si128(_mm_aesdeclast_si128(block2, keys[mRounds]), in1);
+		block3 = _mm_xor_si128(_mm_aesdeclast_si128(block3, keys[mRounds]), in2);
+		_mm_storeu_si128((__m128i*)(outOutput + offset), block0);
+		_mm_storeu_si128((__m128i*)(outOutput + offset + 16), block1);
+		_mm_storeu_si128((__m128i*)(outOutput + offset + 32), block2);
+		_mm_storeu_si128((__m128i*)(outOutput + offset + 48), block3);
+		feedback = in3;
+	}
+
+	for (; offset < inLength; offset += 16) {
+		__m128i in = _mm_loadu_si128((const __m128i*)(inInput + offset));
+		__m128i block = _mm_xor_si128(in, keys[0]);
+		for (int round = 1; round < mRounds; ++round)
+			block = _mm_aesdec_si128(block, keys[round]);
+		block = _mm_xor_si128(_mm_aesdeclast_si128(block, keys[mRounds]), feedback);
+		_mm_storeu_si128((__m128i*)(outOutput + offset), block);
+		feedback = in;
+	}
+	_mm_storeu_si128((__m128i*)ioIV, feedback);
+	return true;
+}
+
+#endif
+
+AESNICryptoBackend::AESNICryptoBackend(void)
+{
+}
+
+AESNICryptoBackend::~AESNICryptoBackend(void)
+{
+}
+
+bool AESNICryptoBackend::IsSupported()
+{
+#ifdef PDFHUMMUS_AESNI_POSSIBLE
+	static const bool scSupported = DetectAESNI();
+	return scSupported;
+#else
+	return false;
+#endif
+}
+
+const char* AESNICryptoBackend::GetName()
+{
+	return "AES-NI";
+}
+
+IAESCipher* AESNICryptoBackend::CreateAESCipher(const Byte* inKey, size_t inKeyLength)
+{
+#ifdef PDFHUMMUS_AESNI_POSSIBLE
+	if (IsSupported() && (16 == inKeyLength || 32 == inKeyLength)) {
+		AESNICipher* cipher = new AESNICipher();
+		if (cipher->SetKey(inKey, inKeyLength))
+			return cipher;
+		delete cipher;
+	}
+#endif
+
+	// not available, or a key length without an AES-NI implementation
+	PortableAESCipher* cipher = new PortableAESCipher();
+	if (!cipher->SetKey(inKey, inKeyLength)) {
+		TRACE_LOG1("AESNICryptoBackend::CreateAESCipher, failed to set AES key of length %ld", (long)inKeyLength);
+		delete cipher;
+		return NULL;
+	}
+	return cipher;
+}
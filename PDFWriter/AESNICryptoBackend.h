@@ -0,0 +1,40 @@
+/*
+   Source File : AESNICryptoBackend.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ICryptoBackend.h"
+
+/*
+	AES with the x86-64 AES-NI instructions. Check IsSupported before using, it is false on other architectures,
+	and on processors without AES-NI. 128 and 256 bits keys use the instructions, 192 bits keys use the portable implementation.
+*/
+class AESNICryptoBackend : public ICryptoBackend
+{
+public:
+	AESNICryptoBackend(void);
+	virtual ~AESNICryptoBackend(void);
+
+	// runtime check for AES-NI
+	static bool IsSupported();
+
+	virtual const char* GetName();
+	virtual IAESCipher* CreateAESCipher(const IOBasicTypes::Byte* inKey, size_t inKeyLength);
+};
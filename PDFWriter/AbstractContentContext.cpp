@@ -30,6 +30,7 @@
 #include "OutputStreamTraits.h"
 #include "IContentContextListener.h"
 #include "DocumentContext.h"
+#include "ObjectsContext.h"
 #include <ctype.h>
 #include <algorithm>
 
@@ -239,6 +240,9 @@ unsigned long AbstractContentContext::ColorValueForName(const std::string& inCol
 AbstractContentContext::AbstractContentContext(PDFHummus::DocumentContext* inDocumentContext)
 {
 	mDocumentContext = inDocumentContext;
+	// write doubles with the document precision
+	if(mDocumentContext && mDocumentContext->GetObjectsContext())
+		mPrimitiveWriter.SetDoublePrecision(mDocumentContext->GetObjectsContext()->GetDoublePrecision());
 }
 
 AbstractContentContext::~AbstractContentContext(void)
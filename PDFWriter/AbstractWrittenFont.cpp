@@ -29,6 +29,7 @@
 #include "PDFArray.h"
 #include "PDFInteger.h"
 #include "PDFIndirectObjectReference.h"
+#include "FreeTypeFaceWrapper.h"
 
 #include <list>
 
@@ -49,6 +50,26 @@ AbstractWrittenFont::~AbstractWrittenFont(void)
 	delete mANSIRepresentation;
 }
 
+static const std::string scPlus = "+";
+void AbstractWrittenFont::NameEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo)
+{
+	// font writers fail with no postscript name, before getting to generate subset names
+	std::string postscriptFontName = inFontInfo.GetPostscriptName();
+	if(postscriptFontName.length() == 0)
+		return;
+
+	// same order as writing, ANSI then CID, so that the subset names are the same as when generated by the font writers
+	if(ShouldWriteRepresentation(mANSIRepresentation))
+		mANSIRepresentation->mPreparedEmbeddedFont.mSubsetFontName = mObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName;
+	if(ShouldWriteRepresentation(mCIDRepresentation))
+		mCIDRepresentation->mPreparedEmbeddedFont.mSubsetFontName = mObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName;
+}
+
+bool AbstractWrittenFont::ShouldWriteRepresentation(WrittenFontRepresentation* inRepresentation)
+{
+	return inRepresentation && !inRepresentation->isEmpty() && inRepresentation->mWrittenObjectID != 0;
+}
+
 void AbstractWrittenFont::AppendGlyphs(
 						  const GlyphUnicodeMappingList& inGlyphsList,
 						  UShortList& outEncodedCharacters,
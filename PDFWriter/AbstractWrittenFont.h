@@ -43,6 +43,8 @@ public:
 							  UShortListList& outEncodedCharacters,
 							  bool& outEncodingIsMultiByte,
 							  ObjectIDType &outFontObjectID);
+
+	virtual void NameEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo);
 protected:
 	WrittenFontRepresentation* mCIDRepresentation;
 	WrittenFontRepresentation* mANSIRepresentation;
@@ -52,6 +54,9 @@ protected:
 	PDFHummus::EStatusCode WriteStateAfterDictionary(ObjectsContext* inStateWriter);
 	PDFHummus::EStatusCode ReadStateFromObject(PDFParser* inStateReader,PDFDictionary* inState);
 
+	// representations that WriteFontDefinition writes
+	bool ShouldWriteRepresentation(WrittenFontRepresentation* inRepresentation);
+
 private:
 	ObjectIDType mCidRepresentationObjectStateID;
 	ObjectIDType mAnsiRepresentationObjectStateID;
@@ -68,7 +68,12 @@ EStatusCode CFFANSIFontWriter::WriteFont(	FreeTypeFaceWrapper& inFontInfo,
 
 	if (inEmbedFont)
 	{
-		fontName = inObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName;
+		// use the subset font name and program if prepared ahead
+		PreparedEmbeddedFont& preparedFont = inFontOccurrence->mPreparedEmbeddedFont;
+
+		fontName = preparedFont.mSubsetFontName.empty() ?
+						inObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName :
+						preparedFont.mSubsetFontName;
 		const char* fontType = inFontInfo.GetTypeString();
 
 		EStatusCode status;
@@ -76,23 +81,35 @@ EStatusCode CFFANSIFontWriter::WriteFont(	FreeTypeFaceWrapper& inFontInfo,
 		{
 			Type1ToCFFEmbeddedFontWriter embeddedFontWriter;
 
-			status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
-				inFontOccurrence->GetGlyphIDsAsOrderedVector(),
-				scType1C,
-				fontName,
-				inObjectsContext,
-				mEmbeddedFontFileObjectID);
+			if(preparedFont.mIsPrepared)
+				status = embeddedFontWriter.WriteEmbeddedFont(preparedFont,
+					scType1C,
+					inObjectsContext,
+					mEmbeddedFontFileObjectID);
+			else
+				status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
+					inFontOccurrence->GetGlyphIDsAsOrderedVector(),
+					scType1C,
+					fontName,
+					inObjectsContext,
+					mEmbeddedFontFileObjectID);
 		}
 		else if (strcmp(scCFF, fontType) == 0)
 		{
 			CFFEmbeddedFontWriter embeddedFontWriter;
 
-			status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
-				inFontOccurrence->GetGlyphIDsAsOrderedVector(),
-				scType1C,
-				fontName,
-				inObjectsContext,
-				mEmbeddedFontFileObjectID);
+			if(preparedFont.mIsPrepared)
+				status = embeddedFontWriter.WriteEmbeddedFont(preparedFont,
+					scType1C,
+					inObjectsContext,
+					mEmbeddedFontFileObjectID);
+			else
+				status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
+					inFontOccurrence->GetGlyphIDsAsOrderedVector(),
+					scType1C,
+					fontName,
+					inObjectsContext,
+					mEmbeddedFontFileObjectID);
 		}
 		else
 		{
@@ -100,6 +117,7 @@ EStatusCode CFFANSIFontWriter::WriteFont(	FreeTypeFaceWrapper& inFontInfo,
 			TRACE_LOG("CFFANSIFontWriter::WriteFont, Exception, unfamilar font type for embedding representation");
 			status = PDFHummus::eFailure;
 		}
+		preparedFont.Reset();
 		if (status != PDFHummus::eSuccess)
 			return status;
 	}
@@ -111,6 +129,37 @@ EStatusCode CFFANSIFontWriter::WriteFont(	FreeTypeFaceWrapper& inFontInfo,
 	return fontWriter.WriteFont(inFontInfo, inFontOccurrence, inObjectsContext, this, fontName);
 }
 
+EStatusCode CFFANSIFontWriter::PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+													WrittenFontRepresentation* inFontOccurrence)
+{
+	const char* fontType = inFontInfo.GetTypeString();
+
+	if (strcmp(scType1Type, fontType) == 0)
+	{
+		Type1ToCFFEmbeddedFontWriter embeddedFontWriter;
+
+		return embeddedFontWriter.PrepareEmbeddedFont(inFontInfo,
+			inFontOccurrence->GetGlyphIDsAsOrderedVector(),
+			inFontOccurrence->mPreparedEmbeddedFont.mSubsetFontName,
+			inFontOccurrence->mPreparedEmbeddedFont);
+	}
+	else if (strcmp(scCFF, fontType) == 0)
+	{
+		CFFEmbeddedFontWriter embeddedFontWriter;
+
+		return embeddedFontWriter.PrepareEmbeddedFont(inFontInfo,
+			inFontOccurrence->GetGlyphIDsAsOrderedVector(),
+			inFontOccurrence->mPreparedEmbeddedFont.mSubsetFontName,
+			NULL,
+			inFontOccurrence->mPreparedEmbeddedFont);
+	}
+	else
+	{
+		// unfamiliar font type. leave it for WriteFont to fail
+		return PDFHummus::eFailure;
+	}
+}
+
 static const char* scType1 = "Type1";
 void CFFANSIFontWriter::WriteSubTypeValue(DictionaryContext* inDictionary)
 {
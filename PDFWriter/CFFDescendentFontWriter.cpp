@@ -44,12 +44,32 @@ CFFDescendentFontWriter::~CFFDescendentFontWriter(void)
 
 static const std::string scCIDFontType0C = "CIDFontType0C";
 static const char* scType1 = "Type 1";
+
+static void GetSubsetGlyphsAndCIDMapping(const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,UIntVector& outOrderedGlyphs,UShortVector& outCIDMapping)
+{
+	// Gal: the following sort completely ruins everything.
+	// the order of the glyphs should be maintained per the ENCODED characthers
+	// which is how the input is recieved. IMPORTANT - the order is critical
+	// for the success of the embedding, as the order determines the order of the glyphs
+	// in the subset font and so their GID which MUST match the encoded char.
+	//sort(encodedGlyphs.begin(), encodedGlyphs.end(), sEncodedGlypsSort);
+
+	for (UIntAndGlyphEncodingInfoVector::const_iterator it = inEncodedGlyphs.begin();
+		it != inEncodedGlyphs.end();
+		++it)
+	{
+		outOrderedGlyphs.push_back(it->first);
+		outCIDMapping.push_back(it->second.mEncodedCharacter);
+	}
+}
+
 EStatusCode CFFDescendentFontWriter::WriteFont(	ObjectIDType inDecendentObjectID, 
 														const std::string& inFontName,
 														FreeTypeFaceWrapper& inFontInfo,
 														const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
 														ObjectsContext* inObjectsContext,
-														bool inEmbedFont)
+														bool inEmbedFont,
+														PreparedEmbeddedFont& inPreparedFont)
 {
 	// reset embedded font object ID (and flag...to whether it was actually embedded or not, which may 
 	// happen due to font embedding restrictions)
@@ -69,31 +89,29 @@ EStatusCode CFFDescendentFontWriter::WriteFont(	ObjectIDType inDecendentObjectID
 	if (inEmbedFont)
 	{
 		CFFEmbeddedFontWriter embeddedFontWriter;
-		UIntAndGlyphEncodingInfoVector encodedGlyphs = inEncodedGlyphs;
-		UIntVector orderedGlyphs;
-		UShortVector cidMapping;
-
-		// Gal: the following sort completely ruins everything.
-		// the order of the glyphs should be maintained per the ENCODED characthers
-		// which is how the input is recieved. IMPORTANT - the order is critical
-		// for the success of the embedding, as the order determines the order of the glyphs
-		// in the subset font and so their GID which MUST match the encoded char.
-		//sort(encodedGlyphs.begin(), encodedGlyphs.end(), sEncodedGlypsSort);
-
-		for (UIntAndGlyphEncodingInfoVector::const_iterator it = encodedGlyphs.begin();
-			it != encodedGlyphs.end();
-			++it)
+		EStatusCode status;
+
+		if(inPreparedFont.mIsPrepared)
 		{
-			orderedGlyphs.push_back(it->first);
-			cidMapping.push_back(it->second.mEncodedCharacter);
+			status = embeddedFontWriter.WriteEmbeddedFont(inPreparedFont,
+				scCIDFontType0C,
+				inObjectsContext,
+				mEmbeddedFontFileObjectID);
+		}
+		else
+		{
+			UIntVector orderedGlyphs;
+			UShortVector cidMapping;
+
+			GetSubsetGlyphsAndCIDMapping(inEncodedGlyphs,orderedGlyphs,cidMapping);
+			status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
+				orderedGlyphs,
+				scCIDFontType0C,
+				inFontName,
+				inObjectsContext,
+				&cidMapping,
+				mEmbeddedFontFileObjectID);
 		}
-		EStatusCode status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
-			orderedGlyphs,
-			scCIDFontType0C,
-			inFontName,
-			inObjectsContext,
-			&cidMapping,
-			mEmbeddedFontFileObjectID);
 		if (status != PDFHummus::eSuccess)
 			return status;
 	}
@@ -103,6 +121,26 @@ EStatusCode CFFDescendentFontWriter::WriteFont(	ObjectIDType inDecendentObjectID
 	return descendentFontWriter.WriteFont(inDecendentObjectID,inFontName,inFontInfo,inEncodedGlyphs,inObjectsContext,this);
 }
 
+EStatusCode CFFDescendentFontWriter::PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+															const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
+															PreparedEmbeddedFont& ioPreparedFont)
+{
+	// type 1 CIDs are not supported. leave it for WriteFont to fail
+	if(strcmp(scType1,inFontInfo.GetTypeString()) == 0)
+		return PDFHummus::eFailure;
+
+	CFFEmbeddedFontWriter embeddedFontWriter;
+	UIntVector orderedGlyphs;
+	UShortVector cidMapping;
+
+	GetSubsetGlyphsAndCIDMapping(inEncodedGlyphs,orderedGlyphs,cidMapping);
+	return embeddedFontWriter.PrepareEmbeddedFont(inFontInfo,
+		orderedGlyphs,
+		ioPreparedFont.mSubsetFontName,
+		&cidMapping,
+		ioPreparedFont);
+}
+
 static const std::string scCIDFontType0 = "CIDFontType0";
 
 void CFFDescendentFontWriter::WriteSubTypeValue(DictionaryContext* inDescendentFontContext)
@@ -39,6 +39,7 @@ using namespace PDFHummus;
 
 CFFEmbeddedFontWriter::CFFEmbeddedFontWriter(void)
 {
+	mOpenTypeStream = NULL;
 }
 
 CFFEmbeddedFontWriter::~CFFEmbeddedFontWriter(void)
@@ -67,22 +68,44 @@ EStatusCode CFFEmbeddedFontWriter::WriteEmbeddedFont(
 	UShortVector* inCIDMapping,
 	ObjectIDType& outEmbeddedFontObjectID)
 {
-	MyStringBuf rawFontProgram; 
-	bool notEmbedded;
-		// as oppose to true type, the reason for using a memory stream here is mainly peformance - i don't want to start
-		// setting file pointers and move in a file stream
-	EStatusCode status;
+	PreparedEmbeddedFont preparedFont;
+
+	PrepareEmbeddedFont(inFontInfo,inSubsetGlyphIDs,inSubsetFontName,inCIDMapping,preparedFont);
+	return WriteEmbeddedFont(preparedFont,inFontFile3SubType,inObjectsContext,outEmbeddedFontObjectID);
+}
+
+EStatusCode CFFEmbeddedFontWriter::PrepareEmbeddedFont(
+	FreeTypeFaceWrapper& inFontInfo,
+	const UIntVector& inSubsetGlyphIDs,
+	const std::string& inSubsetFontName,
+	UShortVector* inCIDMapping,
+	PreparedEmbeddedFont& outPreparedFont)
+{
+	// as oppose to true type, the reason for using a memory stream here is mainly peformance - i don't want to start
+	// setting file pointers and move in a file stream
+	outPreparedFont.mStatus = CreateCFFSubset(inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName,outPreparedFont.mNotEmbedded,outPreparedFont.mFontProgram);
+	outPreparedFont.mIsPrepared = true;
+	return outPreparedFont.mStatus;
+}
+
+EStatusCode CFFEmbeddedFontWriter::WriteEmbeddedFont(
+	PreparedEmbeddedFont& inPreparedFont,
+	const std::string& inFontFile3SubType,
+	ObjectsContext* inObjectsContext,
+	ObjectIDType& outEmbeddedFontObjectID)
+{
+	MyStringBuf& rawFontProgram = inPreparedFont.mFontProgram;
+	EStatusCode status = inPreparedFont.mStatus;
 
 	do
 	{
-		status = CreateCFFSubset(inFontInfo,inSubsetGlyphIDs,inCIDMapping,inSubsetFontName,notEmbedded,rawFontProgram);
 		if(status != PDFHummus::eSuccess)
 		{
 			TRACE_LOG("CFFEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
 			break;
 		}	
 
-		if(notEmbedded)
+		if(inPreparedFont.mNotEmbedded)
 		{
 			// can't embed. mark succesful, and go back empty
 			outEmbeddedFontObjectID = 0;
@@ -133,14 +156,28 @@ EStatusCode CFFEmbeddedFontWriter::CreateCFFSubset(
 	do
 	{
 
-		status = mOpenTypeFile.OpenFile(inFontInfo.GetFontFilePath());
-		if(status != PDFHummus::eSuccess)
+		// read from the bytes that the face was opened from, or the shared font program bytes if the font program cache is enabled. otherwise
+		// read from the font file. CFF tables are parsed here either way, as reading charstrings goes through the parser stream
+		mFontProgram = inFontInfo.GetFontProgram();
+		if(!mFontProgram)
+			mFontProgram = FontProgramCache::DefaultCache().GetFontProgram(inFontInfo.GetFontFilePath(),inFontInfo.GetFontIndex());
+		if(mFontProgram)
 		{
-			TRACE_LOG1("CFFEmbeddedFontWriter::CreateCFFSubset, cannot open type font file at %s",inFontInfo.GetFontFilePath().c_str());
-			break;
+			mFontProgramStream.Assign((Byte*)mFontProgram->GetData(),mFontProgram->GetSize());
+			mOpenTypeStream = &mFontProgramStream;
+		}
+		else
+		{
+			status = mOpenTypeFile.OpenFile(inFontInfo.GetFontFilePath());
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG1("CFFEmbeddedFontWriter::CreateCFFSubset, cannot open type font file at %s",inFontInfo.GetFontFilePath().c_str());
+				break;
+			}
+			mOpenTypeStream = mOpenTypeFile.GetInputStream();
 		}
 
-		status = mOpenTypeInput.ReadOpenTypeFile(mOpenTypeFile.GetInputStream(),(unsigned short)inFontInfo.GetFontIndex());
+		status = mOpenTypeInput.ReadOpenTypeFile(mOpenTypeStream,(unsigned short)inFontInfo.GetFontIndex());
 		if(status != PDFHummus::eSuccess)
 		{
 			TRACE_LOG("CFFEmbeddedFontWriter::CreateCFFSubset, failed to read true type file");
@@ -269,6 +306,7 @@ EStatusCode CFFEmbeddedFontWriter::CreateCFFSubset(
 	}while(false);
 
 	mOpenTypeFile.CloseFile();
+	mOpenTypeStream = NULL;
 	return status;
 }
 
@@ -336,8 +374,8 @@ EStatusCode CFFEmbeddedFontWriter::WriteCFFHeader()
 	 // i'll probably just set it to something.
 	
 	OutputStreamTraits streamCopier(&mFontFileStream);
-	mOpenTypeFile.GetInputStream()->SetPosition(mOpenTypeInput.mCFF.mCFFOffset);
-	return streamCopier.CopyToOutputStream(mOpenTypeFile.GetInputStream(),mOpenTypeInput.mCFF.mHeader.hdrSize);
+	mOpenTypeStream->SetPosition(mOpenTypeInput.mCFF.mCFFOffset);
+	return streamCopier.CopyToOutputStream(mOpenTypeStream,mOpenTypeInput.mCFF.mHeader.hdrSize);
 }
 
 EStatusCode CFFEmbeddedFontWriter::WriteName(const std::string& inSubsetFontName)
@@ -535,8 +573,8 @@ EStatusCode CFFEmbeddedFontWriter::WriteStringIndex()
 		// starting position is equal to the strings end position. hence length is...
 
 		OutputStreamTraits streamCopier(&mFontFileStream);
-		mOpenTypeFile.GetInputStream()->SetPosition(mOpenTypeInput.mCFF.mCFFOffset + mOpenTypeInput.mCFF.mStringIndexPosition);
-		return streamCopier.CopyToOutputStream(mOpenTypeFile.GetInputStream(),
+		mOpenTypeStream->SetPosition(mOpenTypeInput.mCFF.mCFFOffset + mOpenTypeInput.mCFF.mStringIndexPosition);
+		return streamCopier.CopyToOutputStream(mOpenTypeStream,
 												(LongBufferSizeType)(mOpenTypeInput.mCFF.mGlobalSubrsPosition -
 												mOpenTypeInput.mCFF.mStringIndexPosition));
 	}
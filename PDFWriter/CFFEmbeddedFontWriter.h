@@ -28,6 +28,9 @@
 #include "CFFPrimitiveWriter.h"
 #include "OutputStringBufferStream.h"
 #include "IOBasicTypes.h"
+#include "FontProgramCache.h"
+#include "InputByteArrayStream.h"
+#include "WrittenFontRepresentation.h"
 
 #include <vector>
 #include <string>
@@ -82,10 +85,24 @@ public:
 									UShortVector* inCIDMapping,
 									ObjectIDType& outEmbeddedFontObjectID);
 
+	// split version of WriteEmbeddedFont. PrepareEmbeddedFont only creates the subset font program, and does not use the objects context,
+	// so fonts may be prepared in parallel (a writer per font). the second WriteEmbeddedFont writes the prepared program
+	PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+									const UIntVector& inSubsetGlyphIDs,
+									const std::string& inSubsetFontName,
+									UShortVector* inCIDMapping,
+									PreparedEmbeddedFont& outPreparedFont);
+	PDFHummus::EStatusCode WriteEmbeddedFont(	PreparedEmbeddedFont& inPreparedFont,
+									const std::string& inFontFile3SubType,
+									ObjectsContext* inObjectsContext,
+									ObjectIDType& outEmbeddedFontObjectID);
 
 private:
 	OpenTypeFileInput mOpenTypeInput;
+	FontProgramSharedPtr mFontProgram;
+	InputByteArrayStream mFontProgramStream;
 	InputFile mOpenTypeFile;
+	IByteReaderWithPosition* mOpenTypeStream; // either mFontProgramStream, or mOpenTypeFile stream
 	CFFPrimitiveWriter mPrimitivesWriter;
 	OutputStringBufferStream mFontFileStream;
 	bool mIsCID;
@@ -90,7 +90,12 @@ EStatusCode CIDFontWriter::WriteFont(FreeTypeFaceWrapper& inFontInfo,
 			status = PDFHummus::eFailure;
 			break;
 		}
-		std::string fontName = inEmbedFont ? (inObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName) : postscriptFontName;
+		// subset font name may have been generated already, when the embedded font was prepared ahead
+		std::string fontName = inEmbedFont ? 
+									(inFontOccurrence->mPreparedEmbeddedFont.mSubsetFontName.empty() ?
+										(inObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName) :
+										inFontOccurrence->mPreparedEmbeddedFont.mSubsetFontName) :
+									postscriptFontName;
 		fontContext->WriteNameValue(fontName);
 
 		WriteEncoding(fontContext);
@@ -133,13 +138,26 @@ EStatusCode CIDFontWriter::WriteFont(FreeTypeFaceWrapper& inFontInfo,
 		}
 
 		// Write the descendant font
-		status = inDescendentFontWriter->WriteFont(descendantFontID, fontName, *mFontInfo, mCharactersVector, mObjectsContext, inEmbedFont);
+		status = inDescendentFontWriter->WriteFont(descendantFontID, fontName, *mFontInfo, mCharactersVector, mObjectsContext, inEmbedFont, inFontOccurrence->mPreparedEmbeddedFont);
 
 	} while(false);
 
+	inFontOccurrence->mPreparedEmbeddedFont.Reset();
+
 	return status;
 }
 
+EStatusCode CIDFontWriter::PrepareEmbeddedFont(FreeTypeFaceWrapper& inFontInfo,
+												WrittenFontRepresentation* inFontOccurrence,
+												IDescendentFontWriter* inDescendentFontWriter)
+{
+	mFontInfo = &inFontInfo;
+	mFontOccurrence = inFontOccurrence;
+
+	CalculateCharacterEncodingArray(); // same glyphs order as when writing
+	return inDescendentFontWriter->PrepareEmbeddedFont(inFontInfo, mCharactersVector, inFontOccurrence->mPreparedEmbeddedFont);
+}
+
 static const std::string scEncoding = "Encoding";
 static const std::string scIdentityH = "Identity-H";
 void CIDFontWriter::WriteEncoding(DictionaryContext* inFontContext)
@@ -50,6 +50,12 @@ public:
 							IDescendentFontWriter* inDescendentFontWriter,
 							bool inEmbedFont);
 
+	// create the embedded font program ahead of WriteFont, into inFontOccurrence prepared embedded font (which should have its subset font name set).
+	// does not use the objects context
+	PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+									WrittenFontRepresentation* inFontOccurrence,
+									IDescendentFontWriter* inDescendentFontWriter);
+
 private:
 
 	FreeTypeFaceWrapper* mFontInfo;
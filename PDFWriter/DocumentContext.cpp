@@ -50,6 +50,9 @@
 #include "IPageEndWritingTask.h"
 #include "ITiledPatternEndWritingTask.h"
 #include "PDFPageInput.h"
+#include "PDFImageXObject.h"
+#include "InputFile.h"
+#include "InputByteArrayStream.h"
 
 
 using namespace PDFHummus;
@@ -66,6 +69,11 @@ DocumentContext::~DocumentContext(void)
     Cleanup();
 }
 
+ObjectsContext* DocumentContext::GetObjectsContext()
+{
+	return mObjectsContext;
+}
+
 void DocumentContext::SetObjectsContext(ObjectsContext* inObjectsContext)
 {
 	mObjectsContext = inObjectsContext;
@@ -84,6 +92,22 @@ void DocumentContext::SetEmbedFonts(bool inEmbedFonts) {
 	mUsedFontsRepository.SetEmbedFonts(inEmbedFonts);
 }
 
+void DocumentContext::SetSubsetFontsInParallel(bool inSubsetFontsInParallel) {
+	mUsedFontsRepository.SetSubsetFontsInParallel(inSubsetFontsInParallel);
+}
+
+void DocumentContext::SetLoadFontsToMemory(bool inLoadFontsToMemory) {
+	mUsedFontsRepository.SetLoadFontsToMemory(inLoadFontsToMemory);
+}
+
+void DocumentContext::SetDeduplicateImages(bool inDeduplicateImages) {
+	mImageContentRegistry.SetEnabled(inDeduplicateImages);
+}
+
+ImageContentRegistry& DocumentContext::GetImageContentRegistry() {
+	return mImageContentRegistry;
+}
+
 void DocumentContext::SetOutputFileInformation(OutputFile* inOutputFile)
 {
 	// just save the output file path for the ID generation in the end
@@ -215,13 +239,23 @@ EStatusCode	DocumentContext::FinalizeNewPDF()
 		// write encryption dictionary, if encrypting
 		WriteEncryptionDictionary();
 
-		status = mObjectsContext->WriteXrefTable(xrefTablePosition);
-		if(status != 0)
-			break;
+		if(mObjectsContext->IsWritingObjectStreams())
+		{
+			// objects in object streams require an xref stream, which doubles as the trailer
+			status = WriteXrefStream(xrefTablePosition);
+			if(status != 0)
+				break;
+		}
+		else
+		{
+			status = mObjectsContext->WriteXrefTable(xrefTablePosition);
+			if(status != 0)
+				break;
 
-		status = WriteTrailerDictionary();
-		if(status != 0)
-			break;
+			status = WriteTrailerDictionary();
+			if(status != 0)
+				break;
+		}
 
 		WriteXrefReference(xrefTablePosition);
 		WriteFinalEOF();
@@ -1274,15 +1308,63 @@ bool DocumentContext::IsIdentityMatrix(const double* inMatrix)
 
 PDFImageXObject* DocumentContext::CreateImageXObjectFromJPGFile(const std::string& inJPGFilePath)
 {
-	return mJPEGImageHandler.CreateImageXObjectFromJPGFile(inJPGFilePath);
+	InputFile jpgFile;
+	if(!mImageContentRegistry.IsEnabled() || jpgFile.OpenFile(inJPGFilePath) != eSuccess)
+		return mJPEGImageHandler.CreateImageXObjectFromJPGFile(inJPGFilePath);
+
+	return CreateImageXObjectFromJPGStream(jpgFile.GetInputStream());
 }
 
 PDFFormXObject* DocumentContext::CreateFormXObjectFromJPGFile(const std::string& inJPGFilePath)
 {
-	return mJPEGImageHandler.CreateFormXObjectFromJPGFile(inJPGFilePath);
+	InputFile jpgFile;
+	if(!mImageContentRegistry.IsEnabled() || jpgFile.OpenFile(inJPGFilePath) != eSuccess)
+		return mJPEGImageHandler.CreateFormXObjectFromJPGFile(inJPGFilePath);
+
+	return CreateFormXObjectFromJPGStream(jpgFile.GetInputStream());
+}
+
+PDFImageXObject* DocumentContext::CreateImageXObjectForRegisteredImage(const ImageContentEntry& inEntry)
+{
+	PDFImageXObject* imageXObject = new PDFImageXObject(inEntry.ObjectID);
+
+	StringList::const_iterator it = inEntry.RequiredProcsets.begin();
+	for(; it != inEntry.RequiredProcsets.end(); ++it)
+		imageXObject->AddRequiredProcset(*it);
+	return imageXObject;
+}
+
+PDFFormXObject* DocumentContext::CreateFormXObjectForRegisteredImage(const ImageContentEntry& inEntry)
+{
+	// the form is already written, so it gets no content stream
+	return new PDFFormXObject(this,inEntry.ObjectID,NULL,inEntry.ResourcesDictionaryID);
+}
+
+void DocumentContext::RegisterImageFormXObject(const ImageContentKey& inKey,ByteVector& ioImageData,PDFFormXObject* inFormXObject)
+{
+	if(inFormXObject)
+		mImageContentRegistry.Register(inKey,ioImageData,ImageContentEntry(inFormXObject->GetObjectID(),inFormXObject->GetResourcesDictionaryObjectID()));
 }
 
 #ifndef PDFHUMMUS_NO_PNG
+PDFFormXObject* DocumentContext::CreateFormXObjectFromPNGStream(IByteReaderWithPosition* inPNGStream)
+{
+	if(!mImageContentRegistry.IsEnabled())
+		return mPNGImageHandler.CreateFormXObjectFromPNGStream(inPNGStream,mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID());
+
+	ByteVector imageData;
+	ImageContentKey key = ImageContentRegistry::ReadImageContent(inPNGStream,"PNGForm",imageData);
+	const ImageContentEntry* entry = mImageContentRegistry.Find(key,imageData);
+	if(entry)
+		return CreateFormXObjectForRegisteredImage(*entry);
+
+	// write from the data that was read already
+	InputByteArrayStream imageDataStream(imageData.empty() ? NULL : &(imageData[0]),imageData.size());
+	PDFFormXObject* formXObject = mPNGImageHandler.CreateFormXObjectFromPNGStream(&imageDataStream,mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID());
+	RegisterImageFormXObject(key,imageData,formXObject);
+	return formXObject;
+}
+
 PDFFormXObject* DocumentContext::CreateFormXObjectFromPNGStream(IByteReaderWithPosition* inPNGStream, ObjectIDType inFormXObjectId)
 {
 	return mPNGImageHandler.CreateFormXObjectFromPNGStream(inPNGStream, inFormXObjectId);
@@ -1294,17 +1376,50 @@ JPEGImageHandler& DocumentContext::GetJPEGImageHandler()
 	return mJPEGImageHandler;
 }
 
+// the parameters that affect how the image is written, as raw bytes. only ever compared
+template <typename T>
+static void AppendUsageValue(std::string& ioUsage,const T& inValue)
+{
+	ioUsage.append((const char*)&inValue,sizeof(T));
+}
+
 #ifndef PDFHUMMUS_NO_TIFF
 TIFFImageHandler& DocumentContext::GetTIFFImageHandler()
 {
 	return mTIFFImageHandler;
 }
 
+static void AppendUsageColor(std::string& ioUsage,const CMYKRGBColor& inColor)
+{
+	AppendUsageValue(ioUsage,inColor.UseCMYK);
+	ioUsage.append((const char*)inColor.RGBComponents,3);
+	ioUsage.append((const char*)inColor.CMYKComponents,4);
+}
+
+static std::string GetTIFFUsage(const TIFFUsageParameters& inTIFFUsageParameters)
+{
+	std::string usage("TIFFForm");
+
+	AppendUsageValue(usage,inTIFFUsageParameters.PageIndex);
+	AppendUsageValue(usage,inTIFFUsageParameters.MaxImageBufferSize);
+	AppendUsageValue(usage,inTIFFUsageParameters.UsePassthrough);
+	AppendUsageValue(usage,inTIFFUsageParameters.BWTreatment.AsImageMask);
+	AppendUsageColor(usage,inTIFFUsageParameters.BWTreatment.OneColor);
+	AppendUsageValue(usage,inTIFFUsageParameters.GrayscaleTreatment.AsColorMap);
+	AppendUsageColor(usage,inTIFFUsageParameters.GrayscaleTreatment.OneColor);
+	AppendUsageColor(usage,inTIFFUsageParameters.GrayscaleTreatment.ZeroColor);
+	return usage;
+}
+
 PDFFormXObject* DocumentContext::CreateFormXObjectFromTIFFFile(	const std::string& inTIFFFilePath,
 																const TIFFUsageParameters& inTIFFUsageParameters)
 {
-	
-	return mTIFFImageHandler.CreateFormXObjectFromTIFFFile(inTIFFFilePath,inTIFFUsageParameters);
+	InputFile tiffFile;
+	// OutImageDataPath can't be reported for a reused image, so those are always written
+	if(!mImageContentRegistry.IsEnabled() || inTIFFUsageParameters.OutImageDataPath || tiffFile.OpenFile(inTIFFFilePath) != eSuccess)
+		return mTIFFImageHandler.CreateFormXObjectFromTIFFFile(inTIFFFilePath,inTIFFUsageParameters);
+
+	return CreateFormXObjectFromTIFFStream(tiffFile.GetInputStream(),inTIFFUsageParameters);
 }
 
 PDFFormXObject* DocumentContext::CreateFormXObjectFromTIFFFile(
@@ -1318,7 +1433,19 @@ PDFFormXObject* DocumentContext::CreateFormXObjectFromTIFFFile(
 PDFFormXObject* DocumentContext::CreateFormXObjectFromTIFFStream(IByteReaderWithPosition* inTIFFStream,
                                                                  const TIFFUsageParameters& inTIFFUsageParameters)
 {
-	return mTIFFImageHandler.CreateFormXObjectFromTIFFStream(inTIFFStream,inTIFFUsageParameters);
+	if(!mImageContentRegistry.IsEnabled() || inTIFFUsageParameters.OutImageDataPath)
+		return mTIFFImageHandler.CreateFormXObjectFromTIFFStream(inTIFFStream,inTIFFUsageParameters);
+
+	ByteVector imageData;
+	ImageContentKey key = ImageContentRegistry::ReadImageContent(inTIFFStream,GetTIFFUsage(inTIFFUsageParameters),imageData);
+	const ImageContentEntry* entry = mImageContentRegistry.Find(key,imageData);
+	if(entry)
+		return CreateFormXObjectForRegisteredImage(*entry);
+
+	InputByteArrayStream imageDataStream(imageData.empty() ? NULL : &(imageData[0]),imageData.size());
+	PDFFormXObject* formXObject = mTIFFImageHandler.CreateFormXObjectFromTIFFStream(&imageDataStream,inTIFFUsageParameters);
+	RegisterImageFormXObject(key,imageData,formXObject);
+	return formXObject;
 }
 
 PDFFormXObject* DocumentContext::CreateFormXObjectFromTIFFStream(IByteReaderWithPosition* inTIFFStream,
@@ -1328,6 +1455,13 @@ PDFFormXObject* DocumentContext::CreateFormXObjectFromTIFFStream(IByteReaderWith
 	return mTIFFImageHandler.CreateFormXObjectFromTIFFStream(inTIFFStream,inFormXObjectID,inTIFFUsageParameters);
 }
 
+EStatusCodeAndPDFFormXObjectVector DocumentContext::CreateFormXObjectsFromTIFFFile(const std::string& inTIFFFilePath,
+																	 const UIntVector& inPageIndexes,
+																	 const TIFFUsageParameters& inTIFFUsageParameters)
+{
+	return mTIFFImageHandler.CreateFormXObjectsFromTIFFFile(inTIFFFilePath,inPageIndexes,inTIFFUsageParameters);
+}
+
 #endif
 
 PDFImageXObject* DocumentContext::CreateImageXObjectFromJPGFile(const std::string& inJPGFilePath,ObjectIDType inImageXObjectID)
@@ -1998,7 +2132,20 @@ EStatusCode DocumentContext::MergePDFPagesToPage(PDFPage* inPage,
 
 PDFImageXObject* DocumentContext::CreateImageXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream)
 {
-	return mJPEGImageHandler.CreateImageXObjectFromJPGStream(inJPGStream);
+	if(!mImageContentRegistry.IsEnabled())
+		return mJPEGImageHandler.CreateImageXObjectFromJPGStream(inJPGStream);
+
+	ByteVector imageData;
+	ImageContentKey key = ImageContentRegistry::ReadImageContent(inJPGStream,"JPGImage",imageData);
+	const ImageContentEntry* entry = mImageContentRegistry.Find(key,imageData);
+	if(entry)
+		return CreateImageXObjectForRegisteredImage(*entry);
+
+	InputByteArrayStream imageDataStream(imageData.empty() ? NULL : &(imageData[0]),imageData.size());
+	PDFImageXObject* imageXObject = mJPEGImageHandler.CreateImageXObjectFromJPGStream(&imageDataStream);
+	if(imageXObject)
+		mImageContentRegistry.Register(key,imageData,ImageContentEntry(imageXObject->GetImageObjectID(),0,imageXObject->GetRequiredProcsetResourceNames()));
+	return imageXObject;
 }
 
 PDFImageXObject* DocumentContext::CreateImageXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream,ObjectIDType inImageXObjectID)
@@ -2008,8 +2155,19 @@ PDFImageXObject* DocumentContext::CreateImageXObjectFromJPGStream(IByteReaderWit
 
 PDFFormXObject* DocumentContext::CreateFormXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream)
 {
-	return mJPEGImageHandler.CreateFormXObjectFromJPGStream(inJPGStream);
+	if(!mImageContentRegistry.IsEnabled())
+		return mJPEGImageHandler.CreateFormXObjectFromJPGStream(inJPGStream);
+
+	ByteVector imageData;
+	ImageContentKey key = ImageContentRegistry::ReadImageContent(inJPGStream,"JPGForm",imageData);
+	const ImageContentEntry* entry = mImageContentRegistry.Find(key,imageData);
+	if(entry)
+		return CreateFormXObjectForRegisteredImage(*entry);
 
+	InputByteArrayStream imageDataStream(imageData.empty() ? NULL : &(imageData[0]),imageData.size());
+	PDFFormXObject* formXObject = mJPEGImageHandler.CreateFormXObjectFromJPGStream(&imageDataStream);
+	RegisterImageFormXObject(key,imageData,formXObject);
+	return formXObject;
 }
 
 PDFFormXObject* DocumentContext::CreateFormXObjectFromJPGStream(IByteReaderWithPosition* inJPGStream,ObjectIDType inFormXObjectID)
@@ -2080,6 +2238,7 @@ void DocumentContext::Cleanup()
 	mTIFFImageHandler.Reset();
 #endif
 	mUsedFontsRepository.Reset();
+	mImageContentRegistry.Reset();
 	mOutputFilePath.clear();
 	mExtenders.clear();
 	mAnnotations.clear();
@@ -2583,6 +2742,8 @@ EStatusCode DocumentContext::WriteXrefStream(LongFilePositionType& outXrefPositi
         // start the xref with a dictionary detailing the trailer information, then move to the
         // xref table aspects, with the lower level objects context.
         
+        // all objects should be placed before the xref, including ones still waiting in an object stream
+        mObjectsContext->FlushObjectStreams();
         outXrefPosition = mObjectsContext->GetCurrentPosition();
         mObjectsContext->StartNewIndirectObject();
  
@@ -2745,7 +2906,7 @@ DoubleAndDoublePair DocumentContext::GetImageDimensions(
 				PDFParser pdfParser;
                 
 				InputFile file;
-				if(file.OpenFile(inImageFile) != eSuccess)
+				if(file.OpenFile(inImageFile,inOptions.MemoryMapInputFile) != eSuccess)
 					break;
 				if(pdfParser.StartPDFParsing(file.GetInputStream(), inOptions) != eSuccess)
 					break;
@@ -2894,7 +3055,7 @@ unsigned long DocumentContext::GetImagePagesCount(
 			PDFParser pdfParser;
 
 			InputFile file;
-			if (file.OpenFile(inImageFile) != eSuccess)
+			if (file.OpenFile(inImageFile,inOptions.MemoryMapInputFile) != eSuccess)
 				break;
 			if (pdfParser.StartPDFParsing(file.GetInputStream(), inOptions) != eSuccess)
 				break;
@@ -3006,12 +3167,57 @@ HummusImageInformation& DocumentContext::GetImageInformationStructFor(const std:
 }
 
 
+bool DocumentContext::GetImageContentKeyForDrawing(const std::string& inImageFile,unsigned long inImageIndex,ImageContentKey& outKey,ByteVector& outImageData)
+{
+	// forms for drawing are written later, with WriteFormForImage. PDF pages are not keyed by content
+	std::string usage;
+
+	switch(GetImageType(inImageFile,inImageIndex))
+	{
+		case eJPG:
+			usage = "DrawJPG";
+			break;
+		case eTIFF:
+			usage = "DrawTIFF";
+			AppendUsageValue(usage,inImageIndex);
+			break;
+		case ePNG:
+			usage = "DrawPNG";
+			break;
+		default:
+			return false;
+	}
+
+	InputFile imageFile;
+	if(imageFile.OpenFile(inImageFile) != eSuccess)
+		return false;
+
+	outKey = ImageContentRegistry::ReadImageContent(imageFile.GetInputStream(),usage,outImageData);
+	return true;
+}
+
 ObjectIDTypeAndBool DocumentContext::RegisterImageForDrawing(const std::string& inImageFile,unsigned long inImageIndex)
 {
     HummusImageInformation& imageInformation = GetImageInformationStructFor(inImageFile,inImageIndex);
     bool firstTime;
-    
-    if(imageInformation.writtenObjectID == 0)
+    ImageContentKey key;
+    ByteVector imageData;
+
+    if(imageInformation.writtenObjectID == 0 && mImageContentRegistry.IsEnabled() && GetImageContentKeyForDrawing(inImageFile,inImageIndex,key,imageData))
+    {
+        // same image data under another path
+        const ImageContentEntry* entry = mImageContentRegistry.Find(key,imageData);
+        if(entry)
+        {
+            imageInformation.writtenObjectID = entry->ObjectID;
+            return ObjectIDTypeAndBool(imageInformation.writtenObjectID,false);
+        }
+
+        imageInformation.writtenObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
+        mImageContentRegistry.Register(key,imageData,ImageContentEntry(imageInformation.writtenObjectID,0));
+        firstTime = true;
+    }
+    else if(imageInformation.writtenObjectID == 0)
     {
         imageInformation.writtenObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
         firstTime = true;
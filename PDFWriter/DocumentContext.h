@@ -37,6 +37,7 @@
 #include "EncryptionOptions.h"
 #include "EncryptionHelper.h"
 #include "PNGImageHandler.h"
+#include "ImageContentRegistry.h"
 
 #include <string>
 #include <set>
@@ -111,8 +112,14 @@ namespace PDFHummus
 		~DocumentContext();
 
 		void SetObjectsContext(ObjectsContext* inObjectsContext);
+		ObjectsContext* GetObjectsContext();
 		void SetOutputFileInformation(OutputFile* inOutputFile);
 		void SetEmbedFonts(bool inEmbedFonts);
+		void SetSubsetFontsInParallel(bool inSubsetFontsInParallel);
+		void SetLoadFontsToMemory(bool inLoadFontsToMemory);
+		// reuse written image objects when the same image data is written again in the same way. see ImageContentRegistry
+		void SetDeduplicateImages(bool inDeduplicateImages);
+		ImageContentRegistry& GetImageContentRegistry();
 		PDFHummus::EStatusCode	WriteHeader(EPDFVersion inPDFVersion);
 		PDFHummus::EStatusCode	FinalizeNewPDF();
         PDFHummus::EStatusCode	FinalizeModifiedPDF(PDFParser* inModifiedFileParser,EPDFVersion inModifiedPDFVersion);
@@ -210,9 +217,13 @@ namespace PDFHummus
 		PDFFormXObject* CreateFormXObjectFromTIFFStream(	IByteReaderWithPosition* inTIFFStream,
 														ObjectIDType inFormXObjectID,
 														const TIFFUsageParameters& inTIFFUsageParameters = TIFFUsageParameters::DefaultTIFFUsageParameters());
+		EStatusCodeAndPDFFormXObjectVector CreateFormXObjectsFromTIFFFile(const std::string& inTIFFFilePath,
+															const UIntVector& inPageIndexes,
+															const TIFFUsageParameters& inTIFFUsageParameters = TIFFUsageParameters::DefaultTIFFUsageParameters());
 #endif
 #ifndef PDFHUMMUS_NO_PNG
 		// PNG
+		PDFFormXObject* CreateFormXObjectFromPNGStream(IByteReaderWithPosition* inPNGStream);
 		PDFFormXObject* CreateFormXObjectFromPNGStream(IByteReaderWithPosition* inPNGStream, ObjectIDType inFormXObjectID);
 #endif
 
@@ -385,6 +396,7 @@ namespace PDFHummus
         PDFPageToIPageEndWritingTaskListMap mPageEndTasks;
 		PDFTiledPatternToITiledPatternEndWritingTaskListMap mTiledPatternEndTasks;
 	    StringAndULongPairToHummusImageInformationMap mImagesInformation;
+		ImageContentRegistry mImageContentRegistry;
 		EncryptionHelper mEncryptionHelper;
 		
 		void WriteHeaderComment(EPDFVersion inPDFVersion);
@@ -434,5 +446,9 @@ namespace PDFHummus
 		bool RequiresXrefStream(PDFParser* inModifiedFileParser);
         PDFHummus::EStatusCode WriteXrefStream(LongFilePositionType& outXrefPosition);
 		HummusImageInformation& GetImageInformationStructFor(const std::string& inImageFile,unsigned long inImageIndex);
+		PDFImageXObject* CreateImageXObjectForRegisteredImage(const ImageContentEntry& inEntry);
+		PDFFormXObject* CreateFormXObjectForRegisteredImage(const ImageContentEntry& inEntry);
+		void RegisterImageFormXObject(const ImageContentKey& inKey,ByteVector& ioImageData,PDFFormXObject* inFormXObject);
+		bool GetImageContentKeyForDrawing(const std::string& inImageFile,unsigned long inImageIndex,ImageContentKey& outKey,ByteVector& outImageData);
 	};
 }
\ No newline at end of file
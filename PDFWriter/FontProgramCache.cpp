@@ -0,0 +1,194 @@
+/*
+   Source File : FontProgramCache.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "FontProgramCache.h"
+#include "InputFile.h"
+#include "Trace.h"
+
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+FontProgram::FontProgram(void)
+{
+	mTrueTypeInput = NULL;
+}
+
+FontProgram::~FontProgram(void)
+{
+	delete mTrueTypeInput;
+}
+
+EStatusCode FontProgram::Load(const std::string& inFontFilePath,long inFontIndex)
+{
+	InputFile fontFile;
+	EStatusCode status = eSuccess;
+
+	do
+	{
+		// map the file, and read it only if it can't be mapped
+		if(mMappedFile.Open(inFontFilePath) != eSuccess)
+		{
+			status = fontFile.OpenFile(inFontFilePath);
+			if(status != eSuccess)
+			{
+				TRACE_LOG1("FontProgram::Load, cannot open font file at %s",inFontFilePath.c_str());
+				break;
+			}
+
+			mData.resize((size_t)fontFile.GetFileSize());
+			if(mData.size() > 0 &&
+				fontFile.GetInputStream()->Read(&(mData[0]),mData.size()) != mData.size())
+			{
+				TRACE_LOG1("FontProgram::Load, failed to read font file at %s",inFontFilePath.c_str());
+				status = eFailure;
+				break;
+			}
+		}
+
+		// parse true type tables once, for all users. other fonts (CFF, type 1) only share the bytes
+		if(IsTrueTypeData())
+		{
+			OpenTypeFileInput* trueTypeInput = new OpenTypeFileInput();
+			mTrueTypeInputStream.Assign((Byte*)GetData(),GetSize());
+			if(trueTypeInput->ReadOpenTypeFile(&mTrueTypeInputStream,(unsigned short)inFontIndex) == eSuccess &&
+				trueTypeInput->GetOpenTypeFontType() == EOpenTypeTrueType)
+			{
+				mTrueTypeInput = trueTypeInput;
+			}
+			else
+				delete trueTypeInput;
+		}
+	}while(false);
+
+	fontFile.CloseFile();
+	return status;
+}
+
+bool FontProgram::IsTrueTypeData()
+{
+	// sfnt version of true type fonts, true type collections and dfonts (which may hold either true type or CFF)
+	if(GetSize() < 4)
+		return false;
+	const Byte* data = GetData();
+	unsigned long tag = ((unsigned long)data[0]<<24) | ((unsigned long)data[1]<<16) | ((unsigned long)data[2]<<8) | data[3];
+	return 0x00010000 == tag || 0x74727565 == tag /* true */ || 0x74746366 == tag /* ttcf */ || 0x00000100 == tag;
+}
+
+const Byte* FontProgram::GetData() const
+{
+	if(mMappedFile.GetData())
+		return mMappedFile.GetData();
+	return mData.size() > 0 ? &(mData[0]) : NULL;
+}
+
+LongBufferSizeType FontProgram::GetSize() const
+{
+	if(mMappedFile.GetData())
+		return (LongBufferSizeType)mMappedFile.GetFileSize();
+	return mData.size();
+}
+
+OpenTypeFileInput* FontProgram::GetTrueTypeInput() const
+{
+	return mTrueTypeInput;
+}
+
+FontProgramCache& FontProgramCache::DefaultCache()
+{
+	static FontProgramCache default_cache;
+	return default_cache;
+}
+
+FontProgramCache::FontProgramCache(void)
+{
+	mEnabled = false;
+	mHits = 0;
+	mMisses = 0;
+}
+
+FontProgramCache::~FontProgramCache(void)
+{
+}
+
+void FontProgramCache::SetEnabled(bool inEnabled)
+{
+	std::lock_guard<std::mutex> guard(mLock);
+
+	if(inEnabled && !mEnabled)
+	{
+		mHits = 0;
+		mMisses = 0;
+	}
+	if(!inEnabled)
+		mFontPrograms.clear();
+	mEnabled = inEnabled;
+}
+
+bool FontProgramCache::IsEnabled()
+{
+	std::lock_guard<std::mutex> guard(mLock);
+	return mEnabled;
+}
+
+void FontProgramCache::Clear()
+{
+	std::lock_guard<std::mutex> guard(mLock);
+	mFontPrograms.clear();
+}
+
+FontProgramSharedPtr FontProgramCache::GetFontProgram(const std::string& inFontFilePath,long inFontIndex)
+{
+	std::lock_guard<std::mutex> guard(mLock);
+
+	if(!mEnabled)
+		return FontProgramSharedPtr();
+
+	StringAndLongToFontProgramSharedPtrMap::iterator it = mFontPrograms.find(StringAndLongKey(inFontFilePath,inFontIndex));
+	if(it != mFontPrograms.end())
+	{
+		++mHits;
+		return it->second;
+	}
+
+	++mMisses;
+
+	// loading while locked. this happens once per font, and saves concurrent users from loading the same font
+	FontProgramSharedPtr fontProgram(new FontProgram());
+	if(fontProgram->Load(inFontFilePath,inFontIndex) != eSuccess)
+	{
+		TRACE_LOG1("FontProgramCache::GetFontProgram, failed to load font program from %s",inFontFilePath.c_str());
+		return FontProgramSharedPtr();
+	}
+
+	mFontPrograms.insert(StringAndLongToFontProgramSharedPtrMap::value_type(StringAndLongKey(inFontFilePath,inFontIndex),fontProgram));
+	return fontProgram;
+}
+
+unsigned long FontProgramCache::GetHits()
+{
+	std::lock_guard<std::mutex> guard(mLock);
+	return mHits;
+}
+
+unsigned long FontProgramCache::GetMisses()
+{
+	std::lock_guard<std::mutex> guard(mLock);
+	return mMisses;
+}
@@ -0,0 +1,108 @@
+/*
+   Source File : FontProgramCache.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "IOBasicTypes.h"
+#include "OpenTypeFileInput.h"
+#include "InputByteArrayStream.h"
+#include "InputMemoryMappedFileStream.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <memory>
+#include <mutex>
+
+/*
+	A font file loaded to memory, for sharing between documents (and threads). The file is memory mapped, so that its bytes are
+	paged in as they are used and shared with other processes using it. Files that can't be mapped are read to memory instead.
+	A mapped font file should not change while its font program is in use.
+	For TrueType fonts it also holds the tables parsed for subsetting (head, maxp, hhea, hmtx, OS/2, name, loca and glyf dependencies).
+	CFF fonts only share the file bytes. CFF subsetting keeps reading charstrings through the parser stream, so their tables are
+	parsed by each user, from memory.
+	Font programs are read only once loaded.
+*/
+class FontProgram
+{
+public:
+	FontProgram(void);
+	~FontProgram(void);
+
+	PDFHummus::EStatusCode Load(const std::string& inFontFilePath,long inFontIndex);
+
+	const IOBasicTypes::Byte* GetData() const;
+	IOBasicTypes::LongBufferSizeType GetSize() const;
+
+	// parsed tables, NULL if not a TrueType font. don't read through its stream, use an InputByteArrayStream over GetData instead
+	OpenTypeFileInput* GetTrueTypeInput() const;
+
+private:
+	InputMemoryMappedFileStream mMappedFile;
+	// font file bytes, when the file can't be mapped
+	std::vector<IOBasicTypes::Byte> mData;
+	OpenTypeFileInput* mTrueTypeInput;
+	InputByteArrayStream mTrueTypeInputStream;
+
+	bool IsTrueTypeData();
+};
+
+typedef std::shared_ptr<FontProgram> FontProgramSharedPtr;
+typedef std::pair<std::string,long> StringAndLongKey;
+typedef std::map<StringAndLongKey,FontProgramSharedPtr> StringAndLongToFontProgramSharedPtrMap;
+
+/*
+	Process wide cache of font programs, shared by all PDFWriter instances. Thread safe.
+	Disabled by default. When enabled, embedded font writers get the font file bytes (and parsed TrueType tables) from the cache instead of
+	reading the font file per document. Cached font programs are kept until Clear is called, or the cache is disabled, so enable it when the
+	set of fonts in use is bounded, and call Clear if font files change on disk.
+	Font programs in use by a document remain valid till it's done with them, even if cleared meanwhile.
+*/
+class FontProgramCache
+{
+public:
+	FontProgramCache(void);
+	~FontProgramCache(void);
+
+	static FontProgramCache& DefaultCache();
+
+	void SetEnabled(bool inEnabled);
+	bool IsEnabled();
+
+	// drops all cached font programs
+	void Clear();
+
+	// get the font program for the font file and font index (for font collections), loading it on first use.
+	// returns an empty pointer if the cache is disabled or the font file can't be read
+	FontProgramSharedPtr GetFontProgram(const std::string& inFontFilePath,long inFontIndex);
+
+	// statistics. counting since the cache was enabled
+	unsigned long GetHits();
+	unsigned long GetMisses();
+
+private:
+	std::mutex mLock;
+	bool mEnabled;
+	StringAndLongToFontProgramSharedPtrMap mFontPrograms;
+	unsigned long mHits;
+	unsigned long mMisses;
+};
@@ -675,6 +675,16 @@ long FreeTypeFaceWrapper::GetFontIndex()
     return mFontIndex;
 }
 
+void FreeTypeFaceWrapper::SetFontProgram(const FontProgramSharedPtr& inFontProgram)
+{
+	mFontProgram = inFontProgram;
+}
+
+FontProgramSharedPtr FreeTypeFaceWrapper::GetFontProgram()
+{
+	return mFontProgram;
+}
+
 FT_Short FreeTypeFaceWrapper::GetInPDFMeasurements(FT_Short inFontMeasurement)
 {
 	if(mFace)
@@ -30,10 +30,14 @@
 #include <list>
 #include <string>
 #include <vector>
+#include <memory>
 
 class IFreeTypeFaceExtender;
 class IWrittenFont;
 class ObjectsContext;
+class FontProgram;
+
+typedef std::shared_ptr<FontProgram> FontProgramSharedPtr;
 
 
 
@@ -102,6 +106,10 @@ public:
 	const std::string& GetFontFilePath();
     long GetFontIndex();
 
+	// font file bytes, when the face was opened from memory. embedded font writers use them instead of reading the font file again
+	void SetFontProgram(const FontProgramSharedPtr& inFontProgram);
+	FontProgramSharedPtr GetFontProgram();
+
 
 	// use this method to align measurements from (remember the dreaded point per EM!!!).
 	// all measurements in this class are already aligned...so no need to align them
@@ -126,6 +134,7 @@ private:
 	bool mHaslowercase;
 	std::string mFontFilePath;
     long mFontIndex;
+	FontProgramSharedPtr mFontProgram;
     std::string mNotDefGlyphName;
 	bool mGlyphIsLoaded;
 	unsigned int mCurrentGlyph;
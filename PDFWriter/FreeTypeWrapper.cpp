@@ -42,6 +42,7 @@ const char*  err_msg;
 
 FreeTypeWrapper::FreeTypeWrapper(void)
 {
+	mLoadFontsToMemory = false;
 	if(FT_Init_FreeType(&mFreeType))
 	{
 		TRACE_LOG("FreeTypeWrapper::FreeTypeWrapper, unexpected failure. failed to initialize Free Type");
@@ -61,14 +62,29 @@ FreeTypeWrapper::~FreeTypeWrapper(void)
 		}
 	}
 	mOpenStreams.clear();
+	mFontPrograms.clear();
 	if (mFreeType)
 		FT_Done_FreeType(mFreeType);
 
 }
 
+void FreeTypeWrapper::SetLoadFontsToMemory(bool inLoadFontsToMemory)
+{
+	mLoadFontsToMemory = inLoadFontsToMemory;
+}
+
+FontProgramSharedPtr FreeTypeWrapper::GetFontProgram(FT_Face inFace)
+{
+	FTFaceToFontProgramSharedPtrMap::iterator it = mFontPrograms.find(inFace);
+	return it == mFontPrograms.end() ? FontProgramSharedPtr() : it->second;
+}
+
 // using my own streams, to implement UTF8 paths
 FT_Face FreeTypeWrapper::NewFace(const std::string& inFilePath,FT_Long inFontIndex)
 {
+	if(mLoadFontsToMemory)
+		return NewMemoryFace(inFilePath,inFontIndex);
+
 	FT_Face face;
 	FT_Open_Args openFaceArguments;
 
@@ -98,6 +114,50 @@ FT_Face FreeTypeWrapper::NewFace(const std::string& inFilePath,FT_Long inFontInd
 	return face;
 }
 
+FT_Face FreeTypeWrapper::NewMemoryFace(const std::string& inFilePath,FT_Long inFontIndex)
+{
+	FT_Face face = NULL;
+	FT_Open_Args openFaceArguments;
+
+	do
+	{
+		FontProgramSharedPtr fontProgram = FontProgramCache::DefaultCache().GetFontProgram(inFilePath,inFontIndex);
+		if(!fontProgram)
+		{
+			fontProgram.reset(new FontProgram());
+			if(fontProgram->Load(inFilePath,inFontIndex) != PDFHummus::eSuccess)
+			{
+				TRACE_LOG1("FreeTypeWrapper::NewMemoryFace, Cannot load font file %s",inFilePath.c_str());
+				break;
+			}
+		}
+
+		openFaceArguments.flags = FT_OPEN_MEMORY;
+		openFaceArguments.memory_base = fontProgram->GetData();
+		openFaceArguments.memory_size = (FT_Long)fontProgram->GetSize();
+		openFaceArguments.pathname = NULL;
+		openFaceArguments.stream = NULL;
+		openFaceArguments.driver = NULL;
+		openFaceArguments.num_params = 0;
+		openFaceArguments.params = NULL;
+
+		FT_Error ftStatus =  FT_Open_Face(mFreeType,&openFaceArguments,inFontIndex,&face);
+
+		if(ftStatus)
+		{
+			TRACE_LOG2("FreeTypeWrapper::NewMemoryFace, unable to load font named %s with index %ld",inFilePath.c_str(),inFontIndex);
+			TRACE_LOG2("FreeTypeWrapper::NewMemoryFace, Free Type Error, Code = %d, Message = %s",ft_errors[ftStatus].err_code,ft_errors[ftStatus].err_msg);
+			face = NULL;
+			break;
+		}
+
+		// keep the font program for as long as the face is open
+		mFontPrograms.insert(FTFaceToFontProgramSharedPtrMap::value_type(face,fontProgram));
+	}while(false);
+
+	return face;
+}
+
 EStatusCode FreeTypeWrapper::FillOpenFaceArgumentsForUTF8String(const std::string& inFilePath, FT_Open_Args& ioArgs)
 {
 	ioArgs.flags = FT_OPEN_STREAM;
@@ -179,6 +239,7 @@ FT_Error FreeTypeWrapper::DoneFace(FT_Face ioFace)
 {
 	FT_Error status = FT_Done_Face(ioFace);
 	CleanStreamsForFace(ioFace);
+	mFontPrograms.erase(ioFace);
 	return status;
 }
 
@@ -192,8 +253,8 @@ void FreeTypeWrapper::CleanStreamsForFace(FT_Face inFace)
 		{
 			delete *itStreams;
 		}
+		mOpenStreams.erase(it);
 	}
-	mOpenStreams.erase(it);
 }
 
 
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "EStatusCode.h"
+#include "FontProgramCache.h"
 
 #include <string>
 #include <map>
@@ -33,6 +34,7 @@
 
 typedef std::list<FT_Stream> FTStreamList;
 typedef std::map<FT_Face,FTStreamList> FTFaceToFTStreamListMap;
+typedef std::map<FT_Face,FontProgramSharedPtr> FTFaceToFontProgramSharedPtrMap;
 
 class FreeTypeWrapper
 {
@@ -44,6 +46,13 @@ public:
 	FT_Face NewFace(const std::string& inFilePath,const std::string& inSecondaryFilePath,FT_Long inFontIndex);
 	FT_Error DoneFace(FT_Face ioFace);
 
+	// open faces from font files loaded to memory, rather than through file streams, saving a seek and read per FreeType access.
+	// the font program is kept with the face, for sharing with the embedded font writers. if the font program cache is enabled
+	// its font programs are used, otherwise each face loads its own. secondary (metrics) files are still read through streams
+	void SetLoadFontsToMemory(bool inLoadFontsToMemory);
+	// font program of a face opened from memory. empty if the face is read from a file stream
+	FontProgramSharedPtr GetFontProgram(FT_Face inFace);
+
 	FT_Library operator->();
 	operator FT_Library() const;
 
@@ -51,6 +60,10 @@ private:
 
 	FT_Library mFreeType;
 	FTFaceToFTStreamListMap mOpenStreams;
+	bool mLoadFontsToMemory;
+	FTFaceToFontProgramSharedPtrMap mFontPrograms;
+
+	FT_Face NewMemoryFace(const std::string& inFilePath,FT_Long inFontIndex);
 
 	FT_Stream CreateFTStreamForPath(const std::string& inFilePath);
 	PDFHummus::EStatusCode FillOpenFaceArgumentsForUTF8String(const std::string& inFilePath, FT_Open_Args& ioArgs);
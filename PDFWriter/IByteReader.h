@@ -43,4 +43,14 @@ public:
 	*/
 	virtual bool NotEnded() = 0;
 
+	/*
+		Optional direct access, for readers that have their next bytes available in contiguous memory [memory streams, buffered streams].
+		returns a pointer to the next bytes to read, and sets outAvailableSize to how many of them may be accessed directly.
+		returns NULL (and 0 size) if not supported or if no more bytes are available. the pointer is valid only till the next call
+		to any of the reader methods.
+		call ConsumeDirectBuffer with the amount of bytes actually used, to advance the reader past them.
+	*/
+	virtual const IOBasicTypes::Byte* PeekDirectBuffer(IOBasicTypes::LongBufferSizeType& outAvailableSize) {outAvailableSize = 0;return NULL;}
+	virtual void ConsumeDirectBuffer(IOBasicTypes::LongBufferSizeType /*inConsumedSize*/) {}
+
 };
@@ -0,0 +1,52 @@
+/*
+   Source File : ICryptoBackend.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "IOBasicTypes.h"
+
+#include <stddef.h>
+
+// AES cipher with a set key, for CBC encryption and decryption of whole 16 bytes blocks
+class IAESCipher
+{
+public:
+	virtual ~IAESCipher(void) {}
+
+	// inLength must be a multiple of the block size. ioIV is updated to the last cipher block, so that consecutive calls
+	// continue the chain. input and output may be the same buffer
+	virtual bool EncryptCBC(const IOBasicTypes::Byte* inInput, IOBasicTypes::Byte* outOutput, size_t inLength, IOBasicTypes::Byte* ioIV) = 0;
+	virtual bool DecryptCBC(const IOBasicTypes::Byte* inInput, IOBasicTypes::Byte* outOutput, size_t inLength, IOBasicTypes::Byte* ioIV) = 0;
+};
+
+/*
+	Crypto implementation used by the encryption and decryption streams. Backends are stateless, and may be used by multiple threads.
+	see XCryptionCommon for selecting the backend in use.
+*/
+class ICryptoBackend
+{
+public:
+	virtual ~ICryptoBackend(void) {}
+
+	virtual const char* GetName() = 0;
+
+	// create a cipher for the key. key length is 16, 24 or 32 bytes. returns NULL if the key can't be set up. caller owns the cipher
+	virtual IAESCipher* CreateAESCipher(const IOBasicTypes::Byte* inKey, size_t inKeyLength) = 0;
+};
@@ -46,7 +46,14 @@ public:
 									FreeTypeFaceWrapper& inFontInfo,
 									const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
 									ObjectsContext* inObjectsContext,
-									bool inEmbedFont) = 0;
+									bool inEmbedFont,
+									PreparedEmbeddedFont& inPreparedFont) = 0;
+
+	// create the embedded font program ahead of WriteFont (which will then write it, when passed as inPreparedFont).
+	// ioPreparedFont should have the subset font name set. must not use the objects context, fonts may be prepared in parallel
+	virtual PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+												const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
+												PreparedEmbeddedFont& ioPreparedFont) = 0;
 
 	virtual void WriteSubTypeValue(DictionaryContext* inDescendentFontContext) = 0;
 
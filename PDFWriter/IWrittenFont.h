@@ -63,6 +63,15 @@ public:
 	*/
 	virtual PDFHummus::EStatusCode WriteFontDefinition(FreeTypeFaceWrapper& inFontInfo,bool inEmbedFont) = 0;
 
+	/*
+		Prepare embedded fonts ahead of WriteFontDefinition, so that subsets of multiple fonts may be created in parallel.
+		NameEmbeddedFonts generates the subset font names, and should be called serially, in the order of writing the fonts definitions.
+		PrepareEmbeddedFonts then creates the embedded font programs. it does not use the objects context, and may run concurrently
+		for different fonts. WriteFontDefinition writes the prepared font programs.
+	*/
+	virtual void NameEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo) = 0;
+	virtual PDFHummus::EStatusCode PrepareEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo) = 0;
+
 	// state read and write
 	virtual PDFHummus::EStatusCode WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectID) = 0;
 	virtual PDFHummus::EStatusCode ReadState(PDFParser* inStateReader,ObjectIDType inObjectID) = 0;
@@ -0,0 +1,156 @@
+/*
+   Source File : ImageContentRegistry.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ImageContentRegistry.h"
+#include "IByteReaderWithPosition.h"
+
+#include <string.h>
+
+using namespace IOBasicTypes;
+
+bool ImageContentKey::operator<(const ImageContentKey& inOther) const
+{
+	if(Hash != inOther.Hash)
+		return Hash < inOther.Hash;
+	if(Size != inOther.Size)
+		return Size < inOther.Size;
+	return Usage < inOther.Usage;
+}
+
+ImageContentRegistry::ImageContentRegistry(void)
+{
+	mEnabled = false;
+	mHits = 0;
+	mMisses = 0;
+}
+
+ImageContentRegistry::~ImageContentRegistry(void)
+{
+}
+
+void ImageContentRegistry::SetEnabled(bool inEnabled)
+{
+	mEnabled = inEnabled;
+}
+
+bool ImageContentRegistry::IsEnabled() const
+{
+	return mEnabled;
+}
+
+static const LongBufferSizeType scReadBufferSize = 65536;
+
+// MurmurHash64A, 8 bytes at a time. matches are confirmed by comparing the data, so this only has to spread the keys well
+static unsigned long long HashData(const Byte* inData,size_t inSize)
+{
+	const unsigned long long m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+	unsigned long long h = 0x9747b28cULL ^ ((unsigned long long)inSize * m);
+	size_t blocksSize = inSize - inSize % 8;
+
+	for(size_t i = 0; i < blocksSize; i+=8)
+	{
+		unsigned long long k;
+		memcpy(&k,inData + i,8);
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+
+	if(inSize > blocksSize)
+	{
+		for(size_t i = inSize; i > blocksSize; --i)
+			h ^= (unsigned long long)inData[i - 1] << (8 * (i - 1 - blocksSize));
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	return h;
+}
+
+ImageContentKey ImageContentRegistry::ReadImageContent(IByteReaderWithPosition* inImageStream,const std::string& inUsage,ByteVector& outData)
+{
+	ImageContentKey key;
+	LongFilePositionType originalPosition = inImageStream->GetCurrentPosition();
+	LongBufferSizeType filled = 0;
+
+	key.Usage = inUsage;
+
+	outData.clear();
+	while(inImageStream->NotEnded())
+	{
+		outData.resize(filled + scReadBufferSize);
+		LongBufferSizeType readAmount = inImageStream->Read(&(outData[filled]),scReadBufferSize);
+		filled += readAmount;
+		outData.resize(filled);
+		if(0 == readAmount)
+			break;
+	}
+	key.Size = filled;
+	key.Hash = HashData(filled > 0 ? &(outData[0]) : NULL,filled);
+
+	inImageStream->SetPosition(originalPosition);
+	return key;
+}
+
+const ImageContentEntry* ImageContentRegistry::Find(const ImageContentKey& inKey,const ByteVector& inData)
+{
+	std::pair<ImageContentKeyToRegisteredImageContentMultimap::iterator,ImageContentKeyToRegisteredImageContentMultimap::iterator> range = mImages.equal_range(inKey);
+
+	for(ImageContentKeyToRegisteredImageContentMultimap::iterator it = range.first; it != range.second; ++it)
+	{
+		if(it->second.Data == inData)
+		{
+			++mHits;
+			return &(it->second.Entry);
+		}
+	}
+
+	++mMisses;
+	return NULL;
+}
+
+void ImageContentRegistry::Register(const ImageContentKey& inKey,ByteVector& ioData,const ImageContentEntry& inEntry)
+{
+	ImageContentKeyToRegisteredImageContentMultimap::iterator it = mImages.insert(ImageContentKeyToRegisteredImageContentMultimap::value_type(inKey,RegisteredImageContent()));
+	it->second.Data.swap(ioData);
+	it->second.Entry = inEntry;
+}
+
+unsigned long ImageContentRegistry::GetHits() const
+{
+	return mHits;
+}
+
+unsigned long ImageContentRegistry::GetMisses() const
+{
+	return mMisses;
+}
+
+void ImageContentRegistry::Reset()
+{
+	mImages.clear();
+	mHits = 0;
+	mMisses = 0;
+}
@@ -0,0 +1,105 @@
+/*
+   Source File : ImageContentRegistry.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ObjectsBasicTypes.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+#include <list>
+#include <map>
+#include <vector>
+
+class IByteReaderWithPosition;
+
+typedef std::list<std::string> StringList;
+typedef std::vector<IOBasicTypes::Byte> ByteVector;
+
+// identifies image data written in a particular way. Usage stands for the kind of written object and its decoding parameters
+struct ImageContentKey
+{
+	ImageContentKey(){Size = 0;Hash = 0;}
+
+	std::string Usage;
+	IOBasicTypes::LongFilePositionType Size;
+	// fast, non cryptographic, hash of the image data. images with the same key are compared by their data
+	unsigned long long Hash;
+
+	bool operator<(const ImageContentKey& inOther) const;
+};
+
+struct ImageContentEntry
+{
+	ImageContentEntry(){ObjectID = 0;ResourcesDictionaryID = 0;}
+	ImageContentEntry(ObjectIDType inObjectID,ObjectIDType inResourcesDictionaryID,const StringList& inRequiredProcsets = StringList())
+		{ObjectID = inObjectID;ResourcesDictionaryID = inResourcesDictionaryID;RequiredProcsets = inRequiredProcsets;}
+
+	ObjectIDType ObjectID;
+	// for form xobjects
+	ObjectIDType ResourcesDictionaryID;
+	// for image xobjects
+	StringList RequiredProcsets;
+};
+
+struct RegisteredImageContent
+{
+	ByteVector Data;
+	ImageContentEntry Entry;
+};
+
+typedef std::multimap<ImageContentKey,RegisteredImageContent> ImageContentKeyToRegisteredImageContentMultimap;
+
+/*
+	Images written to a document, keyed by a hash of their data (and how they were written), so that writing the same
+	image again can reuse the written object. Disabled by default.
+	The registry keeps the data of the images registered with it, till Reset, so that an image is reused only when its data
+	is the same, and not just its hash.
+*/
+class ImageContentRegistry
+{
+public:
+	ImageContentRegistry(void);
+	~ImageContentRegistry(void);
+
+	void SetEnabled(bool inEnabled);
+	bool IsEnabled() const;
+
+	// read the image data in the stream, from its current position to its end, and compute its key. the stream is returned to the original position.
+	// writing an image that's not found can then read it from outData, instead of reading the stream again
+	static ImageContentKey ReadImageContent(IByteReaderWithPosition* inImageStream,const std::string& inUsage,ByteVector& outData);
+
+	// returns NULL if no image was registered with this key and data
+	const ImageContentEntry* Find(const ImageContentKey& inKey,const ByteVector& inData);
+	// the registry takes the data, leaving ioData empty
+	void Register(const ImageContentKey& inKey,ByteVector& ioData,const ImageContentEntry& inEntry);
+
+	// statistics, for Find calls
+	unsigned long GetHits() const;
+	unsigned long GetMisses() const;
+
+	void Reset();
+
+private:
+	bool mEnabled;
+	ImageContentKeyToRegisteredImageContentMultimap mImages;
+	unsigned long mHits;
+	unsigned long mMisses;
+};
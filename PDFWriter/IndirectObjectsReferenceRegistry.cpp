@@ -48,6 +48,8 @@ void IndirectObjectsReferenceRegistry::SetupInitialFreeObject()
     singleFreeObjectInformation.mIsDirty = true;
     singleFreeObjectInformation.mGenerationNumber = 65535;
     singleFreeObjectInformation.mWritePosition = 0;
+	singleFreeObjectInformation.mObjectStreamID = 0;
+	singleFreeObjectInformation.mIndexInObjectStream = 0;
 	mObjectsWritesRegistry.push_back(singleFreeObjectInformation);
 }
 
@@ -65,6 +67,8 @@ ObjectIDType IndirectObjectsReferenceRegistry::AllocateNewObjectID()
 	newObjectInformation.mObjectReferenceType = ObjectWriteInformation::Used;
     newObjectInformation.mGenerationNumber = 0;
     newObjectInformation.mIsDirty = true;
+	newObjectInformation.mObjectStreamID = 0;
+	newObjectInformation.mIndexInObjectStream = 0;
 	
 	mObjectsWritesRegistry.push_back(newObjectInformation);
 	return newObjectID;
@@ -98,6 +102,28 @@ EStatusCode IndirectObjectsReferenceRegistry::MarkObjectAsWritten(ObjectIDType i
 	return PDFHummus::eSuccess;
 }
 
+EStatusCode IndirectObjectsReferenceRegistry::MarkObjectAsWrittenInObjectStream(ObjectIDType inObjectID,ObjectIDType inObjectStreamID,unsigned long inIndexInObjectStream)
+{
+	if(mObjectsWritesRegistry.size() <= inObjectID)
+	{
+		TRACE_LOG1("IndirectObjectsReferenceRegistry::MarkObjectAsWrittenInObjectStream, Out of range failure. An Object ID is marked as written, which was not allocated before. ID = %ld",inObjectID);
+		return PDFHummus::eFailure; 
+	}
+
+	if(mObjectsWritesRegistry[inObjectID].mObjectWritten)
+	{
+		TRACE_LOG1("IndirectObjectsReferenceRegistry::MarkObjectAsWrittenInObjectStream, Object rewrite failure. The object %ld was already marked as written",inObjectID);
+		return PDFHummus::eFailure;
+	}
+
+    mObjectsWritesRegistry[inObjectID].mIsDirty = true;
+	mObjectsWritesRegistry[inObjectID].mWritePosition = 0;
+	mObjectsWritesRegistry[inObjectID].mObjectStreamID = inObjectStreamID;
+	mObjectsWritesRegistry[inObjectID].mIndexInObjectStream = inIndexInObjectStream;
+	mObjectsWritesRegistry[inObjectID].mObjectWritten = true;
+	return PDFHummus::eSuccess;
+}
+
 GetObjectWriteInformationResult IndirectObjectsReferenceRegistry::GetObjectWriteInformation(ObjectIDType inObjectID) const
 {
 	GetObjectWriteInformationResult result;
@@ -229,6 +255,15 @@ EStatusCode IndirectObjectsReferenceRegistry::WriteState(ObjectsContext* inState
         
 		registryDictionary->WriteKey("mGenerationNumber");
 		registryDictionary->WriteIntegerValue(it->mGenerationNumber);
+
+		if(it->mObjectStreamID != 0)
+		{
+			registryDictionary->WriteKey("mObjectStreamID");
+			registryDictionary->WriteIntegerValue(it->mObjectStreamID);
+
+			registryDictionary->WriteKey("mIndexInObjectStream");
+			registryDictionary->WriteIntegerValue(it->mIndexInObjectStream);
+		}
         
         
 		inStateWriter->EndDictionary(registryDictionary);
@@ -272,6 +307,11 @@ EStatusCode IndirectObjectsReferenceRegistry::ReadState(PDFParser* inStateReader
         PDFObjectCastPtr<PDFInteger> generationNumber(objectWriteInformationDictionary->QueryDirectObject("mGenerationNumber"));
         newObjectInformation.mGenerationNumber = (unsigned long)generationNumber->GetValue();
 
+		PDFObjectCastPtr<PDFInteger> objectStreamID(objectWriteInformationDictionary->QueryDirectObject("mObjectStreamID"));
+		PDFObjectCastPtr<PDFInteger> indexInObjectStream(objectWriteInformationDictionary->QueryDirectObject("mIndexInObjectStream"));
+		newObjectInformation.mObjectStreamID = !objectStreamID ? 0 : (ObjectIDType)objectStreamID->GetValue();
+		newObjectInformation.mIndexInObjectStream = !indexInObjectStream ? 0 : (unsigned long)indexInObjectStream->GetValue();
+
 		mObjectsWritesRegistry.push_back(newObjectInformation);
 	}
 
@@ -298,6 +338,8 @@ void IndirectObjectsReferenceRegistry::AppendExistingItem(
     newObjectInformation.mGenerationNumber = inGenerationNumber;
     newObjectInformation.mIsDirty = false;
     newObjectInformation.mWritePosition = (inObjectReferenceType == ObjectWriteInformation::Used) ? inWritePosition:0;
+	newObjectInformation.mObjectStreamID = 0;
+	newObjectInformation.mIndexInObjectStream = 0;
 	
 	mObjectsWritesRegistry.push_back(newObjectInformation);
     
@@ -56,6 +56,9 @@ struct ObjectWriteInformation
 	EObjectReferenceType mObjectReferenceType;
     // object generation number
     unsigned long mGenerationNumber;
+	// when written in an object stream, the ID of the object stream and the object index in it. mObjectStreamID is 0 otherwise
+	ObjectIDType mObjectStreamID;
+	unsigned long mIndexInObjectStream;
 };
 
 typedef std::pair<bool,ObjectWriteInformation> GetObjectWriteInformationResult;
@@ -70,6 +73,7 @@ public:
 	ObjectIDType AllocateNewObjectID();
 	
 	PDFHummus::EStatusCode MarkObjectAsWritten(ObjectIDType inObjectID,LongFilePositionType inWritePosition);
+	PDFHummus::EStatusCode MarkObjectAsWrittenInObjectStream(ObjectIDType inObjectID,ObjectIDType inObjectStreamID,unsigned long inIndexInObjectStream);
 	GetObjectWriteInformationResult GetObjectWriteInformation(ObjectIDType inObjectID) const;
 
 	ObjectIDType GetObjectsCount() const;
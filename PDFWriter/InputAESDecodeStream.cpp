@@ -18,6 +18,7 @@ limitations under the License.
 */
 
 #include "InputAESDecodeStream.h"
+#include "XCryptionCommon.h"
 
 #include <algorithm>
 #include <string.h>
@@ -28,12 +29,17 @@ using namespace IOBasicTypes;
 InputAESDecodeStream::InputAESDecodeStream()
 {
 	mSourceStream = NULL;
+	mKey = NULL;
+	mCipher = NULL;
 }
 
 
-InputAESDecodeStream::InputAESDecodeStream(IByteReader* inSourceReader, const ByteList& inKey)
+InputAESDecodeStream::InputAESDecodeStream(IByteReader* inSourceReader, const ByteList& inKey, std::size_t inChunkSize, ICryptoBackend* inCryptoBackend)
 {
-	Assign(inSourceReader, inKey);
+	mSourceStream = NULL;
+	mKey = NULL;
+	mCipher = NULL;
+	Assign(inSourceReader, inKey, inChunkSize, inCryptoBackend);
 }
 
 InputAESDecodeStream::~InputAESDecodeStream(void)
@@ -43,77 +49,63 @@ InputAESDecodeStream::~InputAESDecodeStream(void)
 
 	if (mKey)
 		delete[] mKey;
+	delete mCipher;
 }
 
 
-void InputAESDecodeStream::Assign(IByteReader* inSourceReader, const ByteList& inKey)
+void InputAESDecodeStream::Assign(IByteReader* inSourceReader, const ByteList& inKey, std::size_t inChunkSize, ICryptoBackend* inCryptoBackend)
 {
 	mSourceStream = inSourceReader;
 
 	// convert inEncryptionKey to internal rep and init decrypt [let's hope its 16...]
+	delete[] mKey;
 	mKeyLength = inKey.size();
 	mKey = new unsigned char[mKeyLength];
 	ByteList::const_iterator it = inKey.begin();
 	size_t i = 0;
 	for (; it != inKey.end(); ++i, ++it)
 		mKey[i] = *it;
-	mDecrypt.key(mKey, mKeyLength);
+	delete mCipher;
+	mCipher = inSourceReader ? (inCryptoBackend ? inCryptoBackend : XCryptionCommon::GetDefaultCryptoBackend())->CreateAESCipher(mKey, mKeyLength) : NULL;
 	mIsIvInit = false; // first read flag. still need to read IV
-	mReadBlockSize = AES_BLOCK_SIZE;
-	mOutIndex = mOut + mReadBlockSize;
-	mHitEnd = false;
+	mHitEnd = (NULL == mCipher);
+
+	// room for a chunk, and the block held back from the previous one
+	std::size_t chunkSize = inChunkSize < AES_BLOCK_SIZE ? AES_BLOCK_SIZE : (inChunkSize - inChunkSize % AES_BLOCK_SIZE);
+	mIn.resize(chunkSize + AES_BLOCK_SIZE);
+	mOut.resize(chunkSize + AES_BLOCK_SIZE);
+	mInSize = 0;
+	mOutIndex = 0;
+	mOutSize = 0;
 }
 
 bool InputAESDecodeStream::NotEnded()
 {
-	return (mSourceStream && mSourceStream->NotEnded()) || !mHitEnd || ((mOutIndex - mOut) < mReadBlockSize);
+	return (mSourceStream && mSourceStream->NotEnded()) || !mHitEnd || (mOutIndex < mOutSize);
 }
 
 LongBufferSizeType InputAESDecodeStream::Read(IOBasicTypes::Byte* inBuffer, LongBufferSizeType inSize)
 {
-	if (!mSourceStream)
+	if (!mSourceStream || !mCipher)
 		return 0;
 
-	
 	// if iv not init yet, init now
 	if (!mIsIvInit) {
 		// read iv buffer
 		LongBufferSizeType ivRead = mSourceStream->Read(mIV, AES_BLOCK_SIZE);
 		if (ivRead < AES_BLOCK_SIZE)
 			return 0;
-		// read first buffer
-		LongBufferSizeType firstBlockLength = mSourceStream->Read(mInNext, AES_BLOCK_SIZE);
-		if (firstBlockLength < AES_BLOCK_SIZE)
-			return 0;
-
-		// decrypt first buffer
-		memcpy(mIn, mInNext, AES_BLOCK_SIZE);
-		if (mDecrypt.cbc_decrypt(mIn, mOut, AES_BLOCK_SIZE, mIV) != EXIT_SUCCESS)
-			return 0;
-		mOutIndex = mOut;
-
-		// read next buffer, to determine if first buffer contains padding
-		LongBufferSizeType secondBlockLength = mSourceStream->Read(mInNext, AES_BLOCK_SIZE);
-		if (secondBlockLength < AES_BLOCK_SIZE) {
-			mHitEnd = true;
-			 // secondBlockLength should be 0. this is the case that first buffer already contains padding (using min for safety)
-			mReadBlockSize = AES_BLOCK_SIZE - std::min<size_t>(mOut[AES_BLOCK_SIZE - 1], AES_BLOCK_SIZE);
-		}
-		else
-			mReadBlockSize = AES_BLOCK_SIZE;
 		mIsIvInit = true;
 	}
 
-
 	IOBasicTypes::LongBufferSizeType left = inSize;
 	IOBasicTypes::LongBufferSizeType remainderRead;
 
-
 	while (left > 0) {
-		remainderRead = std::min<size_t>(left,(mReadBlockSize - (mOutIndex - mOut)));
+		remainderRead = std::min<LongBufferSizeType>(left, mOutSize - mOutIndex);
 		if (remainderRead > 0) {
 			// fill block with remainder from latest decryption
-			memcpy(inBuffer + inSize - left, mOutIndex, remainderRead);
+			memcpy(inBuffer + inSize - left, &(mOut[mOutIndex]), remainderRead);
 			mOutIndex += remainderRead;
 			left -= remainderRead;
 		}
@@ -123,25 +115,44 @@ LongBufferSizeType InputAESDecodeStream::Read(IOBasicTypes::Byte* inBuffer, Long
 				// that's true EOF...so finish
 				break;
 			}
-			else {
-				// decrypt next block
-				memcpy(mIn, mInNext, AES_BLOCK_SIZE);
-				if (mDecrypt.cbc_decrypt(mIn, mOut, AES_BLOCK_SIZE, mIV) != EXIT_SUCCESS)
-					break;
-				mOutIndex = mOut;
-
-				// read next buffer from input stream
-				LongBufferSizeType totalRead = mSourceStream->Read(mInNext, AES_BLOCK_SIZE);
-				if (totalRead < AES_BLOCK_SIZE) { // this means that we got to final block, with padding
-					mHitEnd = true; // should be 0. 
-					// now we know that next block is the final one, and can consider padding (using min for safety)
-					mReadBlockSize = AES_BLOCK_SIZE - std::min<size_t>(mOut[AES_BLOCK_SIZE - 1], AES_BLOCK_SIZE);
-					// Gal: one can find out here that the next block is actually empty...that's not gonna be great for
-					// NotEnded + read of 1 byte....
-				}
-			}
+			else if (!DecryptNextChunk())
+				break;
 		}
 	}
 
 	return inSize - left;
-}
\ No newline at end of file
+}
+
+bool InputAESDecodeStream::DecryptNextChunk()
+{
+	// fill the input buffer, following the block held back from the previous chunk
+	while (mInSize < mIn.size()) {
+		LongBufferSizeType readAmount = mSourceStream->Read(&(mIn[mInSize]), mIn.size() - mInSize);
+		if (0 == readAmount)
+			break;
+		mInSize += (std::size_t)readAmount;
+	}
+
+	// a short read means that the input is done, and the last block holds the padding. otherwise hold back the last block
+	// till it's known whether it's the final one
+	bool isFinal = mInSize < mIn.size();
+	std::size_t blocksLength = mInSize - mInSize % AES_BLOCK_SIZE;
+	if (!isFinal)
+		blocksLength -= AES_BLOCK_SIZE;
+
+	if (0 == blocksLength || !mCipher->DecryptCBC(&(mIn[0]), &(mOut[0]), blocksLength, mIV)) {
+		mHitEnd = true;
+		return false;
+	}
+	mOutIndex = 0;
+	mOutSize = blocksLength;
+	if (isFinal) {
+		mHitEnd = true;
+		// now we know that the last block is the final one, and can consider padding (using min for safety)
+		mOutSize -= std::min<size_t>(mOut[blocksLength - 1], AES_BLOCK_SIZE);
+	}
+
+	memmove(&(mIn[0]), &(mIn[blocksLength]), mInSize - blocksLength);
+	mInSize -= blocksLength;
+	return true;
+}
@@ -22,12 +22,17 @@
 
 #include "EStatusCode.h"
 #include "IByteReader.h"
+#include "ICryptoBackend.h"
 #include "aescpp.h"
 
 #include <list>
+#include <vector>
 
 typedef std::list<IOBasicTypes::Byte> ByteList;
 
+// encrypted data is read from the source stream and decrypted in chunks of this size (rounded down to whole AES blocks)
+#define DEFAULT_AES_DECODE_CHUNK_SIZE 16384
+
 class InputAESDecodeStream : public IByteReader
 {
 public:
@@ -35,11 +40,13 @@ public:
 	~InputAESDecodeStream(void);
 
 	// Note that assigning passes ownership on the stream, use Assign(NULL) to remove ownership
-	InputAESDecodeStream(IByteReader* inSourceReader, const ByteList& inKey);
+	InputAESDecodeStream(IByteReader* inSourceReader, const ByteList& inKey, std::size_t inChunkSize = DEFAULT_AES_DECODE_CHUNK_SIZE,
+							ICryptoBackend* inCryptoBackend = NULL); // NULL for the default crypto backend
 
 	// Assigning passes ownership of the input stream to the decoder stream. 
 	// if you don't care for that, then after finishing with the decode, Assign(NULL).
-	void Assign(IByteReader* inSourceReader, const ByteList& inKey = ByteList());
+	void Assign(IByteReader* inSourceReader, const ByteList& inKey = ByteList(), std::size_t inChunkSize = DEFAULT_AES_DECODE_CHUNK_SIZE,
+				ICryptoBackend* inCryptoBackend = NULL);
 
 	// IByteReader implementation. note that "inBufferSize" determines how many
 	// bytes will be placed in the Buffer...not how many are actually read from the underlying
@@ -54,16 +61,19 @@ private:
 	unsigned char* mKey;
 	std::size_t  mKeyLength;
 	unsigned char mIV[AES_BLOCK_SIZE];
-	unsigned char mIn[AES_BLOCK_SIZE];
-	unsigned char mInNext[AES_BLOCK_SIZE];
-	unsigned char mOut[AES_BLOCK_SIZE];
-	unsigned char *mOutIndex;
-	unsigned char mReadBlockSize;
+	// encrypted data read from the source stream. the last block read is held back till it's known whether it's the final (padded) one
+	std::vector<unsigned char> mIn;
+	std::size_t mInSize;
+	// decrypted data waiting to be read
+	std::vector<unsigned char> mOut;
+	std::size_t mOutIndex;
+	std::size_t mOutSize;
 	bool mIsIvInit;
 	bool mHitEnd;
 
+	bool DecryptNextChunk();
 
 	IByteReader *mSourceStream;
-	AESdecrypt mDecrypt;
+	IAESCipher* mCipher;
 
 };
\ No newline at end of file
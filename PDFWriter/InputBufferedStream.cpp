@@ -159,4 +159,20 @@ LongFilePositionType InputBufferedStream::GetCurrentPosition()
 	// when reading the current position is the current stream position minus how much is left
 	// to read from the buffer
 	return mSourceStream->GetCurrentPosition() - (mLastAvailableIndex - mCurrentBufferIndex);
-}
\ No newline at end of file
+}
+const Byte* InputBufferedStream::PeekDirectBuffer(LongBufferSizeType& outAvailableSize)
+{
+	if(mSourceStream && mCurrentBufferIndex == mLastAvailableIndex && mSourceStream->NotEnded())
+	{
+		mLastAvailableIndex = mBuffer + mSourceStream->Read(mBuffer,mBufferSize);
+		mCurrentBufferIndex = mBuffer;
+	}
+
+	outAvailableSize = mLastAvailableIndex - mCurrentBufferIndex;
+	return outAvailableSize > 0 ? mCurrentBufferIndex : NULL;
+}
+
+void InputBufferedStream::ConsumeDirectBuffer(LongBufferSizeType inConsumedSize)
+{
+	mCurrentBufferIndex+= std::min<LongBufferSizeType>(inConsumedSize,mLastAvailableIndex - mCurrentBufferIndex);
+}
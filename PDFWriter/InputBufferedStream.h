@@ -63,6 +63,10 @@ public:
 	virtual void SetPositionFromEnd(LongFilePositionType inOffsetFromEnd);
 	virtual LongFilePositionType GetCurrentPosition();
 
+	// IByteReader direct access implementation. fills the buffer if empty
+	virtual const IOBasicTypes::Byte* PeekDirectBuffer(IOBasicTypes::LongBufferSizeType& outAvailableSize);
+	virtual void ConsumeDirectBuffer(IOBasicTypes::LongBufferSizeType inConsumedSize);
+
 	IByteReaderWithPosition* GetSourceStream();
 
 private:
@@ -85,3 +85,14 @@ LongFilePositionType InputByteArrayStream::GetCurrentPosition()
 {
 	return mCurrentPosition;
 }
+
+const Byte* InputByteArrayStream::PeekDirectBuffer(LongBufferSizeType& outAvailableSize)
+{
+	outAvailableSize = mByteArray ? (LongBufferSizeType)(mArrayLength-mCurrentPosition) : 0;
+	return outAvailableSize > 0 ? mByteArray + mCurrentPosition : NULL;
+}
+
+void InputByteArrayStream::ConsumeDirectBuffer(LongBufferSizeType inConsumedSize)
+{
+	Skip(inConsumedSize);
+}
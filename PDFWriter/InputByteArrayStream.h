@@ -39,6 +39,10 @@ public:
 	virtual void SetPositionFromEnd(LongFilePositionType inOffsetFromEnd);
 	virtual LongFilePositionType GetCurrentPosition();
 
+	// IByteReader direct access implementation
+	virtual const IOBasicTypes::Byte* PeekDirectBuffer(IOBasicTypes::LongBufferSizeType& outAvailableSize);
+	virtual void ConsumeDirectBuffer(IOBasicTypes::LongBufferSizeType inConsumedSize);
+
 private:
 
 	IOBasicTypes::Byte* mByteArray;
@@ -21,6 +21,7 @@
 #include "InputFile.h"
 #include "InputBufferedStream.h"
 #include "InputFileStream.h"
+#include "InputMemoryMappedFileStream.h"
 #include "Trace.h"
 
 using namespace PDFHummus;
@@ -29,6 +30,7 @@ InputFile::InputFile(void)
 {
 	mInputStream = NULL;
 	mFileStream = NULL;
+	mMappedStream = NULL;
 }
 
 InputFile::~InputFile(void)
@@ -36,7 +38,7 @@ InputFile::~InputFile(void)
 	CloseFile();
 }
 
-EStatusCode InputFile::OpenFile(const std::string& inFilePath)
+EStatusCode InputFile::OpenFile(const std::string& inFilePath,bool inUseMemoryMapping)
 {
 	EStatusCode status;
 	do
@@ -47,6 +49,19 @@ EStatusCode InputFile::OpenFile(const std::string& inFilePath)
 			TRACE_LOG1("InputFile::OpenFile, Unexpected Failure. Couldn't close previously open file - %s",mFilePath.c_str());
 			break;
 		}
+
+		if(inUseMemoryMapping)
+		{
+			InputMemoryMappedFileStream* mappedStream = new InputMemoryMappedFileStream();
+			if(mappedStream->Open(inFilePath) == PDFHummus::eSuccess)
+			{
+				mMappedStream = mappedStream;
+				mFilePath = inFilePath;
+				break;
+			}
+			// can't map this file, read it regularly
+			delete mappedStream;
+		}
 	
 		InputFileStream* inputFileStream = new InputFileStream();
 		status = inputFileStream->Open(inFilePath); // explicitly open, so status may be retrieved
@@ -66,7 +81,15 @@ EStatusCode InputFile::OpenFile(const std::string& inFilePath)
 
 EStatusCode InputFile::CloseFile()
 {
-	if(NULL == mInputStream)
+	if(mMappedStream)
+	{
+		EStatusCode status = mMappedStream->Close();
+
+		delete mMappedStream;
+		mMappedStream = NULL;
+		return status;
+	}
+	else if(NULL == mInputStream)
 	{
 		return PDFHummus::eSuccess;
 	}
@@ -84,7 +107,10 @@ EStatusCode InputFile::CloseFile()
 
 IByteReaderWithPosition* InputFile::GetInputStream()
 {
-	return mInputStream;
+	if(mMappedStream)
+		return mMappedStream;
+	else
+		return mInputStream;
 }
 
 const std::string& InputFile::GetFilePath()
@@ -94,7 +120,11 @@ const std::string& InputFile::GetFilePath()
 
 LongFilePositionType InputFile::GetFileSize()
 {
-	if(mInputStream)
+	if(mMappedStream)
+	{
+		return mMappedStream->GetFileSize();
+	}
+	else if(mInputStream)
 	{
 		InputFileStream* inputFileStream = (InputFileStream*)mInputStream->GetSourceStream();
 
@@ -102,4 +132,9 @@ LongFilePositionType InputFile::GetFileSize()
 	}
 	else
 		return 0;
+}
+
+bool InputFile::IsMemoryMapped()
+{
+	return mMappedStream != NULL;
 }
\ No newline at end of file
@@ -26,6 +26,7 @@
 
 class InputBufferedStream;
 class InputFileStream;
+class InputMemoryMappedFileStream;
 
 
 
@@ -35,16 +36,22 @@ public:
 	InputFile(void);
 	~InputFile(void);
 
-	PDFHummus::EStatusCode OpenFile(const std::string& inFilePath);
+	// pass inUseMemoryMapping to read the file through a memory mapping instead of a buffered file stream.
+	// if the file can't be mapped, falls back on the buffered file stream
+	PDFHummus::EStatusCode OpenFile(const std::string& inFilePath,bool inUseMemoryMapping = false);
 	PDFHummus::EStatusCode CloseFile();
 
-	IByteReaderWithPosition* GetInputStream(); // returns buffered input stream
+	IByteReaderWithPosition* GetInputStream(); // returns buffered input stream, or the memory mapped stream if used
 	const std::string& GetFilePath();
 	
 	LongFilePositionType GetFileSize();
 
+	// true if the open file is read through a memory mapping
+	bool IsMemoryMapped();
+
 private:
 	std::string mFilePath;
 	InputBufferedStream* mInputStream;
 	InputFileStream* mFileStream;
+	InputMemoryMappedFileStream* mMappedStream;
 };
@@ -0,0 +1,227 @@
+/*
+   Source File : InputMemoryMappedFileStream.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "InputMemoryMappedFileStream.h"
+
+#include <memory.h>
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+	#include "SafeBufferMacrosDefs.h"
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace PDFHummus;
+
+InputMemoryMappedFileStream::InputMemoryMappedFileStream(void)
+{
+	mData = NULL;
+	mFileSize = 0;
+	mCurrentPosition = 0;
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+	mFileHandle = NULL;
+	mMappingHandle = NULL;
+#endif
+}
+
+InputMemoryMappedFileStream::~InputMemoryMappedFileStream(void)
+{
+	if(mData)
+		Close();
+}
+
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+
+EStatusCode InputMemoryMappedFileStream::Open(const std::string& inFilePath)
+{
+	EStatusCode status = eFailure;
+
+	do
+	{
+		HANDLE fileHandle = CreateFileW(UTF8ToUTF16Wide(inFilePath).c_str(),GENERIC_READ,FILE_SHARE_READ | FILE_SHARE_WRITE,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+		if(INVALID_HANDLE_VALUE == fileHandle)
+			break;
+
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(fileHandle,&fileSize) || 0 == fileSize.QuadPart || (unsigned long long)fileSize.QuadPart > (size_t)-1)
+		{
+			CloseHandle(fileHandle);
+			break;
+		}
+
+		HANDLE mappingHandle = CreateFileMappingW(fileHandle,NULL,PAGE_READONLY,0,0,NULL);
+		if(NULL == mappingHandle)
+		{
+			CloseHandle(fileHandle);
+			break;
+		}
+
+		void* data = MapViewOfFile(mappingHandle,FILE_MAP_READ,0,0,0);
+		if(NULL == data)
+		{
+			CloseHandle(mappingHandle);
+			CloseHandle(fileHandle);
+			break;
+		}
+
+		mFileHandle = fileHandle;
+		mMappingHandle = mappingHandle;
+		mData = (Byte*)data;
+		mFileSize = fileSize.QuadPart;
+		mCurrentPosition = 0;
+		status = eSuccess;
+	}while(false);
+
+	return status;
+}
+
+EStatusCode InputMemoryMappedFileStream::Close()
+{
+	if(!mData)
+		return eSuccess;
+
+	bool success = UnmapViewOfFile(mData) != 0;
+	success = (CloseHandle((HANDLE)mMappingHandle) != 0) && success;
+	success = (CloseHandle((HANDLE)mFileHandle) != 0) && success;
+
+	mData = NULL;
+	mMappingHandle = NULL;
+	mFileHandle = NULL;
+	mFileSize = 0;
+	mCurrentPosition = 0;
+	return success ? eSuccess:eFailure;
+}
+
+#else
+
+EStatusCode InputMemoryMappedFileStream::Open(const std::string& inFilePath)
+{
+	EStatusCode status = eFailure;
+
+	do
+	{
+		int fileDescriptor = open(inFilePath.c_str(),O_RDONLY);
+		if(-1 == fileDescriptor)
+			break;
+
+		// only regular, non empty files can be mapped
+		struct stat fileStatus;
+		if(fstat(fileDescriptor,&fileStatus) != 0 || !S_ISREG(fileStatus.st_mode) || 0 == fileStatus.st_size ||
+			(unsigned long long)fileStatus.st_size > (size_t)-1)
+		{
+			close(fileDescriptor);
+			break;
+		}
+
+		void* data = mmap(NULL,(size_t)fileStatus.st_size,PROT_READ,MAP_PRIVATE,fileDescriptor,0);
+		close(fileDescriptor); // mapping stays valid after closing the descriptor
+		if(MAP_FAILED == data)
+			break;
+
+		mData = (Byte*)data;
+		mFileSize = fileStatus.st_size;
+		mCurrentPosition = 0;
+		status = eSuccess;
+	}while(false);
+
+	return status;
+}
+
+EStatusCode InputMemoryMappedFileStream::Close()
+{
+	if(!mData)
+		return eSuccess;
+
+	EStatusCode result = munmap(mData,(size_t)mFileSize) == 0 ? eSuccess:eFailure;
+
+	mData = NULL;
+	mFileSize = 0;
+	mCurrentPosition = 0;
+	return result;
+}
+
+#endif
+
+LongBufferSizeType InputMemoryMappedFileStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+{
+	if(!mData)
+		return 0;
+
+	LongBufferSizeType amountToRead =
+		inBufferSize < (LongBufferSizeType)(mFileSize-mCurrentPosition) ?
+		inBufferSize :
+		(LongBufferSizeType)(mFileSize-mCurrentPosition);
+
+	if(amountToRead>0)
+		memcpy(inBuffer,mData+mCurrentPosition,amountToRead);
+	mCurrentPosition+= amountToRead;
+	return amountToRead;
+}
+
+bool InputMemoryMappedFileStream::NotEnded()
+{
+	return mData && mCurrentPosition < mFileSize;
+}
+
+void InputMemoryMappedFileStream::Skip(LongBufferSizeType inSkipSize)
+{
+	mCurrentPosition+= inSkipSize < (LongBufferSizeType)(mFileSize-mCurrentPosition) ? inSkipSize : mFileSize-mCurrentPosition;
+}
+
+void InputMemoryMappedFileStream::SetPosition(LongFilePositionType inOffsetFromStart)
+{
+	mCurrentPosition = inOffsetFromStart > mFileSize ? mFileSize:inOffsetFromStart;
+}
+
+void InputMemoryMappedFileStream::SetPositionFromEnd(LongFilePositionType inOffsetFromEnd)
+{
+	// if seeks too much, place at file begin (like InputFileStream)
+	mCurrentPosition = inOffsetFromEnd > mFileSize ? 0:(mFileSize-inOffsetFromEnd);
+}
+
+LongFilePositionType InputMemoryMappedFileStream::GetCurrentPosition()
+{
+	return mCurrentPosition;
+}
+
+LongFilePositionType InputMemoryMappedFileStream::GetFileSize() const
+{
+	return mFileSize;
+}
+
+const Byte* InputMemoryMappedFileStream::GetData() const
+{
+	return mData;
+}
+
+const Byte* InputMemoryMappedFileStream::PeekDirectBuffer(LongBufferSizeType& outAvailableSize)
+{
+	outAvailableSize = mData ? (LongBufferSizeType)(mFileSize-mCurrentPosition) : 0;
+	return outAvailableSize > 0 ? mData + mCurrentPosition : NULL;
+}
+
+void InputMemoryMappedFileStream::ConsumeDirectBuffer(LongBufferSizeType inConsumedSize)
+{
+	Skip(inConsumedSize);
+}
@@ -0,0 +1,70 @@
+/*
+   Source File : InputMemoryMappedFileStream.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "EStatusCode.h"
+#include "IByteReaderWithPosition.h"
+
+#include <string>
+
+/*
+	Read only file stream that maps the whole file to memory (mmap/CreateFileMapping), so that
+	random access reading is simple pointer arithmetic, and multiple readers of the same file share the OS page cache.
+	Open fails for files that can't be mapped (e.g. empty files, or non regular files), in which case use InputFileStream.
+*/
+
+class InputMemoryMappedFileStream : public IByteReaderWithPosition
+{
+public:
+	InputMemoryMappedFileStream(void);
+	virtual ~InputMemoryMappedFileStream(void);
+
+	// input file path is in UTF8
+	PDFHummus::EStatusCode Open(const std::string& inFilePath);
+	PDFHummus::EStatusCode Close();
+
+	// IByteReaderWithPosition implementation
+	virtual LongBufferSizeType Read(Byte* inBuffer,LongBufferSizeType inBufferSize);
+	virtual bool NotEnded();
+	virtual void Skip(LongBufferSizeType inSkipSize);
+	virtual void SetPosition(LongFilePositionType inOffsetFromStart);
+	virtual void SetPositionFromEnd(LongFilePositionType inOffsetFromEnd);
+	virtual LongFilePositionType GetCurrentPosition();
+
+	// IByteReader direct access implementation
+	virtual const IOBasicTypes::Byte* PeekDirectBuffer(IOBasicTypes::LongBufferSizeType& outAvailableSize);
+	virtual void ConsumeDirectBuffer(IOBasicTypes::LongBufferSizeType inConsumedSize);
+
+	LongFilePositionType GetFileSize() const;
+
+	// direct access to the mapped file content. NULL if not open
+	const Byte* GetData() const;
+
+private:
+
+	Byte* mData;
+	LongFilePositionType mFileSize;
+	LongFilePositionType mCurrentPosition;
+#if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
+	void* mFileHandle;
+	void* mMappingHandle;
+#endif
+};
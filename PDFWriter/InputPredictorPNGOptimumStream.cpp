@@ -21,7 +21,15 @@
 #include "InputPredictorPNGOptimumStream.h"
 
 #include "Trace.h"
+
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PDFHUMMUS_PREDICTOR_SSE2
+#include <emmintrin.h>
+#endif
 
 /*
 	Note from Gal: Note that optimum also implements the others. this is because PNG compression requires that the first byte in the line holds the algo -
@@ -66,36 +74,38 @@ LongBufferSizeType InputPredictorPNGOptimumStream::Read(Byte* inBuffer,LongBuffe
 {
 	LongBufferSizeType readBytes = 0;
 
-
-	// exhaust what's in the buffer currently
-	while(mBufferSize > (LongBufferSizeType)(mIndex - mBuffer) && readBytes < inBufferSize)
+	while(readBytes < inBufferSize)
 	{
-		DecodeNextByte(inBuffer[readBytes]);
-		++readBytes;
-	}
+		// copy what's left of the decoded row
+		LongBufferSizeType available = mBufferSize - (LongBufferSizeType)(mIndex - mBuffer);
+		if(available > 0)
+		{
+			LongBufferSizeType copyBytes = std::min<LongBufferSizeType>(available,inBufferSize - readBytes);
+			memcpy(inBuffer + readBytes,mIndex,copyBytes);
+			mIndex += copyBytes;
+			readBytes += copyBytes;
+			continue;
+		}
 
-	// now repeatedly read bytes from the input stream, and decode
-	while(readBytes < inBufferSize && mSourceStream->NotEnded())
-	{
-		memcpy(mUpValues,mBuffer,mBufferSize);
+		if(!mSourceStream->NotEnded())
+			break;
+
+		// the decoded row becomes the "up" row of the next one
+		std::swap(mUpValues,mBuffer);
 		LongBufferSizeType readFromSource = mSourceStream->Read(mBuffer, mBufferSize);
-		if (readFromSource == 0) {
-			break; // a belated end. must be flate
-		}
 		if(readFromSource != mBufferSize)
 		{
-			TRACE_LOG("InputPredictorPNGOptimumStream::Read, problem, expected columns number read. didn't make it");
+			if(readFromSource != 0) // 0 is a belated end. must be flate
+				TRACE_LOG("InputPredictorPNGOptimumStream::Read, problem, expected columns number read. didn't make it");
+			std::swap(mUpValues,mBuffer);
+			mIndex = mBuffer + mBufferSize;
 			break;
 		}
-		mFunctionType = *mBuffer;
-		*mBuffer = 0; // so i can use this as "left" value...we don't care about this one...it's just a tag
-		mIndex = mBuffer+1; // skip the first tag
 
-		while(mBufferSize > (LongBufferSizeType)(mIndex - mBuffer) && readBytes < inBufferSize)
-		{
-			DecodeNextByte(inBuffer[readBytes]);
-			++readBytes;
-		}
+		// decode the whole row in place. the first byte is the row filter tag
+		mFunctionType = *mBuffer;
+		DecodeRow(mFunctionType,mBuffer + 1,mUpValues + 1,mBufferSize - 1,mBytesPerPixel);
+		mIndex = mBuffer + 1;
 	}
 	return readBytes;
 }
@@ -105,30 +115,256 @@ bool InputPredictorPNGOptimumStream::NotEnded()
 	return mSourceStream->NotEnded() || (LongBufferSizeType)(mIndex - mBuffer) < mBufferSize;
 }
 
-void InputPredictorPNGOptimumStream::DecodeNextByte(Byte& outDecodedByte)
+/*
+	Row filters. left and upper left values are of the corresponding byte in the previous pixel, and 0 for the first pixel in the row.
+	Sub, Average and Paeth depend on the previous pixel, so they go pixel by pixel. they are specialized per bytes per pixel, and for 3 and 4 bytes
+	pixels (RGB and RGBA/CMYK) use SIMD for the pixel. Up doesn't, so it goes 16 bytes at a time.
+	BPP of 0 means that the bytes per pixel is only known at runtime.
+*/
+
+static void UnfilterUp(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength)
+{
+	LongBufferSizeType i = 0;
+#ifdef PDFHUMMUS_PREDICTOR_SSE2
+	for(; i + 16 <= inLength; i+=16)
+		_mm_storeu_si128((__m128i*)(ioRow + i),_mm_add_epi8(_mm_loadu_si128((const __m128i*)(ioRow + i)),_mm_loadu_si128((const __m128i*)(inUpRow + i))));
+#endif
+	for(; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + inUpRow[i]);
+}
+
+template <LongBufferSizeType BPP>
+static void UnfilterSub(Byte* ioRow,LongBufferSizeType inLength,LongBufferSizeType inBytesPerPixel)
+{
+	const LongBufferSizeType bytesPerPixel = BPP ? BPP : inBytesPerPixel;
+
+	for(LongBufferSizeType i = bytesPerPixel; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + ioRow[i - bytesPerPixel]);
+}
+
+template <LongBufferSizeType BPP>
+static void UnfilterAverage(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength,LongBufferSizeType inBytesPerPixel)
+{
+	const LongBufferSizeType bytesPerPixel = BPP ? BPP : inBytesPerPixel;
+	LongBufferSizeType i = 0;
+
+	for(; i < bytesPerPixel && i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + (inUpRow[i] >> 1));
+	for(; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + ((ioRow[i - bytesPerPixel] + inUpRow[i]) >> 1));
+}
+
+static Byte PaethPredictor(Byte inLeft,Byte inUp,Byte inUpLeft)
+{
+	int p = inLeft + inUp - inUpLeft;
+	int pLeft = abs(p - inLeft);
+	int pUp = abs(p - inUp);
+	int pUpLeft = abs(p - inUpLeft);
+
+	if(pLeft <= pUp && pLeft <= pUpLeft)
+	  return inLeft;
+	else if(pUp <= pUpLeft)
+	  return inUp;
+	else
+	  return inUpLeft;
+}
+
+template <LongBufferSizeType BPP>
+static void UnfilterPaeth(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength,LongBufferSizeType inBytesPerPixel)
+{
+	const LongBufferSizeType bytesPerPixel = BPP ? BPP : inBytesPerPixel;
+	LongBufferSizeType i = 0;
+
+	// no left pixel, so the predictor is up
+	for(; i < bytesPerPixel && i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + inUpRow[i]);
+	for(; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + PaethPredictor(ioRow[i - bytesPerPixel],inUpRow[i],inUpRow[i - bytesPerPixel]));
+}
+
+#ifdef PDFHUMMUS_PREDICTOR_SSE2
+
+// pixels of 3 or 4 bytes, loaded to the low bytes of a register
+template <LongBufferSizeType BPP>
+static __m128i LoadPixel(const Byte* inPixel)
+{
+	int value = 0;
+	memcpy(&value,inPixel,BPP);
+	return _mm_cvtsi32_si128(value);
+}
+
+template <LongBufferSizeType BPP>
+static void StorePixel(Byte* outPixel,__m128i inValue)
+{
+	int value = _mm_cvtsi128_si32(inValue);
+	memcpy(outPixel,&value,BPP);
+}
+
+template <LongBufferSizeType BPP>
+static void UnfilterSubSSE2(Byte* ioRow,LongBufferSizeType inLength)
+{
+	__m128i left = _mm_setzero_si128();
+	LongBufferSizeType i = 0;
+
+	for(; i + BPP <= inLength; i+=BPP)
+	{
+		left = _mm_add_epi8(LoadPixel<BPP>(ioRow + i),left);
+		StorePixel<BPP>(ioRow + i,left);
+	}
+	// rows may end with a partial pixel
+	for(; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + ioRow[i - BPP]);
+}
+
+template <LongBufferSizeType BPP>
+static void UnfilterAverageSSE2(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength)
+{
+	__m128i left = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi8(1);
+	LongBufferSizeType i = 0;
+
+	for(; i + BPP <= inLength; i+=BPP)
+	{
+		__m128i up = LoadPixel<BPP>(inUpRow + i);
+		// avg_epu8 rounds up, so take off the rounding bit for the floor of the average
+		__m128i average = _mm_sub_epi8(_mm_avg_epu8(left,up),_mm_and_si128(_mm_xor_si128(left,up),ones));
+		left = _mm_add_epi8(LoadPixel<BPP>(ioRow + i),average);
+		StorePixel<BPP>(ioRow + i,left);
+	}
+	for(; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + (i < BPP ? (inUpRow[i] >> 1) : ((ioRow[i - BPP] + inUpRow[i]) >> 1)));
+}
+
+static __m128i AbsEpi16(__m128i inValue)
 {
-	// decoding function is determined by mFunctionType
-	switch(mFunctionType)
+	return _mm_max_epi16(inValue,_mm_sub_epi16(_mm_setzero_si128(),inValue));
+}
+
+static __m128i Select(__m128i inCondition,__m128i inThen,__m128i inElse)
+{
+	return _mm_or_si128(_mm_and_si128(inCondition,inThen),_mm_andnot_si128(inCondition,inElse));
+}
+
+template <LongBufferSizeType BPP>
+static void UnfilterPaethSSE2(Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength)
+{
+	// computing in 16 bits lanes, for the signed distances
+	const __m128i zero = _mm_setzero_si128();
+	__m128i left = zero;
+	__m128i upLeft = zero;
+	LongBufferSizeType i = 0;
+
+	for(; i + BPP <= inLength; i+=BPP)
+	{
+		__m128i up = _mm_unpacklo_epi8(LoadPixel<BPP>(inUpRow + i),zero);
+		__m128i value = _mm_unpacklo_epi8(LoadPixel<BPP>(ioRow + i),zero);
+
+		// distances of left + up - upleft from left, up and upleft
+		__m128i pLeft = _mm_sub_epi16(up,upLeft);
+		__m128i pUp = _mm_sub_epi16(left,upLeft);
+		__m128i pUpLeft = AbsEpi16(_mm_add_epi16(pLeft,pUp));
+		pLeft = AbsEpi16(pLeft);
+		pUp = AbsEpi16(pUp);
+
+		// ties prefer left, then up
+		__m128i smallest = _mm_min_epi16(pUpLeft,_mm_min_epi16(pLeft,pUp));
+		__m128i predictor = Select(_mm_cmpeq_epi16(smallest,pLeft),left,Select(_mm_cmpeq_epi16(smallest,pUp),up,upLeft));
+
+		// adding bytes, to wrap within the byte. the high bytes are 0 for both
+		left = _mm_add_epi8(value,predictor);
+		StorePixel<BPP>(ioRow + i,_mm_packus_epi16(left,left));
+		upLeft = up;
+	}
+	for(; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + (i < BPP ? inUpRow[i] : PaethPredictor(ioRow[i - BPP],inUpRow[i],inUpRow[i - BPP])));
+}
+
+#endif
+
+template <LongBufferSizeType BPP>
+static void DecodeRowForBytesPerPixel(Byte inFunctionType,Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength,LongBufferSizeType inBytesPerPixel)
+{
+	switch(inFunctionType)
 	{
-		case 0:
-			outDecodedByte = *mIndex;
+		case 1:
+			UnfilterSub<BPP>(ioRow,inLength,inBytesPerPixel);
+			break;
+		case 2:
+			UnfilterUp(ioRow,inUpRow,inLength);
+			break;
+		case 3:
+			UnfilterAverage<BPP>(ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+		case 4:
+			UnfilterPaeth<BPP>(ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+		default:
+			// 0 (none) and unknown types are copied as is
 			break;
+	}
+}
+
+#ifdef PDFHUMMUS_PREDICTOR_SSE2
+
+template <LongBufferSizeType BPP>
+static void DecodeRowForBytesPerPixelSSE2(Byte inFunctionType,Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength)
+{
+	switch(inFunctionType)
+	{
 		case 1:
-			outDecodedByte = (Byte)((char)*(mIndex-mBytesPerPixel) + (char)*mIndex);
+			UnfilterSubSSE2<BPP>(ioRow,inLength);
 			break;
 		case 2:
-			outDecodedByte = (Byte)((char)mUpValues[mIndex-mBuffer] + (char)*mIndex);
+			UnfilterUp(ioRow,inUpRow,inLength);
 			break;
 		case 3:
-			outDecodedByte = (Byte)((char)mBuffer[mIndex-mBuffer - 1]/2 + (char)mUpValues[mIndex-mBuffer]/2 + (char)*mIndex);
+			UnfilterAverageSSE2<BPP>(ioRow,inUpRow,inLength);
 			break;
 		case 4:
-			outDecodedByte = (Byte)(PaethPredictor(mBuffer[mIndex-mBuffer - 1],mUpValues[mIndex-mBuffer],mUpValues[mIndex-mBuffer - 1]) + (char)*mIndex);
+			UnfilterPaethSSE2<BPP>(ioRow,inUpRow,inLength);
+			break;
+		default:
 			break;
 	}
+}
 
-	*mIndex = outDecodedByte; // saving the encoded value back to the buffer, for later copying as "Up value", and current using as "Left" value
-	++mIndex;
+#endif
+
+void InputPredictorPNGOptimumStream::DecodeRow(Byte inFunctionType,Byte* ioRow,const Byte* inUpRow,LongBufferSizeType inLength,LongBufferSizeType inBytesPerPixel)
+{
+	switch(inBytesPerPixel)
+	{
+		case 1:
+			DecodeRowForBytesPerPixel<1>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+		case 2:
+			DecodeRowForBytesPerPixel<2>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+#ifdef PDFHUMMUS_PREDICTOR_SSE2
+		case 3:
+			DecodeRowForBytesPerPixelSSE2<3>(inFunctionType,ioRow,inUpRow,inLength);
+			break;
+		case 4:
+			DecodeRowForBytesPerPixelSSE2<4>(inFunctionType,ioRow,inUpRow,inLength);
+			break;
+#else
+		case 3:
+			DecodeRowForBytesPerPixel<3>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+		case 4:
+			DecodeRowForBytesPerPixel<4>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+#endif
+		case 6:
+			DecodeRowForBytesPerPixel<6>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+		case 8:
+			DecodeRowForBytesPerPixel<8>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+		default:
+			DecodeRowForBytesPerPixel<0>(inFunctionType,ioRow,inUpRow,inLength,inBytesPerPixel);
+			break;
+	}
 }
 
 void InputPredictorPNGOptimumStream::Assign(IByteReader* inSourceStream,
@@ -140,28 +376,17 @@ void InputPredictorPNGOptimumStream::Assign(IByteReader* inSourceStream,
 
 	delete[] mBuffer;
 	delete[] mUpValues;
+	// for less than 8 bits pixels, filters operate on bytes
 	mBytesPerPixel = inColors * inBitsPerComponent / 8;
+	if(0 == mBytesPerPixel)
+		mBytesPerPixel = 1;
 	// Rows may contain empty bits at end
 	mBufferSize = (inColumns * inColors * inBitsPerComponent + 7) / 8 + 1;
+	// the buffers swap roles per row, and the first row is decoded against an up row of 0s
 	mBuffer = new Byte[mBufferSize];
 	memset(mBuffer,0,mBufferSize);
 	mUpValues = new Byte[mBufferSize];
-	memset(mUpValues,0,mBufferSize); // that's less important
+	memset(mUpValues,0,mBufferSize);
 	mIndex = mBuffer + mBufferSize;
 	mFunctionType = 0;
 }
-
-char InputPredictorPNGOptimumStream::PaethPredictor(char inLeft,char inUp,char inUpLeft)
-{
-	int p = inLeft + inUp - inUpLeft;
-	int pLeft = abs(p - inLeft);
-	int pUp = abs(p - inUp);
-	int pUpLeft = abs(p - inUpLeft);
-
-	if(pLeft <= pUp && pLeft <= pUpLeft)
-	  return pLeft;
-	else if(pUp <= pUpLeft)
-	  return inUp;
-	else
-	  return inUpLeft;
-}
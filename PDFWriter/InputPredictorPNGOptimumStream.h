@@ -53,6 +53,10 @@ private:
 
 	IOBasicTypes::Byte* mUpValues;
 
-	void DecodeNextByte(IOBasicTypes::Byte& outDecodedByte);
-	char PaethPredictor(char inLeft,char inUp,char inUpLeft);
+	// decode a whole row in place, per the PNG filter type
+	void DecodeRow(IOBasicTypes::Byte inFunctionType,
+					IOBasicTypes::Byte* ioRow,
+					const IOBasicTypes::Byte* inUpRow,
+					IOBasicTypes::LongBufferSizeType inLength,
+					IOBasicTypes::LongBufferSizeType inBytesPerPixel);
 };
@@ -21,14 +21,17 @@
 #include "InputPredictorTIFFSubStream.h"
 #include "Trace.h"
 
+#include <string.h>
+#include <algorithm>
+
 using namespace IOBasicTypes;
 
 InputPredictorTIFFSubStream::InputPredictorTIFFSubStream(void)
 {
 	mSourceStream = NULL;
 	mRowBuffer = NULL;
-	mReadColors = NULL;
-	mReadColorsCount = 0;
+	mRowSize = 0;
+	mRowIndex = NULL;
 }
 
 InputPredictorTIFFSubStream::InputPredictorTIFFSubStream(IByteReader* inSourceStream,
@@ -38,7 +41,8 @@ InputPredictorTIFFSubStream::InputPredictorTIFFSubStream(IByteReader* inSourceSt
 {
 	mSourceStream = NULL;
 	mRowBuffer = NULL;
-	mReadColors = NULL;
+	mRowSize = 0;
+	mRowIndex = NULL;
 
 	Assign(inSourceStream,inColors,inBitsPerComponent,inColumns);
 }
@@ -47,44 +51,43 @@ InputPredictorTIFFSubStream::~InputPredictorTIFFSubStream(void)
 {
 	delete mSourceStream;
 	delete[] mRowBuffer;
-	delete[] mReadColors;
 }
 
 LongBufferSizeType InputPredictorTIFFSubStream::Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
 {
 	LongBufferSizeType readBytes = 0;
-	
 
-	// exhaust what's in the buffer currently
-	while(mReadColorsCount > (LongBufferSizeType)(mReadColorsIndex - mReadColors) && readBytes < inBufferSize)
+	while(readBytes < inBufferSize)
 	{
-		ReadByteFromColorsArray(inBuffer[readBytes]);
-		++readBytes;
-	}
-
-	// now repeatedly read bytes from the input stream, and decode
-	while(readBytes < inBufferSize && mSourceStream->NotEnded())
-	{
-		if(mSourceStream->Read(mRowBuffer,(mColumns*mColors*mBitsPerComponent)/8) != (mColumns*mColors*mBitsPerComponent)/8)
+		// exhaust what's in the buffer currently
+		LongBufferSizeType available = mRowSize - (LongBufferSizeType)(mRowIndex - mRowBuffer);
+		if(available > 0)
 		{
-			TRACE_LOG("InputPredictorPNGSubStream::Read, problem, expected columns*colors*bitspercomponent/8 number read. didn't make it");
-			readBytes = 0;
-			break;
+			LongBufferSizeType copyBytes = std::min<LongBufferSizeType>(available,inBufferSize - readBytes);
+			memcpy(inBuffer + readBytes,mRowIndex,copyBytes);
+			mRowIndex += copyBytes;
+			readBytes += copyBytes;
+			continue;
 		}
-		DecodeBufferToColors();
 
-		while(mReadColorsCount > (LongBufferSizeType)(mReadColorsIndex - mReadColors) && readBytes < inBufferSize)
+		if(!mSourceStream->NotEnded())
+			break;
+
+		// now read the next row from the input stream, and decode
+		if(mSourceStream->Read(mRowBuffer,mRowSize) != mRowSize)
 		{
-			ReadByteFromColorsArray(inBuffer[readBytes]);
-			++readBytes;
+			TRACE_LOG("InputPredictorTIFFSubStream::Read, problem, expected columns*colors*bitspercomponent/8 number read. didn't make it");
+			readBytes = 0;
+			break;
 		}
+		DecodeRow();
 	}
-	return readBytes;	
+	return readBytes;
 }
 
 bool InputPredictorTIFFSubStream::NotEnded()
 {
-	return mSourceStream->NotEnded() || (LongBufferSizeType)(mReadColorsIndex - mReadColors) < mReadColorsCount;
+	return mSourceStream->NotEnded() || (LongBufferSizeType)(mRowIndex - mRowBuffer) < mRowSize;
 }
 
 void InputPredictorTIFFSubStream::Assign(IByteReader* inSourceStream,
@@ -96,87 +99,87 @@ void InputPredictorTIFFSubStream::Assign(IByteReader* inSourceStream,
 	mColors = inColors;
 	mBitsPerComponent = inBitsPerComponent;
 	mColumns = inColumns;
-	
-	delete mRowBuffer;
-	mRowBuffer = new Byte[(inColumns*inColors*inBitsPerComponent)/8];
 
-	mReadColorsCount = inColumns * inColors;
-	mReadColors = new unsigned short[mReadColorsCount];
-	mReadColorsIndex = mReadColors + mReadColorsCount; // assign to end of array so will know that should read new buffer
-	mIndexInColor = 0;
+	delete[] mRowBuffer;
+	// Rows may contain empty bits at end
+	mRowSize = (inColumns*inColors*inBitsPerComponent + 7)/8;
+	mRowBuffer = new Byte[mRowSize];
+	mRowIndex = mRowBuffer + mRowSize; // assign to end of row so will know that should read a new one
 
 	mBitMask = 0;
-	for(Byte i=0;i<inBitsPerComponent;++i)
+	for(Byte i=0;i<inBitsPerComponent && i<8;++i)
 		mBitMask = (mBitMask<<1) + 1;
 }
 
-void InputPredictorTIFFSubStream::ReadByteFromColorsArray(Byte& outBuffer)
+/*
+	Each component is the difference from the same component in the previous pixel, modulo the component size.
+	8 bits components accumulate byte by byte, specialized per colors count. 16 bits components are big endian.
+	COLORS of 0 means that the colors count is only known at runtime.
+*/
+
+template <LongBufferSizeType COLORS>
+static void AccumulateBytes(Byte* ioRow,LongBufferSizeType inLength,LongBufferSizeType inColors)
 {
-	if(8 == mBitsPerComponent)
-	{
-		outBuffer = (Byte)(*mReadColorsIndex);
-		++mReadColorsIndex;
-	}
-	else if(8 > mBitsPerComponent)
-	{
-		outBuffer = 0;
-		for(Byte i=0;i<(8/mBitsPerComponent);++i)
-		{
-			outBuffer = (outBuffer<<mBitsPerComponent) + (Byte)(*mReadColorsIndex);
-			++mReadColorsIndex;
-		}
-	}
-	else // 8 < mBitsPerComponent [which is just 16 for now]
+	const LongBufferSizeType colors = COLORS ? COLORS : inColors;
+
+	for(LongBufferSizeType i = colors; i < inLength; ++i)
+		ioRow[i] = (Byte)(ioRow[i] + ioRow[i - colors]);
+}
+
+static void AccumulateShorts(Byte* ioRow,LongBufferSizeType inComponentsCount,LongBufferSizeType inColors)
+{
+	Byte* component = ioRow + inColors*2;
+	const Byte* leftComponent = ioRow;
+
+	for(LongBufferSizeType i = inColors; i < inComponentsCount; ++i, component+=2, leftComponent+=2)
 	{
-		outBuffer =(Byte)(((*mReadColorsIndex)>>(mBitsPerComponent - mIndexInColor*8)) & 0xff);
-		++mIndexInColor;
-		if(mBitsPerComponent/8 == mIndexInColor)
-		{
-			++mReadColorsIndex;
-			mIndexInColor = 0;
-		}
+		unsigned short value = (unsigned short)(((component[0]<<8) | component[1]) + ((leftComponent[0]<<8) | leftComponent[1]));
+		component[0] = (Byte)(value>>8);
+		component[1] = (Byte)(value & 0xff);
 	}
 }
 
-void InputPredictorTIFFSubStream::DecodeBufferToColors()
-{	
-	//1. Split to colors. Use array of colors (should be columns * colors). Each time take BitsPerComponent of the buffer
-	//2. Once you got the "colors", loop the array, setting values after diffs (use modulo of bit mask for "sign" computing)
-	//3. Now you have the colors array. 
-	LongBufferSizeType i = 0;
+void InputPredictorTIFFSubStream::DecodeRow()
+{
+	LongBufferSizeType componentsCount = mColumns*mColors;
 
-	// read the colors differences according to bits per component
 	if(8 == mBitsPerComponent)
 	{
-		for(; i < mReadColorsCount;++i)
-			mReadColors[i] = mRowBuffer[i];
-	}
-	else if(8 > mBitsPerComponent)
-	{
-		for(; i < (mReadColorsCount*mBitsPerComponent/8);++i)
+		switch(mColors)
 		{
-			for(LongBufferSizeType j=0; j < (LongBufferSizeType)(8/mBitsPerComponent); ++j)
-			{
-				mReadColors[(i+1)*8/mBitsPerComponent - j - 1] = mRowBuffer[i] & mBitMask;
-				mRowBuffer[i] = mRowBuffer[i]>>mBitsPerComponent;
-			}
+			case 1:
+				AccumulateBytes<1>(mRowBuffer,mRowSize,mColors);
+				break;
+			case 3:
+				AccumulateBytes<3>(mRowBuffer,mRowSize,mColors);
+				break;
+			case 4:
+				AccumulateBytes<4>(mRowBuffer,mRowSize,mColors);
+				break;
+			default:
+				AccumulateBytes<0>(mRowBuffer,mRowSize,mColors);
+				break;
 		}
 	}
-	else // mBitesPerComponent > 8
+	else if(16 == mBitsPerComponent)
 	{
-		for(; i < mReadColorsCount;++i)
+		AccumulateShorts(mRowBuffer,componentsCount,mColors);
+	}
+	else if(8 > mBitsPerComponent)
+	{
+		// components are packed from the high bits. 1, 2 and 4 bits never cross a byte
+		for(LongBufferSizeType i = mColors; i < componentsCount; ++i)
 		{
-			mReadColors[i] = 0;
-			for(Byte j=0;j<mBitsPerComponent/8;++j)
-				mReadColors[i] = (mReadColors[i]<<mBitsPerComponent) + mRowBuffer[i*mBitsPerComponent/8 + j];
+			LongBufferSizeType bitOffset = i*mBitsPerComponent;
+			LongBufferSizeType leftBitOffset = (i - mColors)*mBitsPerComponent;
+			Byte shift = (Byte)(8 - mBitsPerComponent - (bitOffset & 7));
+			Byte leftShift = (Byte)(8 - mBitsPerComponent - (leftBitOffset & 7));
+			Byte& component = mRowBuffer[bitOffset>>3];
+
+			Byte value = (Byte)((((component>>shift) & mBitMask) + ((mRowBuffer[leftBitOffset>>3]>>leftShift) & mBitMask)) & mBitMask);
+			component = (Byte)((component & ~(mBitMask<<shift)) | (value<<shift));
 		}
 	}
 
-	// calculate color values according to diffs
-	for(i = mColors; i < mReadColorsCount; ++i)
-		mReadColors[i] = (mReadColors[i] + mReadColors[i-mColors]) & mBitMask;
-
-	mReadColorsIndex = mReadColors;
-	mIndexInColor = 0;
-
-}
\ No newline at end of file
+	mRowIndex = mRowBuffer;
+}
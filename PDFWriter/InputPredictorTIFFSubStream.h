@@ -50,15 +50,11 @@ private:
 	IOBasicTypes::Byte mBitsPerComponent;
 	IOBasicTypes::LongBufferSizeType mColumns;
 	
+	// current row, decoded in place, and the position of the next byte to read from it
 	IOBasicTypes::Byte* mRowBuffer;
-	IOBasicTypes::LongBufferSizeType mReadColorsCount;
-	unsigned short* mReadColors;
-	unsigned short* mReadColorsIndex;
-	IOBasicTypes::Byte mIndexInColor;
-	unsigned short mBitMask;
-
-	void ReadByteFromColorsArray(IOBasicTypes::Byte& outBuffer);
-	void DecodeBufferToColors();
-
+	IOBasicTypes::LongBufferSizeType mRowSize;
+	IOBasicTypes::Byte* mRowIndex;
+	IOBasicTypes::Byte mBitMask;
 
+	void DecodeRow();
 };
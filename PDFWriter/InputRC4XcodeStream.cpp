@@ -53,13 +53,15 @@ bool InputRC4XcodeStream::NotEnded()
 LongBufferSizeType InputRC4XcodeStream::Read(IOBasicTypes::Byte* inBuffer, LongBufferSizeType inBufferSize)
 {
 	LongBufferSizeType mCurrentIndex = 0;
-	Byte buffer;
 
+	// read as much as possible, and decode it in place
 	while (NotEnded() && mCurrentIndex < inBufferSize)
 	{
-		mSourceStream->Read(&buffer, 1);
-		inBuffer[mCurrentIndex] = mRC4.DecodeNextByte(buffer);
-		++mCurrentIndex;
+		LongBufferSizeType readAmount = mSourceStream->Read(inBuffer + mCurrentIndex, inBufferSize - mCurrentIndex);
+		if (0 == readAmount)
+			break;
+		mRC4.Xcode(inBuffer + mCurrentIndex, inBuffer + mCurrentIndex, readAmount);
+		mCurrentIndex += readAmount;
 	}
 
 	return mCurrentIndex;
@@ -56,6 +56,17 @@ bool InputStreamSkipperStream::NotEnded()
 	return mStream->NotEnded();
 }
 
+const IOBasicTypes::Byte* InputStreamSkipperStream::PeekDirectBuffer(IOBasicTypes::LongBufferSizeType& outAvailableSize)
+{
+	return mStream->PeekDirectBuffer(outAvailableSize);
+}
+
+void InputStreamSkipperStream::ConsumeDirectBuffer(IOBasicTypes::LongBufferSizeType inConsumedSize)
+{
+	mStream->ConsumeDirectBuffer(inConsumedSize);
+	mAmountRead+=inConsumedSize;
+}
+
 
 bool InputStreamSkipperStream::CanSkipTo(IOBasicTypes::LongFilePositionType inPositionInStream)
 {
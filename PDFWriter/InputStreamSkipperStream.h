@@ -42,6 +42,8 @@ public:
 	// IByteReader implementation
 	virtual IOBasicTypes::LongBufferSizeType Read(IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inBufferSize);
 	virtual bool NotEnded();
+	virtual const IOBasicTypes::Byte* PeekDirectBuffer(IOBasicTypes::LongBufferSizeType& outAvailableSize);
+	virtual void ConsumeDirectBuffer(IOBasicTypes::LongBufferSizeType inConsumedSize);
 
 	// IReadPositionProvider implementation
 	virtual IOBasicTypes::LongFilePositionType GetCurrentPosition();
@@ -0,0 +1,153 @@
+/*
+   Source File : ObjectIDTypeDenseMap.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ObjectIDTypeDenseMap.h"
+
+#include <stddef.h>
+
+// array entries hold the mapped ID + 1, leaving 0 for free entries. so the one value that can't be held there is the maximal ID
+static const ObjectIDType scNoDenseValue = ~((ObjectIDType)0);
+
+ObjectIDTypeDenseMap::iterator::iterator()
+{
+	mMap = NULL;
+	mDenseIndex = 0;
+}
+
+ObjectIDTypeDenseMap::iterator::iterator(const ObjectIDTypeDenseMap* inMap,ObjectIDType inDenseIndex,ObjectIDTypeToObjectIDTypeSparseMap::const_iterator inSparseIterator)
+{
+	mMap = inMap;
+	mDenseIndex = inDenseIndex;
+	mSparseIterator = inSparseIterator;
+	MoveToMappedEntry();
+}
+
+const ObjectIDTypeDenseMap::value_type& ObjectIDTypeDenseMap::iterator::operator*() const
+{
+	return mValue;
+}
+
+const ObjectIDTypeDenseMap::value_type* ObjectIDTypeDenseMap::iterator::operator->() const
+{
+	return &mValue;
+}
+
+ObjectIDTypeDenseMap::iterator& ObjectIDTypeDenseMap::iterator::operator++()
+{
+	if(IsAtDenseEntry())
+		++mDenseIndex;
+	else
+		++mSparseIterator;
+	MoveToMappedEntry();
+	return *this;
+}
+
+bool ObjectIDTypeDenseMap::iterator::operator==(const iterator& inOther) const
+{
+	return mDenseIndex == inOther.mDenseIndex && mSparseIterator == inOther.mSparseIterator;
+}
+
+bool ObjectIDTypeDenseMap::iterator::operator!=(const iterator& inOther) const
+{
+	return !(*this == inOther);
+}
+
+bool ObjectIDTypeDenseMap::iterator::IsAtDenseEntry() const
+{
+	// the current entry is the lower ID of the next array entry and the next map entry [an ID is never in both]
+	return mDenseIndex < mMap->mDenseEntries.size() &&
+			(mSparseIterator == mMap->mSparseEntries.end() || mDenseIndex < mSparseIterator->first);
+}
+
+void ObjectIDTypeDenseMap::iterator::MoveToMappedEntry()
+{
+	// skip free array entries
+	while(mDenseIndex < mMap->mDenseEntries.size() && 0 == mMap->mDenseEntries[mDenseIndex])
+		++mDenseIndex;
+
+	if(IsAtDenseEntry())
+		mValue = value_type(mDenseIndex,mMap->mDenseEntries[mDenseIndex] - 1);
+	else if(mSparseIterator != mMap->mSparseEntries.end())
+		mValue = *mSparseIterator;
+}
+
+ObjectIDTypeDenseMap::ObjectIDTypeDenseMap(void)
+{
+	mDenseSize = 0;
+}
+
+ObjectIDTypeDenseMap::~ObjectIDTypeDenseMap(void)
+{
+}
+
+void ObjectIDTypeDenseMap::Reset(ObjectIDType inDenseSize)
+{
+	clear();
+	mDenseSize = inDenseSize;
+}
+
+void ObjectIDTypeDenseMap::clear()
+{
+	// release the memory, and not just clear it. maps are normally reset for a different source document
+	std::vector<ObjectIDType>().swap(mDenseEntries);
+	mSparseEntries.clear();
+}
+
+ObjectIDTypeDenseMap::iterator ObjectIDTypeDenseMap::begin() const
+{
+	return iterator(this,0,mSparseEntries.begin());
+}
+
+ObjectIDTypeDenseMap::iterator ObjectIDTypeDenseMap::end() const
+{
+	return iterator(this,mDenseEntries.size(),mSparseEntries.end());
+}
+
+ObjectIDTypeDenseMap::iterator ObjectIDTypeDenseMap::find(ObjectIDType inKey) const
+{
+	// iterators point at the next entry of both the array and the map, so that iterating from them merges the two in order
+	if(inKey < mDenseEntries.size() && mDenseEntries[inKey] != 0)
+		return iterator(this,inKey,mSparseEntries.upper_bound(inKey));
+
+	ObjectIDTypeToObjectIDTypeSparseMap::const_iterator it = mSparseEntries.find(inKey);
+	if(it == mSparseEntries.end())
+		return end();
+	else
+		return iterator(this,inKey < mDenseEntries.size() ? inKey + 1 : (ObjectIDType)mDenseEntries.size(),it);
+}
+
+std::pair<ObjectIDTypeDenseMap::iterator,bool> ObjectIDTypeDenseMap::insert(const value_type& inValue)
+{
+	iterator it = find(inValue.first);
+	if(it != end())
+		return std::pair<iterator,bool>(it,false);
+
+	if(inValue.first < mDenseSize && inValue.second != scNoDenseValue)
+	{
+		if(mDenseEntries.size() == 0)
+			mDenseEntries.resize(mDenseSize,0);
+		mDenseEntries[inValue.first] = inValue.second + 1;
+	}
+	else
+	{
+		mSparseEntries.insert(inValue);
+	}
+	return std::pair<iterator,bool>(find(inValue.first),true);
+}
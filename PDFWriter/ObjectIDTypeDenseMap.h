@@ -0,0 +1,86 @@
+/*
+   Source File : ObjectIDTypeDenseMap.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ObjectsBasicTypes.h"
+
+#include <vector>
+#include <map>
+#include <utility>
+
+/*
+	Map from object IDs to object IDs, for object IDs that are mostly dense, like the object IDs of a parsed PDF.
+	IDs below the dense size [normally the source objects count] are kept in an array, indexed by the ID. others are kept in a map.
+	The array is allocated on first insert, so an unused map costs nothing.
+	Iteration is in ascending ID order, same as std::map, and has the std::map interface that MapIterator needs. IDs below the dense size
+	may still be in the map [when mapped to the maximal ID, which the array can't hold], so iteration merges the array and the map.
+	Iterators are not kept valid by inserts.
+*/
+class ObjectIDTypeDenseMap
+{
+public:
+	typedef ObjectIDType key_type;
+	typedef ObjectIDType mapped_type;
+	typedef std::pair<ObjectIDType,ObjectIDType> value_type;
+	typedef std::map<ObjectIDType,ObjectIDType> ObjectIDTypeToObjectIDTypeSparseMap;
+
+	class iterator
+	{
+	public:
+		iterator();
+		iterator(const ObjectIDTypeDenseMap* inMap,ObjectIDType inDenseIndex,ObjectIDTypeToObjectIDTypeSparseMap::const_iterator inSparseIterator);
+
+		const value_type& operator*() const;
+		const value_type* operator->() const;
+		iterator& operator++();
+		bool operator==(const iterator& inOther) const;
+		bool operator!=(const iterator& inOther) const;
+
+	private:
+		const ObjectIDTypeDenseMap* mMap;
+		ObjectIDType mDenseIndex;
+		ObjectIDTypeToObjectIDTypeSparseMap::const_iterator mSparseIterator;
+		value_type mValue;
+
+		void MoveToMappedEntry();
+		bool IsAtDenseEntry() const;
+	};
+	typedef iterator const_iterator;
+
+	ObjectIDTypeDenseMap(void);
+	~ObjectIDTypeDenseMap(void);
+
+	// clears the map, and sets the IDs range to keep in the array [0..inDenseSize)
+	void Reset(ObjectIDType inDenseSize);
+	void clear();
+
+	iterator begin() const;
+	iterator end() const;
+	iterator find(ObjectIDType inKey) const;
+
+	// same as std::map. doesn't change an existing mapping, and returns it with false
+	std::pair<iterator,bool> insert(const value_type& inValue);
+
+private:
+	ObjectIDType mDenseSize;
+	std::vector<ObjectIDType> mDenseEntries;
+	ObjectIDTypeToObjectIDTypeSparseMap mSparseEntries;
+};
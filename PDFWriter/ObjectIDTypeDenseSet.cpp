@@ -0,0 +1,77 @@
+/*
+   Source File : ObjectIDTypeDenseSet.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ObjectIDTypeDenseSet.h"
+
+#include <algorithm>
+
+ObjectIDTypeDenseSet::ObjectIDTypeDenseSet(void)
+{
+	mDenseSize = 0;
+	mGeneration = 1;
+}
+
+ObjectIDTypeDenseSet::~ObjectIDTypeDenseSet(void)
+{
+}
+
+void ObjectIDTypeDenseSet::Reset(ObjectIDType inDenseSize)
+{
+	std::vector<unsigned int>().swap(mDenseMarks);
+	mSparseEntries.clear();
+	mDenseSize = inDenseSize;
+	mGeneration = 1;
+}
+
+void ObjectIDTypeDenseSet::Clear()
+{
+	mSparseEntries.clear();
+
+	// a new generation invalidates all marks. when the generations run out, start over with cleared marks
+	++mGeneration;
+	if(0 == mGeneration)
+	{
+		std::fill(mDenseMarks.begin(),mDenseMarks.end(),0);
+		mGeneration = 1;
+	}
+}
+
+bool ObjectIDTypeDenseSet::Contains(ObjectIDType inObjectID) const
+{
+	if(inObjectID < mDenseSize)
+		return inObjectID < mDenseMarks.size() && mDenseMarks[inObjectID] == mGeneration;
+	else
+		return mSparseEntries.find(inObjectID) != mSparseEntries.end();
+}
+
+bool ObjectIDTypeDenseSet::Insert(ObjectIDType inObjectID)
+{
+	if(inObjectID < mDenseSize)
+	{
+		if(mDenseMarks.size() == 0)
+			mDenseMarks.resize(mDenseSize,0);
+		if(mDenseMarks[inObjectID] == mGeneration)
+			return false;
+		mDenseMarks[inObjectID] = mGeneration;
+		return true;
+	}
+	else
+		return mSparseEntries.insert(inObjectID).second;
+}
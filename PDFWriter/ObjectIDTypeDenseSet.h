@@ -0,0 +1,53 @@
+/*
+   Source File : ObjectIDTypeDenseSet.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ObjectsBasicTypes.h"
+
+#include <vector>
+#include <set>
+
+/*
+	Set of object IDs, for object IDs that are mostly dense, like the object IDs of a parsed PDF.
+	IDs below the dense size are marked in an array, others are kept in a set.
+	Marks hold the generation in which they were made, so Clear doesn't have to go over the array,
+	which makes it cheap to clear a set that is used for many small jobs [like a copy of an object and its dependencies].
+*/
+class ObjectIDTypeDenseSet
+{
+public:
+	ObjectIDTypeDenseSet(void);
+	~ObjectIDTypeDenseSet(void);
+
+	// clears the set, and sets the IDs range to keep in the array [0..inDenseSize)
+	void Reset(ObjectIDType inDenseSize);
+	void Clear();
+
+	bool Contains(ObjectIDType inObjectID) const;
+	// returns false if already in the set
+	bool Insert(ObjectIDType inObjectID);
+
+private:
+	ObjectIDType mDenseSize;
+	unsigned int mGeneration;
+	std::vector<unsigned int> mDenseMarks;
+	std::set<ObjectIDType> mSparseEntries;
+};
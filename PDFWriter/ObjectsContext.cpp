@@ -31,18 +31,27 @@
 #include "PDFDictionary.h"
 #include "PDFIndirectObjectReference.h"
 #include "PDFBoolean.h"
+#include "PDFInteger.h"
 #include "PDFLiteralString.h"
 #include "EncryptionHelper.h"
 #include "PDFObjectParser.h"
+#include "IObjectsContextExtender.h"
 
 using namespace PDFHummus;
 
 ObjectsContext::ObjectsContext(void)
 {
 	mOutputStream = NULL;
+	mTargetOutputStream = NULL;
 	mCompressStreams = true;
+	mCompressStreamsInParallel = false;
 	mExtender = NULL;
 	mEncryptionHelper = NULL;
+	mWriteObjectStreams = false;
+	mObjectStreamsSuspended = false;
+	mPackedObjectID = 0;
+	mPackedObjectTargetStream = NULL;
+	mObjectStreamID = 0;
 }
 
 ObjectsContext::~ObjectsContext(void)
@@ -54,8 +63,20 @@ ObjectsContext::~ObjectsContext(void)
 
 void ObjectsContext::SetOutputStream(IByteWriterWithPosition* inOutputStream)
 {
-	mOutputStream = inOutputStream;
-	mPrimitiveWriter.SetStreamForWriting(inOutputStream);
+	mTargetOutputStream = inOutputStream;
+
+	// with parallel compression, write through the ordered compression stream, which takes care of placing compressed streams
+	if(mCompressStreamsInParallel && inOutputStream)
+	{
+		mOrderedCompressionStream.Assign(inOutputStream,&mReferencesRegistry);
+		mOutputStream = &mOrderedCompressionStream;
+	}
+	else
+	{
+		mOrderedCompressionStream.Assign(NULL,NULL);
+		mOutputStream = inOutputStream;
+	}
+	mPrimitiveWriter.SetStreamForWriting(mOutputStream);
 }
 
 void ObjectsContext::SetEncryptionHelper(EncryptionHelper* inEncryptionHelper) 
@@ -148,6 +169,11 @@ LongFilePositionType ObjectsContext::GetCurrentPosition() {
 	if (!mOutputStream) // in case somebody gets smart and ask before the stream is set
 		return 0;
 
+	// position is asked for the object being written, so it can't go into an object stream
+	UnpackObject();
+
+	// exact position is known only when all pending streams are written
+	FlushParallelCompression();
 	return mOutputStream->GetCurrentPosition();
 }
 
@@ -157,6 +183,8 @@ static const IOBasicTypes::Byte scXref[] = {'x','r','e','f'};
 EStatusCode ObjectsContext::WriteXrefTable(LongFilePositionType& outWritePosition)
 {
 	EStatusCode status = PDFHummus::eSuccess;
+	// all objects should be in place before writing their positions
+	FlushParallelCompression();
 	outWritePosition = mOutputStream->GetCurrentPosition();
 	
 	// write xref keyword
@@ -193,7 +221,13 @@ EStatusCode ObjectsContext::WriteXrefTable(LongFilePositionType& outWritePositio
             {
                 // used object
                 
-                if(objectReference.mObjectWritten)
+                if(objectReference.mObjectWritten && objectReference.mObjectStreamID != 0)
+                {
+                    // objects in object streams can only be referenced from xref streams
+                    status = PDFHummus::eFailure;
+                    TRACE_LOG1("ObjectsContext::WriteXrefTable, Unexpected Failure. Object of ID = %ld was written in an object stream. use WriteXrefStream",i);
+                }
+                else if(objectReference.mObjectWritten)
                 {
                     SAFE_SPRINTF_2(entryBuffer,21,"%010lld %05ld n\r\n",objectReference.mWritePosition,objectReference.mGenerationNumber);
                     mOutputStream->Write((const IOBasicTypes::Byte *)entryBuffer,20);
@@ -317,33 +351,45 @@ static const std::string scObj = "obj";
 ObjectIDType ObjectsContext::StartNewIndirectObject()
 {
 	ObjectIDType newObjectID = mReferencesRegistry.AllocateNewObjectID();
-	mReferencesRegistry.MarkObjectAsWritten(newObjectID,mOutputStream->GetCurrentPosition());
-	mPrimitiveWriter.WriteInteger(newObjectID);
-	mPrimitiveWriter.WriteInteger(0);
-	mPrimitiveWriter.WriteKeyword(scObj);
-
-	if(IsEncrypting()) {
-		mEncryptionHelper->OnObjectStart((long long)newObjectID, 0);
-	}
-
+	StartNewIndirectObject(newObjectID);
 	return newObjectID;
 }
 
 void ObjectsContext::StartNewIndirectObject(ObjectIDType inObjectID)
 {
-	mReferencesRegistry.MarkObjectAsWritten(inObjectID,mOutputStream->GetCurrentPosition());
-	mPrimitiveWriter.WriteInteger(inObjectID);
-	mPrimitiveWriter.WriteInteger(0);
-	mPrimitiveWriter.WriteKeyword(scObj);
+	// an object that was not ended is not going to make it into an object stream
+	UnpackObject();
+
+	if(ShouldPackObject())
+	{
+		StartPackedObject(inObjectID);
+		return;
+	}
+
+	MarkObjectAsWritten(inObjectID);
+	WriteIndirectObjectHeader(inObjectID);
 
 	if (IsEncrypting()) {
 		mEncryptionHelper->OnObjectStart((long long)inObjectID, 0);
 	}
 }
 
+void ObjectsContext::WriteIndirectObjectHeader(ObjectIDType inObjectID)
+{
+	mPrimitiveWriter.WriteInteger(inObjectID);
+	mPrimitiveWriter.WriteInteger(0);
+	mPrimitiveWriter.WriteKeyword(scObj);
+}
+
 void ObjectsContext::StartModifiedIndirectObject(ObjectIDType inObjectID)
 {
-	mReferencesRegistry.MarkObjectAsUpdated(inObjectID,mOutputStream->GetCurrentPosition());
+	UnpackObject();
+
+	// position is registered when known, in case it comes after streams still being compressed
+	if(mOutputStream == &mOrderedCompressionStream)
+		mOrderedCompressionStream.MarkObjectAsUpdated(inObjectID);
+	else
+		mReferencesRegistry.MarkObjectAsUpdated(inObjectID,mOutputStream->GetCurrentPosition());
 	mPrimitiveWriter.WriteInteger(inObjectID);
 	mPrimitiveWriter.WriteInteger(0);
 	mPrimitiveWriter.WriteKeyword(scObj);    
@@ -353,9 +399,24 @@ void ObjectsContext::StartModifiedIndirectObject(ObjectIDType inObjectID)
 	}
 }
 
+void ObjectsContext::MarkObjectAsWritten(ObjectIDType inObjectID)
+{
+	// position is registered when known, in case it comes after streams still being compressed
+	if(mOutputStream == &mOrderedCompressionStream)
+		mOrderedCompressionStream.MarkObjectAsWritten(inObjectID);
+	else
+		mReferencesRegistry.MarkObjectAsWritten(inObjectID,mOutputStream->GetCurrentPosition());
+}
+
 static const std::string scEndObj = "endobj";
 void ObjectsContext::EndIndirectObject()
 {
+	if(mPackedObjectID != 0)
+	{
+		EndPackedObject();
+		return;
+	}
+
 	mPrimitiveWriter.WriteKeyword(scEndObj);
 
 	if (IsEncrypting()) {
@@ -378,6 +439,157 @@ void ObjectsContext::SetCompressStreams(bool inCompressStreams)
 	mCompressStreams = inCompressStreams;
 }
 
+bool ObjectsContext::IsCompressingStreams()
+{
+	return mCompressStreams;
+}
+
+void ObjectsContext::SetCompressStreamsInParallel(bool inCompressStreamsInParallel)
+{
+	mCompressStreamsInParallel = inCompressStreamsInParallel;
+	if(mTargetOutputStream)
+		SetOutputStream(mTargetOutputStream);
+}
+
+void ObjectsContext::FlushParallelCompression()
+{
+	if(mOutputStream == &mOrderedCompressionStream)
+		mOrderedCompressionStream.Flush();
+}
+
+void ObjectsContext::SetWriteObjectStreams(bool inWriteObjectStreams)
+{
+	mWriteObjectStreams = inWriteObjectStreams;
+}
+
+bool ObjectsContext::IsWritingObjectStreams()
+{
+	return mWriteObjectStreams;
+}
+
+bool ObjectsContext::ShouldPackObject()
+{
+	return mWriteObjectStreams && !mObjectStreamsSuspended && mOutputStream && !IsEncrypting();
+}
+
+void ObjectsContext::StartPackedObject(ObjectIDType inObjectID)
+{
+	// write the object to a side buffer, till it ends (and can go into an object stream), or turns out to be a stream
+	mPackedObjectID = inObjectID;
+	mPackedObjectTargetStream = mOutputStream;
+	mPackedObjectStream.Reset();
+	mOutputStream = &mPackedObjectStream;
+	mPrimitiveWriter.SetStreamForWriting(mOutputStream);
+}
+
+void ObjectsContext::UnpackObject()
+{
+	if(0 == mPackedObjectID)
+		return;
+
+	// write the object collected so far as a regular indirect object, and continue writing it directly
+	ObjectIDType objectID = mPackedObjectID;
+	std::string objectContent = mPackedObjectStream.ToString();
+
+	mPackedObjectID = 0;
+	mOutputStream = mPackedObjectTargetStream;
+	mPackedObjectTargetStream = NULL;
+	mPrimitiveWriter.SetStreamForWriting(mOutputStream);
+	mPackedObjectStream.Reset();
+
+	MarkObjectAsWritten(objectID);
+	WriteIndirectObjectHeader(objectID);
+	mOutputStream->Write((const IOBasicTypes::Byte*)objectContent.c_str(),objectContent.size());
+}
+
+void ObjectsContext::EndPackedObject()
+{
+	std::string objectContent = mPackedObjectStream.ToString();
+	ObjectIDType objectID = mPackedObjectID;
+
+	mPackedObjectID = 0;
+	mOutputStream = mPackedObjectTargetStream;
+	mPackedObjectTargetStream = NULL;
+	mPrimitiveWriter.SetStreamForWriting(mOutputStream);
+	mPackedObjectStream.Reset();
+
+	if(0 == mObjectStreamID)
+		mObjectStreamID = mReferencesRegistry.AllocateNewObjectID();
+
+	mReferencesRegistry.MarkObjectAsWrittenInObjectStream(objectID,mObjectStreamID,(unsigned long)mObjectStreamEntries.size());
+	mObjectStreamEntries.push_back(ObjectIDTypeAndOffset(objectID,mObjectStreamContent.GetCurrentPosition()));
+	mObjectStreamContent.Write((const IOBasicTypes::Byte*)objectContent.c_str(),objectContent.size());
+
+	if(mObjectStreamEntries.size() >= OBJECT_STREAM_MAX_OBJECTS)
+		WriteObjectStream();
+}
+
+void ObjectsContext::FlushObjectStreams()
+{
+	UnpackObject();
+	WriteObjectStream();
+}
+
+static const std::string scType = "Type";
+static const std::string scObjStm = "ObjStm";
+static const std::string scN = "N";
+static const std::string scFirst = "First";
+
+void ObjectsContext::WriteObjectStream()
+{
+	if(mObjectStreamEntries.empty())
+		return;
+
+	// object stream header, is pairs of object ID and object offset (relative to first object)
+	OutputStringBufferStream headerStream;
+	PrimitiveObjectsWriter headerWriter(&headerStream);
+	ObjectIDTypeAndOffsetList::iterator it = mObjectStreamEntries.begin();
+	for(; it != mObjectStreamEntries.end(); ++it)
+	{
+		headerWriter.WriteInteger(it->first);
+		headerWriter.WriteInteger(it->second);
+	}
+	headerWriter.EndLine();
+	std::string header = headerStream.ToString();
+	std::string content = mObjectStreamContent.ToString();
+	ObjectIDType objectStreamID = mObjectStreamID;
+	size_t objectsCount = mObjectStreamEntries.size();
+
+	mObjectStreamID = 0;
+	mObjectStreamEntries.clear();
+	mObjectStreamContent.Reset();
+
+	// the object stream itself, and its length, are regular objects
+	mObjectStreamsSuspended = true;
+
+	StartNewIndirectObject(objectStreamID);
+	DictionaryContext* objectStreamDictionary = StartDictionary();
+	objectStreamDictionary->WriteKey(scType);
+	objectStreamDictionary->WriteNameValue(scObjStm);
+	objectStreamDictionary->WriteKey(scN);
+	objectStreamDictionary->WriteIntegerValue(objectsCount);
+	objectStreamDictionary->WriteKey(scFirst);
+	objectStreamDictionary->WriteIntegerValue(header.size());
+
+	PDFStream* objectStream = StartPDFStream(objectStreamDictionary,true);
+	objectStream->GetWriteStream()->Write((const IOBasicTypes::Byte*)header.c_str(),header.size());
+	objectStream->GetWriteStream()->Write((const IOBasicTypes::Byte*)content.c_str(),content.size());
+	EndPDFStream(objectStream);
+	delete objectStream;
+
+	mObjectStreamsSuspended = false;
+}
+
+void ObjectsContext::SetDoublePrecision(int inDoublePrecision)
+{
+	mPrimitiveWriter.SetDoublePrecision(inDoublePrecision);
+}
+
+int ObjectsContext::GetDoublePrecision()
+{
+	return mPrimitiveWriter.GetDoublePrecision();
+}
+
 static const std::string scLength = "Length";
 static const std::string scStream = "stream";
 static const std::string scEndStream = "endstream";
@@ -389,6 +601,9 @@ PDFStream* ObjectsContext::StartPDFStream(DictionaryContext* inStreamDictionary,
 	// write stream header and allocate PDF stream.
 	// PDF stream will take care of maintaining state for the stream till writing is finished
 
+	// streams can't go into object streams
+	UnpackObject();
+
 	// Write the stream header
 	// Write Stream Dictionary (note that inStreamDictionary is optionally used)
 	DictionaryContext* streamDictionaryContext = (NULL == inStreamDictionary ? StartDictionary() : inStreamDictionary);
@@ -415,7 +630,12 @@ PDFStream* ObjectsContext::StartPDFStream(DictionaryContext* inStreamDictionary,
         // Write Stream Content
         WriteKeyword(scStream);
         
-		result = new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,lengthObjectID,mExtender);
+		// compression may be deferred to a worker thread, when writing in parallel. only for plain flate compression
+		bool deferCompression = mCompressStreams &&
+								mOutputStream == &mOrderedCompressionStream &&
+								!IsEncrypting() &&
+								!(mExtender && mExtender->OverridesStreamCompression());
+		result = new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,lengthObjectID,mExtender,deferCompression);
     }
     else
 		result = new PDFStream(mCompressStreams,mOutputStream, mEncryptionHelper,streamDictionaryContext,mExtender);
@@ -432,6 +652,9 @@ PDFStream* ObjectsContext::StartUnfilteredPDFStream(DictionaryContext* inStreamD
 	// write stream header and allocate PDF stream.
 	// PDF stream will take care of maintaining state for the stream till writing is finished
 
+	// streams can't go into object streams
+	UnpackObject();
+
 	// Write the stream header
 	// Write Stream Dictionary (note that inStreamDictionary is optionally used)
 	DictionaryContext* streamDictionaryContext = (NULL == inStreamDictionary ? StartDictionary() : inStreamDictionary);
@@ -486,6 +709,22 @@ void ObjectsContext::EndPDFStream(PDFStream* inStream)
         EndIndirectObject();
         
     }
+    else if(inStream->IsCompressionDeferred())
+    {
+        // compressed stream content and length are placed by the ordered compression stream, once compressed
+        mOrderedCompressionStream.WriteCompressed(inStream->GetDeferredCompressionContent());
+        WritePDFStreamEndWithoutExtent();
+        EndIndirectObject();
+
+        // the length is written to the output directly, so it's a regular object
+        bool objectStreamsSuspended = mObjectStreamsSuspended;
+        mObjectStreamsSuspended = true;
+        StartNewIndirectObject(inStream->GetExtentObjectID());
+        mOrderedCompressionStream.WriteLastCompressedLength();
+        EndLine();
+        EndIndirectObject();
+        mObjectStreamsSuspended = objectStreamsSuspended;
+    }
     else
     {
         WritePDFStreamEndWithoutExtent();
@@ -524,6 +763,10 @@ EStatusCode ObjectsContext::WriteState(ObjectsContext* inStateWriter,ObjectIDTyp
 		
 	do
 	{
+		// make sure all objects are in place, before saving the registry
+		FlushObjectStreams();
+		FlushParallelCompression();
+
 		inStateWriter->StartNewIndirectObject(inObjectID);
 
 		ObjectIDType referencesRegistryObjectID = inStateWriter->GetInDirectObjectsRegistry().AllocateNewObjectID();
@@ -540,6 +783,12 @@ EStatusCode ObjectsContext::WriteState(ObjectsContext* inStateWriter,ObjectIDTyp
 		objectsContextDict->WriteKey("mCompressStreams");
 		objectsContextDict->WriteBooleanValue(mCompressStreams);
 
+		objectsContextDict->WriteKey("mDoublePrecision");
+		objectsContextDict->WriteIntegerValue(mPrimitiveWriter.GetDoublePrecision());
+
+		objectsContextDict->WriteKey("mWriteObjectStreams");
+		objectsContextDict->WriteBooleanValue(mWriteObjectStreams);
+
 		objectsContextDict->WriteKey("mSubsetFontsNamesSequance");
 		objectsContextDict->WriteNewObjectReferenceValue(subsetFontsNameSequanceID);
 
@@ -578,6 +827,13 @@ EStatusCode ObjectsContext::ReadState(PDFParser* inStateReader,ObjectIDType inOb
 	PDFObjectCastPtr<PDFBoolean> compressStreams(objectsContext->QueryDirectObject("mCompressStreams"));
 	mCompressStreams = compressStreams->GetValue();
 
+	// state files from older versions don't have the precision
+	PDFObjectCastPtr<PDFInteger> doublePrecision(objectsContext->QueryDirectObject("mDoublePrecision"));
+	mPrimitiveWriter.SetDoublePrecision(!doublePrecision ? DEFAULT_DOUBLE_PRECISION : (int)doublePrecision->GetValue());
+
+	PDFObjectCastPtr<PDFBoolean> writeObjectStreams(objectsContext->QueryDirectObject("mWriteObjectStreams"));
+	mWriteObjectStreams = !writeObjectStreams ? false : writeObjectStreams->GetValue();
+
 	PDFObjectCastPtr<PDFDictionary> subsetFontsNamesSequance(inStateReader->QueryDictionaryObject(objectsContext.GetPtr(),"mSubsetFontsNamesSequance"));
 	PDFObjectCastPtr<PDFLiteralString> sequanceString(subsetFontsNamesSequance->QueryDirectObject("mSequanceString"));
 	mSubsetFontsNamesSequance.SetSequanceString(sequanceString->GetValue());
@@ -590,8 +846,21 @@ EStatusCode ObjectsContext::ReadState(PDFParser* inStateReader,ObjectIDType inOb
 
 void ObjectsContext::Cleanup()
 {
+	mOrderedCompressionStream.Reset();
+	mOrderedCompressionStream.Assign(NULL,NULL);
 	mOutputStream = NULL;
+	mTargetOutputStream = NULL;
 	mCompressStreams = true;
+	mCompressStreamsInParallel = false;
+	mPrimitiveWriter.SetDoublePrecision(DEFAULT_DOUBLE_PRECISION);
+	mWriteObjectStreams = false;
+	mObjectStreamsSuspended = false;
+	mPackedObjectID = 0;
+	mPackedObjectTargetStream = NULL;
+	mPackedObjectStream.Reset();
+	mObjectStreamID = 0;
+	mObjectStreamContent.Reset();
+	mObjectStreamEntries.clear();
 	mExtender = NULL;
 	mEncryptionHelper = NULL;
 
@@ -674,7 +943,14 @@ EStatusCode ObjectsContext::WriteXrefStream(DictionaryContext* inDictionaryConte
             {
                 // used object
                 
-                if(objectReference.mObjectWritten)
+                if(objectReference.mObjectWritten && objectReference.mObjectStreamID != 0)
+                {
+                    // compressed object, placed in an object stream
+                    WriteXrefNumber(aStream->GetWriteStream(),2,typeSize);
+                    WriteXrefNumber(aStream->GetWriteStream(),objectReference.mObjectStreamID,locationSize);
+                    WriteXrefNumber(aStream->GetWriteStream(),objectReference.mIndexInObjectStream,generationSize);
+                }
+                else if(objectReference.mObjectWritten)
                 {
                     WriteXrefNumber(aStream->GetWriteStream(),1,typeSize);
                     WriteXrefNumber(aStream->GetWriteStream(),objectReference.mWritePosition,locationSize);
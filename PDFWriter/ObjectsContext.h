@@ -25,8 +25,14 @@
 #include "ETokenSeparator.h"
 #include "PrimitiveObjectsWriter.h"
 #include "UppercaseSequance.h"
+#include "OutputOrderedCompressionStream.h"
+#include "OutputStringBufferStream.h"
 #include <string>
 #include <list>
+#include <utility>
+
+// maximum number of objects packed in a single object stream
+#define OBJECT_STREAM_MAX_OBJECTS 100
 
 
 
@@ -39,6 +45,8 @@ class PDFParser;
 class EncryptionHelper;
 
 typedef std::list<DictionaryContext*> DictionaryContextList;
+typedef std::pair<ObjectIDType,LongFilePositionType> ObjectIDTypeAndOffset;
+typedef std::list<ObjectIDTypeAndOffset> ObjectIDTypeAndOffsetList;
 
 class ObjectsContext
 {
@@ -55,7 +63,7 @@ public:
 
 	// pre 1.5 xref writing
 	PDFHummus::EStatusCode WriteXrefTable(LongFilePositionType& outWritePosition);
-    // post 1.5 xref writing (only used now for modified files)
+    // post 1.5 xref writing (used for modified files, and for new files written with object streams)
     PDFHummus::EStatusCode WriteXrefStream(DictionaryContext* inDictionaryContext);
     
 	// Free Context, for direct writing to output stream
@@ -114,6 +122,24 @@ public:
 
 	// Sets whether streams created by the objects context will be compressed (with flate) or not
 	void SetCompressStreams(bool inCompressStreams);
+	bool IsCompressingStreams();
+
+	// Sets whether compressed streams will be compressed in parallel, by worker threads, while writing continues.
+	// Output is the same. Applies to streams that are not encrypted, and when the compression is not overriden by an extender.
+	void SetCompressStreamsInParallel(bool inCompressStreamsInParallel);
+	// wait for streams being compressed in parallel, and write them
+	void FlushParallelCompression();
+
+	// Sets whether non stream objects will be packed into compressed object streams (PDF 1.5). requires writing
+	// the xref as a stream. Objects that turn out to be streams, and objects written while encrypting, are written as regular objects
+	void SetWriteObjectStreams(bool inWriteObjectStreams);
+	bool IsWritingObjectStreams();
+	// write the object stream of objects packed so far. call when no object is being written
+	void FlushObjectStreams();
+
+	// Sets the number of digits after the decimal point for doubles written by the objects context and content contexts
+	void SetDoublePrecision(int inDoublePrecision);
+	int GetDoublePrecision();
 
 	// Create PDF stream and write it's header. note that stream are written with indirect object for Length, to allow one pass writing.
 	// inStreamDictionary can be passed in order to include stream generic information in an already written stream dictionary
@@ -140,6 +166,9 @@ public:
 private:
 	IObjectsContextExtender* mExtender;
 	IByteWriterWithPosition* mOutputStream;
+	IByteWriterWithPosition* mTargetOutputStream;
+	bool mCompressStreamsInParallel;
+	OutputOrderedCompressionStream mOrderedCompressionStream;
 	IndirectObjectsReferenceRegistry mReferencesRegistry;
 	PrimitiveObjectsWriter mPrimitiveWriter;
 	bool mCompressStreams;
@@ -148,10 +177,27 @@ private:
 
 	DictionaryContextList mDictionaryStack;
 
+	// object streams writing. objects are collected to mPackedObjectStream till known to not be streams
+	bool mWriteObjectStreams;
+	bool mObjectStreamsSuspended;
+	ObjectIDType mPackedObjectID;
+	IByteWriterWithPosition* mPackedObjectTargetStream;
+	OutputStringBufferStream mPackedObjectStream;
+	ObjectIDType mObjectStreamID;
+	OutputStringBufferStream mObjectStreamContent;
+	ObjectIDTypeAndOffsetList mObjectStreamEntries;
+
 	void WritePDFStreamEndWithoutExtent();
 	void WritePDFStreamExtent(PDFStream* inStream);
     void WriteXrefNumber(IByteWriter* inStream,LongFilePositionType inElement, size_t inElementSize);
 	bool IsEncrypting();
+	void MarkObjectAsWritten(ObjectIDType inObjectID);
+	void WriteIndirectObjectHeader(ObjectIDType inObjectID);
+	bool ShouldPackObject();
+	void StartPackedObject(ObjectIDType inObjectID);
+	void UnpackObject();
+	void EndPackedObject();
+	void WriteObjectStream();
 	std::string MaybeEncryptString(const std::string& inString);
 	std::string DecodeHexString(const std::string& inString);
 
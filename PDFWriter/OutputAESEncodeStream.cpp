@@ -20,7 +20,9 @@ limitations under the License.
 #include "OutputAESEncodeStream.h"
 #include "MD5Generator.h"
 #include "PDFDate.h"
+#include "XCryptionCommon.h"
 
+#include <algorithm>
 #include <string.h>
 
 using namespace IOBasicTypes;
@@ -31,26 +33,35 @@ OutputAESEncodeStream::OutputAESEncodeStream(void)
 	mTargetStream = NULL;
 	mOwnsStream = false;
 	mWroteIV = false;
+	mEncryptionKey = NULL;
+	mChunkUsed = 0;
+	mCipher = NULL;
 }
 
 OutputAESEncodeStream::~OutputAESEncodeStream(void)
 {
-	Flush();
+	if(mTargetStream && mCipher)
+		Flush();
+	delete mCipher;
 	if(mEncryptionKey)
 		delete[] mEncryptionKey;
 	if (mOwnsStream)
 		delete mTargetStream;
 }
 
-OutputAESEncodeStream::OutputAESEncodeStream(IByteWriterWithPosition* inTargetStream, const ByteList& inEncryptionKey, bool inOwnsStream) 
+OutputAESEncodeStream::OutputAESEncodeStream(IByteWriterWithPosition* inTargetStream, const ByteList& inEncryptionKey, bool inOwnsStream, std::size_t inChunkSize, ICryptoBackend* inCryptoBackend) 
 {
 	mTargetStream = inTargetStream;
 	mOwnsStream = inOwnsStream;
+	mEncryptionKey = NULL;
+	mChunkUsed = 0;
+	mCipher = NULL;
 
 	if (!mTargetStream)
 		return;
 
 	mInIndex = mIn;
+	mChunk.resize(inChunkSize < AES_BLOCK_SIZE ? AES_BLOCK_SIZE : (inChunkSize - inChunkSize % AES_BLOCK_SIZE));
 
 	// convert inEncryptionKey to internal rep and init encrypt [let's hope its 16...]
 	mEncryptionKey = new unsigned char[inEncryptionKey.size()];
@@ -59,7 +70,7 @@ OutputAESEncodeStream::OutputAESEncodeStream(IByteWriterWithPosition* inTargetSt
 	size_t i = 0;
 	for (; it != inEncryptionKey.end(); ++i, ++it)
 		mEncryptionKey[i] = *it;
-	mEncrypt.key(mEncryptionKey, mEncryptionKeyLength);
+	mCipher = (inCryptoBackend ? inCryptoBackend : XCryptionCommon::GetDefaultCryptoBackend())->CreateAESCipher(mEncryptionKey, mEncryptionKeyLength);
 	
 	mWroteIV = false;
 
@@ -75,65 +86,85 @@ LongFilePositionType OutputAESEncodeStream::GetCurrentPosition()
 
 LongBufferSizeType OutputAESEncodeStream::Write(const IOBasicTypes::Byte* inBuffer, IOBasicTypes::LongBufferSizeType inSize) 
 {
-	if (!mTargetStream)
+	if (!mTargetStream || !mCipher)
 		return 0;
 
-	// write IV if didn't write yet
-	if (!mWroteIV) {
-		// create IV and write it to output file [use existing PDFDate]
-		MD5Generator md5;
-		// encode current time
-		PDFDate currentTime;
-		currentTime.SetToCurrentTime();
-		md5.Accumulate(currentTime.ToString());
-		memcpy(mIV, (const unsigned char*)md5.ToStringAsString().c_str(), AES_BLOCK_SIZE); // md5 should give us the desired 16 bytes
-
-																						   // now write mIV to the output stream
-		mTargetStream->Write(mIV, AES_BLOCK_SIZE);
-		mWroteIV = true;
+	if (!mWroteIV)
+		WriteIV();
+
+	IOBasicTypes::LongBufferSizeType left = inSize;
+	const unsigned char* inIndex = inBuffer;
+
+	// complete a block started by a previous write
+	if (mInIndex != mIn) {
+		IOBasicTypes::LongBufferSizeType remainder = std::min<IOBasicTypes::LongBufferSizeType>(left, AES_BLOCK_SIZE - (mInIndex - mIn));
+		memcpy(mInIndex, inIndex, remainder);
+		mInIndex += remainder;
+		inIndex += remainder;
+		left -= remainder;
+		if (mInIndex - mIn < AES_BLOCK_SIZE)
+			return inSize;
+		EncryptToChunk(mIn, AES_BLOCK_SIZE);
+		mInIndex = mIn;
 	}
 
+	// encrypt all complete blocks directly from the input, and keep what's left of the last block for later
+	IOBasicTypes::LongBufferSizeType blocksLength = left - left % AES_BLOCK_SIZE;
+	if (blocksLength > 0) {
+		EncryptToChunk(inIndex, (std::size_t)blocksLength);
+		inIndex += blocksLength;
+		left -= blocksLength;
+	}
 
-	// input and existing buffer sizes smaller than block size, so just copy and return
+	memcpy(mIn, inIndex, left);
+	mInIndex = mIn + left;
 
+	return inSize;
+}
 
-	IOBasicTypes::LongBufferSizeType left = inSize;
+void OutputAESEncodeStream::WriteIV() {
+	// create IV and write it to output file [use existing PDFDate]
+	MD5Generator md5;
+	// encode current time
+	PDFDate currentTime;
+	currentTime.SetToCurrentTime();
+	md5.Accumulate(currentTime.ToString());
+	memcpy(mIV, (const unsigned char*)md5.ToStringAsString().c_str(), AES_BLOCK_SIZE); // md5 should give us the desired 16 bytes
+
+	// now write mIV to the output stream
+	mTargetStream->Write(mIV, AES_BLOCK_SIZE);
+	mWroteIV = true;
+}
 
-	while (left > 0) {
-		// if what's left is not enough to finish block, just copy and stop
-		if (left + (mInIndex - mIn) < AES_BLOCK_SIZE) {
-			memcpy(mInIndex, inBuffer + inSize - left, left);
-			mInIndex += left;
-			left = 0;
-		}
-		else {
-			// otherwise, enough to fill block. fill, encode and continue
-			IOBasicTypes::LongBufferSizeType remainder = AES_BLOCK_SIZE - (mInIndex - mIn);
-			memcpy(mInIndex, inBuffer + inSize - left, remainder);
-
-			// encrypt
-			mEncrypt.cbc_encrypt(mIn, mOut, AES_BLOCK_SIZE, mIV);
-			mTargetStream->Write(mOut, AES_BLOCK_SIZE);
-			mInIndex = mIn;
-			left -= remainder;
-		}
+void OutputAESEncodeStream::EncryptToChunk(const unsigned char* inBlocks, std::size_t inLength) {
+	// encrypt as many blocks as fit in the chunk in a single call, writing the chunk when full
+	while (inLength > 0) {
+		std::size_t length = std::min<std::size_t>(inLength, mChunk.size() - mChunkUsed);
+		mCipher->EncryptCBC(inBlocks, &(mChunk[mChunkUsed]), length, mIV);
+		mChunkUsed += length;
+		inBlocks += length;
+		inLength -= length;
+		if (mChunkUsed == mChunk.size())
+			WriteChunk();
 	}
+}
 
-	return inSize;
+void OutputAESEncodeStream::WriteChunk() {
+	if (mChunkUsed > 0) {
+		mTargetStream->Write(&(mChunk[0]), mChunkUsed);
+		mChunkUsed = 0;
+	}
 }
 
 void OutputAESEncodeStream::Flush() {
-	// if there's a full buffer waiting, write it now.
-	if (mInIndex - mIn == AES_BLOCK_SIZE) {
-		mEncrypt.cbc_encrypt(mIn, mOut, AES_BLOCK_SIZE, mIV);
-		mTargetStream->Write(mOut, AES_BLOCK_SIZE);
-		mInIndex = mIn;
-	}
+	// an empty stream still gets an IV, and a padding block
+	if (!mWroteIV)
+		WriteIV();
 
-	// (otherwise or in addition) finish encoding by completing a full block with the block remainder size. if the remainder is AES_BLOCK_SIZE cause block is empty, fill with AES_BLOCK_SIZE
+	// finish encoding by completing a full block with the block remainder size. if the remainder is AES_BLOCK_SIZE cause block is empty, fill with AES_BLOCK_SIZE
 	unsigned char remainder = (unsigned char)(AES_BLOCK_SIZE - (mInIndex - mIn));
 	for (size_t i = 0; i < remainder; ++i)
 		mInIndex[i] = remainder;
-	mEncrypt.cbc_encrypt(mIn, mOut, AES_BLOCK_SIZE, mIV);
-	mTargetStream->Write(mOut, AES_BLOCK_SIZE);
-}
\ No newline at end of file
+	EncryptToChunk(mIn, AES_BLOCK_SIZE);
+	WriteChunk();
+}
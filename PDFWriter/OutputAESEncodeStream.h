@@ -20,12 +20,17 @@ limitations under the License.
 */
 #pragma once
 #include "IByteWriterWithPosition.h"
+#include "ICryptoBackend.h"
 #include "aescpp.h"
 
 #include <list>
+#include <vector>
 
 typedef std::list<IOBasicTypes::Byte> ByteList;
 
+// encrypted data is collected and written to the target stream in chunks of this size (rounded down to whole AES blocks)
+#define DEFAULT_AES_ENCODE_CHUNK_SIZE 16384
+
 
 class OutputAESEncodeStream : public IByteWriterWithPosition
 {
@@ -33,7 +38,8 @@ public:
 	OutputAESEncodeStream(void);
 	virtual ~OutputAESEncodeStream(void);
 
-	OutputAESEncodeStream(IByteWriterWithPosition* inTargetStream, const ByteList& inEncryptionKey, bool inOwnsStream);
+	OutputAESEncodeStream(IByteWriterWithPosition* inTargetStream, const ByteList& inEncryptionKey, bool inOwnsStream, std::size_t inChunkSize = DEFAULT_AES_ENCODE_CHUNK_SIZE,
+							ICryptoBackend* inCryptoBackend = NULL); // NULL for the default crypto backend
 
 	virtual IOBasicTypes::LongBufferSizeType Write(const IOBasicTypes::Byte* inBuffer, IOBasicTypes::LongBufferSizeType inSize);
 	virtual IOBasicTypes::LongFilePositionType GetCurrentPosition();
@@ -50,10 +56,15 @@ private:
 	std::size_t  mEncryptionKeyLength;
 	unsigned char mIV[AES_BLOCK_SIZE];
 	unsigned char mIn[AES_BLOCK_SIZE];
-	unsigned char mOut[AES_BLOCK_SIZE];
 	unsigned char *mInIndex;
+	// encrypted blocks waiting to be written to the target stream
+	std::vector<unsigned char> mChunk;
+	std::size_t mChunkUsed;
 
-	AESencrypt mEncrypt;
+	IAESCipher* mCipher;
 
 	void Flush();
+	void WriteIV();
+	void EncryptToChunk(const unsigned char* inBlocks, std::size_t inLength);
+	void WriteChunk();
 };
\ No newline at end of file
@@ -0,0 +1,343 @@
+/*
+   Source File : OutputOrderedCompressionStream.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "OutputOrderedCompressionStream.h"
+#include "OutputFlateEncodeStream.h"
+#include "OutputStringBufferStream.h"
+#include "IndirectObjectsReferenceRegistry.h"
+#include "PrimitiveObjectsWriter.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+using namespace IOBasicTypes;
+
+struct OrderedCompressionJob
+{
+	std::string mContent;
+	std::string mCompressedBytes;
+	// guarded by the workers mutex. once set, the job is no longer accessed by the workers
+	bool mDone;
+};
+
+typedef std::shared_ptr<OrderedCompressionJob> OrderedCompressionJobPtr;
+
+static std::string CompressContent(const std::string& inContent)
+{
+	OutputStringBufferStream compressedStream;
+	OutputFlateEncodeStream flateEncodeStream;
+
+	flateEncodeStream.Assign(&compressedStream);
+	flateEncodeStream.Write((const Byte*)inContent.c_str(),inContent.size());
+	flateEncodeStream.Assign(NULL); // finishes the encoding, and releases the string stream
+
+	return compressedStream.ToString();
+}
+
+/*
+	Fixed pool of threads compressing the queued jobs, in the order they were queued.
+	Destroying the pool completes the queued jobs before the threads exit.
+*/
+class OrderedCompressionWorkers
+{
+public:
+	OrderedCompressionWorkers(unsigned int inWorkersCount)
+	{
+		mStopping = false;
+		for(unsigned int i=0; i < inWorkersCount; ++i)
+			mThreads.push_back(std::thread(&OrderedCompressionWorkers::WorkerLoop,this));
+	}
+
+	~OrderedCompressionWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+		mJobsAvailable.notify_all();
+
+		std::vector<std::thread>::iterator it = mThreads.begin();
+		for(; it != mThreads.end(); ++it)
+			it->join();
+	}
+
+	unsigned int GetWorkersCount()
+	{
+		return (unsigned int)mThreads.size();
+	}
+
+	void Compress(const OrderedCompressionJobPtr& inJob)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			inJob->mDone = false;
+			mQueue.push_back(inJob);
+		}
+		mJobsAvailable.notify_one();
+	}
+
+	bool IsDone(const OrderedCompressionJobPtr& inJob)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return inJob->mDone;
+	}
+
+	void WaitFor(const OrderedCompressionJobPtr& inJob)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while(!inJob->mDone)
+			mJobDone.wait(lock);
+	}
+
+private:
+	std::mutex mMutex;
+	std::condition_variable mJobsAvailable;
+	std::condition_variable mJobDone;
+	std::deque<OrderedCompressionJobPtr> mQueue;
+	bool mStopping;
+	std::vector<std::thread> mThreads;
+
+	void WorkerLoop()
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		while(true)
+		{
+			while(mQueue.empty() && !mStopping)
+				mJobsAvailable.wait(lock);
+			if(mQueue.empty())
+				break;
+
+			OrderedCompressionJobPtr job = mQueue.front();
+			mQueue.pop_front();
+
+			lock.unlock();
+			job->mCompressedBytes = CompressContent(job->mContent);
+			job->mContent.clear();
+			lock.lock();
+
+			job->mDone = true;
+			mJobDone.notify_all();
+		}
+	}
+};
+
+OutputOrderedCompressionStream::OutputOrderedCompressionStream(void)
+{
+	mTargetStream = NULL;
+	mReferencesRegistry = NULL;
+	mMaxParallelCompressions = 0;
+	mWorkers = NULL;
+	mPendingCompressionsCount = 0;
+	mPendingBytesSize = 0;
+}
+
+OutputOrderedCompressionStream::~OutputOrderedCompressionStream(void)
+{
+	Reset();
+	delete mWorkers;
+}
+
+void OutputOrderedCompressionStream::Assign(IByteWriterWithPosition* inTargetStream,IndirectObjectsReferenceRegistry* inReferencesRegistry)
+{
+	if(mTargetStream)
+		Flush();
+	else
+		Reset();
+	mTargetStream = inTargetStream;
+	mReferencesRegistry = inReferencesRegistry;
+}
+
+void OutputOrderedCompressionStream::SetMaxParallelCompressions(unsigned int inMaxParallelCompressions)
+{
+	mMaxParallelCompressions = inMaxParallelCompressions;
+
+	// restart the pool with the new size. deleting it completes the jobs already queued
+	if(mWorkers && mWorkers->GetWorkersCount() != GetMaxParallelCompressions())
+	{
+		delete mWorkers;
+		mWorkers = new OrderedCompressionWorkers(GetMaxParallelCompressions());
+	}
+}
+
+unsigned int OutputOrderedCompressionStream::GetMaxParallelCompressions()
+{
+	if(0 == mMaxParallelCompressions)
+		return std::max<unsigned int>(std::thread::hardware_concurrency(),1);
+	else
+		return mMaxParallelCompressions;
+}
+
+LongBufferSizeType OutputOrderedCompressionStream::Write(const Byte* inBuffer,LongBufferSizeType inSize)
+{
+	if(mPendingParts.empty())
+		return mTargetStream->Write(inBuffer,inSize);
+
+	if(mPendingParts.back().mType != eOrderedPartBytes)
+	{
+		mPendingParts.push_back(OrderedPart());
+		mPendingParts.back().mType = eOrderedPartBytes;
+		mPendingParts.back().mObjectID = 0;
+	}
+	mPendingParts.back().mBytes.append((const char*)inBuffer,inSize);
+	mPendingBytesSize+= inSize;
+	return inSize;
+}
+
+LongFilePositionType OutputOrderedCompressionStream::GetCurrentPosition()
+{
+	return mTargetStream->GetCurrentPosition() + mPendingBytesSize;
+}
+
+void OutputOrderedCompressionStream::WriteCompressed(const std::string& inContent)
+{
+	OrderedPart part;
+	part.mType = eOrderedPartCompressed;
+	part.mObjectID = 0;
+	part.mCompression = std::make_shared<OrderedCompressionJob>();
+	part.mCompression->mContent = inContent;
+
+	unsigned int maxParallelCompressions = GetMaxParallelCompressions();
+	if(!mWorkers)
+		mWorkers = new OrderedCompressionWorkers(maxParallelCompressions);
+	mWorkers->Compress(part.mCompression);
+	mLastCompression = part.mCompression;
+
+	mPendingParts.push_back(part);
+	++mPendingCompressionsCount;
+
+	// write what's already done, and wait for earlier parts if too many are being compressed
+	WritePendingParts(false);
+
+	while(mPendingCompressionsCount > maxParallelCompressions)
+	{
+		WritePart(mPendingParts.front());
+		mPendingParts.pop_front();
+	}
+}
+
+void OutputOrderedCompressionStream::WriteLastCompressedLength()
+{
+	if(!mLastCompression)
+		return;
+
+	OrderedPart part;
+	part.mType = eOrderedPartCompressedLength;
+	part.mObjectID = 0;
+	part.mCompression = mLastCompression;
+
+	if(mPendingParts.empty()) // already written
+		WritePart(part);
+	else
+		mPendingParts.push_back(part);
+}
+
+void OutputOrderedCompressionStream::MarkObjectAsWritten(ObjectIDType inObjectID)
+{
+	PushObjectPart(eOrderedPartObjectWritten,inObjectID);
+}
+
+void OutputOrderedCompressionStream::MarkObjectAsUpdated(ObjectIDType inObjectID)
+{
+	PushObjectPart(eOrderedPartObjectUpdated,inObjectID);
+}
+
+void OutputOrderedCompressionStream::PushObjectPart(EOrderedPartType inType,ObjectIDType inObjectID)
+{
+	OrderedPart part;
+	part.mType = inType;
+	part.mObjectID = inObjectID;
+
+	if(mPendingParts.empty())
+		WritePart(part);
+	else
+		mPendingParts.push_back(part);
+}
+
+bool OutputOrderedCompressionStream::HasPendingParts()
+{
+	return !mPendingParts.empty();
+}
+
+void OutputOrderedCompressionStream::Flush()
+{
+	WritePendingParts(true);
+}
+
+void OutputOrderedCompressionStream::Reset()
+{
+	OrderedPartList::iterator it = mPendingParts.begin();
+	for(; it != mPendingParts.end(); ++it)
+		if(it->mType == eOrderedPartCompressed)
+			mWorkers->WaitFor(it->mCompression);
+	mPendingParts.clear();
+	mPendingCompressionsCount = 0;
+	mPendingBytesSize = 0;
+	mLastCompression.reset();
+}
+
+void OutputOrderedCompressionStream::WritePendingParts(bool inWait)
+{
+	while(!mPendingParts.empty())
+	{
+		OrderedPart& part = mPendingParts.front();
+		if(!inWait &&
+			(eOrderedPartCompressed == part.mType || eOrderedPartCompressedLength == part.mType) &&
+			!mWorkers->IsDone(part.mCompression))
+			break;
+		WritePart(part);
+		mPendingParts.pop_front();
+	}
+}
+
+void OutputOrderedCompressionStream::WritePart(OrderedPart& inPart)
+{
+	switch(inPart.mType)
+	{
+		case eOrderedPartBytes:
+			mTargetStream->Write((const Byte*)inPart.mBytes.c_str(),inPart.mBytes.size());
+			mPendingBytesSize-= inPart.mBytes.size();
+			break;
+		case eOrderedPartCompressed:
+		{
+			mWorkers->WaitFor(inPart.mCompression);
+			const std::string& compressedBytes = inPart.mCompression->mCompressedBytes;
+			mTargetStream->Write((const Byte*)compressedBytes.c_str(),compressedBytes.size());
+			--mPendingCompressionsCount;
+			break;
+		}
+		case eOrderedPartCompressedLength:
+		{
+			mWorkers->WaitFor(inPart.mCompression);
+			PrimitiveObjectsWriter primitiveWriter(mTargetStream);
+			primitiveWriter.WriteInteger(inPart.mCompression->mCompressedBytes.size(),eTokenSepratorNone);
+			break;
+		}
+		case eOrderedPartObjectWritten:
+			mReferencesRegistry->MarkObjectAsWritten(inPart.mObjectID,mTargetStream->GetCurrentPosition());
+			break;
+		case eOrderedPartObjectUpdated:
+			mReferencesRegistry->MarkObjectAsUpdated(inPart.mObjectID,mTargetStream->GetCurrentPosition());
+			break;
+	}
+}
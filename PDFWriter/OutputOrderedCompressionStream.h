@@ -0,0 +1,120 @@
+/*
+   Source File : OutputOrderedCompressionStream.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+/*
+	Output stream that allows compressing parts of the output in parallel.
+	Stream contents are passed with WriteCompressed, and are flate encoded by a fixed pool of worker threads, started with the first
+	compressed part. Meanwhile, writing continues
+	normally. Bytes that should come after a part that is still being compressed are kept in memory, and the stream
+	writes everything to the target stream in the original order, as parts get done.
+
+	Since the final position of anything written after a pending part is not known till that part is done, object positions
+	should be registered with MarkObjectAsWritten/MarkObjectAsUpdated, which register them in the references registry once they are placed.
+	GetCurrentPosition is good for measuring lengths of what's written with Write. use Flush to wait for all pending parts when
+	an exact position is required.
+*/
+
+#include "IByteWriterWithPosition.h"
+#include "ObjectsBasicTypes.h"
+
+#include <string>
+#include <list>
+#include <memory>
+
+class IndirectObjectsReferenceRegistry;
+class OrderedCompressionWorkers;
+struct OrderedCompressionJob;
+
+class OutputOrderedCompressionStream : public IByteWriterWithPosition
+{
+public:
+	OutputOrderedCompressionStream(void);
+	// waits for any pending compression, but does not write it. make sure to Flush before
+	virtual ~OutputOrderedCompressionStream(void);
+
+	// Assign flushes anything pending to the current target stream before moving to the new one. not taking ownership
+	void Assign(IByteWriterWithPosition* inTargetStream,IndirectObjectsReferenceRegistry* inReferencesRegistry);
+
+	// set the maximum number of parts that may be compressed at the same time, which is also the number of worker threads.
+	// writing waits for earlier parts when reached. 0 (the default) uses the number of hardware threads
+	void SetMaxParallelCompressions(unsigned int inMaxParallelCompressions);
+
+	// IByteWriter implementation
+	virtual IOBasicTypes::LongBufferSizeType Write(const IOBasicTypes::Byte* inBuffer,IOBasicTypes::LongBufferSizeType inSize);
+
+	// IByteWriterWithPosition implementation. 
+	// the position does not include parts still being compressed
+	virtual IOBasicTypes::LongFilePositionType GetCurrentPosition();
+
+	// start compressing inContent in parallel. its flate encoded bytes will be written at the current point in the output
+	void WriteCompressed(const std::string& inContent);
+	// write, as a decimal integer, the length of the compressed bytes of the last part passed to WriteCompressed
+	void WriteLastCompressedLength();
+
+	// register the current position as the write position of the object, once everything before it is placed
+	void MarkObjectAsWritten(ObjectIDType inObjectID);
+	void MarkObjectAsUpdated(ObjectIDType inObjectID);
+
+	bool HasPendingParts();
+
+	// wait for all pending compression, and write everything to the target stream
+	void Flush();
+
+	// wait for pending compression (worker threads use data owned by this object), and drop any pending parts without writing them
+	void Reset();
+
+private:
+
+	enum EOrderedPartType
+	{
+		eOrderedPartBytes,
+		eOrderedPartCompressed,
+		eOrderedPartCompressedLength,
+		eOrderedPartObjectWritten,
+		eOrderedPartObjectUpdated
+	};
+
+	struct OrderedPart
+	{
+		EOrderedPartType mType;
+		std::string mBytes; // for eOrderedPartBytes
+		std::shared_ptr<OrderedCompressionJob> mCompression; // for eOrderedPartCompressed and eOrderedPartCompressedLength
+		ObjectIDType mObjectID; // for object positions parts
+	};
+
+	typedef std::list<OrderedPart> OrderedPartList;
+
+	IByteWriterWithPosition* mTargetStream;
+	IndirectObjectsReferenceRegistry* mReferencesRegistry;
+	unsigned int mMaxParallelCompressions;
+	OrderedCompressionWorkers* mWorkers;
+	OrderedPartList mPendingParts;
+	unsigned int mPendingCompressionsCount;
+	IOBasicTypes::LongFilePositionType mPendingBytesSize;
+	std::shared_ptr<OrderedCompressionJob> mLastCompression;
+
+	void PushObjectPart(EOrderedPartType inType,ObjectIDType inObjectID);
+	// write parts from the start of the pending list. when inWait is false, stops at the first part that's not done compressing yet
+	void WritePendingParts(bool inWait);
+	void WritePart(OrderedPart& inPart);
+	unsigned int GetMaxParallelCompressions();
+};
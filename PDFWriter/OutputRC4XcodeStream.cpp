@@ -19,6 +19,8 @@ limitations under the License.
 
 #include "OutputRC4XcodeStream.h"
 
+#include <algorithm>
+
 using namespace IOBasicTypes;
 
 
@@ -45,14 +47,16 @@ LongBufferSizeType OutputRC4XcodeStream::Write(const Byte* inBuffer, LongBufferS
 	if (!mTargetStream)
 		return 0;
 
+	// encode in chunks, writing each chunk at once
+	Byte buffer[4096];
 	LongBufferSizeType mCurrentIndex = 0;
-	Byte buffer;
 
 	while (mCurrentIndex < inSize)
 	{
-		buffer = mRC4.DecodeNextByte(inBuffer[mCurrentIndex]);
-		mTargetStream->Write(&buffer, 1);
-		++mCurrentIndex;
+		LongBufferSizeType length = std::min<LongBufferSizeType>(inSize - mCurrentIndex, sizeof(buffer));
+		mRC4.Xcode(inBuffer + mCurrentIndex, buffer, length);
+		mTargetStream->Write(buffer, length);
+		mCurrentIndex += length;
 	}
 
 	return mCurrentIndex;
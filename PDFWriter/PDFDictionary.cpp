@@ -35,10 +35,9 @@ PDFDictionary::~PDFDictionary(void)
 	}
 }
 
-PDFObject* PDFDictionary::QueryDirectObject(std::string inName)
+PDFObject* PDFDictionary::QueryDirectObject(const std::string& inName)
 {
-	PDFName key(inName);
-	PDFNameToPDFObjectMap::iterator it = mValues.find(&key);
+	PDFNameToPDFObjectMap::iterator it = mValues.find(inName);
 
 	if(it == mValues.end())
 	{
@@ -53,17 +52,17 @@ PDFObject* PDFDictionary::QueryDirectObject(std::string inName)
 
 void PDFDictionary::Insert(PDFName* inKeyObject, PDFObject* inValueObject)
 {
-	inKeyObject->AddRef();
-	inValueObject->AddRef();
-
-	mValues.insert(PDFNameToPDFObjectMap::value_type(inKeyObject,inValueObject));
+	if(mValues.insert(PDFNameToPDFObjectMap::value_type(inKeyObject,inValueObject)).second)
+	{
+		inKeyObject->AddRef();
+		inValueObject->AddRef();
+	}
 }
 
 
-bool PDFDictionary::Exists(std::string inName)
+bool PDFDictionary::Exists(const std::string& inName)
 {
-	PDFName key(inName);
-	return mValues.find(&key) != mValues.end();
+	return mValues.find(inName) != mValues.end();
 }
 
 MapIterator<PDFNameToPDFObjectMap> PDFDictionary::GetIterator()
@@ -22,6 +22,7 @@
 #include "PDFObject.h"
 #include "PDFName.h"
 #include "MapIterator.h"
+#include "PDFNameToPDFObjectMap.h"
 
 #include <map>
 
@@ -36,8 +37,6 @@ struct PDFNameLess
 	}
 };
 
-typedef std::map<PDFName*,PDFObject*,PDFNameLess> PDFNameToPDFObjectMap;
-
 class PDFDictionary : public PDFObject
 {
 public:
@@ -50,12 +49,13 @@ public:
 	PDFDictionary(void);
 	virtual ~PDFDictionary(void);
 
-	// AddRefs on both
+	// AddRefs on both. if the key already exists, the existing value is kept
 	void Insert(PDFName* inKeyObject, PDFObject* inValueObject);
 
-    bool Exists(std::string inName);
-	PDFObject* QueryDirectObject(std::string inName);
+    bool Exists(const std::string& inName);
+	PDFObject* QueryDirectObject(const std::string& inName);
 
+	// iterates entries in insertion order
 	MapIterator<PDFNameToPDFObjectMap> GetIterator();
 
 private:
@@ -95,6 +95,11 @@ EStatusCodeAndObjectIDType PDFDocumentCopyingContext::AppendPDFPageFromPDF(unsig
 	return mDocumentHandler.AppendPDFPageFromPDF(inPageIndex);
 }
 
+EStatusCodeAndObjectIDTypeList PDFDocumentCopyingContext::AppendPDFPagesFromPDF(const PDFPageRange& inPageRange)
+{
+	return mDocumentHandler.AppendPDFPagesFromPDF(inPageRange);
+}
+
 EStatusCodeAndObjectIDType PDFDocumentCopyingContext::CopyObject(ObjectIDType inSourceObjectID)
 {
 	return mDocumentHandler.CopyObject(inSourceObjectID);
@@ -112,7 +117,13 @@ PDFParser* PDFDocumentCopyingContext::GetSourceDocumentParser()
 
 MapIterator<ObjectIDTypeToObjectIDTypeMap> PDFDocumentCopyingContext::GetCopiedObjectsMappingIterator()
 {
-	return mDocumentHandler.GetCopiedObjectsMappingIterator();
+	// the handler keeps the mapping in a dense map, so copy it to a map. iteration is ordered in both, so the hint makes each insert constant
+	MapIterator<ObjectIDTypeDenseMap> it = mDocumentHandler.GetCopiedObjectsMappingIterator();
+
+	mCopiedObjectsMapping.clear();
+	while(it.MoveNext())
+		mCopiedObjectsMapping.insert(mCopiedObjectsMapping.end(),ObjectIDTypeToObjectIDTypeMap::value_type(it.GetKey(),it.GetValue()));
+	return MapIterator<ObjectIDTypeToObjectIDTypeMap>(mCopiedObjectsMapping);
 }
 
 EStatusCode PDFDocumentCopyingContext::MergePDFPageToPage(PDFPage* inTargetPage,unsigned long inSourcePageIndex)
@@ -176,3 +187,8 @@ IByteReaderWithPosition* PDFDocumentCopyingContext::GetSourceDocumentStream()
 {
 	return mDocumentHandler.GetSourceDocumentStream();
 }
+
+unsigned long PDFDocumentCopyingContext::GetPrefetchedObjectsUsedCount()
+{
+	return mDocumentHandler.GetPrefetchedObjectsUsedCount();
+}
@@ -74,6 +74,9 @@ public:
 																const double* inTransformationMatrix = NULL,
 																ObjectIDType inPredefinedFormId = 0);
 	EStatusCodeAndObjectIDType AppendPDFPageFromPDF(unsigned long inPageIndex);
+	// appends a range of pages. same as appending them one by one, but lets a parallel import [see PDFParsingOptions::ImportPagesInParallel]
+	// read the objects of several pages at a time
+	EStatusCodeAndObjectIDTypeList AppendPDFPagesFromPDF(const PDFPageRange& inPageRange);
 	PDFHummus::EStatusCode MergePDFPageToPage(PDFPage* inTargetPage,unsigned long inSourcePageIndex);
     
     // MergePDFPageToFormXObject merges a page content into a form xobject.
@@ -102,7 +105,11 @@ public:
 
 	PDFParser* GetSourceDocumentParser();
 	IByteReaderWithPosition* GetSourceDocumentStream();
+	// count of copied objects that were read ahead by parallel import workers. 0 when importing serially
+	unsigned long GetPrefetchedObjectsUsedCount();
 	EStatusCodeAndObjectIDType GetCopiedObjectID(ObjectIDType inSourceObjectID);
+	// iterates a snapshot of the copied objects mapping, in ascending source object ID order. the snapshot is taken on each call,
+	// so an iterator is valid till the next call
 	MapIterator<ObjectIDTypeToObjectIDTypeMap> GetCopiedObjectsMappingIterator();
 
 	void End();
@@ -138,6 +145,7 @@ private:
 
 	PDFHummus::DocumentContext* mDocumentContext;
 	PDFDocumentHandler mDocumentHandler;
+	ObjectIDTypeToObjectIDTypeMap mCopiedObjectsMapping;
 
 
 };
@@ -43,12 +43,18 @@
 #include "PageContentContext.h"
 #include "PDFPage.h"
 #include "PDFParserTokenizer.h"
-#include "InputStreamSkipperStream.h"
 #include "IResourceWritingTask.h"
 #include "IFormEndWritingTask.h"
 #include "PDFPageInput.h"
 #include "IndirectObjectsReferenceRegistry.h"
 #include "SimpleStringTokenizer.h"
+#include "InputByteArrayStream.h"
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <system_error>
+#include <string.h>
 
 using namespace PDFHummus;
 
@@ -59,11 +65,13 @@ PDFDocumentHandler::PDFDocumentHandler(void)
 	mWrittenPage = NULL;
     mParser = NULL;
     mParserOwned = false;
-
+	mParserExtender = NULL;
+	mPrefetchedObjectsUsedCount = 0;
 }
 
 PDFDocumentHandler::~PDFDocumentHandler(void)
 {
+	StopParallelImportParsers();
     if(mParserOwned)
         delete mParser;
 }
@@ -496,13 +504,14 @@ EStatusCode PDFDocumentHandler::CopyResourcesIndirectObjects(PDFDictionary* inPa
 
 EStatusCode PDFDocumentHandler::WriteNewObjects(const ObjectIDTypeList& inSourceObjectIDs)
 {
-	ObjectIDTypeSet writtenObjects;
 	// note that any objects in inSourceObjectIDs are trusted for not having been copied yet!
-	return WriteNewObjects(inSourceObjectIDs,writtenObjects);
+	// copies don't start while another is in progress, so the copied objects set can be shared by all
+	mCopiedObjects.Clear();
+	return WriteNewObjects(inSourceObjectIDs,mCopiedObjects);
 }
 
 
-EStatusCode PDFDocumentHandler::WriteNewObjects(const ObjectIDTypeList& inSourceObjectIDs,ObjectIDTypeSet& ioCopiedObjects)
+EStatusCode PDFDocumentHandler::WriteNewObjects(const ObjectIDTypeList& inSourceObjectIDs,ObjectIDTypeDenseSet& ioCopiedObjects)
 {
 
 	ObjectIDTypeList::const_iterator itNewObjects = inSourceObjectIDs.begin();
@@ -512,15 +521,15 @@ EStatusCode PDFDocumentHandler::WriteNewObjects(const ObjectIDTypeList& inSource
 	{
 		// theoretically speaking, it could be that while one object was copied, another one in this array is already
 		// copied, so make sure to check that these objects are still required for copying
-		if(ioCopiedObjects.find(*itNewObjects) == ioCopiedObjects.end())
+		if(!ioCopiedObjects.Contains(*itNewObjects))
 		{
-			ObjectIDTypeToObjectIDTypeMap::iterator it = mSourceToTarget.find(*itNewObjects);
+			ObjectIDTypeDenseMap::iterator it = mSourceToTarget.find(*itNewObjects);
 			if(it == mSourceToTarget.end())
 			{
 				ObjectIDType newObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-				it = mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(*itNewObjects,newObjectID)).first;
+				it = mSourceToTarget.insert(ObjectIDTypeDenseMap::value_type(*itNewObjects,newObjectID)).first;
 			}
-			ioCopiedObjects.insert(*itNewObjects);
+			ioCopiedObjects.Insert(*itNewObjects);
 			status = CopyInDirectObject(*itNewObjects,it->second,ioCopiedObjects);
 		}
 	}
@@ -536,7 +545,7 @@ void PDFDocumentHandler::RegisterInDirectObjects(PDFDictionary* inDictionary,Obj
 	{
 		if(it.GetValue()->GetType() == PDFObject::ePDFObjectIndirectObjectReference)
 		{
-			ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)it.GetValue())->mObjectID);
+			ObjectIDTypeDenseMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)it.GetValue())->mObjectID);
 			if(itObjects == mSourceToTarget.end())
 				outNewObjects.push_back(((PDFIndirectObjectReference*)it.GetValue())->mObjectID);
 		} 
@@ -559,7 +568,7 @@ void PDFDocumentHandler::RegisterInDirectObjects(PDFArray* inArray,ObjectIDTypeL
 	{
 		if(it.GetItem()->GetType() == PDFObject::ePDFObjectIndirectObjectReference)
 		{
-			ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)it.GetItem())->mObjectID);
+			ObjectIDTypeDenseMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)it.GetItem())->mObjectID);
 			if(itObjects == mSourceToTarget.end())
 				outNewObjects.push_back(((PDFIndirectObjectReference*)it.GetItem())->mObjectID);
 		} 
@@ -576,12 +585,12 @@ void PDFDocumentHandler::RegisterInDirectObjects(PDFArray* inArray,ObjectIDTypeL
 
 EStatusCode PDFDocumentHandler::CopyInDirectObject(ObjectIDType inSourceObjectID,ObjectIDType inTargetObjectID)
 {
-	ObjectIDTypeSet ioCopiedObjects;
-	return CopyInDirectObject(inSourceObjectID,inTargetObjectID,ioCopiedObjects);
+	mCopiedObjects.Clear();
+	return CopyInDirectObject(inSourceObjectID,inTargetObjectID,mCopiedObjects);
 }
 
 
-EStatusCode PDFDocumentHandler::CopyInDirectObject(ObjectIDType inSourceObjectID,ObjectIDType inTargetObjectID,ObjectIDTypeSet& ioCopiedObjects)
+EStatusCode PDFDocumentHandler::CopyInDirectObject(ObjectIDType inSourceObjectID,ObjectIDType inTargetObjectID,ObjectIDTypeDenseSet& ioCopiedObjects)
 {
 	// CopyInDirectObject will do this (lissen up)
 	// Start a new object with the input ID
@@ -591,8 +600,23 @@ EStatusCode PDFDocumentHandler::CopyInDirectObject(ObjectIDType inSourceObjectID
 	EStatusCode status;
 	ObjectIDTypeList newObjectsToWrite;
 	OutWritingPolicy writingPolicy(this, newObjectsToWrite);
+	RefCountPtr<PDFObject> sourceObject;
+	std::vector<IOBasicTypes::Byte> prefetchedStreamData;
+	bool isPrefetched = false;
+
+	// use the object if already read by a parallel import worker, otherwise parse it now
+	ObjectIDTypeToPrefetchedObjectMap::iterator itPrefetched = mPrefetchedObjects.find(inSourceObjectID);
+	if(itPrefetched != mPrefetchedObjects.end())
+	{
+		sourceObject = itPrefetched->second.Object;
+		prefetchedStreamData.swap(itPrefetched->second.StreamData);
+		mPrefetchedObjects.erase(itPrefetched);
+		isPrefetched = true;
+		++mPrefetchedObjectsUsedCount;
+	}
+	else
+		sourceObject = RefCountPtr<PDFObject>(mParser->ParseNewObject(inSourceObjectID));
 
-	RefCountPtr<PDFObject> sourceObject = mParser->ParseNewObject(inSourceObjectID);
 	if(!sourceObject)
 	{
 		XrefEntryInput* xrefEntry = mParser->GetXrefEntry(inSourceObjectID);
@@ -609,7 +633,13 @@ EStatusCode PDFDocumentHandler::CopyInDirectObject(ObjectIDType inSourceObjectID
 	}
 
 	mObjectsContext->StartNewIndirectObject(inTargetObjectID);
-	status = WriteObjectByType(sourceObject.GetPtr(),eTokenSeparatorEndLine, &writingPolicy);
+	if(isPrefetched && sourceObject->GetType() == PDFObject::ePDFObjectStream)
+	{
+		InputByteArrayStream streamReader(prefetchedStreamData.size() > 0 ? &(prefetchedStreamData[0]) : NULL,prefetchedStreamData.size());
+		status = WriteStreamObject((PDFStreamInput*)sourceObject.GetPtr(),&streamReader,&writingPolicy);
+	}
+	else
+		status = WriteObjectByType(sourceObject.GetPtr(),eTokenSeparatorEndLine, &writingPolicy);
 	if(PDFHummus::eSuccess == status)
 	{
 		if (sourceObject->GetType() != PDFObject::ePDFObjectStream) // write indirect object end for non streams only...cause they take care of writing their own
@@ -688,56 +718,8 @@ EStatusCodeAndObjectIDTypeList PDFDocumentHandler::AppendPDFPagesFromPDFInContex
 			}
 		}
 
-		EStatusCodeAndObjectIDType newObject;
-
-		if(PDFPageRange::eRangeTypeAll == inPageRange.mType)
-		{
-			for(unsigned long i=0; i < mParser->GetPagesCount() && PDFHummus::eSuccess == result.first; ++i)
-			{
-				newObject = CreatePDFPageForPage(i);
-				if(PDFHummus::eSuccess == newObject.first)
-				{
-					result.second.push_back(newObject.second);
-				}
-				else
-				{
-					TRACE_LOG1("PDFDocumentHandler::AppendPDFPagesFromPDF, failed to embed page %ld", i);
-					result.first = PDFHummus::eFailure;
-				}
-			}
-		}
-		else
-		{
-			// eRangeTypeSpecific
-			ULongAndULongList::const_iterator it = inPageRange.mSpecificRanges.begin();
-			for(; it != inPageRange.mSpecificRanges.end() && PDFHummus::eSuccess == result.first;++it)
-			{
-				if(it->first <= it->second && it->second < mParser->GetPagesCount())
-				{
-					for(unsigned long i=it->first; i <= it->second && PDFHummus::eSuccess == result.first; ++i)
-					{
-						newObject = CreatePDFPageForPage(i);
-						if(PDFHummus::eSuccess == newObject.first)
-						{
-							result.second.push_back(newObject.second);
-						}
-						else
-						{
-							TRACE_LOG1("PDFDocumentHandler::AppendPDFPagesFromPDF, failed to embed page %ld", i);
-							result.first = PDFHummus::eFailure;
-						}
-					}
-				}
-				else
-				{
-					TRACE_LOG3("PDFDocumentHandler::AppendPDFPagesFromPDF, range mismatch. first = %ld, second = %ld, PDF page count = %ld", 
-						it->first,
-						it->second,
-						mParser->GetPagesCount());
-					result.first = PDFHummus::eFailure;
-				}
-			}
-		}
+		if(PDFHummus::eSuccess == result.first)
+			result = AppendPDFPagesFromPDF(inPageRange);
 
 
 	}while(false);
@@ -755,6 +737,71 @@ EStatusCodeAndObjectIDTypeList PDFDocumentHandler::AppendPDFPagesFromPDFInContex
 	return result;
 }
 
+EStatusCodeAndObjectIDTypeList PDFDocumentHandler::AppendPDFPagesFromPDF(const PDFPageRange& inPageRange)
+{
+	EStatusCodeAndObjectIDTypeList result;
+	result.first = PDFHummus::eSuccess;
+
+	if(PDFPageRange::eRangeTypeAll == inPageRange.mType)
+	{
+		if(mParser->GetPagesCount() > 0)
+			result.first = AppendPDFPagesInRange(0,mParser->GetPagesCount()-1,result.second);
+	}
+	else
+	{
+		// eRangeTypeSpecific
+		ULongAndULongList::const_iterator it = inPageRange.mSpecificRanges.begin();
+		for(; it != inPageRange.mSpecificRanges.end() && PDFHummus::eSuccess == result.first;++it)
+		{
+			if(it->first <= it->second && it->second < mParser->GetPagesCount())
+			{
+				result.first = AppendPDFPagesInRange(it->first,it->second,result.second);
+			}
+			else
+			{
+				TRACE_LOG3("PDFDocumentHandler::AppendPDFPagesFromPDF, range mismatch. first = %ld, second = %ld, PDF page count = %ld", 
+					it->first,
+					it->second,
+					mParser->GetPagesCount());
+				result.first = PDFHummus::eFailure;
+			}
+		}
+	}
+
+	return result;
+}
+
+// pages read ahead at a time when importing in parallel. bounds the memory held by objects waiting to be written
+static const unsigned long scParallelImportPagesBatchSize = 64;
+
+EStatusCode PDFDocumentHandler::AppendPDFPagesInRange(unsigned long inFirstPageIndex,unsigned long inLastPageIndex,ObjectIDTypeList& ioPageObjectIDs)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	bool importInParallel = IsImportingInParallel();
+	EStatusCodeAndObjectIDType newObject;
+
+	for(unsigned long i=inFirstPageIndex; i <= inLastPageIndex && PDFHummus::eSuccess == status; ++i)
+	{
+		if(importInParallel && (i - inFirstPageIndex) % scParallelImportPagesBatchSize == 0)
+			PrefetchPagesObjects(i,std::min<unsigned long>(i + scParallelImportPagesBatchSize - 1,inLastPageIndex));
+
+		newObject = CreatePDFPageForPage(i);
+		if(PDFHummus::eSuccess == newObject.first)
+		{
+			ioPageObjectIDs.push_back(newObject.second);
+		}
+		else
+		{
+			TRACE_LOG1("PDFDocumentHandler::AppendPDFPagesFromPDF, failed to embed page %ld", i);
+			status = PDFHummus::eFailure;
+		}
+	}
+
+	// objects not used by the pages [an extender may have skipped them] are not kept for later
+	mPrefetchedObjects.clear();
+	return status;
+}
+
 EStatusCodeAndObjectIDType PDFDocumentHandler::CreatePDFPageForPage(unsigned long inPageIndex)
 {
 	RefCountPtr<PDFDictionary> pageObject = mParser->ParsePage(inPageIndex);
@@ -961,13 +1008,16 @@ EStatusCode PDFDocumentHandler::WritePDFStreamInputToContentContext(PageContentC
 
 EStatusCode PDFDocumentHandler::StartFileCopyingContext(const std::string& inPDFFilePath, const PDFParsingOptions& inOptions)
 {
-	if(mPDFFile.OpenFile(inPDFFilePath) != PDFHummus::eSuccess)
+	if(mPDFFile.OpenFile(inPDFFilePath,inOptions.MemoryMapInputFile) != PDFHummus::eSuccess)
 	{
 		TRACE_LOG1("PDFDocumentHandler::StartFileCopyingContext, unable to open file for reading in %s",inPDFFilePath.c_str());
 		return PDFHummus::eFailure;
 	}
 
-	return StartCopyingContext(mPDFFile.GetInputStream(), inOptions);
+	EStatusCode status = StartCopyingContext(mPDFFile.GetInputStream(), inOptions);
+	if(PDFHummus::eSuccess == status)
+		mPDFFilePath = inPDFFilePath; // parallel import workers open the file again, each for its own parser
+	return status;
 }
 
 EStatusCode PDFDocumentHandler::StartCopyingContext(PDFParser* inPDFParser)
@@ -981,6 +1031,8 @@ EStatusCode PDFDocumentHandler::StartCopyingContext(PDFParser* inPDFParser)
         mParserOwned = false;
         mParser = inPDFParser;
 		mPDFStream = inPDFParser->GetParserStream();
+		mPDFFilePath.clear();
+		ResetObjectIDsMaps();
         
 		if(mParser->IsEncrypted() && !mParser->IsEncryptionSupported())
 		{
@@ -1004,6 +1056,8 @@ EStatusCode PDFDocumentHandler::StartCopyingContext(IByteReaderWithPosition* inP
             mParser = new PDFParser();
 		mPDFStream = inPDFStream;
         mParserOwned = true;
+		mPDFFilePath.clear();
+		mParsingOptions = inOptions;
 
 		status = mParser->StartPDFParsing(inPDFStream, inOptions);
 		if(status != PDFHummus::eSuccess)
@@ -1011,6 +1065,7 @@ EStatusCode PDFDocumentHandler::StartCopyingContext(IByteReaderWithPosition* inP
 			TRACE_LOG("PDFDocumentHandler::StartCopyingContext, failure occured while parsing PDF file.");
 			break;
 		}
+		ResetObjectIDsMaps();
 
 		if(mParser->IsEncrypted() && !mParser->IsEncryptionSupported())
 		{
@@ -1099,7 +1154,10 @@ EStatusCodeAndObjectIDType PDFDocumentHandler::AppendPDFPageFromPDF(unsigned lon
 
 	if(inPageIndex < mParser->GetPagesCount())
 	{
+		if(IsImportingInParallel())
+			PrefetchPagesObjects(inPageIndex,inPageIndex);
 		result = CreatePDFPageForPage(inPageIndex);
+		mPrefetchedObjects.clear();
 		if(result.first != PDFHummus::eSuccess)
 			TRACE_LOG1("PDFDocumentHandler::AppendPDFPageFromPDF, failed to append page %ld",inPageIndex);
 	}
@@ -1118,13 +1176,13 @@ EStatusCodeAndObjectIDType PDFDocumentHandler::CopyObject(ObjectIDType inSourceO
 {
 	EStatusCodeAndObjectIDType result;
 
-	ObjectIDTypeToObjectIDTypeMap::iterator it = mSourceToTarget.find(inSourceObjectID);
+	ObjectIDTypeDenseMap::iterator it = mSourceToTarget.find(inSourceObjectID);
 	if(it == mSourceToTarget.end())
 	{
 		ObjectIDTypeList anObjectList;
 		anObjectList.push_back(inSourceObjectID);
 		result.first = WriteNewObjects(anObjectList);
-		result.second = mSourceToTarget[inSourceObjectID];
+		result.second = mSourceToTarget.find(inSourceObjectID)->second;
 	}
 	else
 	{
@@ -1143,7 +1201,7 @@ EStatusCodeAndObjectIDType PDFDocumentHandler::GetCopiedObjectID(ObjectIDType in
 {
 	EStatusCodeAndObjectIDType result;
 
-	ObjectIDTypeToObjectIDTypeMap::iterator it = mSourceToTarget.find(inSourceObjectID);
+	ObjectIDTypeDenseMap::iterator it = mSourceToTarget.find(inSourceObjectID);
 	if(it == mSourceToTarget.end())
 	{
 		result.first = PDFHummus::eFailure;
@@ -1156,13 +1214,26 @@ EStatusCodeAndObjectIDType PDFDocumentHandler::GetCopiedObjectID(ObjectIDType in
 	return result;
 }
 
-MapIterator<ObjectIDTypeToObjectIDTypeMap> PDFDocumentHandler::GetCopiedObjectsMappingIterator()
+MapIterator<ObjectIDTypeDenseMap> PDFDocumentHandler::GetCopiedObjectsMappingIterator()
 {
-	return MapIterator<ObjectIDTypeToObjectIDTypeMap>(mSourceToTarget);
+	return MapIterator<ObjectIDTypeDenseMap>(mSourceToTarget);
+}
+
+void PDFDocumentHandler::ResetObjectIDsMaps()
+{
+	// source object IDs are mostly below the source objects count, so most can be kept in arrays.
+	// the parser already holds an xref entry per object, so arrays of this size are safe to allocate
+	ObjectIDType objectsCount = mParser->GetObjectsCount();
+
+	mSourceToTarget.Reset(objectsCount);
+	mCopiedObjects.Reset(objectsCount);
+	mPrefetchRegisteredObjects.Reset(objectsCount);
 }
 
 void PDFDocumentHandler::StopCopyingContext()
 {
+	StopParallelImportParsers();
+	mPDFFilePath.clear();
 	mPDFFile.CloseFile();
 	mPDFStream = NULL;
 	// clearing the source to target mapping here. note that copying enjoyed sharing of objects between them
@@ -1533,11 +1604,11 @@ EStatusCodeAndObjectIDType PDFDocumentHandler::CopyObjectToIndirectObject(PDFObj
 	}
 	else
 	{
-		ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)inObject)->mObjectID);
+		ObjectIDTypeDenseMap::iterator	itObjects = mSourceToTarget.find(((PDFIndirectObjectReference*)inObject)->mObjectID);
 		if(itObjects == mSourceToTarget.end())
 		{
 			result.second = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-			mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(((PDFIndirectObjectReference*)inObject)->mObjectID,result.second));
+			mSourceToTarget.insert(ObjectIDTypeDenseMap::value_type(((PDFIndirectObjectReference*)inObject)->mObjectID,result.second));
 			result.first = CopyInDirectObject(((PDFIndirectObjectReference*)inObject)->mObjectID,result.second);
 		}
 		else
@@ -1642,32 +1713,129 @@ EStatusCode PDFDocumentHandler::WritePDFStreamInputToContentContext(PageContentC
 	return status;
 }
 
-EStatusCode PDFDocumentHandler::WritePDFStreamInputToStream(IByteWriter* inTargetStream,PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames)
+static const char scSlash = '/';
+static const LongBufferSizeType scRewriteBufferSize = 4096;
+
+/*
+	Reader for the tokenizer, that keeps what was read till it's written to the target stream. this allows copying the content
+	as is, while replacing the resource names that the tokenizer found, in a single pass over the source stream.
+	Kept content starts at mKeptIndex in the buffer, and its positions are stream positions, starting at mBufferStart, which matches
+	the tokenizer position tracking. written content is dropped by advancing mKeptIndex, and the buffer is compacted only when
+	the dropped prefix is more than half of it, so each byte is moved a constant amount of times.
+*/
+class ResourcesTokensRewritingReader : public IByteReader
 {
-	// as oppose to regular copying, this copying has to replace name references that refer to mapped resources.
-	// as such, the method of copying will be token by token, where each token is checked for being a resource reference.
-	// the current assumption, somewhere between speed and safety compromise, is that the any name token that has a resource name is in fact a relevant
-	// resource reference. 
+public:
+	ResourcesTokensRewritingReader(IByteReader* inSourceStream,IByteWriter* inTargetStream)
+	{
+		mSourceStream = inSourceStream;
+		mTargetStream = inTargetStream;
+		mBufferStart = 0;
+		mKeptIndex = 0;
+		mReadIndex = 0;
+	}
 
+	virtual LongBufferSizeType Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+	{
+		if(mReadIndex == mBuffer.size() && !FillBuffer())
+			return 0;
 
-	// in order to have minimal interferences with the stream content i'm going for two passes here.
-	// the first pass will scan the stream for tokens to replace providing the tokens and their positions.
-	// a second pass is then repeatedly copies the content between tokens that are to be replaced. this might be wasteful,
-	// but is the safest method to get the content right.
+		LongBufferSizeType readAmount = std::min<LongBufferSizeType>(inBufferSize,mBuffer.size() - mReadIndex);
+		memcpy(inBuffer,&(mBuffer[mReadIndex]),readAmount);
+		mReadIndex += readAmount;
+		return readAmount;
+	}
 
-	ResourceTokenMarkerList resourcesPositions;
+	virtual bool NotEnded()
+	{
+		return mReadIndex < mBuffer.size() || mSourceStream->NotEnded();
+	}
 
-	EStatusCode status = ScanStreamForResourcesTokens(inSourceStream,inMappedResourcesNames,resourcesPositions);
-	if(status != PDFHummus::eSuccess)
-		return status;
+	LongFilePositionType GetBufferedSize()
+	{
+		return mBuffer.size() - mKeptIndex;
+	}
 
-	return MergeAndReplaceResourcesTokens(inTargetStream,inSourceStream,inMappedResourcesNames,resourcesPositions);
-}
+	// write the kept content up to the stream position
+	EStatusCode WriteUpTo(LongFilePositionType inPosition)
+	{
+		LongBufferSizeType writeAmount = (LongBufferSizeType)(inPosition - mBufferStart);
+		if(writeAmount > mReadIndex - mKeptIndex)
+			writeAmount = mReadIndex - mKeptIndex;
+		if(0 == writeAmount)
+			return eSuccess;
 
+		if(mTargetStream->Write(&(mBuffer[mKeptIndex]),writeAmount) != writeAmount)
+			return eFailure;
+		Discard(writeAmount);
+		return eSuccess;
+	}
 
-static const char scSlash = '/';
-EStatusCode PDFDocumentHandler::ScanStreamForResourcesTokens(PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames,ResourceTokenMarkerList& outResourceMarkers)
+	// drop kept content up to the stream position, without writing it
+	void SkipTo(LongFilePositionType inPosition)
+	{
+		LongBufferSizeType skipAmount = (LongBufferSizeType)(inPosition - mBufferStart);
+		Discard(skipAmount > mReadIndex - mKeptIndex ? mReadIndex - mKeptIndex : skipAmount);
+	}
+
+	// write all kept content, and whatever the tokenizer didn't get to read
+	EStatusCode WriteRemainder()
+	{
+		LongBufferSizeType keptSize = mBuffer.size() - mKeptIndex;
+		if(keptSize > 0 && mTargetStream->Write(&(mBuffer[mKeptIndex]),keptSize) != keptSize)
+			return eFailure;
+		mBufferStart += keptSize;
+		mBuffer.clear();
+		mKeptIndex = 0;
+		mReadIndex = 0;
+
+		OutputStreamTraits traits(mTargetStream);
+		return traits.CopyToOutputStream(mSourceStream);
+	}
+
+private:
+	IByteReader* mSourceStream;
+	IByteWriter* mTargetStream;
+	std::vector<Byte> mBuffer;
+	LongFilePositionType mBufferStart;
+	LongBufferSizeType mKeptIndex;
+	LongBufferSizeType mReadIndex;
+
+	bool FillBuffer()
+	{
+		if(!mSourceStream->NotEnded())
+			return false;
+
+		LongBufferSizeType keptSize = mBuffer.size();
+		mBuffer.resize(keptSize + scRewriteBufferSize);
+		LongBufferSizeType readAmount = mSourceStream->Read(&(mBuffer[keptSize]),scRewriteBufferSize);
+		mBuffer.resize(keptSize + readAmount);
+		return readAmount > 0;
+	}
+
+	void Discard(LongBufferSizeType inAmount)
+	{
+		mKeptIndex += inAmount;
+		mBufferStart += inAmount;
+
+		if(mKeptIndex > mBuffer.size() / 2)
+		{
+			mBuffer.erase(mBuffer.begin(),mBuffer.begin() + mKeptIndex);
+			mReadIndex -= mKeptIndex;
+			mKeptIndex = 0;
+		}
+	}
+};
+
+EStatusCode PDFDocumentHandler::WritePDFStreamInputToStream(IByteWriter* inTargetStream,PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames)
 {
+	// as oppose to regular copying, this copying has to replace name references that refer to mapped resources.
+	// as such, the method of copying will be token by token, where each token is checked for being a resource reference.
+	// the current assumption, somewhere between speed and safety compromise, is that the any name token that has a resource name is in fact a relevant
+	// resource reference. 
+	// the content is copied as is, other than the replaced names. content read by the tokenizer is kept till written, so the
+	// stream is read (and decoded) once.
+
 	IByteReader* streamReader = mParser->CreateInputStreamReader(inSourceStream);
 
 	if(!streamReader)
@@ -1675,17 +1843,30 @@ EStatusCode PDFDocumentHandler::ScanStreamForResourcesTokens(PDFStreamInput* inS
 
 	mPDFStream->SetPosition(inSourceStream->GetStreamContentStart());
 
+	EStatusCode status = PDFHummus::eSuccess;
+
+	if(inMappedResourcesNames.empty())
+	{
+		// nothing to replace
+		OutputStreamTraits traits(inTargetStream);
+		status = traits.CopyToOutputStream(streamReader);
+		delete streamReader;
+		return status;
+	}
+
+	ResourcesTokensRewritingReader rewritingReader(streamReader,inTargetStream);
+	PrimitiveObjectsWriter primitivesWriter;
+	primitivesWriter.SetStreamForWriting(inTargetStream);
+
 	// using simplestringtokenizer instead of regular pdfparsertokenizer, as content stream may contain
 	// streams, which may have tokens that will be interpreted as pdf tokens (like string start), and so will cause
 	// a wrong inclusion of content and so will skip content that should be replaced.
 	// There's still risk here, in that there will be a string that like a resource name with forward slash which will be mistaken
 	// for a resource usage. this is something to tackle still.
 	SimpleStringTokenizer tokenizer;
-	tokenizer.SetReadStream(streamReader);
+	tokenizer.SetReadStream(&rewritingReader);
 
-	BoolAndString tokenizerResult;
-
-	while(streamReader->NotEnded())
+	while(rewritingReader.NotEnded() && PDFHummus::eSuccess == status)
 	{
 		BoolAndString tokenizerResult = tokenizer.GetNextToken();
 
@@ -1694,57 +1875,31 @@ EStatusCode PDFDocumentHandler::ScanStreamForResourcesTokens(PDFStreamInput* inS
 
 		// check if this is a token that will need replacement - 1. verify that it's a name 2. verify that it's a name in the input map
 		// note that here i don't have to take care of name space chars encoding, as the names are alrady encoded in the map [the new names are never containing space chars]
-		if(tokenizerResult.second.at(0) == scSlash && 
-			(inMappedResourcesNames.find(tokenizerResult.second.substr(1)) != inMappedResourcesNames.end()))
-				outResourceMarkers.push_back(ResourceTokenMarker(tokenizerResult.second.substr(1),tokenizer.GetRecentTokenPosition()));
-	}
-
-	delete streamReader;
-	return PDFHummus::eSuccess;
-}
-
-EStatusCode PDFDocumentHandler::MergeAndReplaceResourcesTokens(	IByteWriter* inTargetStream,
-																PDFStreamInput* inSourceStream,
-																const StringToStringMap& inMappedResourcesNames,
-																const ResourceTokenMarkerList& inResourceMarkers)
-{
-	IByteReader* streamReader = mParser->CreateInputStreamReader(inSourceStream);
-
-	if(!streamReader)
-		return PDFHummus::eFailure;
-
-	mPDFStream->SetPosition(inSourceStream->GetStreamContentStart());
-
-	OutputStreamTraits traits(inTargetStream);
-	PrimitiveObjectsWriter primitivesWriter;
-	primitivesWriter.SetStreamForWriting(inTargetStream);
-	EStatusCode status = PDFHummus::eSuccess;
-	InputStreamSkipperStream skipper(streamReader);
-	ResourceTokenMarkerList::const_iterator it = inResourceMarkers.begin();
-	LongFilePositionType previousContentPosition = 0;
-
-	for(; it != inResourceMarkers.end() && PDFHummus::eSuccess == status; ++it)
-	{
-		status = traits.CopyToOutputStream(streamReader,(LongBufferSizeType)(it->ResourceTokenPosition - previousContentPosition));
-		if(status != PDFHummus::eSuccess)
-			break;
-		primitivesWriter.WriteName(inMappedResourcesNames.find(it->ResourceToken)->second,eTokenSepratorNone);
-		// note that i'm using SkipBy here. if i want to use SkipTo, i have to user the skipper stream as input stream for the rest
-		// of the reader objects here, as SkipTo relies on information on how many bytes were read
-		skipper.SkipBy(it->ResourceToken.size() + 1); // skip the resource name in the read stream [include +1 for slash]
-		previousContentPosition = it->ResourceTokenPosition + it->ResourceToken.size() + 1;
+		StringToStringMap::const_iterator it = tokenizerResult.second.at(0) == scSlash ? 
+													inMappedResourcesNames.find(tokenizerResult.second.substr(1)) : 
+													inMappedResourcesNames.end();
+		if(it != inMappedResourcesNames.end())
+		{
+			status = rewritingReader.WriteUpTo(tokenizer.GetRecentTokenPosition());
+			if(status != PDFHummus::eSuccess)
+				break;
+			primitivesWriter.WriteName(it->second,eTokenSepratorNone);
+			rewritingReader.SkipTo(tokenizer.GetRecentTokenPosition() + tokenizerResult.second.size());
+		}
+		else if(rewritingReader.GetBufferedSize() >= (LongFilePositionType)scRewriteBufferSize)
+		{
+			// content before this token is final, write it in large enough pieces
+			status = rewritingReader.WriteUpTo(tokenizer.GetRecentTokenPosition());
+		}
 	}
 
-	// copy from last marker (or in case there are none - from the beginning), till end
 	if(PDFHummus::eSuccess == status)
-		status = traits.CopyToOutputStream(streamReader);
-	
-	skipper.Assign(NULL);
+		status = rewritingReader.WriteRemainder();
+
 	delete streamReader;
 	return status;
 }
 
-
 EStatusCode PDFDocumentHandler::MergePDFPageToPage(PDFPage* inTargetPage,unsigned long inSourcePageIndex)
 {
 	EStatusCode status;
@@ -1856,9 +2011,254 @@ EStatusCode PDFDocumentHandler::CopyNewObjectsForDirectObject(const ObjectIDType
 
 void PDFDocumentHandler::SetParserExtender(IPDFParserExtender* inParserExtender)
 {
+	mParserExtender = inParserExtender;
 	mParser->SetParserExtender(inParserExtender);
 }
 
+bool PDFDocumentHandler::IsImportingInParallel()
+{
+	// workers need a file to open parsers of their own over. parser extenders are not assumed to be thread safe
+	return mParsingOptions.ImportPagesInParallel && 
+			mParserOwned && 
+			!mPDFFilePath.empty() && 
+			!mParserExtender;
+}
+
+EStatusCode PDFDocumentHandler::StartParallelImportParsers()
+{
+	if(mParallelImportParsers.size() > 0)
+		return PDFHummus::eSuccess;
+
+	EStatusCode status = PDFHummus::eSuccess;
+	unsigned int workersCount = std::max<unsigned int>(std::thread::hardware_concurrency(),1);
+
+	for(unsigned int i=0; i < workersCount && PDFHummus::eSuccess == status; ++i)
+	{
+		ParallelImportParser* importParser = new ParallelImportParser();
+		mParallelImportParsers.push_back(importParser);
+
+		status = importParser->File.OpenFile(mPDFFilePath,mParsingOptions.MemoryMapInputFile);
+		if(status != PDFHummus::eSuccess)
+		{
+			TRACE_LOG1("PDFDocumentHandler::StartParallelImportParsers, unable to open file for reading in %s",mPDFFilePath.c_str());
+			break;
+		}
+
+		status = importParser->Parser.StartPDFParsing(importParser->File.GetInputStream(),mParsingOptions);
+		if(status != PDFHummus::eSuccess)
+			TRACE_LOG("PDFDocumentHandler::StartParallelImportParsers, failure occured while parsing PDF file.");
+	}
+
+	if(status != PDFHummus::eSuccess)
+		StopParallelImportParsers();
+	return status;
+}
+
+void PDFDocumentHandler::StopParallelImportParsers()
+{
+	// prefetched objects may be allocated from the parsers arenas, so release them first
+	mPrefetchedObjects.clear();
+
+	ParallelImportParserVector::iterator it = mParallelImportParsers.begin();
+	for(; it != mParallelImportParsers.end(); ++it)
+		delete *it;
+	mParallelImportParsers.clear();
+}
+
+static const LongBufferSizeType scPrefetchReadBufferSize = 64*1024;
+
+static void PrefetchObjects(PDFParser* inParser,const ObjectIDTypeVector& inObjectIDs,const std::vector<size_t>& inIndexes,PrefetchedObjectVector& ioObjects)
+{
+	std::vector<IOBasicTypes::Byte> buffer(scPrefetchReadBufferSize);
+
+	for(std::vector<size_t>::const_iterator it = inIndexes.begin(); it != inIndexes.end(); ++it)
+	{
+		size_t i = *it;
+		RefCountPtr<PDFObject> object(inParser->ParseNewObject(inObjectIDs[i]));
+
+		// objects that fail here are left for the copying to parse [and report on] again
+		if(!object)
+			continue;
+
+		if(object->GetType() == PDFObject::ePDFObjectStream)
+		{
+			IByteReader* streamReader = inParser->StartReadingFromStreamForPlainCopying((PDFStreamInput*)object.GetPtr());
+			if(!streamReader)
+				continue;
+
+			while(streamReader->NotEnded())
+			{
+				LongBufferSizeType readBytes = streamReader->Read(&(buffer[0]),scPrefetchReadBufferSize);
+				if(0 == readBytes)
+					break;
+				ioObjects[i].StreamData.insert(ioObjects[i].StreamData.end(),buffer.begin(),buffer.begin() + readBytes);
+			}
+			delete streamReader;
+		}
+		ioObjects[i].Object = object;
+	}
+}
+
+typedef std::vector<std::vector<size_t> > SizeTVectorVector;
+
+static bool IsLargerGroup(const std::vector<size_t>* inLeft,const std::vector<size_t>* inRight)
+{
+	return inLeft->size() > inRight->size();
+}
+
+static void PartitionPrefetchObjects(PDFParser* inParser,const ObjectIDTypeVector& inObjectIDs,size_t inWorkersCount,SizeTVectorVector& outWorkersIndexes)
+{
+	/*
+		objects that are stored in an object stream are given to the same worker, so that the object stream
+		is decoded once [and then kept in the worker parser decoded object streams cache], and not by every worker.
+		the groups are then given to the workers largest first, each to the worker with least objects so far.
+	*/
+	std::map<ObjectIDType,std::vector<size_t> > objectStreamsGroups;
+	SizeTVectorVector singleObjectsGroups;
+
+	for(size_t i = 0; i < inObjectIDs.size(); ++i)
+	{
+		XrefEntryInput* xrefEntry = inParser->GetXrefEntry(inObjectIDs[i]);
+		if(xrefEntry && eXrefEntryStreamObject == xrefEntry->mType)
+			objectStreamsGroups[(ObjectIDType)xrefEntry->mObjectPosition].push_back(i);
+		else
+			singleObjectsGroups.push_back(std::vector<size_t>(1,i));
+	}
+
+	std::vector<const std::vector<size_t>*> groups;
+	std::map<ObjectIDType,std::vector<size_t> >::const_iterator itObjectStream = objectStreamsGroups.begin();
+	for(; itObjectStream != objectStreamsGroups.end(); ++itObjectStream)
+		groups.push_back(&(itObjectStream->second));
+	for(size_t i = 0; i < singleObjectsGroups.size(); ++i)
+		groups.push_back(&(singleObjectsGroups[i]));
+	std::stable_sort(groups.begin(),groups.end(),IsLargerGroup);
+
+	outWorkersIndexes.assign(std::min<size_t>(inWorkersCount,groups.size()),std::vector<size_t>());
+	for(size_t i = 0; i < groups.size(); ++i)
+	{
+		size_t leastLoadedWorker = 0;
+		for(size_t j = 1; j < outWorkersIndexes.size(); ++j)
+		{
+			if(outWorkersIndexes[j].size() < outWorkersIndexes[leastLoadedWorker].size())
+				leastLoadedWorker = j;
+		}
+		outWorkersIndexes[leastLoadedWorker].insert(outWorkersIndexes[leastLoadedWorker].end(),groups[i]->begin(),groups[i]->end());
+	}
+}
+
+void PDFDocumentHandler::PrefetchPagesObjects(unsigned long inFirstPageIndex,unsigned long inLastPageIndex)
+{
+	/*
+		Read the objects that copying the pages will require, so that copying finds them ready.
+		the pages resources and content streams are the roots. the objects they refer to are then read level by level,
+		each level split between the workers [keeping objects of one object stream together], till no new objects are found. objects already copied [or replaced] are skipped, so
+		resources shared with earlier pages are not read again.
+		Writing the objects remains with the regular copying, which takes them from here by source object ID.
+	*/
+	if(StartParallelImportParsers() != PDFHummus::eSuccess)
+	{
+		TRACE_LOG("PDFDocumentHandler::PrefetchPagesObjects, failed to start parallel import parsers. pages objects will be read serially");
+		return;
+	}
+
+	ObjectIDTypeVector objectIDs;
+	mPrefetchRegisteredObjects.Clear();
+
+	for(unsigned long i = inFirstPageIndex; i <= inLastPageIndex; ++i)
+	{
+		RefCountPtr<PDFDictionary> pageObject(mParser->ParsePage(i));
+		if(!pageObject)
+			continue;
+
+		RefCountPtr<PDFObject> resources(FindPageResources(mParser,pageObject.GetPtr()));
+		if(!!resources)
+			RegisterObjectsForPrefetch(resources.GetPtr(),objectIDs);
+
+		RefCountPtr<PDFObject> contents(pageObject->QueryDirectObject("Contents"));
+		if(!!contents)
+			RegisterObjectsForPrefetch(contents.GetPtr(),objectIDs);
+	}
+
+	while(objectIDs.size() > 0)
+	{
+		PrefetchedObjectVector objects(objectIDs.size());
+		std::vector<std::thread> workers;
+		SizeTVectorVector workersIndexes;
+
+		PartitionPrefetchObjects(mParser,objectIDs,mParallelImportParsers.size(),workersIndexes);
+		workers.reserve(workersIndexes.size());
+		size_t startedWorkers = 0;
+		try
+		{
+			for(; startedWorkers < workersIndexes.size(); ++startedWorkers)
+				workers.push_back(std::thread(PrefetchObjects,&(mParallelImportParsers[startedWorkers]->Parser),std::cref(objectIDs),std::cref(workersIndexes[startedWorkers]),std::ref(objects)));
+		}
+		catch(std::system_error&)
+		{
+			TRACE_LOG1("PDFDocumentHandler::PrefetchPagesObjects, failed to start prefetch worker %ld. its objects will be read serially",(long)startedWorkers);
+		}
+
+		// objects of workers that could not be started are read here, each with the parser of its worker
+		for(size_t i = startedWorkers; i < workersIndexes.size(); ++i)
+			PrefetchObjects(&(mParallelImportParsers[i]->Parser),objectIDs,workersIndexes[i],objects);
+		for(size_t i = 0; i < workers.size(); ++i)
+			workers[i].join();
+
+		// keep the level objects, and collect the next level from their references
+		ObjectIDTypeVector nextObjectIDs;
+		for(size_t i = 0; i < objectIDs.size(); ++i)
+		{
+			if(!objects[i].Object)
+				continue;
+
+			PrefetchedObject& prefetchedObject = mPrefetchedObjects[objectIDs[i]];
+			prefetchedObject.Object = objects[i].Object;
+			prefetchedObject.StreamData.swap(objects[i].StreamData);
+
+			if(objects[i].Object->GetType() == PDFObject::ePDFObjectStream)
+			{
+				RefCountPtr<PDFDictionary> streamDictionary(((PDFStreamInput*)objects[i].Object.GetPtr())->QueryStreamDictionary());
+				RegisterObjectsForPrefetch(streamDictionary.GetPtr(),nextObjectIDs);
+			}
+			else
+				RegisterObjectsForPrefetch(objects[i].Object.GetPtr(),nextObjectIDs);
+		}
+		objectIDs.swap(nextObjectIDs);
+	}
+}
+
+void PDFDocumentHandler::RegisterObjectsForPrefetch(PDFObject* inObject,ObjectIDTypeVector& ioObjectIDs)
+{
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectIndirectObjectReference:
+		{
+			ObjectIDType objectID = ((PDFIndirectObjectReference*)inObject)->mObjectID;
+			if(mSourceToTarget.find(objectID) == mSourceToTarget.end() && 
+				mPrefetchedObjects.find(objectID) == mPrefetchedObjects.end() &&
+				mPrefetchRegisteredObjects.Insert(objectID))
+				ioObjectIDs.push_back(objectID);
+			break;
+		}
+		case PDFObject::ePDFObjectArray:
+		{
+			SingleValueContainerIterator<PDFObjectVector> it(((PDFArray*)inObject)->GetIterator());
+			while(it.MoveNext())
+				RegisterObjectsForPrefetch(it.GetItem(),ioObjectIDs);
+			break;
+		}
+		case PDFObject::ePDFObjectDictionary:
+		{
+			MapIterator<PDFNameToPDFObjectMap> it(((PDFDictionary*)inObject)->GetIterator());
+			while(it.MoveNext())
+				RegisterObjectsForPrefetch(it.GetValue(),ioObjectIDs);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
 void PDFDocumentHandler::ReplaceSourceObjects(const ObjectIDTypeToObjectIDTypeMap& inSourceObjectsToNewTargetObjects)
 {
 	ObjectIDTypeToObjectIDTypeMap::const_iterator itReplaced = inSourceObjectsToNewTargetObjects.begin();
@@ -1866,7 +2266,7 @@ void PDFDocumentHandler::ReplaceSourceObjects(const ObjectIDTypeToObjectIDTypeMa
 	for(; itReplaced != inSourceObjectsToNewTargetObjects.end(); ++itReplaced)
 	{
 		if(mSourceToTarget.find(itReplaced->first) == mSourceToTarget.end())
-			mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(itReplaced->first,itReplaced->second));
+			mSourceToTarget.insert(ObjectIDTypeDenseMap::value_type(itReplaced->first,itReplaced->second));
 	}
 }
 
@@ -1875,6 +2275,11 @@ IByteReaderWithPosition* PDFDocumentHandler::GetSourceDocumentStream()
 	return mPDFStream;
 }
 
+unsigned long PDFDocumentHandler::GetPrefetchedObjectsUsedCount()
+{
+	return mPrefetchedObjectsUsedCount;
+}
+
 // for modification scenarios, no need for deep copying. the following implement this path
 EStatusCode PDFDocumentHandler::CopyDirectObjectAsIs(PDFObject* inObject)
 {
@@ -1888,11 +2293,11 @@ void InWritingPolicy::WriteReference(PDFIndirectObjectReference* inReference, ET
 
 void OutWritingPolicy::WriteReference(PDFIndirectObjectReference* inReference, ETokenSeparator inSeparator) {
 	ObjectIDType sourceObjectID = inReference->mObjectID;
-	ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mDocumentHandler->mSourceToTarget.find(sourceObjectID);
+	ObjectIDTypeDenseMap::iterator	itObjects = mDocumentHandler->mSourceToTarget.find(sourceObjectID);
 	if (itObjects == mDocumentHandler->mSourceToTarget.end())
 	{
 		ObjectIDType newObjectID = mDocumentHandler->mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-		itObjects = mDocumentHandler->mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(sourceObjectID, newObjectID)).first;
+		itObjects = mDocumentHandler->mSourceToTarget.insert(ObjectIDTypeDenseMap::value_type(sourceObjectID, newObjectID)).first;
 		mSourceObjectsToAdd.push_back(sourceObjectID);
 	}
 	mDocumentHandler->mObjectsContext->WriteNewIndirectObjectReference(itObjects->second, inSeparator);
@@ -2008,6 +2413,14 @@ EStatusCode PDFDocumentHandler::WriteDictionaryObject(PDFDictionary* inDictionar
 }
 
 EStatusCode PDFDocumentHandler::WriteStreamObject(PDFStreamInput* inStream, IObjectWritePolicy* inWritePolicy)
+{
+	IByteReader* streamReader = mParser->StartReadingFromStreamForPlainCopying(inStream);
+	EStatusCode status = WriteStreamObject(inStream,streamReader,inWritePolicy);
+	delete streamReader;
+	return status;
+}
+
+EStatusCode PDFDocumentHandler::WriteStreamObject(PDFStreamInput* inStream, IByteReader* inStreamReader, IObjectWritePolicy* inWritePolicy)
 {
 	/*
 	1. Create stream dictionary, copy all elements of input stream but Length (which may be the same...but due to internals may not)
@@ -2035,20 +2448,17 @@ EStatusCode PDFDocumentHandler::WriteStreamObject(PDFStreamInput* inStream, IObj
 
 	PDFStream* newStream = mObjectsContext->StartUnfilteredPDFStream(newStreamDictionary);
 	OutputStreamTraits outputTraits(newStream->GetWriteStream());
-	IByteReader* streamReader = mParser->StartReadingFromStreamForPlainCopying(inStream);
 
-	status = outputTraits.CopyToOutputStream(streamReader);
+	status = outputTraits.CopyToOutputStream(inStreamReader);
 	if (status != PDFHummus::eSuccess)
 	{
 		TRACE_LOG("PDFDocumentHandler::WriteStreamObject, failed to copy stream");
 		delete newStream;
-		delete streamReader;
 		return PDFHummus::eFailure;
 	}
 
 	mObjectsContext->EndPDFStream(newStream);
 	delete newStream;
-	delete streamReader;
 	return status;
 }
 
@@ -2335,12 +2745,12 @@ void PDFDocumentHandler::RegisterResourcesForResourcesCategory(PDFFormXObject* i
             if(it.GetValue()->GetType() == PDFObject::ePDFObjectIndirectObjectReference)
             {
                 PDFIndirectObjectReference* indirectReference = (PDFIndirectObjectReference*)(it.GetValue());
-                ObjectIDTypeToObjectIDTypeMap::iterator	itObjects = mSourceToTarget.find(indirectReference->mObjectID);
+                ObjectIDTypeDenseMap::iterator	itObjects = mSourceToTarget.find(indirectReference->mObjectID);
                 ObjectIDType targetObjectID;
                 if(itObjects == mSourceToTarget.end())
                 {
                     targetObjectID = mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID();
-                    mSourceToTarget.insert(ObjectIDTypeToObjectIDTypeMap::value_type(indirectReference->mObjectID,targetObjectID));
+                    mSourceToTarget.insert(ObjectIDTypeDenseMap::value_type(indirectReference->mObjectID,targetObjectID));
                     ioObjectsToLaterCopy.push_back(indirectReference->mObjectID);
                 }
                 else
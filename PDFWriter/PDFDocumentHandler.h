@@ -29,10 +29,16 @@
 #include "DocumentContextExtenderAdapter.h"
 #include "MapIterator.h"
 #include "PDFParsingOptions.h"
+#include "ObjectIDTypeDenseMap.h"
+#include "ObjectIDTypeDenseSet.h"
+#include "RefCountPtr.h"
+#include "IOBasicTypes.h"
 
 #include <map>
 #include <list>
 #include <set>
+#include <vector>
+#include <string>
 
 class ObjectsContext;
 class IByteWriter;
@@ -61,18 +67,26 @@ typedef std::map<std::string,std::string> StringToStringMap;
 typedef std::set<ObjectIDType> ObjectIDTypeSet;
 typedef std::set<IDocumentContextExtender*> IDocumentContextExtenderSet;
 
-struct ResourceTokenMarker
+// a source object read ahead of copying by a parallel import worker. for streams, the stream data is kept as it is to be copied
+struct PrefetchedObject
 {
-	ResourceTokenMarker(std::string inResourceToken,LongFilePositionType inResourceTokenPosition)
-	{
-		ResourceToken = inResourceToken;
-		ResourceTokenPosition = inResourceTokenPosition;
-	}
+	RefCountPtr<PDFObject> Object;
+	std::vector<IOBasicTypes::Byte> StreamData;
+};
 
-	std::string ResourceToken;
-	LongFilePositionType ResourceTokenPosition;
+typedef std::map<ObjectIDType,PrefetchedObject> ObjectIDTypeToPrefetchedObjectMap;
+typedef std::vector<ObjectIDType> ObjectIDTypeVector;
+typedef std::vector<PrefetchedObject> PrefetchedObjectVector;
+
+// a parser of its own for a parallel import worker, over the same source file
+struct ParallelImportParser
+{
+	InputFile File;
+	PDFParser Parser;
 };
 
+typedef std::vector<ParallelImportParser*> ParallelImportParserVector;
+
 class IObjectWritePolicy
 {
 public:
@@ -102,8 +116,6 @@ private:
 	ObjectIDTypeList& mSourceObjectsToAdd;
 };
 
-typedef std::list<ResourceTokenMarker> ResourceTokenMarkerList;
-
 class PDFDocumentHandler : public DocumentContextExtenderAdapter
 {
 	friend class InWritingPolicy;
@@ -201,18 +213,21 @@ public:
 														 const double* inTransformationMatrix,
 														ObjectIDType inPredefinedFormId);
 	EStatusCodeAndObjectIDType AppendPDFPageFromPDF(unsigned long inPageIndex);
+	EStatusCodeAndObjectIDTypeList AppendPDFPagesFromPDF(const PDFPageRange& inPageRange);
 	PDFHummus::EStatusCode MergePDFPageToPage(PDFPage* inTargetPage,unsigned long inSourcePageIndex);
     PDFHummus::EStatusCode MergePDFPageToFormXObject(PDFFormXObject* inTargetFormXObject,unsigned long inSourcePageIndex);
 	EStatusCodeAndObjectIDType CopyObject(ObjectIDType inSourceObjectID);
 	PDFParser* GetSourceDocumentParser();
 	EStatusCodeAndObjectIDType GetCopiedObjectID(ObjectIDType inSourceObjectID);
-	MapIterator<ObjectIDTypeToObjectIDTypeMap> GetCopiedObjectsMappingIterator();
+	MapIterator<ObjectIDTypeDenseMap> GetCopiedObjectsMappingIterator();
 	EStatusCodeAndObjectIDTypeList CopyDirectObjectWithDeepCopy(PDFObject* inObject);
     PDFHummus::EStatusCode CopyDirectObjectAsIs(PDFObject* inObject);
 	PDFHummus::EStatusCode CopyNewObjectsForDirectObject(const ObjectIDTypeList& inReferencedObjects);
 	void StopCopyingContext();
 	void ReplaceSourceObjects(const ObjectIDTypeToObjectIDTypeMap& inSourceObjectsToNewTargetObjects);
 	IByteReaderWithPosition* GetSourceDocumentStream();
+	// count of copied objects that were read ahead by parallel import workers [see PDFParsingOptions::ImportPagesInParallel]
+	unsigned long GetPrefetchedObjectsUsedCount();
 
 	// Internal implementation. do not use directly
 	PDFFormXObject* CreatePDFFormXObjectForPage(unsigned long inPageIndex,
@@ -238,8 +253,19 @@ private:
 	IByteReaderWithPosition* mPDFStream;
 	PDFParser* mParser;
     bool mParserOwned;
-	ObjectIDTypeToObjectIDTypeMap mSourceToTarget;
+	ObjectIDTypeDenseMap mSourceToTarget;
+	// objects copied by the current copy [of an object and its dependencies]
+	ObjectIDTypeDenseSet mCopiedObjects;
 	PDFDictionary* mWrittenPage;
+
+	// parallel import [see PDFParsingOptions::ImportPagesInParallel]
+	std::string mPDFFilePath;
+	PDFParsingOptions mParsingOptions;
+	IPDFParserExtender* mParserExtender;
+	ParallelImportParserVector mParallelImportParsers;
+	ObjectIDTypeToPrefetchedObjectMap mPrefetchedObjects;
+	ObjectIDTypeDenseSet mPrefetchRegisteredObjects;
+	unsigned long mPrefetchedObjectsUsedCount;
 	
 
 	PDFRectangle DeterminePageBox(PDFDictionary* inDictionary,EPDFPageBox inPageBoxType);
@@ -249,8 +275,8 @@ private:
 	void RegisterInDirectObjects(PDFDictionary* inDictionary,ObjectIDTypeList& outNewObjects);
 	void RegisterInDirectObjects(PDFArray* inArray,ObjectIDTypeList& outNewObjects);
 	PDFHummus::EStatusCode WriteNewObjects(const ObjectIDTypeList& inSourceObjectIDs);
-	PDFHummus::EStatusCode WriteNewObjects(const ObjectIDTypeList& inSourceObjectIDs,ObjectIDTypeSet& ioCopiedObjects);
-	PDFHummus::EStatusCode CopyInDirectObject(ObjectIDType inSourceObjectID,ObjectIDType inTargetObjectID,ObjectIDTypeSet& ioCopiedObjects);
+	PDFHummus::EStatusCode WriteNewObjects(const ObjectIDTypeList& inSourceObjectIDs,ObjectIDTypeDenseSet& ioCopiedObjects);
+	PDFHummus::EStatusCode CopyInDirectObject(ObjectIDType inSourceObjectID,ObjectIDType inTargetObjectID,ObjectIDTypeDenseSet& ioCopiedObjects);
 	EStatusCodeAndObjectIDTypeList CreateFormXObjectsFromPDF(const std::string& inPDFFilePath,
 															const PDFParsingOptions& inParsingOptions,
 															const PDFPageRange& inPageRange,
@@ -268,9 +294,18 @@ private:
 	PDFHummus::EStatusCode WriteArrayObject(PDFArray* inArray, ETokenSeparator inSeparator, IObjectWritePolicy* inWritePolicy);
 	PDFHummus::EStatusCode WriteDictionaryObject(PDFDictionary* inDictionary, IObjectWritePolicy* inWritePolicy);
 	PDFHummus::EStatusCode WriteStreamObject(PDFStreamInput* inStream, IObjectWritePolicy* inWritePolicy);
+	PDFHummus::EStatusCode WriteStreamObject(PDFStreamInput* inStream, IByteReader* inStreamReader, IObjectWritePolicy* inWritePolicy);
 
 
 	EStatusCodeAndObjectIDType CreatePDFPageForPage(unsigned long inPageIndex);
+	PDFHummus::EStatusCode AppendPDFPagesInRange(unsigned long inFirstPageIndex,unsigned long inLastPageIndex,ObjectIDTypeList& ioPageObjectIDs);
+
+	bool IsImportingInParallel();
+	PDFHummus::EStatusCode StartParallelImportParsers();
+	void StopParallelImportParsers();
+	void ResetObjectIDsMaps();
+	void PrefetchPagesObjects(unsigned long inFirstPageIndex,unsigned long inLastPageIndex);
+	void RegisterObjectsForPrefetch(PDFObject* inObject,ObjectIDTypeVector& ioObjectIDs);
 
 	PDFHummus::EStatusCode CopyPageContentToTargetPagePassthrough(PDFPage* inPage, PDFDictionary* inPageObject);
 	PDFHummus::EStatusCode CopyPageContentToTargetPageRecoded(PDFPage* inPage,PDFDictionary* inPageObject);
@@ -283,11 +318,6 @@ private:
 	PDFHummus::EStatusCode MergePageContentToTargetPage(PDFPage* inTargetPage,PDFDictionary* inSourcePage,const StringToStringMap& inMappedResourcesNames);
 	PDFHummus::EStatusCode WritePDFStreamInputToContentContext(PageContentContext* inContentContext,PDFStreamInput* inContentSource,const StringToStringMap& inMappedResourcesNames);
 	PDFHummus::EStatusCode WritePDFStreamInputToStream(IByteWriter* inTargetStream,PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames);
-	PDFHummus::EStatusCode ScanStreamForResourcesTokens(PDFStreamInput* inSourceStream,const StringToStringMap& inMappedResourcesNames,ResourceTokenMarkerList& outResourceMarkers);
-	PDFHummus::EStatusCode MergeAndReplaceResourcesTokens(	IByteWriter* inTargetStream,
-												PDFStreamInput* inSourceStream,
-												const StringToStringMap& inMappedResourcesNames,
-												const ResourceTokenMarkerList& inResourceMarkers);
 
 	EStatusCodeAndObjectIDTypeList CreateFormXObjectsFromPDFInContext(
 																		const PDFPageRange& inPageRange,
@@ -28,7 +28,7 @@ PDFFormXObject::PDFFormXObject(PDFHummus::DocumentContext* inDocumentContext,Obj
 	mXObjectID = inFormXObjectID;
 	mResourcesDictionaryID = inFormXObjectResourcesDictionaryID;
 	mContentStream = inXObjectStream;
-	mContentContext = new XObjectContentContext(inDocumentContext,this);	
+	mContentContext = inXObjectStream ? new XObjectContentContext(inDocumentContext,this) : NULL;
 }
 
 PDFFormXObject::~PDFFormXObject(void)
@@ -37,6 +37,7 @@ class PDFFormXObject
 {
 public:
 
+	// pass a NULL stream for a form that's already written. it will have no content context
 	PDFFormXObject(PDFHummus::DocumentContext* inDocumentContext,ObjectIDType inFormXObjectID,PDFStream* inXObjectStream,ObjectIDType inFormXObjectResourcesDictionaryID);
 	~PDFFormXObject(void);
 
@@ -19,10 +19,24 @@
    
 */
 #include "PDFName.h"
+#include "PDFNameAtoms.h"
 
 PDFName::PDFName(const std::string& inValue) : PDFObject(eType)
 {
-	mValue = inValue;
+	Setup(inValue.c_str(),inValue.size());
+}
+
+PDFName::PDFName(const char* inValue,size_t inLength) : PDFObject(eType)
+{
+	Setup(inValue,inLength);
+}
+
+void PDFName::Setup(const char* inValue,size_t inLength)
+{
+	mHash = HashValue(inValue,inLength);
+	mAtom = PDFNameAtoms::Find(inValue,inLength,mHash);
+	if(!mAtom)
+		mValue.assign(inValue,inLength);
 }
 
 PDFName::~PDFName(void)
@@ -31,10 +45,45 @@ PDFName::~PDFName(void)
 
 const std::string& PDFName::GetValue() const
 {
-	return mValue;
+	return mAtom ? *mAtom : mValue;
 }
 
 PDFName::operator std::string() const
 {
-	return mValue;
+	return GetValue();
+}
+
+size_t PDFName::GetHash() const
+{
+	return mHash;
+}
+
+bool PDFName::IsInterned() const
+{
+	return mAtom != NULL;
+}
+
+bool PDFName::Equals(const PDFName* inOther) const
+{
+	// interned names are equal only if they are the same atom. interned and non interned names are never equal
+	if(mAtom || inOther->mAtom)
+		return mAtom == inOther->mAtom;
+	return mHash == inOther->mHash && mValue == inOther->mValue;
+}
+
+size_t PDFName::HashValue(const char* inValue,size_t inLength)
+{
+	// FNV-1a
+	size_t hash = 2166136261U;
+	for(size_t i = 0; i < inLength; ++i)
+	{
+		hash ^= (unsigned char)inValue[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+size_t PDFName::HashValue(const std::string& inValue)
+{
+	return HashValue(inValue.c_str(),inValue.size());
 }
@@ -21,6 +21,7 @@
 #pragma once
 #include "PDFObject.h"
 
+#include <stddef.h>
 #include <string>
 
 
@@ -34,14 +35,29 @@ public:
 		eType = ePDFObjectName
 	};
 
-	// value must be the already interpreted name - no initial slash, and all special charachters (with # definition) interpreted
+	// value must be the already interpreted name - no initial slash, and all special charachters (with # definition) interpreted.
+	// standard PDF names are interned (see PDFNameAtoms), and don't allocate a string of their own
 	PDFName(const std::string& inValue);
+	PDFName(const char* inValue,size_t inLength);
 	virtual ~PDFName(void);
 
 	const std::string& GetValue() const;
 	operator std::string() const;
 
+	// hash of the name value, computed on construction
+	size_t GetHash() const;
+	bool IsInterned() const;
+	bool Equals(const PDFName* inOther) const;
+
+	static size_t HashValue(const char* inValue,size_t inLength);
+	static size_t HashValue(const std::string& inValue);
+
 private:
 
+	// interned value, or NULL if using mValue
+	const std::string* mAtom;
 	std::string mValue;
+	size_t mHash;
+
+	void Setup(const char* inValue,size_t inLength);
 };
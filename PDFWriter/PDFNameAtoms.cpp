@@ -0,0 +1,138 @@
+/*
+   Source File : PDFNameAtoms.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFNameAtoms.h"
+#include "PDFName.h"
+
+#include <string.h>
+#include <vector>
+
+static const char* scStandardNames[] = {
+	// general
+	"Type","Subtype","Length","Filter","DecodeParms","F","FFilter","FDecodeParms","DL","N","First","Extends",
+	"Size","Prev","Root","Info","ID","Encrypt","Index","W","XRefStm","XRef","ObjStm","Version","Extensions",
+	"Metadata","PieceInfo","LastModified","StructParents","StructParent","Name","Names","Dests","OpenAction","AA",
+	// filters
+	"FlateDecode","LZWDecode","ASCIIHexDecode","ASCII85Decode","RunLengthDecode","CCITTFaxDecode","DCTDecode",
+	"JBIG2Decode","JPXDecode","Crypt","Predictor","Colors","BitsPerComponent","Columns","EarlyChange","K",
+	"EncodedByteAlign","Rows","EndOfBlock","BlackIs1","DamagedRowsBeforeError","ColorTransform","JBIG2Globals",
+	// document structure
+	"Catalog","Pages","Page","Kids","Parent","Count","Outlines","PageLabels","PageLayout","PageMode","ViewerPreferences",
+	"AcroForm","StructTreeRoot","MarkInfo","Lang","Threads","URI","OCProperties","Perms","Legal","Requirements",
+	"Collection","NeedsRendering","Title","Author","Subject","Keywords","Creator","Producer","CreationDate","ModDate",
+	"Trapped","Next","Last","Dest","S","D","Nums","Limits",
+	// pages
+	"MediaBox","CropBox","BleedBox","TrimBox","ArtBox","BoxColorInfo","Contents","Rotate","Group","Thumb","B","Dur",
+	"Trans","Annots","UserUnit","VP","Tabs","TemplateInstantiated","PresSteps","Resources","ProcSet",
+	"PDF","Text","ImageB","ImageC","ImageI",
+	// resources
+	"ExtGState","ColorSpace","Pattern","Shading","XObject","Font","Properties",
+	// xobjects and images
+	"Image","Form","PS","FormType","BBox","Matrix","Ref","OPI","OC","Width","Height","Decode","Interpolate",
+	"ImageMask","Mask","SMask","SMaskInData","Alternates","Intent","Matte",
+	// color spaces
+	"DeviceGray","DeviceRGB","DeviceCMYK","CalGray","CalRGB","Lab","ICCBased","Indexed","Separation","DeviceN",
+	"WhitePoint","BlackPoint","Gamma","Range","Alternate","All","None",
+	// graphics state
+	"LW","LC","LJ","ML","RI","OP","op","OPM","BG","BG2","UCR","UCR2","TR","TR2","HT","FL","SM","SA","BM","CA","ca","AIS","TK",
+	"Normal","Multiply","Screen","Compatible",
+	// patterns and shadings
+	"PatternType","PaintType","TilingType","XStep","YStep","ShadingType","Coords","Domain","Function","Functions",
+	"FunctionType","C0","C1","Bounds","Encode","Background","AntiAlias","BitsPerCoordinate","BitsPerFlag",
+	// fonts
+	"Type0","Type1","MMType1","Type3","TrueType","CIDFontType0","CIDFontType2","BaseFont","FirstChar","LastChar",
+	"Widths","FontDescriptor","Encoding","ToUnicode","DescendantFonts","CIDSystemInfo","Registry","Ordering",
+	"Supplement","DW","W2","DW2","CIDToGIDMap","Identity","Identity-H","Identity-V","FontName","FontFamily",
+	"FontStretch","FontWeight","Flags","FontBBox","ItalicAngle","Ascent","Descent","Leading","CapHeight","XHeight",
+	"StemV","StemH","AvgWidth","MaxWidth","MissingWidth","FontFile","FontFile2","FontFile3","CharSet","Style","CIDSet",
+	"Length1","Length2","Length3","BaseEncoding","Differences","WinAnsiEncoding","MacRomanEncoding",
+	"MacExpertEncoding","StandardEncoding","CharProcs","FontMatrix","Type1C","CIDFontType0C","OpenType",
+	// annotations and forms
+	"Annot","Link","Widget","Rect","Border","BS","AP","AS","NM","M","H","Q","QuadPoints","Popup","Open","IRT","RC",
+	"A","Action","JavaScript","GoTo","GoToR","Launch","Fields","DR","DA","DV","V","FT","Ff","Btn","Tx","Ch","Sig",
+	"T","TU","TM","Opt","MK","XYZ","Fit","FitH","FitV","FitR","FitB",
+	// encryption
+	"Standard","R","O","U","P","CF","StmF","StrF","EFF","CFM","AuthEvent","EncryptMetadata","OE","UE","Identity",
+	"V2","AESV2","AESV3","DocOpen","Recipients",
+	// marked content
+	"MCID","Pg","Obj","StructElem","ParentTree","ParentTreeNextKey","RoleMap","ClassMap","Marked","Artifact","Span"
+};
+
+#define ATOMS_COUNT (sizeof(scStandardNames) / sizeof(scStandardNames[0]))
+
+class PDFNameAtomsTable
+{
+public:
+	PDFNameAtomsTable()
+	{
+		// index size is a power of 2 of at least 4 times the atoms count, so probing is short
+		size_t indexSize = 1;
+		while(indexSize < ATOMS_COUNT * 4)
+			indexSize*=2;
+		mIndex.assign(indexSize,0);
+		mNames.reserve(ATOMS_COUNT); // no reallocations, atoms addresses are stable
+		mHashes.reserve(ATOMS_COUNT);
+
+		for(size_t i = 0; i < ATOMS_COUNT; ++i)
+		{
+			size_t length = strlen(scStandardNames[i]);
+			size_t hash = PDFName::HashValue(scStandardNames[i],length);
+			if(Find(scStandardNames[i],length,hash)) // ignore repeats
+				continue;
+
+			mNames.push_back(std::string(scStandardNames[i],length));
+			mHashes.push_back(hash);
+
+			size_t mask = mIndex.size() - 1;
+			size_t slot = hash & mask;
+			while(mIndex[slot] != 0)
+				slot = (slot + 1) & mask;
+			mIndex[slot] = mNames.size();
+		}
+	}
+
+	const std::string* Find(const char* inName,size_t inLength,size_t inHash) const
+	{
+		size_t mask = mIndex.size() - 1;
+		for(size_t slot = inHash & mask; mIndex[slot] != 0; slot = (slot + 1) & mask)
+		{
+			size_t atomIndex = mIndex[slot] - 1;
+			if(mHashes[atomIndex] == inHash && 
+				mNames[atomIndex].size() == inLength && 
+				memcmp(mNames[atomIndex].c_str(),inName,inLength) == 0)
+				return &(mNames[atomIndex]);
+		}
+		return NULL;
+	}
+
+private:
+	std::vector<std::string> mNames;
+	std::vector<size_t> mHashes;
+	// holds atom index + 1, 0 for empty slots
+	std::vector<size_t> mIndex;
+};
+
+const std::string* PDFNameAtoms::Find(const char* inName,size_t inLength,size_t inHash)
+{
+	// initialized once, on first use. thread safe
+	static const PDFNameAtomsTable sTable;
+
+	return sTable.Find(inName,inLength,inHash);
+}
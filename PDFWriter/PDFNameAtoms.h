@@ -0,0 +1,39 @@
+/*
+   Source File : PDFNameAtoms.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+/*
+	Process wide table of standard PDF names (dictionary keys and common name values).
+	PDFName objects with these values share the table strings, instead of holding a copy of their own, 
+	and two interned names are equal if they point to the same string.
+	The table is built on first use and never changes later, so it's safe to use from multiple threads.
+*/
+
+class PDFNameAtoms
+{
+public:
+
+	// returns the interned string for the name, or NULL if it's not a standard name
+	static const std::string* Find(const char* inName,size_t inLength,size_t inHash);
+};
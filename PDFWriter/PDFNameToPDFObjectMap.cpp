@@ -0,0 +1,166 @@
+/*
+   Source File : PDFNameToPDFObjectMap.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFNameToPDFObjectMap.h"
+#include "PDFName.h"
+
+PDFNameToPDFObjectMap::PDFNameToPDFObjectMap(void)
+{
+}
+
+PDFNameToPDFObjectMap::~PDFNameToPDFObjectMap(void)
+{
+}
+
+PDFNameToPDFObjectMap::iterator PDFNameToPDFObjectMap::begin()
+{
+	return mValues.begin();
+}
+
+PDFNameToPDFObjectMap::iterator PDFNameToPDFObjectMap::end()
+{
+	return mValues.end();
+}
+
+PDFNameToPDFObjectMap::const_iterator PDFNameToPDFObjectMap::begin() const
+{
+	return mValues.begin();
+}
+
+PDFNameToPDFObjectMap::const_iterator PDFNameToPDFObjectMap::end() const
+{
+	return mValues.end();
+}
+
+size_t PDFNameToPDFObjectMap::size() const
+{
+	return mValues.size();
+}
+
+bool PDFNameToPDFObjectMap::empty() const
+{
+	return mValues.empty();
+}
+
+PDFNameToPDFObjectMap::iterator PDFNameToPDFObjectMap::find(const std::string& inName)
+{
+	return mValues.begin() + FindIndex(inName,PDFName::HashValue(inName));
+}
+
+PDFNameToPDFObjectMap::iterator PDFNameToPDFObjectMap::find(const PDFName* inKey)
+{
+	return mValues.begin() + FindIndex(inKey);
+}
+
+size_t PDFNameToPDFObjectMap::FindIndex(const std::string& inName,size_t inHash) const
+{
+	if(mHashIndex.empty())
+	{
+		for(size_t i = 0; i < mValues.size(); ++i)
+		{
+			if(mHashes[i] == inHash && mValues[i].first->GetValue() == inName)
+				return i;
+		}
+		return mValues.size();
+	}
+
+	// index size is a power of 2, and never full, so probing ends on an empty slot
+	size_t mask = mHashIndex.size() - 1;
+	for(size_t slot = inHash & mask; mHashIndex[slot] != 0; slot = (slot + 1) & mask)
+	{
+		size_t entryIndex = mHashIndex[slot] - 1;
+		if(mHashes[entryIndex] == inHash && mValues[entryIndex].first->GetValue() == inName)
+			return entryIndex;
+	}
+	return mValues.size();
+}
+
+size_t PDFNameToPDFObjectMap::FindIndex(const PDFName* inKey) const
+{
+	// same as string lookup, but with the key precomputed hash, and atoms compared by pointer
+	size_t hash = inKey->GetHash();
+
+	if(mHashIndex.empty())
+	{
+		for(size_t i = 0; i < mValues.size(); ++i)
+		{
+			if(mHashes[i] == hash && mValues[i].first->Equals(inKey))
+				return i;
+		}
+		return mValues.size();
+	}
+
+	size_t mask = mHashIndex.size() - 1;
+	for(size_t slot = hash & mask; mHashIndex[slot] != 0; slot = (slot + 1) & mask)
+	{
+		size_t entryIndex = mHashIndex[slot] - 1;
+		if(mHashes[entryIndex] == hash && mValues[entryIndex].first->Equals(inKey))
+			return entryIndex;
+	}
+	return mValues.size();
+}
+
+std::pair<PDFNameToPDFObjectMap::iterator,bool> PDFNameToPDFObjectMap::insert(const value_type& inValue)
+{
+	size_t existingIndex = FindIndex(inValue.first);
+	if(existingIndex != mValues.size())
+		return std::pair<iterator,bool>(mValues.begin() + existingIndex,false);
+
+	mValues.push_back(inValue);
+	mHashes.push_back(inValue.first->GetHash());
+
+	if(mValues.size() > PDF_NAME_MAP_HASH_THRESHOLD)
+	{
+		// keep the index at most half full
+		if(mHashIndex.size() < mValues.size() * 2)
+			RebuildHashIndex();
+		else
+			AddToHashIndex(mValues.size() - 1);
+	}
+
+	return std::pair<iterator,bool>(mValues.end() - 1,true);
+}
+
+void PDFNameToPDFObjectMap::AddToHashIndex(size_t inEntryIndex)
+{
+	size_t mask = mHashIndex.size() - 1;
+	size_t slot = mHashes[inEntryIndex] & mask;
+	while(mHashIndex[slot] != 0)
+		slot = (slot + 1) & mask;
+	mHashIndex[slot] = inEntryIndex + 1;
+}
+
+void PDFNameToPDFObjectMap::RebuildHashIndex()
+{
+	size_t indexSize = PDF_NAME_MAP_HASH_THRESHOLD * 4;
+	while(indexSize < mValues.size() * 4)
+		indexSize*= 2;
+
+	mHashIndex.assign(indexSize,0);
+	for(size_t i = 0; i < mValues.size(); ++i)
+		AddToHashIndex(i);
+}
+
+void PDFNameToPDFObjectMap::clear()
+{
+	mValues.clear();
+	mHashes.clear();
+	mHashIndex.clear();
+}
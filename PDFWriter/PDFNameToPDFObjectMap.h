@@ -0,0 +1,79 @@
+/*
+   Source File : PDFNameToPDFObjectMap.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+
+class PDFName;
+class PDFObject;
+
+/*
+	Dictionary entries container, for PDFDictionary.
+	Entries are kept in a vector, in insertion order, with the hash of each key name (precomputed by PDFName). lookup is a linear scan comparing hashes, 
+	which is fast for the small dictionaries that are common in PDFs. once the dictionary grows beyond PDF_NAME_MAP_HASH_THRESHOLD entries, 
+	an open addressing hash index is maintained for lookups.
+	Provides the map interface parts that MapIterator uses, so MapIterator<PDFNameToPDFObjectMap> works as before. 
+	The container does not hold references of its own, reference counting is the owner's responsibility.
+*/
+
+#define PDF_NAME_MAP_HASH_THRESHOLD 16
+
+class PDFNameToPDFObjectMap
+{
+public:
+	typedef PDFName* key_type;
+	typedef PDFObject* mapped_type;
+	typedef std::pair<PDFName*,PDFObject*> value_type;
+	typedef std::vector<value_type> ValueTypeVector;
+	typedef ValueTypeVector::iterator iterator;
+	typedef ValueTypeVector::const_iterator const_iterator;
+
+	PDFNameToPDFObjectMap(void);
+	~PDFNameToPDFObjectMap(void);
+
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+	size_t size() const;
+	bool empty() const;
+
+	iterator find(const std::string& inName);
+	iterator find(const PDFName* inKey);
+
+	// inserts the entry, if no entry with the same key exists. returns the entry with the key, and whether it was inserted
+	std::pair<iterator,bool> insert(const value_type& inValue);
+
+	void clear();
+
+private:
+	ValueTypeVector mValues;
+	std::vector<size_t> mHashes;
+	// open addressing index. holds entry index + 1, 0 for empty slots. empty while below the threshold
+	std::vector<size_t> mHashIndex;
+
+	size_t FindIndex(const std::string& inName,size_t inHash) const;
+	size_t FindIndex(const PDFName* inKey) const;
+	void AddToHashIndex(size_t inEntryIndex);
+	void RebuildHashIndex();
+};
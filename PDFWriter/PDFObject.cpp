@@ -19,6 +19,7 @@
    
 */
 #include "PDFObject.h"
+#include "PDFObjectArena.h"
 
 const char* PDFObject::scPDFObjectTypeLabel(int index) 
 {
@@ -40,6 +41,16 @@ const char* PDFObject::scPDFObjectTypeLabel(int index)
 	return labels[index];
 };
 
+void* PDFObject::operator new(size_t inSize)
+{
+	return PDFObjectArena::Allocate(inSize);
+}
+
+void PDFObject::operator delete(void* inMemory)
+{
+	PDFObjectArena::Deallocate(inMemory);
+}
+
 PDFObject::PDFObject(EPDFObjectType inType)
 {
 	mType = inType;
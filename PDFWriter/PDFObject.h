@@ -22,6 +22,7 @@
 
 #include "RefCountObject.h"
 
+#include <stddef.h>
 #include <string>
 #include <map>
 
@@ -51,6 +52,10 @@ public:
 	PDFObject(int inType); 
 	virtual ~PDFObject(void);
 
+	// objects are allocated from the thread active PDFObjectArena, if any [see PDFObjectArena.h]
+	static void* operator new(size_t inSize);
+	static void operator delete(void* inMemory);
+
 	EPDFObjectType GetType();
     
     static const char* scPDFObjectTypeLabel(int index);
@@ -0,0 +1,232 @@
+/*
+   Source File : PDFObjectArena.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFObjectArena.h"
+
+#include <new>
+#include <vector>
+#include <atomic>
+
+// each allocation is preceded by a header pointing at the chunk it came from, or NULL for heap allocations.
+// header size keeps the objects aligned to the maximal alignment
+#define ARENA_ALLOCATION_HEADER_SIZE 16
+#define ARENA_CHUNK_SIZE 64*1024
+// larger allocations go to the heap, so chunks are not wasted
+#define ARENA_MAX_ALLOCATION_SIZE 1024
+
+class PDFObjectArenaChunk;
+
+class PDFObjectArenaPool
+{
+public:
+	PDFObjectArenaPool()
+	{
+		// the arena holds a reference, till destroyed
+		mReferences = 1;
+		mLiveChunks = 0;
+		mCurrentChunk = NULL;
+		mCurrentPosition = 0;
+	}
+
+	// called only on the thread where the pool is active
+	void* Allocate(size_t inSize);
+
+	// called by the arena when destroyed
+	void ReleaseByArena();
+
+	// may be called from any thread, when a chunk memory is freed
+	void ChunkFreed()
+	{
+		--mLiveChunks;
+		Release();
+	}
+
+	size_t GetChunksCount()
+	{
+		return mLiveChunks.load();
+	}
+
+private:
+	// 1 for the arena, and 1 per chunk that was not freed yet
+	std::atomic<unsigned long> mReferences;
+	std::atomic<size_t> mLiveChunks;
+	PDFObjectArenaChunk* mCurrentChunk;
+	size_t mCurrentPosition;
+
+	void Release()
+	{
+		if(--mReferences == 0)
+			delete this;
+	}
+};
+
+/*
+	A chunk is freed as soon as it is not the pool current chunk, and all objects allocated from it are released.
+	So objects that are kept alive hold only the chunks they were allocated from, and not the whole arena memory.
+*/
+class PDFObjectArenaChunk
+{
+public:
+	static PDFObjectArenaChunk* Create(PDFObjectArenaPool* inPool)
+	{
+		return new (::operator new(ARENA_CHUNK_SIZE)) PDFObjectArenaChunk(inPool);
+	}
+
+	// the pool holds a reference while this is its current chunk
+	void AddRef()
+	{
+		++mReferences;
+	}
+
+	// may be called from any thread
+	void Release()
+	{
+		if(--mReferences == 0)
+		{
+			PDFObjectArenaPool* pool = mPool;
+			this->~PDFObjectArenaChunk();
+			::operator delete(this);
+			pool->ChunkFreed();
+		}
+	}
+
+	// true when no allocated objects are alive, only the pool reference. safe to check from the pool thread,
+	// as only it may add references
+	bool IsUnused()
+	{
+		return 1 == mReferences.load();
+	}
+
+	char* GetData()
+	{
+		return ((char*)this) + scHeaderSize;
+	}
+
+	static const size_t scHeaderSize = (sizeof(PDFObjectArenaPool*) + sizeof(std::atomic<unsigned long>) + ARENA_ALLOCATION_HEADER_SIZE - 1) & ~((size_t)ARENA_ALLOCATION_HEADER_SIZE - 1);
+	static const size_t scCapacity = ARENA_CHUNK_SIZE - scHeaderSize;
+
+private:
+	PDFObjectArenaChunk(PDFObjectArenaPool* inPool)
+	{
+		mPool = inPool;
+		mReferences = 1;
+	}
+
+	PDFObjectArenaPool* mPool;
+	std::atomic<unsigned long> mReferences;
+};
+
+void* PDFObjectArenaPool::Allocate(size_t inSize)
+{
+	// when all objects of the current chunk are released, start it over
+	if(mCurrentChunk && mCurrentChunk->IsUnused())
+		mCurrentPosition = 0;
+
+	if(!mCurrentChunk || mCurrentPosition + inSize > PDFObjectArenaChunk::scCapacity)
+	{
+		// leave the full chunk to its objects. it is freed when the last of them is released
+		if(mCurrentChunk)
+			mCurrentChunk->Release();
+		++mReferences;
+		++mLiveChunks;
+		mCurrentChunk = PDFObjectArenaChunk::Create(this);
+		mCurrentPosition = 0;
+	}
+
+	char* result = mCurrentChunk->GetData() + mCurrentPosition;
+	mCurrentPosition+= inSize;
+	mCurrentChunk->AddRef();
+	*((PDFObjectArenaChunk**)result) = mCurrentChunk;
+	return result;
+}
+
+void PDFObjectArenaPool::ReleaseByArena()
+{
+	if(mCurrentChunk)
+	{
+		mCurrentChunk->Release();
+		mCurrentChunk = NULL;
+	}
+	Release();
+}
+
+static thread_local PDFObjectArenaPool* sActivePool = NULL;
+
+PDFObjectArena::PDFObjectArena(void)
+{
+	mPool = new PDFObjectArenaPool();
+}
+
+PDFObjectArena::~PDFObjectArena(void)
+{
+	mPool->ReleaseByArena();
+}
+
+size_t PDFObjectArena::GetChunksCount()
+{
+	return mPool->GetChunksCount();
+}
+
+void* PDFObjectArena::Allocate(size_t inSize)
+{
+	size_t allocationSize = ARENA_ALLOCATION_HEADER_SIZE + ((inSize + ARENA_ALLOCATION_HEADER_SIZE - 1) & ~((size_t)ARENA_ALLOCATION_HEADER_SIZE - 1));
+	char* memory;
+	PDFObjectArenaPool* pool = (sActivePool && inSize <= ARENA_MAX_ALLOCATION_SIZE) ? sActivePool : NULL;
+
+	if(pool)
+	{
+		memory = (char*)pool->Allocate(allocationSize);
+	}
+	else
+	{
+		memory = (char*)::operator new(allocationSize);
+		*((PDFObjectArenaChunk**)memory) = NULL;
+	}
+
+	return memory + ARENA_ALLOCATION_HEADER_SIZE;
+}
+
+void PDFObjectArena::Deallocate(void* inMemory)
+{
+	if(!inMemory)
+		return;
+
+	char* memory = (char*)inMemory - ARENA_ALLOCATION_HEADER_SIZE;
+	PDFObjectArenaChunk* chunk = *((PDFObjectArenaChunk**)memory);
+
+	if(chunk)
+		chunk->Release();
+	else
+		::operator delete(memory);
+}
+
+PDFObjectArenaScope::PDFObjectArenaScope(PDFObjectArena* inArena)
+{
+	mActivated = inArena != NULL;
+	mPreviousPool = sActivePool;
+	if(mActivated)
+		sActivePool = inArena->mPool;
+}
+
+PDFObjectArenaScope::~PDFObjectArenaScope(void)
+{
+	if(mActivated)
+		sActivePool = mPreviousPool;
+}
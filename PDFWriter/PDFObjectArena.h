@@ -0,0 +1,76 @@
+/*
+   Source File : PDFObjectArena.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#pragma once
+
+#include <stddef.h>
+
+/*
+	Bulk memory for PDFObject allocations.
+	While a PDFObjectArenaScope is active on a thread, PDFObject instances created on that thread are allocated 
+	from the scope arena, by bumping a pointer in large chunks, instead of separately from the heap. 
+	Reference counting is unaffected - releasing an object runs its destructor as usual. Each chunk is freed once the arena moved on
+	to a newer chunk (or was destroyed) and all objects allocated from the chunk are released, so objects may safely outlive the arena (and scope),
+	while holding only the chunks they were allocated from. When all objects of the current chunk are released, it is reused for the following allocations.
+
+	usage:
+	PDFObjectArena arena;
+	{
+		PDFObjectArenaScope scope(&arena);
+		// parse objects...
+	}
+*/
+
+class PDFObjectArenaPool;
+
+class PDFObjectArena
+{
+public:
+	PDFObjectArena(void);
+	~PDFObjectArena(void);
+
+	// number of arena chunks that are not freed yet
+	size_t GetChunksCount();
+
+	// PDFObject memory management. allocates from the arena active on the current thread, or from the heap
+	static void* Allocate(size_t inSize);
+	static void Deallocate(void* inMemory);
+
+private:
+	friend class PDFObjectArenaScope;
+
+	PDFObjectArenaPool* mPool;
+
+	// no copying
+	PDFObjectArena(const PDFObjectArena&);
+	PDFObjectArena& operator=(const PDFObjectArena&);
+};
+
+class PDFObjectArenaScope
+{
+public:
+	// activates the arena for the current thread, till the scope ends. passing NULL does nothing
+	PDFObjectArenaScope(PDFObjectArena* inArena);
+	~PDFObjectArenaScope(void);
+
+private:
+	bool mActivated;
+	PDFObjectArenaPool* mPreviousPool;
+};
@@ -456,6 +456,10 @@ bool PDFObjectParser::IsName(const std::string& inToken)
 static const char scSharp = '#';
 PDFObject* PDFObjectParser::ParseName(const std::string& inToken)
 {
+	// names without hex codes are the token itself, sans the slash. create directly, to allow standard names interning without a temporary string
+	if(inToken.find(scSharp) == std::string::npos)
+		return new PDFName(inToken.c_str() + 1,inToken.size() - 1);
+
 	EStatusCode status = PDFHummus::eSuccess;
 	std::stringbuf stringBuffer;
 	BoolAndByte hexResult;
@@ -44,8 +44,10 @@
 #include "IPDFParserExtender.h"
 #include "InputDCTDecodeStream.h"
 #include "ArrayOfInputStreamsStream.h"
+#include "InputByteArrayStream.h"
 
 #include  <algorithm>
+#include <memory.h>
 using namespace PDFHummus;
 
 PDFParser::PDFParser(void)
@@ -59,6 +61,13 @@ PDFParser::PDFParser(void)
                                     // declared size. but i would like to allow files that do extend. as this is incompatible with the specs, i'll make
                                     // this boolean dendent. i will sometimes make it public so ppl can actually modify this policy. for now, it's internal
 	mObjectParser.SetDecryptionHelper(&mDecryptionHelper);
+	mDecodedObjectStreamsCacheSize = 0;
+	mDecodedObjectStreamsCacheLimit = DEFAULT_DECODED_OBJECT_STREAMS_CACHE_SIZE;
+	mObjectStreamsDecodingsCount = 0;
+	mParsedObjectsCacheLimit = 0;
+	mParsedObjectsCacheHits = 0;
+	mParsedObjectsCacheMisses = 0;
+	mObjectsArena = NULL;
 }
 
 PDFParser::~PDFParser(void)
@@ -80,6 +89,15 @@ void PDFParser::ResetParser()
 	for(; it != mObjectStreamsCache.end();++it)
 		delete[] it->second;
 	mObjectStreamsCache.clear();
+	ClearDecodedObjectStreamsCache();
+	mObjectStreamsDecodingsCount = 0;
+	ClearParsedObjectsCache();
+	mParsedObjectsCacheLimit = 0;
+	mParsedObjectsCacheHits = 0;
+	mParsedObjectsCacheMisses = 0;
+	// objects still referenced keep the arena memory till released
+	delete mObjectsArena;
+	mObjectsArena = NULL;
 	mDecryptionHelper.Reset();
 
 }
@@ -93,6 +111,10 @@ EStatusCode PDFParser::StartPDFParsing(IByteReaderWithPosition* inSourceStream,
 	mStream = inSourceStream;
 	mCurrentPositionProvider.Assign(mStream);
 	mObjectParser.SetReadStream(inSourceStream,&mCurrentPositionProvider);
+	mDecodedObjectStreamsCacheLimit = inOptions.DecodedObjectStreamsCacheSize;
+	// cached objects are all kept alive, so they would hold arena chunks for as long as they are cached. allocate from the heap instead
+	if(inOptions.AllocateObjectsFromArena && 0 == inOptions.ParsedObjectsCacheSize)
+		mObjectsArena = new PDFObjectArena();
 
 	do
 	{
@@ -121,6 +143,9 @@ EStatusCode PDFParser::StartPDFParsing(IByteReaderWithPosition* inSourceStream,
 		if (status != PDFHummus::eSuccess)
 			break;
 
+		// enable the parsed objects cache only once decryption is setup, so objects are cached in their final form
+		mParsedObjectsCacheLimit = inOptions.ParsedObjectsCacheSize;
+
 		if (IsEncrypted() && !IsEncryptionSupported())
 		{
 			// not parsing pages for encrypted docs that the lib cant decrypt.
@@ -695,6 +720,79 @@ double PDFParser::GetPDFLevel()
 }
 
 PDFObject* PDFParser::ParseNewObject(ObjectIDType inObjectId)
+{
+	// parsed objects are allocated from the parser arena, if using one
+	PDFObjectArenaScope arenaScope(mObjectsArena);
+
+	if(0 == mParsedObjectsCacheLimit)
+		return ParseNewUncachedObject(inObjectId);
+
+	ObjectIDTypeToCachedParsedObjectMap::iterator it = mParsedObjectsCache.find(inObjectId);
+	if(it != mParsedObjectsCache.end())
+	{
+		++mParsedObjectsCacheHits;
+		// mark as most recently used
+		mParsedObjectsUsage.splice(mParsedObjectsUsage.begin(),mParsedObjectsUsage,it->second.mUsagePosition);
+		it->second.mObject->AddRef();
+		return it->second.mObject;
+	}
+
+	++mParsedObjectsCacheMisses;
+	PDFObject* anObject = ParseNewUncachedObject(inObjectId);
+	if(anObject)
+		CacheParsedObject(inObjectId,anObject);
+	return anObject;
+}
+
+void PDFParser::CacheParsedObject(ObjectIDType inObjectId,PDFObject* inObject)
+{
+	// evict least recently used objects till there's room for the new one
+	while(mParsedObjectsCache.size() >= mParsedObjectsCacheLimit)
+	{
+		ObjectIDTypeToCachedParsedObjectMap::iterator it = mParsedObjectsCache.find(mParsedObjectsUsage.back());
+		it->second.mObject->Release();
+		mParsedObjectsCache.erase(it);
+		mParsedObjectsUsage.pop_back();
+	}
+
+	CachedParsedObject cachedObject;
+	mParsedObjectsUsage.push_front(inObjectId);
+	cachedObject.mObject = inObject;
+	cachedObject.mUsagePosition = mParsedObjectsUsage.begin();
+	inObject->AddRef(); // cache holds its own reference
+	mParsedObjectsCache.insert(ObjectIDTypeToCachedParsedObjectMap::value_type(inObjectId,cachedObject));
+}
+
+void PDFParser::ClearParsedObjectsCache()
+{
+	ObjectIDTypeToCachedParsedObjectMap::iterator it = mParsedObjectsCache.begin();
+	for(; it != mParsedObjectsCache.end();++it)
+		it->second.mObject->Release();
+	mParsedObjectsCache.clear();
+	mParsedObjectsUsage.clear();
+}
+
+unsigned long PDFParser::GetObjectStreamsDecodingsCount()
+{
+	return mObjectStreamsDecodingsCount;
+}
+
+unsigned long PDFParser::GetParsedObjectsCacheHits()
+{
+	return mParsedObjectsCacheHits;
+}
+
+unsigned long PDFParser::GetParsedObjectsCacheMisses()
+{
+	return mParsedObjectsCacheMisses;
+}
+
+PDFObjectArena* PDFParser::GetObjectsArena()
+{
+	return mObjectsArena;
+}
+
+PDFObject* PDFParser::ParseNewUncachedObject(ObjectIDType inObjectId)
 {
 	if(inObjectId >= mXrefSize)
 	{
@@ -1654,64 +1752,42 @@ EStatusCode PDFParser::ReadXrefSegmentValue(IByteReader* inSource,int inEntrySiz
 PDFObject* PDFParser::ParseExistingInDirectStreamObject(ObjectIDType inObjectId)
 {
 	// parsing an object in an object stream requires the following:
-	// 1. Setting the position to this object stream
-	// 2. Reading the stream First and N. store.
-	// 3. Creating a stream reader for the initial stream position and length, possibly decoding with flate
-	// 4. Read the stream header. store.
-	// 5. Jump to the right object position (or decode till its position)
-	// 6. Read the object
+	// 1. Getting the decoded object stream. either from the cache, or by decoding it now, which means:
+	//    1.1 Setting the position to this object stream
+	//    1.2 Reading the stream First and N. store.
+	//    1.3 Reading the whole stream into memory, possibly decoding with flate
+	// 2. Read the stream header. store.
+	// 3. Jump to the right object position in the decoded stream
+	// 4. Read the object
 
 	EStatusCode status = PDFHummus::eSuccess;
 	ObjectStreamHeaderEntry* objectStreamHeader;
-	IByteReader* objectSource = NULL;
-
-	InputStreamSkipperStream skipperStream;
-	ObjectIDType objectStreamID;
+	DecodedObjectStream decodedStream;
+	bool isCached = false;
+	InputByteArrayStream objectSource;
+	AdapterIByteReaderWithPositionToIReadPositionProvider objectSourcePositionProvider(&objectSource);
+	ObjectIDType objectStreamID = (ObjectIDType)mXrefTable[inObjectId].mObjectPosition;
 	PDFObject* anObject = NULL;
 
 	do
 	{
-		objectStreamID = (ObjectIDType)mXrefTable[inObjectId].mObjectPosition;
-		PDFObjectCastPtr<PDFStreamInput> objectStream(ParseNewObject(objectStreamID));
-		if(!objectStream)
-		{
-			TRACE_LOG2("PDFParser::ParseExistingInDirectStreamObject, failed to parse object %ld. failed to find object stream for it, which should be %ld",
-						inObjectId,mXrefTable[inObjectId].mObjectPosition);
-			status = PDFHummus::eFailure;
-			break;
-		}
-
-		RefCountPtr<PDFDictionary> streamDictionary(objectStream->QueryStreamDictionary());
-
-		PDFObjectCastPtr<PDFInteger> streamObjectsCount(QueryDictionaryObject(streamDictionary.GetPtr(),"N"));
-		if(!streamObjectsCount)
-		{
-			TRACE_LOG1("PDFParser::ParseExistingInDirectStreamObject, no N key in stream dictionary %ld",objectStreamID);
-			status = PDFHummus::eFailure;
-			break;
-		}
-		ObjectIDType objectsCount = (ObjectIDType)streamObjectsCount->GetValue();
-
-		PDFObjectCastPtr<PDFInteger> firstStreamObjectPosition(QueryDictionaryObject(streamDictionary.GetPtr(),"First"));
-		if(!streamObjectsCount)
+		status = AcquireDecodedObjectStream(objectStreamID,decodedStream,isCached);
+		if(status != PDFHummus::eSuccess)
 		{
-			TRACE_LOG1("PDFParser::ParseExistingInDirectStreamObject, no First key in stream dictionary %ld",objectStreamID);
-			status = PDFHummus::eFailure;
+			TRACE_LOG2("PDFParser::ParseExistingInDirectStreamObject, failed to parse object %ld. failed to read object stream for it, which should be %ld",
+						inObjectId,objectStreamID);
 			break;
 		}
 
-		objectSource = CreateInputStreamReader(objectStream.GetPtr());
-		skipperStream.Assign(objectSource);
-		MovePositionInStream(objectStream->GetStreamContentStart());
-
-		mObjectParser.SetReadStream(&skipperStream,&skipperStream);
+		objectSource.Assign(decodedStream.mSize > 0 ? &((*decodedStream.mData)[0]) : NULL,decodedStream.mSize);
+		mObjectParser.SetReadStream(&objectSource,&objectSourcePositionProvider);
 
 		ObjectIDTypeToObjectStreamHeaderEntryMap::iterator it = mObjectStreamsCache.find(objectStreamID);
 
 		if(it == mObjectStreamsCache.end())
 		{
-			objectStreamHeader = new ObjectStreamHeaderEntry[objectsCount];
-			status = ParseObjectStreamHeader(objectStreamHeader,objectsCount);
+			objectStreamHeader = new ObjectStreamHeaderEntry[decodedStream.mObjectsCount];
+			status = ParseObjectStreamHeader(objectStreamHeader,decodedStream.mObjectsCount);
 			if(status != PDFHummus::eSuccess)
 			{
 				delete[] objectStreamHeader;
@@ -1722,25 +1798,20 @@ PDFObject* PDFParser::ParseExistingInDirectStreamObject(ObjectIDType inObjectId)
 		objectStreamHeader = it->second;
 
 		// verify that i got the right object ID
-		if(objectsCount <= mXrefTable[inObjectId].mRivision || objectStreamHeader[mXrefTable[inObjectId].mRivision].mObjectNumber != inObjectId)
+		if(decodedStream.mObjectsCount <= mXrefTable[inObjectId].mRivision || objectStreamHeader[mXrefTable[inObjectId].mRivision].mObjectNumber != inObjectId)
 		{
 			TRACE_LOG2("PDFParser::ParseXrefFromXrefStream, wrong object. expecting to find object ID %ld, and found %ld",
 						inObjectId,
-						objectsCount <= mXrefTable[inObjectId].mRivision ?
+						decodedStream.mObjectsCount <= mXrefTable[inObjectId].mRivision ?
 							-1 :
 							objectStreamHeader[mXrefTable[inObjectId].mRivision].mObjectNumber);
 			status = PDFHummus::eFailure;
 			break;
 		}
 
-		// when parsing the header, should be at position already..so don't skip if already there [using GetCurrentPosition to see if parsed some]
-		if(mXrefTable[inObjectId].mRivision != 0 || skipperStream.GetCurrentPosition() == 0)
-		{
-			LongFilePositionType objectPositionInStream = objectStreamHeader[mXrefTable[inObjectId].mRivision].mObjectOffset +
-														  firstStreamObjectPosition->GetValue();
-			skipperStream.SkipTo(objectPositionInStream);
-			mObjectParser.ResetReadState();
-		}
+		// the decoded stream is in memory, so just jump to the object position
+		objectSource.SetPosition(objectStreamHeader[mXrefTable[inObjectId].mRivision].mObjectOffset + decodedStream.mFirstObjectPosition);
+		mObjectParser.ResetReadState();
 
 		mDecryptionHelper.PauseDecryption(); // objects within objects stream already enjoy the object stream protection, and so are no longer encrypted
 		NotifyIndirectObjectStart(inObjectId,0);
@@ -1752,9 +1823,133 @@ PDFObject* PDFParser::ParseExistingInDirectStreamObject(ObjectIDType inObjectId)
 
 	mObjectParser.SetReadStream(mStream,&mCurrentPositionProvider);
 
+	// streams too large for the cache are used just for this object
+	if(!isCached)
+		delete decodedStream.mData;
+
 	return anObject;
 }
 
+EStatusCode PDFParser::AcquireDecodedObjectStream(ObjectIDType inObjectStreamID,DecodedObjectStream& outDecodedStream,bool& outIsCached)
+{
+	ObjectIDTypeToDecodedObjectStreamMap::iterator it = mDecodedObjectStreamsCache.find(inObjectStreamID);
+
+	if(it != mDecodedObjectStreamsCache.end())
+	{
+		// mark as most recently used
+		mDecodedObjectStreamsUsage.splice(mDecodedObjectStreamsUsage.begin(),mDecodedObjectStreamsUsage,it->second.mUsagePosition);
+		outDecodedStream = it->second;
+		outIsCached = true;
+		return PDFHummus::eSuccess;
+	}
+
+	outIsCached = false;
+	EStatusCode status = DecodeObjectStream(inObjectStreamID,outDecodedStream);
+	if(status != PDFHummus::eSuccess)
+		return status;
+
+	if(mDecodedObjectStreamsCacheLimit > 0 && outDecodedStream.mSize <= mDecodedObjectStreamsCacheLimit)
+	{
+		CacheDecodedObjectStream(inObjectStreamID,outDecodedStream);
+		outIsCached = true;
+	}
+	return status;
+}
+
+#define OBJECT_STREAM_READ_BUFFER_SIZE 64*1024
+EStatusCode PDFParser::DecodeObjectStream(ObjectIDType inObjectStreamID,DecodedObjectStream& outDecodedStream)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	IByteReader* objectSource = NULL;
+
+	do
+	{
+		PDFObjectCastPtr<PDFStreamInput> objectStream(ParseNewObject(inObjectStreamID));
+		if(!objectStream)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, failed to find object stream %ld",inObjectStreamID);
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		RefCountPtr<PDFDictionary> streamDictionary(objectStream->QueryStreamDictionary());
+
+		PDFObjectCastPtr<PDFInteger> streamObjectsCount(QueryDictionaryObject(streamDictionary.GetPtr(),"N"));
+		if(!streamObjectsCount)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, no N key in stream dictionary %ld",inObjectStreamID);
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		PDFObjectCastPtr<PDFInteger> firstStreamObjectPosition(QueryDictionaryObject(streamDictionary.GetPtr(),"First"));
+		if(!firstStreamObjectPosition)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, no First key in stream dictionary %ld",inObjectStreamID);
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		objectSource = CreateInputStreamReader(objectStream.GetPtr());
+		if(!objectSource)
+		{
+			TRACE_LOG1("PDFParser::DecodeObjectStream, unable to create reader for object stream %ld",inObjectStreamID);
+			status = PDFHummus::eFailure;
+			break;
+		}
+		MovePositionInStream(objectStream->GetStreamContentStart());
+		++mObjectStreamsDecodingsCount;
+
+		// read straight into the buffer that is kept [and possibly cached], growing it as needed
+		std::vector<Byte>* decodedContent = new std::vector<Byte>();
+		while(objectSource->NotEnded())
+		{
+			size_t filledSize = decodedContent->size();
+			decodedContent->resize(filledSize + OBJECT_STREAM_READ_BUFFER_SIZE);
+			LongBufferSizeType readBytes = objectSource->Read(&((*decodedContent)[filledSize]),OBJECT_STREAM_READ_BUFFER_SIZE);
+			decodedContent->resize(filledSize + readBytes);
+			if(0 == readBytes)
+				break;
+		}
+
+		outDecodedStream.mData = decodedContent;
+		outDecodedStream.mSize = decodedContent->size();
+		outDecodedStream.mObjectsCount = (ObjectIDType)streamObjectsCount->GetValue();
+		outDecodedStream.mFirstObjectPosition = firstStreamObjectPosition->GetValue();
+	}while(false);
+
+	delete objectSource;
+	return status;
+}
+
+void PDFParser::CacheDecodedObjectStream(ObjectIDType inObjectStreamID,DecodedObjectStream& ioDecodedStream)
+{
+	// evict least recently used streams till there's room for the new one
+	while(!mDecodedObjectStreamsUsage.empty() && mDecodedObjectStreamsCacheSize + ioDecodedStream.mSize > mDecodedObjectStreamsCacheLimit)
+	{
+		ObjectIDTypeToDecodedObjectStreamMap::iterator it = mDecodedObjectStreamsCache.find(mDecodedObjectStreamsUsage.back());
+		mDecodedObjectStreamsCacheSize-= it->second.mSize;
+		delete it->second.mData;
+		mDecodedObjectStreamsCache.erase(it);
+		mDecodedObjectStreamsUsage.pop_back();
+	}
+
+	mDecodedObjectStreamsUsage.push_front(inObjectStreamID);
+	ioDecodedStream.mUsagePosition = mDecodedObjectStreamsUsage.begin();
+	mDecodedObjectStreamsCache.insert(ObjectIDTypeToDecodedObjectStreamMap::value_type(inObjectStreamID,ioDecodedStream));
+	mDecodedObjectStreamsCacheSize+= ioDecodedStream.mSize;
+}
+
+void PDFParser::ClearDecodedObjectStreamsCache()
+{
+	ObjectIDTypeToDecodedObjectStreamMap::iterator it = mDecodedObjectStreamsCache.begin();
+	for(; it != mDecodedObjectStreamsCache.end();++it)
+		delete it->second.mData;
+	mDecodedObjectStreamsCache.clear();
+	mDecodedObjectStreamsUsage.clear();
+	mDecodedObjectStreamsCacheSize = 0;
+}
+
 void PDFParser::NotifyIndirectObjectStart(long long inObjectID, long long inGenerationNumber) {
 	if (mParserExtender)
 		mParserExtender->OnObjectStart(inObjectID, inGenerationNumber);
@@ -30,8 +30,11 @@
 #include "AdapterIByteReaderWithPositionToIReadPositionProvider.h"
 #include "DecryptionHelper.h"
 #include "PDFParsingOptions.h"
+#include "PDFObjectArena.h"
 
 #include <map>
+#include <list>
+#include <vector>
 #include <utility>
 
 class PDFArray;
@@ -71,6 +74,32 @@ struct ObjectStreamHeaderEntry
 
 typedef std::map<ObjectIDType,ObjectStreamHeaderEntry*> ObjectIDTypeToObjectStreamHeaderEntryMap;
 
+typedef std::list<ObjectIDType> ObjectIDTypeList;
+
+struct DecodedObjectStream
+{
+	DecodedObjectStream(){mData = NULL;mSize = 0;mObjectsCount = 0;mFirstObjectPosition = 0;}
+
+	// fully decoded object stream content. owned by the cache when cached
+	std::vector<IOBasicTypes::Byte>* mData;
+	LongBufferSizeType mSize;
+	ObjectIDType mObjectsCount;
+	LongFilePositionType mFirstObjectPosition;
+	// position in recently-used list, for eviction
+	ObjectIDTypeList::iterator mUsagePosition;
+};
+
+typedef std::map<ObjectIDType,DecodedObjectStream> ObjectIDTypeToDecodedObjectStreamMap;
+
+struct CachedParsedObject
+{
+	PDFObject* mObject;
+	// position in recently-used list, for eviction
+	ObjectIDTypeList::iterator mUsagePosition;
+};
+
+typedef std::map<ObjectIDType,CachedParsedObject> ObjectIDTypeToCachedParsedObjectMap;
+
 class PDFParser
 {
 public:
@@ -97,10 +126,22 @@ public:
 	// IMPORTANT! All non "Get" prefix methods below return an object after calling AddRef (or at least make sure reference is added)
 	// to handle refcount use the RefCountPtr object, or just make sure to call Release when you are done.
 	
-	// Creates a new object, use smart pointers to control ownership
+	// Creates a new object, use smart pointers to control ownership.
+	// if PDFParsingOptions::ParsedObjectsCacheSize is set, a previously parsed instance may be returned instead
+	// of a new one. in that case parser extender object notifications will not be called again for it.
 	PDFObject* ParseNewObject(ObjectIDType inObjectId);
 	ObjectIDType GetObjectsCount();
 
+	// count of object streams decodings [each miss of the decoded object streams cache is a decoding]. counting since StartPDFParsing
+	unsigned long GetObjectStreamsDecodingsCount();
+
+	// parsed objects cache statistics. counting since StartPDFParsing
+	unsigned long GetParsedObjectsCacheHits();
+	unsigned long GetParsedObjectsCacheMisses();
+
+	// arena used for allocating parsed objects. NULL when not allocating from an arena [see PDFParsingOptions::AllocateObjectsFromArena]
+	PDFObjectArena* GetObjectsArena();
+
 	// Query a dictinary object, if indirect, go and fetch the indirect object and return it instead
 	// [if you want the direct dictionary value, use PDFDictionary::QueryDirectObject [will AddRef automatically]
 	PDFObject* QueryDictionaryObject(PDFDictionary* inDictionary,const std::string& inName);
@@ -178,6 +219,17 @@ private:
 	LongBufferSizeType mLastReadPositionFromEnd;
 	bool mEncounteredFileStart;
 	ObjectIDTypeToObjectStreamHeaderEntryMap mObjectStreamsCache;
+	ObjectIDTypeToDecodedObjectStreamMap mDecodedObjectStreamsCache;
+	ObjectIDTypeList mDecodedObjectStreamsUsage; // most recently used first
+	LongBufferSizeType mDecodedObjectStreamsCacheSize;
+	LongBufferSizeType mDecodedObjectStreamsCacheLimit;
+	unsigned long mObjectStreamsDecodingsCount;
+	ObjectIDTypeToCachedParsedObjectMap mParsedObjectsCache;
+	ObjectIDTypeList mParsedObjectsUsage; // most recently used first
+	unsigned long mParsedObjectsCacheLimit;
+	unsigned long mParsedObjectsCacheHits;
+	unsigned long mParsedObjectsCacheMisses;
+	PDFObjectArena* mObjectsArena;
 
 	double mPDFLevel;
 	LongFilePositionType mLastXrefPosition;
@@ -204,7 +256,10 @@ private:
                                                   ObjectIDType* outExtendedTableSize);
     XrefEntryInput* ExtendXrefTableToSize(XrefEntryInput* inXrefTable,ObjectIDType inOldSize,ObjectIDType inNewSize);
 	PDFHummus::EStatusCode ReadNextXrefEntry(Byte inBuffer[20]);
+	PDFObject* ParseNewUncachedObject(ObjectIDType inObjectId);
 	PDFObject*  ParseExistingInDirectObject(ObjectIDType inObjectID);
+	void CacheParsedObject(ObjectIDType inObjectId,PDFObject* inObject);
+	void ClearParsedObjectsCache();
 	PDFHummus::EStatusCode SetupDecryptionHelper(const std::string& inPassword);
 	PDFHummus::EStatusCode ParsePagesObjectIDs();
 	PDFHummus::EStatusCode ParsePagesIDs(PDFDictionary* inPageNode,ObjectIDType inNodeObjectID);
@@ -241,6 +296,10 @@ private:
                                           ObjectIDType* outExtendedTableSize);
 	PDFObject* ParseExistingInDirectStreamObject(ObjectIDType inObjectId);
 	PDFHummus::EStatusCode ParseObjectStreamHeader(ObjectStreamHeaderEntry* inHeaderInfo,ObjectIDType inObjectsCount);
+	PDFHummus::EStatusCode AcquireDecodedObjectStream(ObjectIDType inObjectStreamID,DecodedObjectStream& outDecodedStream,bool& outIsCached);
+	PDFHummus::EStatusCode DecodeObjectStream(ObjectIDType inObjectStreamID,DecodedObjectStream& outDecodedStream);
+	void CacheDecodedObjectStream(ObjectIDType inObjectStreamID,DecodedObjectStream& ioDecodedStream);
+	void ClearDecodedObjectStreamsCache();
 	void MovePositionInStream(LongFilePositionType inPosition);
 	EStatusCodeAndIByteReader CreateFilterForStream(IByteReader* inStream,PDFName* inFilterName,PDFDictionary* inDecodeParams, PDFStreamInput* inPDFStream);
 
@@ -20,7 +20,8 @@
 */
 #include "PDFParserTokenizer.h"
 #include "IByteReader.h"
-#include "OutputStringBufferStream.h"
+
+#include <memory.h>
 
 using namespace PDFHummus;
 using namespace IOBasicTypes;
@@ -38,6 +39,7 @@ PDFParserTokenizer::~PDFParserTokenizer(void)
 void PDFParserTokenizer::SetReadStream(IByteReader* inSourceStream)
 {
 	mStream = inSourceStream;
+	mDirectBufferSupported = true;
 	ResetReadState();
 }
 
@@ -46,6 +48,7 @@ void PDFParserTokenizer::ResetReadState()
 	mHasTokenBuffer = false;
 	mStreamPositionTracker = 0;
 	mRecentTokenPosition = 0;
+	mDirectBufferStart = mDirectBufferCurrent = mDirectBufferEnd = NULL;
 }
 
 
@@ -55,9 +58,10 @@ void PDFParserTokenizer::ResetReadState(const PDFParserTokenizer& inExternalToke
 	mHasTokenBuffer = inExternalTokenizer.mHasTokenBuffer;
 	mStreamPositionTracker = inExternalTokenizer.mStreamPositionTracker;
 	mRecentTokenPosition = inExternalTokenizer.mRecentTokenPosition;
+	mDirectBufferStart = mDirectBufferCurrent = mDirectBufferEnd = NULL;
 }
 
-static const Byte scBackSlash[] = {'\\'};
+static const Byte scBackSlash = '\\';
 static const std::string scStream = "stream";
 static const char scCR = '\r';
 static const char scLF = '\n';
@@ -65,7 +69,7 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 {
 	BoolAndString result;
 	Byte buffer;
-	OutputStringBufferStream tokenBuffer;
+	std::string tokenBuffer;
 	
 	if(!mStream || (!mStream->NotEnded() && !mHasTokenBuffer))
 	{
@@ -76,7 +80,8 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 	do
 	{
 		SkipTillToken();
-		if(!mStream->NotEnded())
+		// note that a saved token byte may still be pending even if the stream ended (e.g. "]" at the very end of an in-memory stream)
+		if(!StreamNotEnded() && !mHasTokenBuffer)
 		{
 			result.first = false;
 			break;
@@ -92,7 +97,7 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 			result.first = false;
 			break;
 		}
-		tokenBuffer.Write(&buffer,1);
+		tokenBuffer.push_back(buffer);
 
 		result.first = true; // will only be changed to false in case of read error
 
@@ -103,18 +108,18 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 			case '%':
 			{
 				// for a comment, the token goes on till the end of line marker [not including]
-				while(mStream->NotEnded())
+				while(StreamNotEnded())
 				{
 					if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 					{	
-						result.first = !mStream->NotEnded();
+						result.first = !StreamNotEnded();
 						break;
 					}
 					if(0xD == buffer|| 0xA == buffer)
 						break;
-					tokenBuffer.Write(&buffer,1);
+					tokenBuffer.push_back(buffer);
 				}
-				result.second = tokenBuffer.ToString();
+				result.second = tokenBuffer;
 				break;
 			}
 
@@ -123,11 +128,11 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 				// for a literal string, the token goes on until the balanced-closing right paranthesis
 				int balanceLevel = 1;
 				bool backSlashEncountered = false;
-				while(balanceLevel > 0 && mStream->NotEnded())
+				while(balanceLevel > 0 && StreamNotEnded())
 				{
 					if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 					{	
-						result.first = !mStream->NotEnded();
+						result.first = !StreamNotEnded();
 						break;
 					}
 			
@@ -138,11 +143,11 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						{
 							// ignore backslash and newline. might also need to read extra
 							// for cr-ln
-							if(0xD == buffer && mStream->NotEnded())
+							if(0xD == buffer && StreamNotEnded())
 							{
 								if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 								{
-									result.first = !mStream->NotEnded();
+									result.first = !StreamNotEnded();
 									break;
 								}
 								if(buffer != 0xA)
@@ -151,8 +156,8 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						}
 						else
 						{
-							tokenBuffer.Write(scBackSlash,1);					
-							tokenBuffer.Write(&buffer,1);
+							tokenBuffer.push_back(scBackSlash);					
+							tokenBuffer.push_back(buffer);
 						}
 					}
 					else
@@ -166,11 +171,11 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 							++balanceLevel;
 						else if(')' == buffer)
 							--balanceLevel;
-						tokenBuffer.Write(&buffer,1);
+						tokenBuffer.push_back(buffer);
 					}
 				}
 				if(result.first)
-					result.second = tokenBuffer.ToString();
+					result.second = tokenBuffer;
 				break;
 			}
 
@@ -179,77 +184,77 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 				// k. this might be a dictionary start marker or a hax string start. depending on whether it has a < following it or not
 
 				// Hex string, read till end of hex string marker
-				if(!mStream->NotEnded())
+				if(!StreamNotEnded())
 				{
-					result.second = tokenBuffer.ToString();
+					result.second = tokenBuffer;
 					break;
 				}
 
 				if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 				{	
-						result.first = !mStream->NotEnded();
+						result.first = !StreamNotEnded();
 						break;
 				}
 
 				if('<' == buffer)
 				{
 					// Dictionary start marker
-					tokenBuffer.Write(&buffer,1);
-					result.second = tokenBuffer.ToString();
+					tokenBuffer.push_back(buffer);
+					result.second = tokenBuffer;
 					break;
 				}
 				else
 				{
 					// Hex string 
 
-					tokenBuffer.Write(&buffer,1);
+					tokenBuffer.push_back(buffer);
 
-					while(mStream->NotEnded() && buffer != '>')
+					while(StreamNotEnded() && buffer != '>')
 					{
 						if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 						{	
-							result.first = !mStream->NotEnded();
+							result.first = !StreamNotEnded();
 							break;
 						}
 
 						if(!IsPDFWhiteSpace(buffer))
-							tokenBuffer.Write(&buffer,1);
+							tokenBuffer.push_back(buffer);
 					}
 				}
-				result.second = tokenBuffer.ToString();
+				result.second = tokenBuffer;
 				break;
 			}
 			case '[': // for all array or executable tokanizers, the tokanizer is just the mark
 			case ']':
 			case '{':
 			case '}':
-				result.second = tokenBuffer.ToString();
+				result.second = tokenBuffer;
 				break;
 			case '>': // parse end dictionary marker as a single entity or a hex string end marker
 			{
-				if(!mStream->NotEnded()) // this means a loose end string marker...wierd
+				if(!StreamNotEnded()) // this means a loose end string marker...wierd
 				{
-					result.second = tokenBuffer.ToString();
+					result.second = tokenBuffer;
 					break;
 				}
 
 				if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 				{	
-					result.first = !mStream->NotEnded();
+					result.first = !StreamNotEnded();
 					break;
 				}
 
 				if('>' == buffer)
 				{
-					tokenBuffer.Write(&buffer,1);
-					result.second = tokenBuffer.ToString();
+					tokenBuffer.push_back(buffer);
+					result.second = tokenBuffer;
 					break;
 				}
 				else
 				{
 					// hex string loose end
 					SaveTokenBuffer(buffer);
-					result.second = tokenBuffer.ToString();
+					result.second = tokenBuffer;
 					break;
 				}
 
@@ -258,11 +263,24 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 
 			default: // regular token. read till next breaker or whitespace
 			{
-				while(mStream->NotEnded())
+				while(StreamNotEnded())
 				{
+					// fast path - scan for the token end directly in the stream buffer, when it's available
+					if(!mHasTokenBuffer && mDirectBufferCurrent < mDirectBufferEnd)
+					{
+						const Byte* tokenEnd = mDirectBufferCurrent;
+						while(tokenEnd < mDirectBufferEnd && !IsPDFTokenEnd(*tokenEnd))
+							++tokenEnd;
+						tokenBuffer.append((const char*)mDirectBufferCurrent,tokenEnd - mDirectBufferCurrent);
+						mStreamPositionTracker+= tokenEnd - mDirectBufferCurrent;
+						mDirectBufferCurrent = tokenEnd;
+						if(tokenEnd == mDirectBufferEnd)
+							continue; // token may continue past this buffer
+					}
+
 					if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 					{	
-						result.first = !mStream->NotEnded();
+						result.first = !StreamNotEnded();
 						break;
 					}
 					if(IsPDFWhiteSpace(buffer))
@@ -275,11 +293,11 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						break;
 					}
 					else
-						tokenBuffer.Write(&buffer,1);
+						tokenBuffer.push_back(buffer);
 				}
-				result.second = tokenBuffer.ToString();
+				result.second = tokenBuffer;
 				
-				if(result.first && mStream->NotEnded() && scStream == result.second)
+				if(result.first && StreamNotEnded() && scStream == result.second)
 				{
 					// k. a bit of a special case here for streams. the reading changes after the keyword "stream", 
 					// essentially forcing the next content to start after either CR, CR-LF or LF. so there might be a little
@@ -288,9 +306,9 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 					// that we should either skip one more "LF" or do nothing (based on what was parsed)
 					
 					// verify that when whitespaces are finished buffer is either CR or LF, and behave accordingly
-					while(mStream->NotEnded()) {
+					while(StreamNotEnded()) {
 						if (!IsPDFWhiteSpace(buffer)) {
-							result.first = !mStream->NotEnded(); // something wrong! not whitespace
+							result.first = !StreamNotEnded(); // something wrong! not whitespace
 							break;
 						}
 
@@ -311,7 +329,7 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 						} // else - some other white space
 
 						if (GetNextByteForToken(buffer) != PDFHummus::eSuccess) {
-							result.first = !mStream->NotEnded(); //can't read but not eof. fail
+							result.first = !StreamNotEnded(); //can't read but not eof. fail
 							break;
 						}
 					}
@@ -323,7 +341,8 @@ BoolAndString PDFParserTokenizer::GetNextToken()
 
 	}while(false);
 
-
+	// bytes used from the stream buffer are consumed only now, so the stream position is right for whoever reads it next
+	FlushDirectBuffer();
 
 	return result;
 }
@@ -336,8 +355,18 @@ void PDFParserTokenizer::SkipTillToken()
 		return;
 
 	// skip till hitting first non space, or segment end
-	while(mStream->NotEnded())
+	while(StreamNotEnded())
 	{
+		// fast path - skip directly in the stream buffer. a non space is left there as the next byte to read
+		if(!mHasTokenBuffer && mDirectBufferCurrent < mDirectBufferEnd)
+		{
+			if(!IsPDFWhiteSpace(*mDirectBufferCurrent))
+				break;
+			++mDirectBufferCurrent;
+			++mStreamPositionTracker;
+			continue;
+		}
+
 		if(GetNextByteForToken(buffer) != PDFHummus::eSuccess)
 			break;
 
@@ -358,17 +387,89 @@ EStatusCode PDFParserTokenizer::GetNextByteForToken(Byte& outByte)
 		mHasTokenBuffer = false;
 		return PDFHummus::eSuccess;
 	}
+
+	if(mDirectBufferCurrent == mDirectBufferEnd)
+		RefillDirectBuffer();
+
+	if(mDirectBufferCurrent < mDirectBufferEnd)
+	{
+		outByte = *mDirectBufferCurrent;
+		++mDirectBufferCurrent;
+		return PDFHummus::eSuccess;
+	}
 	else
 		return (mStream->Read(&outByte,1) != 1) ? PDFHummus::eFailure:PDFHummus::eSuccess;
 }
 
-static const Byte scWhiteSpaces[] = {0,0x9,0xA,0xC,0xD,0x20};
+bool PDFParserTokenizer::StreamNotEnded()
+{
+	if(mDirectBufferCurrent < mDirectBufferEnd)
+		return true;
+
+	// make sure the stream knows about bytes already used from its buffer before asking it
+	FlushDirectBuffer();
+	return mStream->NotEnded();
+}
+
+void PDFParserTokenizer::RefillDirectBuffer()
+{
+	FlushDirectBuffer();
+	if(!mDirectBufferSupported)
+		return;
+
+	LongBufferSizeType availableSize;
+	mDirectBufferStart = mStream->PeekDirectBuffer(availableSize);
+	if(mDirectBufferStart)
+	{
+		mDirectBufferCurrent = mDirectBufferStart;
+		mDirectBufferEnd = mDirectBufferStart + availableSize;
+	}
+	else if(mStream->NotEnded())
+	{
+		// has more to read, but doesn't provide direct access. don't bother asking again
+		mDirectBufferSupported = false;
+	}
+}
+
+void PDFParserTokenizer::FlushDirectBuffer()
+{
+	if(mDirectBufferCurrent != mDirectBufferStart)
+		mStream->ConsumeDirectBuffer(mDirectBufferCurrent - mDirectBufferStart);
+	mDirectBufferStart = mDirectBufferCurrent = mDirectBufferEnd = NULL;
+}
+
+// character classes lookup table, for quick whitespace and delimiters checks
+static const Byte scWhiteSpaceClass = 1;
+static const Byte scEntityBreakerClass = 2;
+
+class PDFCharacterClasses
+{
+public:
+	PDFCharacterClasses()
+	{
+		static const Byte scWhiteSpaces[] = {0,0x9,0xA,0xC,0xD,0x20};
+		static const Byte scEntityBreakers[] = {'(',')','<','>',']','[','{','}','/','%'};
+
+		memset(mClasses,0,256);
+		for(int i=0; i < 6; ++i)
+			mClasses[scWhiteSpaces[i]]|= scWhiteSpaceClass;
+		for(int i=0; i < 10; ++i)
+			mClasses[scEntityBreakers[i]]|= scEntityBreakerClass;
+	}
+
+	Byte mClasses[256];
+};
+
+static const PDFCharacterClasses scCharacterClasses;
+
 bool PDFParserTokenizer::IsPDFWhiteSpace(Byte inCharacter)
 {
-	bool isWhiteSpace = false;
-	for(int i=0; i < 6 && !isWhiteSpace; ++i)
-		isWhiteSpace =  (scWhiteSpaces[i] == inCharacter);
-	return isWhiteSpace;
+	return (scCharacterClasses.mClasses[inCharacter] & scWhiteSpaceClass) != 0;
+}
+
+bool PDFParserTokenizer::IsPDFTokenEnd(Byte inCharacter)
+{
+	return scCharacterClasses.mClasses[inCharacter] != 0;
 }
 
 void PDFParserTokenizer::SaveTokenBuffer(Byte inToSave)
@@ -383,13 +484,9 @@ IOBasicTypes::LongFilePositionType PDFParserTokenizer::GetReadBufferSize()
 	return mHasTokenBuffer ? 1 : 0;
 }
 
-static const Byte scEntityBreakers[] = {'(',')','<','>',']','[','{','}','/','%'};
 bool PDFParserTokenizer::IsPDFEntityBreaker(Byte inCharacter)
 {
-	bool isEntityBreak = false;
-	for(int i=0; i < 10 && !isEntityBreak; ++i)
-		isEntityBreak =  (scEntityBreakers[i] == inCharacter);
-	return isEntityBreak;
+	return (scCharacterClasses.mClasses[inCharacter] & scEntityBreakerClass) != 0;
 }
 
 LongFilePositionType PDFParserTokenizer::GetRecentTokenPosition()
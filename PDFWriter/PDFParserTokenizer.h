@@ -80,6 +80,13 @@ private:
 	IOBasicTypes::LongFilePositionType mStreamPositionTracker;
 	IOBasicTypes::LongFilePositionType mRecentTokenPosition;
 
+	// direct access to the stream buffer, when the stream supports it [see IByteReader::PeekDirectBuffer].
+	// bytes between start and current were used, but not yet consumed from the stream
+	bool mDirectBufferSupported;
+	const IOBasicTypes::Byte* mDirectBufferStart;
+	const IOBasicTypes::Byte* mDirectBufferCurrent;
+	const IOBasicTypes::Byte* mDirectBufferEnd;
+
 
 	void SkipTillToken();
 
@@ -89,5 +96,11 @@ private:
 	bool IsPDFWhiteSpace(IOBasicTypes::Byte inCharacter);
 	void SaveTokenBuffer(IOBasicTypes::Byte inToSave);
 	bool IsPDFEntityBreaker(IOBasicTypes::Byte inCharacter);
+	// either whitespace or entity breaker
+	bool IsPDFTokenEnd(IOBasicTypes::Byte inCharacter);
+
+	bool StreamNotEnded();
+	void RefillDirectBuffer();
+	void FlushDirectBuffer();
 
 };
@@ -20,14 +20,42 @@ limitations under the License.
 */
 #pragma once
 
+#include "IOBasicTypes.h"
+
 #include <string>
 
+// default byte budget for keeping decoded object streams in memory [16MB]
+#define DEFAULT_DECODED_OBJECT_STREAMS_CACHE_SIZE 16*1024*1024
+
 struct PDFParsingOptions
 {
 	std::string Password;
 
-	PDFParsingOptions() {}
-	PDFParsingOptions(std::string inPassword) { Password = inPassword; }
+	// maximum amount of decoded object streams bytes the parser may keep in memory, so that
+	// objects in the same object stream don't require decoding the stream again. 0 disables caching.
+	IOBasicTypes::LongBufferSizeType DecodedObjectStreamsCacheSize;
+
+	// maximum number of parsed indirect objects the parser keeps for reuse. when set, repeated ParseNewObject calls
+	// for the same object ID return the same (shared) object, so callers should treat parsed objects as read only.
+	// 0 [default] disables caching.
+	unsigned long ParsedObjectsCacheSize;
+
+	// when the library opens the parsed file by itself (copying contexts, embedding PDF pages as forms, PDF images),
+	// read it through a memory mapping instead of buffered file reads. falls back on file reads if mapping fails.
+	bool MemoryMapInputFile;
+
+	// allocate objects parsed by ParseNewObject from an arena owned by the parser [see PDFObjectArena.h], instead of separately from the heap.
+	// objects may still outlive the parser, in which case the arena chunks they were allocated from are kept till they are released.
+	// ignored when ParsedObjectsCacheSize is set, as cached objects are kept alive anyways.
+	bool AllocateObjectsFromArena;
+
+	// when appending pages from a file (AppendPDFPagesFromPDF, or a copying context started with a file path), read the objects
+	// that the pages require with multiple threads, each with its own parser over the file. objects are still written in order, by the
+	// calling thread, so the result is the same as when importing serially. ignored when importing from a stream or with a parser extender.
+	bool ImportPagesInParallel;
+
+	PDFParsingOptions() { DecodedObjectStreamsCacheSize = DEFAULT_DECODED_OBJECT_STREAMS_CACHE_SIZE; ParsedObjectsCacheSize = 0; MemoryMapInputFile = false; AllocateObjectsFromArena = false; ImportPagesInParallel = false; }
+	PDFParsingOptions(std::string inPassword) { Password = inPassword; DecodedObjectStreamsCacheSize = DEFAULT_DECODED_OBJECT_STREAMS_CACHE_SIZE; ParsedObjectsCacheSize = 0; MemoryMapInputFile = false; AllocateObjectsFromArena = false; ImportPagesInParallel = false; }
 
 	static const PDFParsingOptions& DefaultPDFParsingOptions();
 };
\ No newline at end of file
@@ -28,10 +28,12 @@ PDFStream::PDFStream(bool inCompressStream,
 					 IByteWriterWithPosition* inOutputStream,
 					 EncryptionHelper* inEncryptionHelper,
 					 ObjectIDType inExtentObjectID,
-					 IObjectsContextExtender* inObjectsContextExtender)
+					 IObjectsContextExtender* inObjectsContextExtender,
+					 bool inDeferCompression)
 {
 	mExtender = inObjectsContextExtender;
 	mCompressStream = inCompressStream;
+	mDeferCompression = inCompressStream && inDeferCompression;
 	mExtendObjectID = inExtentObjectID;	
 	mStreamStartPosition = inOutputStream->GetCurrentPosition();
 	mOutputStream = inOutputStream;
@@ -46,7 +48,13 @@ PDFStream::PDFStream(bool inCompressStream,
     mStreamDictionaryContextForDirectExtentStream = NULL;
 
 
-	if(mCompressStream)
+	if(mDeferCompression)
+	{
+		// content is kept in memory, uncompressed. the objects context will have it compressed and written
+		mTemporaryOutputStream.Assign(&mTemporaryStream);
+		mWriteStream = &mTemporaryOutputStream;
+	}
+	else if(mCompressStream)
 	{
 		if(mExtender && mExtender->OverridesStreamCompression())
 		{
@@ -72,6 +80,7 @@ PDFStream::PDFStream(
 {
 	mExtender = inObjectsContextExtender;
 	mCompressStream = inCompressStream;
+	mDeferCompression = false;
 	mExtendObjectID = 0;	
 	mStreamStartPosition = 0;
 	mOutputStream = inOutputStream;
@@ -118,6 +127,14 @@ IByteWriter* PDFStream::GetWriteStream()
 
 void PDFStream::FinalizeStreamWrite()
 {
+	if(mDeferCompression)
+	{
+		// length is known only after compression
+		mWriteStream = NULL;
+		mOutputStream = NULL;
+		return;
+	}
+
 	if(mExtender && mExtender->OverridesStreamCompression() && mCompressStream)
 		mExtender->FinalizeCompressedStreamWrite(mWriteStream);
 	mWriteStream = NULL;
@@ -158,6 +175,16 @@ ObjectIDType PDFStream::GetExtentObjectID()
 	return mExtendObjectID;
 }
 
+bool PDFStream::IsCompressionDeferred()
+{
+	return mDeferCompression;
+}
+
+std::string PDFStream::GetDeferredCompressionContent()
+{
+	return mTemporaryStream.str();
+}
+
 DictionaryContext* PDFStream::GetStreamDictionaryForDirectExtentStream()
 {
     return mStreamDictionaryContextForDirectExtentStream;
@@ -50,7 +50,8 @@ public:
 		IByteWriterWithPosition* inOutputStream,
 		EncryptionHelper* inEncryptionHelper,
 		ObjectIDType inExtentObjectID,
-		IObjectsContextExtender* inObjectsContextExtender);
+		IObjectsContextExtender* inObjectsContextExtender,
+		bool inDeferCompression = false);
     
     PDFStream(
         bool inCompressStream,
@@ -78,8 +79,13 @@ public:
     DictionaryContext* GetStreamDictionaryForDirectExtentStream();
     void FlushStreamContentForDirectExtentStream();
 
+	// deferred compression specific. stream content is written uncompressed to memory, and compressed later by the objects context
+	bool IsCompressionDeferred();
+	std::string GetDeferredCompressionContent();
+
 private:
 	bool mCompressStream;
+	bool mDeferCompression;
 	OutputFlateEncodeStream mFlateEncodingStream;
 	IByteWriterWithPosition* mOutputStream;
 	IByteWriterWithPosition* mEncryptionStream;
@@ -123,6 +123,20 @@ EStatusCode PDFUsedFont::WriteFontDefinition()
         return mWrittenFont->WriteFontDefinition(mFaceWrapper, mEmbedFont);
 }
 
+void PDFUsedFont::NameEmbeddedFonts()
+{
+	if(mWrittenFont && mEmbedFont)
+		mWrittenFont->NameEmbeddedFonts(mFaceWrapper);
+}
+
+EStatusCode PDFUsedFont::PrepareEmbeddedFonts()
+{
+	if(!mWrittenFont || !mEmbedFont)
+		return eSuccess;
+	else
+		return mWrittenFont->PrepareEmbeddedFonts(mFaceWrapper);
+}
+
 EStatusCode PDFUsedFont::WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectID)
 {
 	inStateWriter->StartNewIndirectObject(inObjectID);
@@ -113,6 +113,11 @@ public:
 
 	PDFHummus::EStatusCode WriteFontDefinition();
 
+	// create the embedded font programs ahead of WriteFontDefinition, for subsetting fonts in parallel. see IWrittenFont.
+	// both do nothing if the font is not embedded
+	void NameEmbeddedFonts();
+	PDFHummus::EStatusCode PrepareEmbeddedFonts();
+
 	// use this method to translate text to glyphs and unicode mapping, to be later used for EncodeStringForShowing
 	PDFHummus::EStatusCode TranslateStringToGlyphs(const std::string& inText,GlyphUnicodeMappingList& outGlyphsUnicodeMapping);
 
@@ -60,6 +60,12 @@ EPDFVersion thisOrDefaultVersion(EPDFVersion inPDFVersion) {
 	return ePDFVersionUndefined == inPDFVersion ? ePDFVersion14 : inPDFVersion;
 }
 
+EPDFVersion thisOrObjectStreamsVersion(EPDFVersion inPDFVersion, const PDFCreationSettings& inPDFCreationSettings) {
+	// object streams are available from PDF 1.5
+	EPDFVersion version = thisOrDefaultVersion(inPDFVersion);
+	return (inPDFCreationSettings.WriteObjectStreams && version < ePDFVersion15) ? ePDFVersion15 : version;
+}
+
 EStatusCode PDFWriter::StartPDF(
 							const std::string& inOutputFilePath,
 							EPDFVersion inPDFVersion,
@@ -68,6 +74,7 @@ EStatusCode PDFWriter::StartPDF(
 {
 	SetupLog(inLogConfiguration);
 	SetupCreationSettings(inPDFCreationSettings);
+	mObjectsContext.SetWriteObjectStreams(inPDFCreationSettings.WriteObjectStreams);
 
 	EStatusCode status = mOutputFile.OpenFile(inOutputFilePath);
 	if(status != eSuccess)
@@ -77,7 +84,7 @@ EStatusCode PDFWriter::StartPDF(
 	mDocumentContext.SetOutputFileInformation(&mOutputFile);    
 
 	if (inPDFCreationSettings.DocumentEncryptionOptions.ShouldEncrypt) {
-		mDocumentContext.SetupEncryption(inPDFCreationSettings.DocumentEncryptionOptions, thisOrDefaultVersion(inPDFVersion));
+		mDocumentContext.SetupEncryption(inPDFCreationSettings.DocumentEncryptionOptions, thisOrObjectStreamsVersion(inPDFVersion,inPDFCreationSettings));
 		if (!mDocumentContext.SupportsEncryption()) {
 			mOutputFile.CloseFile(); // close the file, to keep things clean
 			return eFailure;
@@ -86,7 +93,7 @@ EStatusCode PDFWriter::StartPDF(
 
 	mIsModified = false;
 	
-	return mDocumentContext.WriteHeader(thisOrDefaultVersion(inPDFVersion));
+	return mDocumentContext.WriteHeader(thisOrObjectStreamsVersion(inPDFVersion,inPDFCreationSettings));
 }
 
 EStatusCode PDFWriter::EndPDF()
@@ -173,7 +180,12 @@ void PDFWriter::SetupLog(const LogConfiguration& inLogConfiguration)
 void PDFWriter::SetupCreationSettings(const PDFCreationSettings& inPDFCreationSettings)
 {
 	mObjectsContext.SetCompressStreams(inPDFCreationSettings.CompressStreams);
+	mObjectsContext.SetDoublePrecision(inPDFCreationSettings.DoublePrecision);
+	mObjectsContext.SetCompressStreamsInParallel(inPDFCreationSettings.CompressStreamsInParallel);
 	mDocumentContext.SetEmbedFonts(inPDFCreationSettings.EmbedFonts);
+	mDocumentContext.SetSubsetFontsInParallel(inPDFCreationSettings.SubsetFontsInParallel);
+	mDocumentContext.SetLoadFontsToMemory(inPDFCreationSettings.LoadFontsToMemory);
+	mDocumentContext.SetDeduplicateImages(inPDFCreationSettings.DeduplicateImages);
 }
 
 void PDFWriter::ReleaseLog()
@@ -265,11 +277,23 @@ PDFFormXObject* PDFWriter::CreateFormXObjectFromTIFFStream(IByteReaderWithPositi
 	return mDocumentContext.CreateFormXObjectFromTIFFStream(inTIFFStream,inFormXObjectID,inTIFFUsageParameters);
 }
 
+EStatusCodeAndPDFFormXObjectVector PDFWriter::CreateFormXObjectsFromTIFFFile(const std::string& inTIFFFilePath,
+															   const UIntVector& inPageIndexes,
+															   const TIFFUsageParameters& inTIFFUsageParameters)
+{
+	return mDocumentContext.CreateFormXObjectsFromTIFFFile(inTIFFFilePath,inPageIndexes,inTIFFUsageParameters);
+}
+
 #endif
 
 #ifndef PDFHUMMUS_NO_PNG
 PDFFormXObject* PDFWriter::CreateFormXObjectFromPNGFile(const std::string& inPNGFilePath) {
-	return CreateFormXObjectFromPNGFile(inPNGFilePath, mObjectsContext.GetInDirectObjectsRegistry().AllocateNewObjectID());
+	InputFile inputFile;
+	if (inputFile.OpenFile(inPNGFilePath) != eSuccess) {
+		return NULL;
+	}
+
+	return CreateFormXObjectFromPNGStream(inputFile.GetInputStream());
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromPNGFile(const std::string& inPNGFilePath, ObjectIDType inFormXObjectId) {
@@ -283,7 +307,7 @@ PDFFormXObject* PDFWriter::CreateFormXObjectFromPNGFile(const std::string& inPNG
 
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromPNGStream(IByteReaderWithPosition* inPNGStream) {
-	return CreateFormXObjectFromPNGStream(inPNGStream , mObjectsContext.GetInDirectObjectsRegistry().AllocateNewObjectID());
+	return mDocumentContext.CreateFormXObjectFromPNGStream(inPNGStream);
 }
 
 PDFFormXObject* PDFWriter::CreateFormXObjectFromPNGStream(IByteReaderWithPosition* inPNGStream, ObjectIDType inFormXObjectId) {
@@ -551,8 +575,9 @@ EStatusCode PDFWriter::StartPDFForStream(IByteWriterWithPosition* inOutputStream
 {
 	SetupLog(inLogConfiguration);
 	SetupCreationSettings(inPDFCreationSettings);
+	mObjectsContext.SetWriteObjectStreams(inPDFCreationSettings.WriteObjectStreams);
 	if (inPDFCreationSettings.DocumentEncryptionOptions.ShouldEncrypt) {
-		mDocumentContext.SetupEncryption(inPDFCreationSettings.DocumentEncryptionOptions, thisOrDefaultVersion(inPDFVersion));
+		mDocumentContext.SetupEncryption(inPDFCreationSettings.DocumentEncryptionOptions, thisOrObjectStreamsVersion(inPDFVersion,inPDFCreationSettings));
 		if (!mDocumentContext.SupportsEncryption())
 			return eFailure;
 	}
@@ -560,7 +585,7 @@ EStatusCode PDFWriter::StartPDFForStream(IByteWriterWithPosition* inOutputStream
 	mObjectsContext.SetOutputStream(inOutputStream);
     mIsModified = false;
 	
-	return mDocumentContext.WriteHeader(thisOrDefaultVersion(inPDFVersion));
+	return mDocumentContext.WriteHeader(thisOrObjectStreamsVersion(inPDFVersion,inPDFCreationSettings));
 }
 EStatusCode PDFWriter::EndPDFForStream()
 {
@@ -59,10 +59,29 @@ struct PDFCreationSettings
 	bool CompressStreams;
 	bool EmbedFonts;
 	EncryptionOptions DocumentEncryptionOptions;
+	// number of digits after the decimal point for written doubles (coordinates etc.). trailing zeros are trimmed
+	int DoublePrecision;
+	// compress streams (page contents etc.) with worker threads, while writing continues. output is the same
+	bool CompressStreamsInParallel;
+	// pack non stream objects into compressed object streams, and write a cross reference stream. new documents only. requires PDF 1.5, version is raised if lower
+	bool WriteObjectStreams;
+	// create embedded fonts subsets with worker threads, when writing the fonts at the end of the document. output is the same
+	bool SubsetFontsInParallel;
+	// map font files to memory once [or read them, when they can't be mapped], and open font faces from memory. the embedded font writers use the same bytes instead of reading the files again
+	bool LoadFontsToMemory;
+	// write an image only once when the same image data is used again (JPG, PNG and TIFF, from files or streams), reusing the written object.
+	// images are matched by their data and the parameters they are written with. the data of written images is kept till the end of the document
+	bool DeduplicateImages;
 
 	PDFCreationSettings(bool inCompressStreams, bool inEmbedFonts,EncryptionOptions inDocumentEncryptionOptions = EncryptionOptions::DefaultEncryptionOptions()):DocumentEncryptionOptions(inDocumentEncryptionOptions){ 
 		CompressStreams = inCompressStreams; 
 		EmbedFonts = inEmbedFonts;
+		DoublePrecision = DEFAULT_DOUBLE_PRECISION;
+		CompressStreamsInParallel = false;
+		WriteObjectStreams = false;
+		SubsetFontsInParallel = false;
+		LoadFontsToMemory = false;
+		DeduplicateImages = false;
 	}
 
 };
@@ -181,6 +200,11 @@ public:
 	PDFFormXObject* CreateFormXObjectFromTIFFStream(	IByteReaderWithPosition* inTIFFStream,
 													ObjectIDType inFormXObjectID,
 													const TIFFUsageParameters& inTIFFUsageParameters = TIFFUsageParameters::DefaultTIFFUsageParameters());
+	// convert multiple pages of a tiff file in parallel. forms are returned (and written) in the order of inPageIndexes.
+	// on failure, the forms of the pages written before the failing one are returned with the status [see TIFFImageHandler.h]
+	EStatusCodeAndPDFFormXObjectVector CreateFormXObjectsFromTIFFFile(const std::string& inTIFFFilePath,
+														const UIntVector& inPageIndexes,
+														const TIFFUsageParameters& inTIFFUsageParameters = TIFFUsageParameters::DefaultTIFFUsageParameters());
 #endif
 
 	// png
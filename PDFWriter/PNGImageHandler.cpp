@@ -34,11 +34,28 @@
 #include "OutputStringBufferStream.h"
 #include "InputStringBufferStream.h"
 #include "OutputStreamTraits.h"
+#include "OutputFlateEncodeStream.h"
 #include "SafeBufferMacrosDefs.h"
+#include "IByteReaderWithPosition.h"
 #include "png.h"
 
 #include <list>
+#include <vector>
+#include <string>
 #include <stdlib.h> 
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PNG_HANDLER_SSE2
+	#include <emmintrin.h>
+	#if defined(__SSSE3__) || defined(__AVX__)
+		#define PNG_HANDLER_SSSE3
+		#include <tmmintrin.h>
+	#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define PNG_HANDLER_NEON
+	#include <arm_neon.h>
+#endif
 
 using namespace PDFHummus;
 using namespace std;
@@ -73,11 +90,101 @@ static const std::string scDeviceGray = "DeviceGray";
 static const std::string scDeviceRGB = "DeviceRGB";
 static const std::string scBitsPerComponent = "BitsPerComponent";
 static const std::string scSMask = "SMask";
+static const std::string scIndexed = "Indexed";
+static const std::string scFilter = "Filter";
+static const std::string scFlateDecode = "FlateDecode";
+static const std::string scDecodeParms = "DecodeParms";
+static const std::string scPredictor = "Predictor";
+static const std::string scColors = "Colors";
+static const std::string scColumns = "Columns";
+
+/*
+	De-interleave a row of 8 bits samples with alpha (gray+alpha or rgb+alpha) to a color row and an alpha row.
+	Uses SIMD where available, per 16 pixels, and completes the rest of the row per pixel.
+*/
+static void SplitAlphaRow(const png_byte* inRow, png_uint_32 inWidth, png_byte inChannelsCount, png_bytep outColorRow, png_bytep outAlphaRow) {
+	png_uint_32 i = 0;
+
+	if (2 == inChannelsCount) {
+#if defined(PNG_HANDLER_SSE2)
+		const __m128i lowBytesMask = _mm_set1_epi16(0x00FF);
+		for (; i + 16 <= inWidth; i += 16) {
+			__m128i first = _mm_loadu_si128((const __m128i*)(inRow + i * 2));
+			__m128i second = _mm_loadu_si128((const __m128i*)(inRow + i * 2 + 16));
+			_mm_storeu_si128((__m128i*)(outColorRow + i), _mm_packus_epi16(_mm_and_si128(first, lowBytesMask), _mm_and_si128(second, lowBytesMask)));
+			_mm_storeu_si128((__m128i*)(outAlphaRow + i), _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8)));
+		}
+#elif defined(PNG_HANDLER_NEON)
+		for (; i + 16 <= inWidth; i += 16) {
+			uint8x16x2_t samples = vld2q_u8(inRow + i * 2);
+			vst1q_u8(outColorRow + i, samples.val[0]);
+			vst1q_u8(outAlphaRow + i, samples.val[1]);
+		}
+#endif
+		for (; i < inWidth; ++i) {
+			outColorRow[i] = inRow[i * 2];
+			outAlphaRow[i] = inRow[i * 2 + 1];
+		}
+	}
+	else {
+#if defined(PNG_HANDLER_SSE2)
+		// the last iteration stores 4 bytes beyond the 16 pixels color, so keep a margin of 2 pixels for it
+		for (; i + 18 <= inWidth; i += 16) {
+			const png_byte* source = inRow + i * 4;
+			__m128i samples[4];
+			for (int j = 0; j < 4; ++j)
+				samples[j] = _mm_loadu_si128((const __m128i*)(source + j * 16));
+
+			// alpha is the high byte of each pixel
+			__m128i alphaLow = _mm_packs_epi32(_mm_srli_epi32(samples[0], 24), _mm_srli_epi32(samples[1], 24));
+			__m128i alphaHigh = _mm_packs_epi32(_mm_srli_epi32(samples[2], 24), _mm_srli_epi32(samples[3], 24));
+			_mm_storeu_si128((__m128i*)(outAlphaRow + i), _mm_packus_epi16(alphaLow, alphaHigh));
+
+#if defined(PNG_HANDLER_SSSE3)
+			const __m128i colorShuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+			for (int j = 0; j < 4; ++j)
+				_mm_storeu_si128((__m128i*)(outColorRow + (i + j * 4) * 3), _mm_shuffle_epi8(samples[j], colorShuffle));
+#else
+			for (int j = 0; j < 16; ++j) {
+				outColorRow[(i + j) * 3] = source[j * 4];
+				outColorRow[(i + j) * 3 + 1] = source[j * 4 + 1];
+				outColorRow[(i + j) * 3 + 2] = source[j * 4 + 2];
+			}
+#endif
+		}
+#elif defined(PNG_HANDLER_NEON)
+		for (; i + 16 <= inWidth; i += 16) {
+			uint8x16x4_t samples = vld4q_u8(inRow + i * 4);
+			uint8x16x3_t color;
+			color.val[0] = samples.val[0];
+			color.val[1] = samples.val[1];
+			color.val[2] = samples.val[2];
+			vst3q_u8(outColorRow + i * 3, color);
+			vst1q_u8(outAlphaRow + i, samples.val[3]);
+		}
+#endif
+		for (; i < inWidth; ++i) {
+			outColorRow[i * 3] = inRow[i * 4];
+			outColorRow[i * 3 + 1] = inRow[i * 4 + 1];
+			outColorRow[i * 3 + 2] = inRow[i * 4 + 2];
+			outAlphaRow[i] = inRow[i * 4 + 3];
+		}
+	}
+}
+
 PDFImageXObject* CreateImageXObjectForData(png_structp png_ptr, png_infop info_ptr, png_bytep row, ObjectsContext* inObjectsContext) {
 	PDFImageXObjectList listOfImages;
 	PDFImageXObject* imageXObject = NULL;
 	PDFStream* imageStream = NULL;
 	EStatusCode status = eSuccess;
+	// alpha data is kept aside, compressed when possible, till the color image is done, and then written as the image soft mask
+	// (volatile, as they are set after setjmp, and freed after a possible longjmp)
+	png_bytep volatile colorRow = NULL;
+	png_bytep volatile alphaRow = NULL;
+	MyStringBuf alphaComponentsData;
+	OutputStringBufferStream alphaWriteStream(&alphaComponentsData);
+	OutputFlateEncodeStream alphaEncodeStream;
+	bool compressAlpha = inObjectsContext->IsCompressingStreams();
 
 	do
 	{
@@ -100,7 +207,6 @@ PDFImageXObject* CreateImageXObjectForData(png_structp png_ptr, png_infop info_p
 		bool isAlpha = (transformed_color_type & PNG_COLOR_MASK_ALPHA) != 0;
 		png_byte colorComponents = isAlpha ? (channels_count - 1) : channels_count;
 		ObjectIDType imageMaskObjectId = isAlpha ? inObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID():0;
-		MyStringBuf alphaComponentsData;
 
 		inObjectsContext->StartNewIndirectObject(imageXObjectObjectId);
 		DictionaryContext* imageContext = inObjectsContext->StartDictionary();
@@ -142,22 +248,24 @@ PDFImageXObject* CreateImageXObjectForData(png_structp png_ptr, png_infop info_p
 		png_uint_32 y = transformed_height;
 
 		if (isAlpha) {
-			OutputStringBufferStream alphaWriteStream(&alphaComponentsData);
+			colorRow = (png_bytep)malloc(transformed_width*colorComponents);
+			alphaRow = (png_bytep)malloc(transformed_width);
+			if (colorRow == NULL || alphaRow == NULL)
+				png_error(png_ptr, "OOM allocating row buffers");
+
+			alphaEncodeStream.Assign(&alphaWriteStream, compressAlpha);
 
 			while (y-- > 0) {
 				// read (using "rectangle" method)
 				png_read_row(png_ptr, NULL, row);
-				// write. iterate per sample, splitting color components and alpha
-				for (png_uint_32 i = 0; i < transformed_width; ++i) {
-					
-					// note that we're writing by color components, but multiply by channel...that's casue we're skipping alpha
-					writerStream->Write((IOBasicTypes::Byte*)(row + i*channels_count), colorComponents);
-					
-					// write out to alpha stream as well (hummfff i don't like this...but i like less to decode the png again....
-					// alpha is the last byte, so offset by color components
-					alphaWriteStream.Write((IOBasicTypes::Byte*)(row + i*channels_count + colorComponents), 1);
-				}
+				// split color components and alpha, and write each whole
+				SplitAlphaRow(row, transformed_width, channels_count, colorRow, alphaRow);
+				writerStream->Write((IOBasicTypes::Byte*)colorRow, transformed_width*colorComponents);
+				alphaEncodeStream.Write((IOBasicTypes::Byte*)alphaRow, transformed_width);
 			}
+
+			// finish alpha compression
+			alphaEncodeStream.Assign(NULL);
 		}
 		else {
 			while (y-- > 0) {
@@ -199,13 +307,19 @@ PDFImageXObject* CreateImageXObjectForData(png_structp png_ptr, png_infop info_p
 			imageMaskContext->WriteKey(scColorSpace);
 			imageMaskContext->WriteNameValue(scDeviceGray);
 
-			PDFStream* imageMaskStream = inObjectsContext->StartPDFStream(imageMaskContext);
+			// alpha samples are already encoded
+			if (compressAlpha) {
+				imageMaskContext->WriteKey(scFilter);
+				imageMaskContext->WriteNameValue(scFlateDecode);
+			}
+
+			PDFStream* imageMaskStream = inObjectsContext->StartUnfilteredPDFStream(imageMaskContext);
 			IByteWriter* writerMaskStream = imageMaskStream->GetWriteStream();
 
 			// write the alpha samples
-			InputStringBufferStream alphaWriteStream(&alphaComponentsData);
+			InputStringBufferStream alphaReadStream(&alphaComponentsData);
 			OutputStreamTraits traits(writerMaskStream);
-			traits.CopyToOutputStream(&alphaWriteStream);
+			traits.CopyToOutputStream(&alphaReadStream);
 
 			inObjectsContext->EndPDFStream(imageMaskStream);
 			delete imageMaskStream;
@@ -218,6 +332,10 @@ PDFImageXObject* CreateImageXObjectForData(png_structp png_ptr, png_infop info_p
 		delete imageXObject;
 		imageXObject = NULL;
 	}
+	// detach alpha stream, so it doesn't get deleted
+	alphaEncodeStream.Assign(NULL);
+	free(colorRow);
+	free(alphaRow);
 	delete imageStream;
 	return imageXObject;
 }
@@ -284,6 +402,202 @@ void HandlePngWarning(png_structp png_ptr, png_const_charp warning_message) {
 }
 
 
+/*
+	PNG passthrough. PNG image data (the concatenated IDAT chunks) is a zlib stream of rows, each prefixed with a PNG filter type byte. 
+	This is exactly what a PDF FlateDecode stream with a PNG predictor (/Predictor 15) holds, so when no transformation is required 
+	(no alpha or transparency, no interlacing, no 16 bits components) the data can be copied as is, skipping decoding and re-encoding.
+*/
+
+typedef std::pair<IOBasicTypes::LongFilePositionType, png_uint_32> LongFilePositionTypeAndPNGUInt32;
+typedef std::vector<LongFilePositionTypeAndPNGUInt32> LongFilePositionTypeAndPNGUInt32Vector;
+
+struct PNGPassthroughInfo
+{
+	png_uint_32 width;
+	png_uint_32 height;
+	png_byte bitDepth;
+	png_byte colorType;
+	std::string palette;
+	// position and length of each IDAT chunk data
+	LongFilePositionTypeAndPNGUInt32Vector dataChunks;
+};
+
+static const IOBasicTypes::Byte scPNGSignature[8] = { 0x89,0x50,0x4e,0x47,0x0d,0x0a,0x1a,0x0a };
+
+static bool ReadPNGUInt32(IByteReaderWithPosition* inPNGStream, png_uint_32& outValue) {
+	IOBasicTypes::Byte buffer[4];
+	if (inPNGStream->Read(buffer, 4) != 4)
+		return false;
+	outValue = ((png_uint_32)buffer[0] << 24) | ((png_uint_32)buffer[1] << 16) | ((png_uint_32)buffer[2] << 8) | (png_uint_32)buffer[3];
+	return true;
+}
+
+// reads the PNG chunks structure, and determines whether the image data can be passed through. returns false if not, or on any read failure
+static bool ReadPNGPassthroughInfo(IByteReaderWithPosition* inPNGStream, PNGPassthroughInfo& outInfo) {
+	IOBasicTypes::Byte signature[8];
+	if (inPNGStream->Read(signature, 8) != 8 || memcmp(signature, scPNGSignature, 8) != 0)
+		return false;
+
+	bool readHeader = false;
+	bool readEnd = false;
+	bool readingData = false;
+
+	while (!readEnd) {
+		png_uint_32 chunkLength;
+		IOBasicTypes::Byte chunkType[4];
+
+		if (!ReadPNGUInt32(inPNGStream, chunkLength) || chunkLength > PNG_UINT_31_MAX || inPNGStream->Read(chunkType, 4) != 4)
+			return false;
+
+		// header must be first
+		if (!readHeader && memcmp(chunkType, "IHDR", 4) != 0)
+			return false;
+
+		IOBasicTypes::LongFilePositionType chunkDataPosition = inPNGStream->GetCurrentPosition();
+
+		if (memcmp(chunkType, "IHDR", 4) == 0) {
+			IOBasicTypes::Byte header[5];
+			if (readHeader || chunkLength != 13 ||
+				!ReadPNGUInt32(inPNGStream, outInfo.width) ||
+				!ReadPNGUInt32(inPNGStream, outInfo.height) ||
+				inPNGStream->Read(header, 5) != 5)
+				return false;
+			outInfo.bitDepth = header[0];
+			outInfo.colorType = header[1];
+
+			// compression and filter methods must be the standard ones, and no interlacing
+			if (0 == outInfo.width || 0 == outInfo.height || header[2] != 0 || header[3] != 0 || header[4] != 0)
+				return false;
+
+			// no alpha, and no 16 bits components. gray and palette images can also be 1, 2 or 4 bits
+			bool supportedFormat =
+				(PNG_COLOR_TYPE_GRAY == outInfo.colorType && (1 == outInfo.bitDepth || 2 == outInfo.bitDepth || 4 == outInfo.bitDepth || 8 == outInfo.bitDepth)) ||
+				(PNG_COLOR_TYPE_PALETTE == outInfo.colorType && (1 == outInfo.bitDepth || 2 == outInfo.bitDepth || 4 == outInfo.bitDepth || 8 == outInfo.bitDepth)) ||
+				(PNG_COLOR_TYPE_RGB == outInfo.colorType && 8 == outInfo.bitDepth);
+			if (!supportedFormat)
+				return false;
+			readHeader = true;
+		}
+		else if (memcmp(chunkType, "PLTE", 4) == 0) {
+			if (chunkLength % 3 != 0 || chunkLength > 256 * 3)
+				return false;
+			if (PNG_COLOR_TYPE_PALETTE == outInfo.colorType) {
+				std::vector<char> palette(chunkLength);
+				if (chunkLength > 0 && inPNGStream->Read((IOBasicTypes::Byte*)&palette[0], chunkLength) != chunkLength)
+					return false;
+				outInfo.palette.assign(palette.begin(), palette.end());
+			}
+		}
+		else if (memcmp(chunkType, "tRNS", 4) == 0) {
+			// transparency requires an smask
+			return false;
+		}
+		else if (memcmp(chunkType, "IDAT", 4) == 0) {
+			// image data chunks must be consecutive
+			if (!outInfo.dataChunks.empty() && !readingData)
+				return false;
+			if (chunkLength > 0)
+				outInfo.dataChunks.push_back(LongFilePositionTypeAndPNGUInt32(chunkDataPosition, chunkLength));
+			readingData = true;
+		}
+		else {
+			if (memcmp(chunkType, "IEND", 4) == 0)
+				readEnd = true;
+			readingData = false;
+		}
+
+		// skip to next chunk (past the CRC). make sure that the chunk is complete
+		inPNGStream->SetPosition(chunkDataPosition + chunkLength + 4);
+		if (inPNGStream->GetCurrentPosition() != chunkDataPosition + chunkLength + 4)
+			return false;
+	}
+
+	return readHeader && !outInfo.dataChunks.empty() && (PNG_COLOR_TYPE_PALETTE != outInfo.colorType || !outInfo.palette.empty());
+}
+
+static PDFImageXObject* CreateImageXObjectForPNGPassthrough(IByteReaderWithPosition* inPNGStream, const PNGPassthroughInfo& inInfo, ObjectsContext* inObjectsContext) {
+	PDFImageXObject* imageXObject = NULL;
+
+	do
+	{
+		ObjectIDType imageXObjectObjectId = inObjectsContext->StartNewIndirectObject();
+		DictionaryContext* imageContext = inObjectsContext->StartDictionary();
+
+		// type
+		imageContext->WriteKey(scType);
+		imageContext->WriteNameValue(scXObject);
+
+		// subtype
+		imageContext->WriteKey(scSubType);
+		imageContext->WriteNameValue(scImage);
+
+		// Width
+		imageContext->WriteKey(scWidth);
+		imageContext->WriteIntegerValue(inInfo.width);
+
+		// Height
+		imageContext->WriteKey(scHeight);
+		imageContext->WriteIntegerValue(inInfo.height);
+
+		// Bits Per Component
+		imageContext->WriteKey(scBitsPerComponent);
+		imageContext->WriteIntegerValue(inInfo.bitDepth);
+
+		// Color Space
+		imageContext->WriteKey(scColorSpace);
+		if (PNG_COLOR_TYPE_PALETTE == inInfo.colorType) {
+			inObjectsContext->StartArray();
+			inObjectsContext->WriteName(scIndexed);
+			inObjectsContext->WriteName(scDeviceRGB);
+			inObjectsContext->WriteInteger(inInfo.palette.size() / 3 - 1);
+			inObjectsContext->WriteHexString(inInfo.palette);
+			inObjectsContext->EndArray(eTokenSeparatorEndLine);
+		}
+		else {
+			imageContext->WriteNameValue(PNG_COLOR_TYPE_GRAY == inInfo.colorType ? scDeviceGray : scDeviceRGB);
+		}
+
+		// Data is already flate encoded, with PNG predictors
+		imageContext->WriteKey(scFilter);
+		imageContext->WriteNameValue(scFlateDecode);
+
+		imageContext->WriteKey(scDecodeParms);
+		DictionaryContext* decodeParmsContext = inObjectsContext->StartDictionary();
+		decodeParmsContext->WriteKey(scPredictor);
+		decodeParmsContext->WriteIntegerValue(15);
+		decodeParmsContext->WriteKey(scColors);
+		decodeParmsContext->WriteIntegerValue(PNG_COLOR_TYPE_RGB == inInfo.colorType ? 3 : 1);
+		decodeParmsContext->WriteKey(scBitsPerComponent);
+		decodeParmsContext->WriteIntegerValue(inInfo.bitDepth);
+		decodeParmsContext->WriteKey(scColumns);
+		decodeParmsContext->WriteIntegerValue(inInfo.width);
+		inObjectsContext->EndDictionary(decodeParmsContext);
+
+		PDFStream* imageStream = inObjectsContext->StartUnfilteredPDFStream(imageContext);
+		OutputStreamTraits traits(imageStream->GetWriteStream());
+		EStatusCode status = eSuccess;
+
+		LongFilePositionTypeAndPNGUInt32Vector::const_iterator it = inInfo.dataChunks.begin();
+		for (; it != inInfo.dataChunks.end() && eSuccess == status; ++it) {
+			inPNGStream->SetPosition(it->first);
+			status = traits.CopyToOutputStream(inPNGStream, it->second);
+		}
+
+		inObjectsContext->EndPDFStream(imageStream);
+		delete imageStream;
+
+		if (status != eSuccess) {
+			TRACE_LOG("PNGImageHandler::CreateImageXObjectForPNGPassthrough, failed to copy image data");
+			break;
+		}
+
+		imageXObject = new PDFImageXObject(imageXObjectObjectId,
+			PNG_COLOR_TYPE_PALETTE == inInfo.colorType ? KProcsetImageI : (PNG_COLOR_TYPE_GRAY == inInfo.colorType ? KProcsetImageB : KProcsetImageC));
+	} while (false);
+
+	return imageXObject;
+}
+
 PDFFormXObject* CreateFormXObjectForPNGStream(IByteReaderWithPosition* inPNGStream, DocumentContext* inDocumentContext, ObjectsContext* inObjectsContext, ObjectIDType inFormXObjectID) {
 	// Start reading image to get dimension. we'll then create the form, and then the image
 	PDFFormXObject* formXObject = NULL;
@@ -293,6 +607,22 @@ PDFFormXObject* CreateFormXObjectForPNGStream(IByteReaderWithPosition* inPNGStre
 	png_structp png_ptr = NULL;
 	png_infop info_ptr = NULL;
 	png_bytep row = NULL;
+	PNGPassthroughInfo passthroughInfo;
+	IOBasicTypes::LongFilePositionType startPosition = inPNGStream->GetCurrentPosition();
+
+	// when possible, copy the image data as is
+	if (ReadPNGPassthroughInfo(inPNGStream, passthroughInfo)) {
+		imageXObject = CreateImageXObjectForPNGPassthrough(inPNGStream, passthroughInfo, inObjectsContext);
+		if (imageXObject) {
+			listOfImages.push_back(imageXObject);
+			formXObject = CreateImageFormXObjectFromImageXObject(listOfImages, inFormXObjectID, passthroughInfo.width, passthroughInfo.height, inDocumentContext);
+			delete imageXObject;
+			return formXObject;
+		}
+		// image writing failed half way, can't fall back
+		return NULL;
+	}
+	inPNGStream->SetPosition(startPosition);
 
 	do {
 		// init structs and prep 
@@ -0,0 +1,90 @@
+/*
+   Source File : PortableCryptoBackend.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "PortableCryptoBackend.h"
+#include "Trace.h"
+
+#include <limits.h>
+
+using namespace IOBasicTypes;
+
+PortableAESCipher::PortableAESCipher(void)
+{
+}
+
+PortableAESCipher::~PortableAESCipher(void)
+{
+}
+
+bool PortableAESCipher::SetKey(const Byte* inKey, size_t inKeyLength)
+{
+	return mEncrypt.key(inKey, (int)inKeyLength) == EXIT_SUCCESS && mDecrypt.key(inKey, (int)inKeyLength) == EXIT_SUCCESS;
+}
+
+bool PortableAESCipher::EncryptCBC(const Byte* inInput, Byte* outOutput, size_t inLength, Byte* ioIV)
+{
+	// LibAesgm takes int lengths, so go in parts for very large buffers
+	while (inLength > 0) {
+		size_t length = inLength > (size_t)(INT_MAX - AES_BLOCK_SIZE + 1) ? (size_t)(INT_MAX - AES_BLOCK_SIZE + 1) : inLength;
+		if (mEncrypt.cbc_encrypt(inInput, outOutput, (int)length, ioIV) != EXIT_SUCCESS)
+			return false;
+		inInput += length;
+		outOutput += length;
+		inLength -= length;
+	}
+	return true;
+}
+
+bool PortableAESCipher::DecryptCBC(const Byte* inInput, Byte* outOutput, size_t inLength, Byte* ioIV)
+{
+	while (inLength > 0) {
+		size_t length = inLength > (size_t)(INT_MAX - AES_BLOCK_SIZE + 1) ? (size_t)(INT_MAX - AES_BLOCK_SIZE + 1) : inLength;
+		if (mDecrypt.cbc_decrypt(inInput, outOutput, (int)length, ioIV) != EXIT_SUCCESS)
+			return false;
+		inInput += length;
+		outOutput += length;
+		inLength -= length;
+	}
+	return true;
+}
+
+PortableCryptoBackend::PortableCryptoBackend(void)
+{
+}
+
+PortableCryptoBackend::~PortableCryptoBackend(void)
+{
+}
+
+const char* PortableCryptoBackend::GetName()
+{
+	return "Portable";
+}
+
+IAESCipher* PortableCryptoBackend::CreateAESCipher(const Byte* inKey, size_t inKeyLength)
+{
+	PortableAESCipher* cipher = new PortableAESCipher();
+	if (!cipher->SetKey(inKey, inKeyLength)) {
+		TRACE_LOG1("PortableCryptoBackend::CreateAESCipher, failed to set AES key of length %ld", (long)inKeyLength);
+		delete cipher;
+		return NULL;
+	}
+	return cipher;
+}
@@ -0,0 +1,51 @@
+/*
+   Source File : PortableCryptoBackend.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ICryptoBackend.h"
+#include "aescpp.h"
+
+// AES with LibAesgm. works everywhere
+class PortableAESCipher : public IAESCipher
+{
+public:
+	PortableAESCipher(void);
+	virtual ~PortableAESCipher(void);
+
+	bool SetKey(const IOBasicTypes::Byte* inKey, size_t inKeyLength);
+
+	virtual bool EncryptCBC(const IOBasicTypes::Byte* inInput, IOBasicTypes::Byte* outOutput, size_t inLength, IOBasicTypes::Byte* ioIV);
+	virtual bool DecryptCBC(const IOBasicTypes::Byte* inInput, IOBasicTypes::Byte* outOutput, size_t inLength, IOBasicTypes::Byte* ioIV);
+
+private:
+	AESencrypt mEncrypt;
+	AESdecrypt mDecrypt;
+};
+
+class PortableCryptoBackend : public ICryptoBackend
+{
+public:
+	PortableCryptoBackend(void);
+	virtual ~PortableCryptoBackend(void);
+
+	virtual const char* GetName();
+	virtual IAESCipher* CreateAESCipher(const IOBasicTypes::Byte* inKey, size_t inKeyLength);
+};
@@ -24,12 +24,14 @@
 #include <locale>
 #include <sstream>
 #include <iomanip>
+#include <math.h>
 
 using namespace IOBasicTypes;
 
 PrimitiveObjectsWriter::PrimitiveObjectsWriter(IByteWriter* inStreamForWriting)
 {
 	mStreamForWriting = inStreamForWriting;
+	mDoublePrecision = DEFAULT_DOUBLE_PRECISION;
 }
 
 PrimitiveObjectsWriter::~PrimitiveObjectsWriter(void)
@@ -90,12 +92,29 @@ it is recommended but not required for characters whose codes are outside the ra
 	WriteTokenSeparator(inSeparate);
 }
 
+// writes the decimal digits of inValue backwards, ending right before inBufferEnd. returns the first digit position
+static char* FormatUnsignedBackwards(unsigned long long inValue,char* inBufferEnd)
+{
+	do
+	{
+		*--inBufferEnd = '0' + (char)(inValue % 10);
+		inValue/=10;
+	}while(inValue > 0);
+	return inBufferEnd;
+}
+
 void PrimitiveObjectsWriter::WriteInteger(long long inIntegerToken,ETokenSeparator inSeparate)
 {
-	char buffer[512];
+	char buffer[32];
+	char* bufferEnd = buffer + 32;
+
+	// negate as unsigned, so that the minimal value is fine as well
+	unsigned long long magnitude = inIntegerToken < 0 ? 0ULL - (unsigned long long)inIntegerToken : (unsigned long long)inIntegerToken;
+	char* start = FormatUnsignedBackwards(magnitude,bufferEnd);
+	if(inIntegerToken < 0)
+		*--start = '-';
 
-	SAFE_SPRINTF_1(buffer,512,"%lld",inIntegerToken);
-	mStreamForWriting->Write((const IOBasicTypes::Byte *)buffer,strlen(buffer));
+	mStreamForWriting->Write((const IOBasicTypes::Byte *)start,bufferEnd - start);
 	WriteTokenSeparator(inSeparate);
 }
 
@@ -142,18 +161,101 @@ void PrimitiveObjectsWriter::WriteLiteralString(const std::string& inString,ETok
 }
 
 void PrimitiveObjectsWriter::WriteDouble(double inDoubleToken,ETokenSeparator inSeparate)
+{
+	char buffer[64];
+	char* bufferEnd = buffer + 64;
+	char* start = FormatDouble(inDoubleToken,mDoublePrecision,bufferEnd);
+
+	if(start)
+	{
+		mStreamForWriting->Write((const IOBasicTypes::Byte *)start,bufferEnd - start);
+	}
+	else
+	{
+		// rare values which the fast formatting can't get exactly right. use the streams formatting
+		std::string result = FormatDoubleWithStream(inDoubleToken,mDoublePrecision);
+		mStreamForWriting->Write((const IOBasicTypes::Byte *)(result.c_str()),result.size());
+	}
+	WriteTokenSeparator(inSeparate);
+}
+
+static const int scMaxFastPrecision = 9;
+static const double scDoublePowersOfTen[scMaxFastPrecision+1] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9};
+static const unsigned long long scIntegerPowersOfTen[scMaxFastPrecision+1] = {1ULL,10ULL,100ULL,1000ULL,10000ULL,100000ULL,1000000ULL,10000000ULL,100000000ULL,1000000000ULL};
+// below this, the scaled value error is less than 1/512, so rounding is sure unless the fraction is very close to half
+static const double scFastScaledLimit = 1e12;
+static const double scRoundingUncertainty = 1.0/256;
+
+char* PrimitiveObjectsWriter::FormatDouble(double inDoubleToken,int inPrecision,char* inBufferEnd)
+{
+	if(inPrecision < 0 || inPrecision > scMaxFastPrecision)
+		return NULL;
+
+	// scale to an integer with inPrecision decimal digits. 10^inPrecision is exact, so the only error
+	// is the multiplication rounding
+	double scaled = fabs(inDoubleToken) * scDoublePowersOfTen[inPrecision];
+	if(!(scaled < scFastScaledLimit)) // also takes care of NaN and infinity
+		return NULL;
+
+	double integral = floor(scaled);
+	double fraction = scaled - integral;
+
+	// can't tell on which side of half the exact value is. leave it to exact formatting
+	if(fabs(fraction - 0.5) < scRoundingUncertainty)
+		return NULL;
+
+	unsigned long long rounded = (unsigned long long)integral + (fraction > 0.5 ? 1:0);
+	unsigned long long integerPart = rounded / scIntegerPowersOfTen[inPrecision];
+	unsigned long long fractionPart = rounded % scIntegerPowersOfTen[inPrecision];
+
+	char* start = inBufferEnd;
+
+	// fraction digits, without trailing zeros. no decimal point if there are none
+	if(fractionPart != 0)
+	{
+		int digitsCount = inPrecision;
+		while(fractionPart % 10 == 0)
+		{
+			fractionPart/=10;
+			--digitsCount;
+		}
+		for(int i=0;i<digitsCount;++i)
+		{
+			*--start = '0' + (char)(fractionPart % 10);
+			fractionPart/=10;
+		}
+		*--start = '.';
+	}
+
+	start = FormatUnsignedBackwards(integerPart,start);
+
+	// sign is kept also for values that round to 0 (including negative 0), same as the stream formatting does
+	if(inDoubleToken < 0 || (0 == inDoubleToken && 1/inDoubleToken < 0))
+		*--start = '-';
+
+	return start;
+}
+
+std::string PrimitiveObjectsWriter::FormatDoubleWithStream(double inDoubleToken,int inPrecision)
 {
 	// make sure we get proper decimal point writing
 	std::stringstream s;
 	// use classic locale for no worries writing
 	s.imbue(std::locale::classic());
-	s<<std::fixed<<inDoubleToken;
+	s<<std::fixed<<std::setprecision(inPrecision)<<inDoubleToken;
 	std::string result = s.str();
 
-	LongBufferSizeType sizeToWrite = DetermineDoubleTrimmedLength(result);
+	return result.substr(0,DetermineDoubleTrimmedLength(result));
+}
+
+void PrimitiveObjectsWriter::SetDoublePrecision(int inDoublePrecision)
+{
+	mDoublePrecision = inDoublePrecision;
+}
 
-	mStreamForWriting->Write((const IOBasicTypes::Byte *)(result.c_str()),sizeToWrite);
-	WriteTokenSeparator(inSeparate);
+int PrimitiveObjectsWriter::GetDoublePrecision()
+{
+	return mDoublePrecision;
 }
 
 size_t PrimitiveObjectsWriter::DetermineDoubleTrimmedLength(const std::string& inString)
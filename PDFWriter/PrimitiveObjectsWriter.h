@@ -24,7 +24,8 @@
 #include <string.h>
 #include <string>
 
-
+// number of digits after the decimal point when writing doubles, before trimming trailing zeros
+#define DEFAULT_DOUBLE_PRECISION 6
 
 class IByteWriter;
 
@@ -56,8 +57,19 @@ public:
     
     IByteWriter* GetWritingStream();
 
+	// doubles are written with this many digits after the decimal point (trailing zeros trimmed)
+	void SetDoublePrecision(int inDoublePrecision);
+	int GetDoublePrecision();
+
+	// double formatting, as used by WriteDouble. 
+	// FormatDouble writes the number backwards, ending right before inBufferEnd (make sure to have 64 bytes available),
+	// and returns the start position. it may return NULL for values that it can't format exactly, for which use FormatDoubleWithStream
+	static char* FormatDouble(double inDoubleToken,int inPrecision,char* inBufferEnd);
+	static std::string FormatDoubleWithStream(double inDoubleToken,int inPrecision);
+
 private:
 	IByteWriter* mStreamForWriting;
+	int mDoublePrecision;
 
-	size_t DetermineDoubleTrimmedLength(const std::string& inString);
+	static size_t DetermineDoubleTrimmedLength(const std::string& inString);
 };
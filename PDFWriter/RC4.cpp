@@ -33,14 +33,14 @@ RC4::RC4(const ByteList& inKey) {
 
 
 void RC4::Reset(const ByteList& inKey) {
-	Byte* buffer = new Byte[inKey.size()];
-	Byte* itBuffer = buffer;
+	// key scheduling only uses the first 256 bytes of the key, so no need for more
+	Byte buffer[256];
+	LongBufferSizeType length = 0;
 	ByteList::const_iterator it = inKey.begin();
-	for (; it != inKey.end(); ++it, ++itBuffer)
-		*itBuffer = *it;
+	for (; it != inKey.end() && length < 256; ++it, ++length)
+		buffer[length] = *it;
 
-	Init((const Byte*)buffer, inKey.size());
-	delete[] buffer;
+	Init(buffer, length);
 }
 
 
@@ -90,3 +90,22 @@ Byte RC4::GetNextEncodingByte() {
 Byte RC4::DecodeNextByte(Byte inByte) {
 	return inByte ^ GetNextEncodingByte();
 }
+
+void RC4::Xcode(const Byte* inBuffer, Byte* outBuffer, LongBufferSizeType inSize) {
+	// GetNextEncodingByte, with the state in locals
+	Byte i = (Byte)mI;
+	Byte j = (Byte)mJ;
+	Byte tmp;
+
+	for (LongBufferSizeType index = 0; index < inSize; ++index) {
+		i = i + 1;
+		j = j + mBuffer[i];
+		tmp = mBuffer[i];
+		mBuffer[i] = mBuffer[j];
+		mBuffer[j] = tmp;
+		outBuffer[index] = inBuffer[index] ^ mBuffer[(Byte)(mBuffer[i] + mBuffer[j])];
+	}
+
+	mI = i;
+	mJ = j;
+}
@@ -40,6 +40,9 @@ public:
 	IOBasicTypes::Byte DecodeNextByte(IOBasicTypes::Byte inByte);
 	IOBasicTypes::Byte GetNextEncodingByte();
 
+	// encode\decode a buffer. same as DecodeNextByte per byte. input and output may be the same buffer
+	void Xcode(const IOBasicTypes::Byte* inBuffer, IOBasicTypes::Byte* outBuffer, IOBasicTypes::LongBufferSizeType inSize);
+
 private:
 
 	IOBasicTypes::Byte mBuffer[256];
@@ -87,6 +87,8 @@
 #include "SafeBufferMacrosDefs.h"
 #include "IDocumentContextExtender.h"
 #include "IByteReaderWithPosition.h"
+#include "InputFile.h"
+#include "OutputStringBufferStream.h"
 
 // tiff lib includes
 #include "tiffconf.h"
@@ -94,6 +96,11 @@
 
 #include <stdlib.h> 
 #include <search.h>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <system_error>
+#include <algorithm>
 
 using namespace PDFHummus;
 
@@ -117,6 +124,8 @@ typedef enum{
 	T2P_COMPRESS_NONE=0x00
 	, T2P_COMPRESS_G4=0x01
 	, T2P_COMPRESS_ZIP=0x04
+	, T2P_COMPRESS_G3=0x08 /* only for passing through G3 and modified huffman data */
+	, T2P_COMPRESS_LZW=0x10 /* only for passing through LZW data */
 } t2p_compress_t;
 
 /* This type is whether TIFF image data can be used in PDF without transcoding. */
@@ -217,6 +226,8 @@ struct T2P{
 	uint16 tiff_compression;
 	uint16 tiff_photometric;
 	uint16 tiff_fillorder;
+	uint16 tiff_predictor;
+	uint32 tiff_g3options;
 	uint16 tiff_bitspersample;
 	uint16 tiff_samplesperpixel;
 	uint16 tiff_planar;
@@ -276,7 +287,7 @@ struct T2P{
 	TIFF* input;
 	TIFF* output;
 	std::string inputFilePath;
-	PDFStream* pdfStream;
+	IByteWriter* imageStream;
 	ObjectIDType pdf_transfer_functions_gstate;
 
 	T2P()
@@ -288,6 +299,8 @@ struct T2P{
 		tiff_compression = 0;
 		tiff_photometric = 0;
 		tiff_fillorder = 0;
+		tiff_predictor = PREDICTOR_NONE;
+		tiff_g3options = 0;
 		tiff_bitspersample = 0;
 		tiff_samplesperpixel = 0;
 		tiff_planar = 0;
@@ -343,7 +356,7 @@ struct T2P{
 
 		input = 0;
 		output = 0;
-		pdfStream = 0;
+		imageStream = 0;
 		pdf_transfer_functions_gstate = 0;
 	}
 
@@ -381,16 +394,21 @@ TIFFImageHandler::TIFFImageHandler():mUserParameters(TIFFUsageParameters::Defaul
 {
 	mT2p = NULL;
 	mExtender = NULL;
+	mObjectsContext = NULL;
+	mContainerDocumentContext = NULL;
+	mPreparedPageInput = NULL;
 }
 
 TIFFImageHandler::~TIFFImageHandler(void)
 {
 	DestroyConversionState();
+	DestroyPreparedPage();
 }
 
 void TIFFImageHandler::Reset()
 {
 	DestroyConversionState();
+	DestroyPreparedPage();
 	mT2p = NULL;
 	mExtender = NULL;
 }
@@ -466,10 +484,15 @@ void TIFFImageHandler::DestroyConversionState()
 
 PDFFormXObject* TIFFImageHandler::ConvertTiff2PDF(ObjectIDType inFormXObjectID)
 {
-	PDFFormXObject* imageFormXObject = NULL;
+	if(ReadTIFFPage() != PDFHummus::eSuccess)
+		return NULL;
+
+	return WriteTIFFPage(inFormXObjectID);
+}
+
+EStatusCode TIFFImageHandler::ReadTIFFPage()
+{
 	EStatusCode status;
-	PDFImageXObjectList imagesImageXObject;
-	PDFImageXObject* anImage;
 
 	do
 	{
@@ -488,9 +511,22 @@ PDFFormXObject* TIFFImageHandler::ConvertTiff2PDF(ObjectIDType inFormXObjectID)
 			break;
 		}
 		status = ReadTIFFPageInformation();
-		if(status != PDFHummus::eSuccess)
-			break;
-		
+	}while(false);
+
+	return status;
+}
+
+PDFFormXObject* TIFFImageHandler::WriteTIFFPage(ObjectIDType inFormXObjectID)
+{
+	PDFFormXObject* imageFormXObject = NULL;
+	EStatusCode status = PDFHummus::eSuccess;
+	PDFImageXObjectList imagesImageXObject;
+	PDFImageXObject* anImage;
+
+	do
+	{
+		if(mUserParameters.OutImageDataPath)
+			*(mUserParameters.OutImageDataPath) = (T2P_TRANSCODE_RAW == mT2p->pdf_transcode) ? eTIFFImageDataPassedThrough:eTIFFImageDataReencoded;
 
 		// Write Transfer functions
 		if(mT2p->tiff_transferfunctioncount != 0)
@@ -1076,30 +1112,52 @@ EStatusCode TIFFImageHandler::ReadTIFFPageInformation() //t2p_read_tiff_data
 		ComposePDFPage();
 
 		mT2p->pdf_transcode = T2P_TRANSCODE_ENCODE;
-		if(mT2p->pdf_nopassthrough==0)
+		if(mT2p->pdf_nopassthrough==0 && mUserParameters.UsePassthrough && mT2p->pdf_sample==T2P_SAMPLE_NOTHING)
 		{
-			if(mT2p->tiff_compression==COMPRESSION_CCITTFAX4)
-			{
-				if(TIFFIsTiled(mT2p->input) || (TIFFNumberOfStrips(mT2p->input)==1) )
-				{
-					mT2p->pdf_transcode = T2P_TRANSCODE_RAW;
-					mT2p->pdf_compression=T2P_COMPRESS_G4;
-				}
-			}
-			if(mT2p->tiff_compression== COMPRESSION_ADOBE_DEFLATE 
-				|| mT2p->tiff_compression==COMPRESSION_DEFLATE)
+			// compressed data is copied as is when there's a matching PDF filter. the data of multiple strips can be
+			// joined only for G3, where each row starts with an EOL, and modified huffman, where each row is byte aligned
+			bool singleStrip = TIFFIsTiled(mT2p->input) || (TIFFNumberOfStrips(mT2p->input)==1);
+
+			switch(mT2p->tiff_compression)
 			{
-				if(TIFFIsTiled(mT2p->input) || (TIFFNumberOfStrips(mT2p->input)==1) )
-				{
+				case COMPRESSION_CCITTFAX4:
+					if(singleStrip)
+					{
+						mT2p->pdf_transcode = T2P_TRANSCODE_RAW;
+						mT2p->pdf_compression=T2P_COMPRESS_G4;
+					}
+					break;
+				case COMPRESSION_CCITTFAX3:
+					TIFFGetFieldDefaulted(mT2p->input, TIFFTAG_GROUP3OPTIONS, &(mT2p->tiff_g3options));
+					if((mT2p->tiff_g3options & GROUP3OPT_UNCOMPRESSED) == 0 && 
+						(singleStrip || !G3StripsEndWithRTC()))
+					{
+						mT2p->pdf_transcode = T2P_TRANSCODE_RAW;
+						mT2p->pdf_compression=T2P_COMPRESS_G3;
+					}
+					break;
+				case COMPRESSION_CCITTRLE:
 					mT2p->pdf_transcode = T2P_TRANSCODE_RAW;
-					mT2p->pdf_compression=T2P_COMPRESS_ZIP;
-				}
+					mT2p->pdf_compression=T2P_COMPRESS_G3;
+					break;
+				case COMPRESSION_ADOBE_DEFLATE:
+				case COMPRESSION_DEFLATE:
+				case COMPRESSION_LZW:
+					if(singleStrip && CanPassthroughPredictedData())
+					{
+						mT2p->pdf_transcode = T2P_TRANSCODE_RAW;
+						mT2p->pdf_compression= (COMPRESSION_LZW == mT2p->tiff_compression) ? T2P_COMPRESS_LZW:T2P_COMPRESS_ZIP;
+						// PDF predictor 2 is the TIFF horizontal predictor
+						mT2p->pdf_compressionquality = (PREDICTOR_HORIZONTAL == mT2p->tiff_predictor) ? PREDICTOR_HORIZONTAL:0;
+					}
+					break;
 			}
 		}
 
 		if(mT2p->pdf_transcode!=T2P_TRANSCODE_RAW)
 		{
 			mT2p->pdf_compression = mT2p->pdf_defaultcompression;
+			mT2p->pdf_compressionquality = mT2p->pdf_defaultcompressionquality;
 		}
 
 		if(mT2p->pdf_sample & T2P_SAMPLE_REALIZE_PALETTE)
@@ -1187,7 +1245,8 @@ EStatusCode TIFFImageHandler::ReadTIFFPageInformation() //t2p_read_tiff_data
 		}
 		
 		if( mT2p->tiff_bitspersample==1 &&
-			mT2p->tiff_samplesperpixel==1)
+			mT2p->tiff_samplesperpixel==1 &&
+			mT2p->pdf_transcode!=T2P_TRANSCODE_RAW)
 		{
 			mT2p->pdf_compression = T2P_COMPRESS_G4;
 		}
@@ -1196,6 +1255,98 @@ EStatusCode TIFFImageHandler::ReadTIFFPageInformation() //t2p_read_tiff_data
 	return status;
 }
 
+bool TIFFImageHandler::CanPassthroughPredictedData()
+{
+	TIFFGetFieldDefaulted(mT2p->input, TIFFTAG_PREDICTOR, &(mT2p->tiff_predictor));
+
+	// PDF reads multi byte samples as big endian, and only has the TIFF horizontal predictor for 8 bit samples
+	if(mT2p->tiff_bitspersample > 8)
+		return false;
+	if(mT2p->tiff_predictor != PREDICTOR_NONE &&
+		(mT2p->tiff_predictor != PREDICTOR_HORIZONTAL || mT2p->tiff_bitspersample != 8))
+		return false;
+
+	if(COMPRESSION_LZW == mT2p->tiff_compression)
+	{
+		// old style LZW (pre TIFF 6) codes are written LSB first, which PDF LZWDecode can't read
+		unsigned char start[2] = {0,0};
+		tsize_t read = TIFFIsTiled(mT2p->input) ? 
+							TIFFReadRawTile(mT2p->input,0,(tdata_t)start,2) : 
+							TIFFReadRawStrip(mT2p->input,0,(tdata_t)start,2);
+		if(read != 2)
+			return false;
+		if(mT2p->tiff_fillorder==FILLORDER_LSB2MSB)
+			TIFFReverseBits(start,2);
+		if(0 == start[0] && (start[1] & 0x1))
+			return false;
+	}
+	return true;
+}
+
+static bool CCITTDataEndsWithRTC(const unsigned char* inData,tsize_t inSize,bool in2DCoding)
+{
+	// look for two EOLs (11 zeros and a 1, followed by a tag bit when 2D coding) at the end of the data, which
+	// only appear in an RTC. trailing zeros are fill
+	long long bit = (long long)inSize*8 - 1;
+
+#define CCITT_BIT_AT(i) ((inData[(i)>>3] >> (7 - ((i)&7))) & 1)
+
+	while(bit >= 0 && !CCITT_BIT_AT(bit))
+		--bit;
+
+	for(int i=0;i<2;++i)
+	{
+		if(in2DCoding)
+		{
+			// RTC EOLs are tagged for 1D coding
+			if(bit < 0 || !CCITT_BIT_AT(bit))
+				return false;
+			--bit;
+		}
+		if(bit < 0 || !CCITT_BIT_AT(bit))
+			return false;
+		--bit;
+		int zeros = 0;
+		for(;bit >= 0 && !CCITT_BIT_AT(bit);--bit)
+			++zeros;
+		if(zeros < 11)
+			return false;
+	}
+	return true;
+
+#undef CCITT_BIT_AT
+}
+
+bool TIFFImageHandler::G3StripsEndWithRTC()
+{
+	// an RTC ends the data for PDF, so strips can be joined only if they (except the last one) don't end with it
+	tstrip_t stripsCount = TIFFNumberOfStrips(mT2p->input);
+	tsize_t_compat* sbc = NULL;
+	bool result = false;
+
+	TIFFGetField(mT2p->input, TIFFTAG_STRIPBYTECOUNTS, &sbc);
+	for(tstrip_t i = 0; i + 1 < stripsCount && !result; ++i)
+	{
+		tsize_t stripSize = static_cast<tsize_t>(sbc[i]);
+		unsigned char* buffer = (unsigned char*)_TIFFmalloc(stripSize);
+		if(!buffer)
+			return true;
+		
+		if(TIFFReadRawStrip(mT2p->input,i,(tdata_t)buffer,stripSize) != stripSize)
+		{
+			result = true;
+		}
+		else
+		{
+			if(mT2p->tiff_fillorder==FILLORDER_LSB2MSB)
+				TIFFReverseBits(buffer,stripSize);
+			result = CCITTDataEndsWithRTC(buffer,stripSize,(mT2p->tiff_g3options & GROUP3OPT_2DENCODING) != 0);
+		}
+		_TIFFfree(buffer);
+	}
+	return result;
+}
+
 EStatusCode TIFFImageHandler::ReadPhotometricPalette()
 {
 	EStatusCode status = PDFHummus::eSuccess;
@@ -2079,10 +2230,17 @@ PDFImageXObject* TIFFImageHandler::WriteTileImageXObject(int inTileIndex)
 
 		imageStream = mObjectsContext->StartUnfilteredPDFStream(imageContext);
 
-		CalculateTiffTileSize(inTileIndex);
+		if(mPreparedImagesData.size() > (size_t)inTileIndex)
+		{
+			WritePreparedImageData(imageStream,inTileIndex);
+		}
+		else
+		{
+			CalculateTiffTileSize(inTileIndex);
 
-		if(WriteImageTileData(imageStream,inTileIndex) != PDFHummus::eSuccess)
-			break;
+			if(WriteImageTileData(imageStream->GetWriteStream(),inTileIndex) != PDFHummus::eSuccess)
+				break;
+		}
 
 		mObjectsContext->EndPDFStream(imageStream);
 
@@ -2163,7 +2321,10 @@ static const std::string scK = "K";
 static const std::string scColumns = "Columns";
 static const std::string scRows = "Rows";
 static const std::string scBlackIs1 = "BlackIs1";
+static const std::string scEndOfLine = "EndOfLine";
+static const std::string scEncodedByteAlign = "EncodedByteAlign";
 static const std::string scFlateDecode = "FlateDecode";
+static const std::string scLZWDecode = "LZWDecode";
 static const std::string scPredictor = "Predictor";
 static const std::string scColors = "Colors";
 
@@ -2172,16 +2333,29 @@ static const std::string scColors = "Colors";
 void TIFFImageHandler::WriteImageXObjectFilter(DictionaryContext* inImageDictionary,int inTileIndex)
 {
 	DictionaryContext* decodeParmsDictionary;
+	uint32 columns = mT2p->tiff_width;
+	uint32 rows = mT2p->tiff_length;
 
 	if(mT2p->pdf_compression==T2P_COMPRESS_NONE)
 		return;
 
+	if(mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilecount != 0)
+	{
+		columns = TileIsRightEdge(inTileIndex) ? 
+					mT2p->tiff_tiles[mT2p->pdf_page].tiles_edgetilewidth :
+					mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilewidth;
+		rows = TileIsBottomEdge(inTileIndex) ? 
+					mT2p->tiff_tiles[mT2p->pdf_page].tiles_edgetilelength :
+					mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilelength;
+	}
+
 	// Filter
 	inImageDictionary->WriteKey(scFilter);
 
 
 	switch(mT2p->pdf_compression)
 	{
+		case T2P_COMPRESS_G3:
 		case T2P_COMPRESS_G4:
 			inImageDictionary->WriteNameValue(scCCITTFaxDecode);
 
@@ -2189,37 +2363,42 @@ void TIFFImageHandler::WriteImageXObjectFilter(DictionaryContext* inImageDiction
 			inImageDictionary->WriteKey(scDecodeParms);
 			decodeParmsDictionary = mObjectsContext->StartDictionary();
 
-			// K
+			// K. for 2D G3 coding, any positive value allows for any number of 2D rows between 1D rows
 			decodeParmsDictionary->WriteKey(scK);
-			decodeParmsDictionary->WriteIntegerValue(-1);
+			if(T2P_COMPRESS_G4 == mT2p->pdf_compression)
+				decodeParmsDictionary->WriteIntegerValue(-1);
+			else if(COMPRESSION_CCITTFAX3 == mT2p->tiff_compression && (mT2p->tiff_g3options & GROUP3OPT_2DENCODING))
+				decodeParmsDictionary->WriteIntegerValue(rows);
+			else
+				decodeParmsDictionary->WriteIntegerValue(0);
 
-			if(0 == mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilecount)
-			{
-				// Columns
-				decodeParmsDictionary->WriteKey(scColumns);
-				decodeParmsDictionary->WriteIntegerValue(mT2p->tiff_width);
+			// Columns
+			decodeParmsDictionary->WriteKey(scColumns);
+			decodeParmsDictionary->WriteIntegerValue(columns);
 
-				// Rows
-				decodeParmsDictionary->WriteKey(scRows);
-				decodeParmsDictionary->WriteIntegerValue(mT2p->tiff_length);
-			}
-			else
+			// Rows
+			decodeParmsDictionary->WriteKey(scRows);
+			decodeParmsDictionary->WriteIntegerValue(rows);
+
+			if(T2P_COMPRESS_G3 == mT2p->pdf_compression)
 			{
-				// Columns
-				decodeParmsDictionary->WriteKey(scColumns);
-				decodeParmsDictionary->WriteIntegerValue(
-					TileIsRightEdge(inTileIndex) ? 
-						mT2p->tiff_tiles[mT2p->pdf_page].tiles_edgetilewidth :
-						mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilewidth
-					);
-			
-				// Rows
-				decodeParmsDictionary->WriteKey(scRows);
-				decodeParmsDictionary->WriteIntegerValue(
-					TileIsBottomEdge(inTileIndex) ? 
-						mT2p->tiff_tiles[mT2p->pdf_page].tiles_edgetilelength :
-						mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilelength
-					);
+				if(COMPRESSION_CCITTFAX3 == mT2p->tiff_compression)
+				{
+					// G3 rows start with an EOL, and with fill bits the EOLs end on byte boundaries
+					decodeParmsDictionary->WriteKey(scEndOfLine);
+					decodeParmsDictionary->WriteBooleanValue(true);
+					if(mT2p->tiff_g3options & GROUP3OPT_FILLBITS)
+					{
+						decodeParmsDictionary->WriteKey(scEncodedByteAlign);
+						decodeParmsDictionary->WriteBooleanValue(true);
+					}
+				}
+				else
+				{
+					// modified huffman rows have no EOLs, and start on byte boundaries
+					decodeParmsDictionary->WriteKey(scEncodedByteAlign);
+					decodeParmsDictionary->WriteBooleanValue(true);
+				}
 			}
 
 			if(mT2p->pdf_switchdecode == 0)
@@ -2231,7 +2410,8 @@ void TIFFImageHandler::WriteImageXObjectFilter(DictionaryContext* inImageDiction
 			mObjectsContext->EndDictionary(decodeParmsDictionary);
 			break;
 		case T2P_COMPRESS_ZIP:
-			inImageDictionary->WriteNameValue(scFlateDecode);
+		case T2P_COMPRESS_LZW:
+			inImageDictionary->WriteNameValue(T2P_COMPRESS_ZIP == mT2p->pdf_compression ? scFlateDecode:scLZWDecode);
 
 			if(mT2p->pdf_compressionquality%100)
 			{
@@ -2245,7 +2425,7 @@ void TIFFImageHandler::WriteImageXObjectFilter(DictionaryContext* inImageDiction
 
 				// Columns
 				decodeParmsDictionary->WriteKey(scColumns);
-				decodeParmsDictionary->WriteIntegerValue(mT2p->tiff_width);
+				decodeParmsDictionary->WriteIntegerValue(columns);
 
 				// Colors
 				decodeParmsDictionary->WriteKey(scColors);
@@ -2305,9 +2485,9 @@ static tsize_t
 t2p_writeproc(thandle_t handle, tdata_t data, tsize_t size) 
 {
 	T2P *t2p = (T2P*) handle;
-	if (t2p->pdfStream) 
+	if (t2p->imageStream) 
 	{
-		tsize_t written = (tsize_t)t2p->pdfStream->GetWriteStream()->Write((const IOBasicTypes::Byte*)data,size);
+		tsize_t written = (tsize_t)t2p->imageStream->Write((const IOBasicTypes::Byte*)data,size);
 		return written;
 	}
 	return size; 
@@ -2360,7 +2540,7 @@ tsize_t GetSizeFromTIFFDataSize(T2P* inT2p)
 	return inT2p->tiff_datasize;
 }
 
-EStatusCode TIFFImageHandler::WriteImageTileData(PDFStream* inImageStream,int inTileIndex)
+EStatusCode TIFFImageHandler::WriteImageTileData(IByteWriter* inImageStream,int inTileIndex)
 {
 	EStatusCode status = PDFHummus::eSuccess;
 	uint16 edge=0;
@@ -2382,9 +2562,7 @@ EStatusCode TIFFImageHandler::WriteImageTileData(PDFStream* inImageStream,int in
 	do
 	{
 		// if recompression is not required, passthrough the image information and finish
-		if((mT2p->pdf_transcode == T2P_TRANSCODE_RAW) && (edge == 0) &&
-			(mT2p->pdf_compression == T2P_COMPRESS_G4 ||
-				mT2p->pdf_compression == T2P_COMPRESS_ZIP))
+		if((mT2p->pdf_transcode == T2P_TRANSCODE_RAW) && (edge == 0))
 		{
 			buffer= (unsigned char*) _TIFFmalloc(mT2p->tiff_datasize);
 			if(!buffer)
@@ -2399,7 +2577,7 @@ EStatusCode TIFFImageHandler::WriteImageTileData(PDFStream* inImageStream,int in
 			TIFFReadRawTile(mT2p->input, inTileIndex, (tdata_t) buffer, mT2p->tiff_datasize);
 			if (mT2p->tiff_fillorder==FILLORDER_LSB2MSB)
 					TIFFReverseBits(buffer, mT2p->tiff_datasize);
-			inImageStream->GetWriteStream()->Write(
+			inImageStream->Write(
 									(const IOBasicTypes::Byte*)buffer,mT2p->tiff_datasize);
 			_TIFFfree(buffer);
 			break; // finish here if recompression is not required
@@ -2704,10 +2882,17 @@ PDFImageXObject* TIFFImageHandler::WriteUntiledImageXObject()
 
 		imageStream = mObjectsContext->StartUnfilteredPDFStream(imageContext);
 
-		CalculateTiffSizeNoTiles();
+		if(mPreparedImagesData.size() > 0)
+		{
+			WritePreparedImageData(imageStream,0);
+		}
+		else
+		{
+			CalculateTiffSizeNoTiles();
 
-		if(WriteImageData(imageStream) != PDFHummus::eSuccess)
-			break;
+			if(WriteImageData(imageStream->GetWriteStream()) != PDFHummus::eSuccess)
+				break;
+		}
 
 		mObjectsContext->EndPDFStream(imageStream);
 
@@ -2763,7 +2948,7 @@ void TIFFImageHandler::WriteCommonImageDictionaryProperties(DictionaryContext* i
 	// decode
 	if( (mT2p->pdf_switchdecode != 0)
 		&& ! (mT2p->pdf_colorspace == T2P_CS_BILEVEL 
-		&& mT2p->pdf_compression == T2P_COMPRESS_G4)
+		&& (mT2p->pdf_compression == T2P_COMPRESS_G4 || mT2p->pdf_compression == T2P_COMPRESS_G3))
 		)
 	{
 		WriteImageXObjectDecode(inImageContext);
@@ -2772,13 +2957,18 @@ void TIFFImageHandler::WriteCommonImageDictionaryProperties(DictionaryContext* i
 
 void TIFFImageHandler::CalculateTiffSizeNoTiles()
 {
-	if(mT2p->pdf_transcode == T2P_TRANSCODE_RAW && 
-		(mT2p->pdf_compression == T2P_COMPRESS_G4 || mT2p->pdf_compression == T2P_COMPRESS_ZIP))
+	if(mT2p->pdf_transcode == T2P_TRANSCODE_RAW)
 	{
+		// the largest strip, strips are copied one at a time.
 		// TIFFTAG_STRIPBYTECOUNTS size changed in tiff 4.0.0
 		tsize_t_compat * sbc = NULL;
 		TIFFGetField(mT2p->input, TIFFTAG_STRIPBYTECOUNTS, &sbc);
-		mT2p->tiff_datasize = static_cast<tsize_t>(sbc[0]);
+		mT2p->tiff_datasize = 0;
+		for(tstrip_t i = 0; i < TIFFNumberOfStrips(mT2p->input); ++i)
+		{
+			if(static_cast<tsize_t>(sbc[i]) > mT2p->tiff_datasize)
+				mT2p->tiff_datasize = static_cast<tsize_t>(sbc[i]);
+		}
 	}
 	else
 	{
@@ -2791,7 +2981,7 @@ void TIFFImageHandler::CalculateTiffSizeNoTiles()
 
 
 
-EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
+EStatusCode TIFFImageHandler::WriteImageData(IByteWriter* inImageStream)
 {
 	unsigned char* buffer=NULL;
 	unsigned char* samplebuffer=NULL;
@@ -2811,26 +3001,55 @@ EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
 	{
 		if(mT2p->pdf_transcode == T2P_TRANSCODE_RAW)
 		{
-			if(mT2p->pdf_compression == T2P_COMPRESS_G4 ||
-				mT2p->pdf_compression == T2P_COMPRESS_ZIP)
+			buffer = (unsigned char*)_TIFFmalloc(mT2p->tiff_datasize);
+			if (!buffer) 
 			{
-				buffer = (unsigned char*)_TIFFmalloc(mT2p->tiff_datasize);
-				if (!buffer) 
+				TRACE_LOG2( 
+					"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
+					mT2p->tiff_datasize, 
+					mT2p->inputFilePath.c_str());
+				status = PDFHummus::eFailure;
+				break;
+			}
+			// copy the strips one after the other (multiple strips are only passed through when they can be joined)
+			stripcount=TIFFNumberOfStrips(mT2p->input);
+			for(i=0;i<stripcount;i++)
+			{
+				read = TIFFReadRawStrip(mT2p->input, i, (tdata_t)buffer,mT2p->tiff_datasize);
+				if(read==-1)
 				{
 					TRACE_LOG2( 
-						"Can't allocate %u bytes of memory for t2p_readwrite_pdf_image, %s", 
-						mT2p->tiff_datasize, 
+						"Error on reading strip %u of %s", 
+						i, 
 						mT2p->inputFilePath.c_str());
 					status = PDFHummus::eFailure;
 					break;
 				}
-				TIFFReadRawStrip(mT2p->input, 0, (tdata_t)buffer,mT2p->tiff_datasize);
 				if (mT2p->tiff_fillorder==FILLORDER_LSB2MSB)
-					TIFFReverseBits(buffer,mT2p->tiff_datasize);
-				inImageStream->GetWriteStream()->Write(
-										(const IOBasicTypes::Byte*)buffer,mT2p->tiff_datasize);
-				_TIFFfree(buffer);
-				break; // stop here if can write directly with no recompression
+					TIFFReverseBits(buffer,read);
+				inImageStream->Write(
+										(const IOBasicTypes::Byte*)buffer,read);
+			}
+			_TIFFfree(buffer);
+			break; // stop here if can write directly with no recompression
+		}
+
+		// images that require more memory than allowed are converted and written in bands of rows. compute
+		// the size here and not with tiff_datasize, which may overflow for large images
+		if(mUserParameters.MaxImageBufferSize != 0)
+		{
+			unsigned long long imageBufferSize = (unsigned long long)TIFFScanlineSize(mT2p->input) * mT2p->tiff_length;
+			if(mT2p->tiff_planar==PLANARCONFIG_SEPARATE)
+				imageBufferSize*= mT2p->tiff_samplesperpixel;
+			if(mT2p->pdf_sample & T2P_SAMPLE_REALIZE_PALETTE)
+				imageBufferSize*= mT2p->tiff_samplesperpixel;
+			if(mT2p->pdf_sample & T2P_SAMPLE_YCBCR_TO_RGB)
+				imageBufferSize = (unsigned long long)mT2p->tiff_width * mT2p->tiff_length * 4;
+
+			if(imageBufferSize > mUserParameters.MaxImageBufferSize)
+			{
+				status = WriteImageDataInBands(inImageStream);
+				break;
 			}
 		}
 
@@ -3006,7 +3225,7 @@ EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
 					buffer=samplebuffer;
 					mT2p->tiff_datasize *= mT2p->tiff_samplesperpixel;
 				}
-				SampleRealizePalette(buffer);
+				SampleRealizePalette(buffer,mT2p->tiff_width*mT2p->tiff_length);
 			}
 
 			if(mT2p->pdf_sample & T2P_SAMPLE_RGBA_TO_RGB)
@@ -3084,7 +3303,192 @@ EStatusCode TIFFImageHandler::WriteImageData(PDFStream* inImageStream)
 	return status;
 }
 
-void TIFFImageHandler::SampleRealizePalette(unsigned char* inBuffer)
+#define TIFF_STREAMING_OUTPUT_BUFFER_SIZE 64*1024
+
+/*
+	Convert and write the image in bands of rows, so that only a band is held in memory at any time.
+	A band is a strip of the input image, or a single row if a strip is larger than the memory limit. YCbCr images converted to RGB
+	are read with the RGBA interface, in bands of as many rows as fit the memory limit (kept a multiple of the vertical subsampling,
+	and not more than a strip). Note that the RGBA interface still decodes a whole input strip internally.
+	Conversions are the same as in WriteImageData, applied per band, and the rows are written through the output encoder one by one.
+*/
+EStatusCode TIFFImageHandler::WriteImageDataInBands(IByteWriter* inImageStream)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	unsigned char* buffer = NULL;
+	unsigned char* samplebuffer = NULL;
+	TIFF* output = NULL;
+
+	do
+	{
+		bool separate = (mT2p->pdf_sample & T2P_SAMPLE_PLANAR_SEPARATE_TO_CONTIG) != 0;
+		bool readRGBA = !separate && (mT2p->pdf_sample & T2P_SAMPLE_YCBCR_TO_RGB) != 0;
+		uint16 planesCount = separate ? mT2p->tiff_samplesperpixel : 1;
+
+		// the output holds the converted samples
+		uint16 outputSamplesPerPixel = mT2p->tiff_samplesperpixel;
+		uint16 outputPhotometric = mT2p->tiff_photometric;
+		if(!separate && (mT2p->pdf_sample & (T2P_SAMPLE_RGBA_TO_RGB | T2P_SAMPLE_RGBAA_TO_RGB | T2P_SAMPLE_YCBCR_TO_RGB)))
+		{
+			outputSamplesPerPixel = 3;
+			outputPhotometric = PHOTOMETRIC_RGB;
+		}
+
+		output = StartImageStreamEncoding(inImageStream,mT2p->tiff_width,mT2p->tiff_length,outputSamplesPerPixel,outputPhotometric);
+		if(!output)
+		{
+			TRACE_LOG1("TIFFImageHandler::WriteImageDataInBands, Error creating encoder for output PDF %s",mT2p->inputFilePath.c_str());
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		// keep the encoder buffer small, data is flushed to the stream whenever it's full
+		if(!TIFFWriteBufferSetup(output,NULL,TIFF_STREAMING_OUTPUT_BUFFER_SIZE))
+		{
+			TRACE_LOG1("TIFFImageHandler::WriteImageDataInBands, Can't allocate encoder buffer for %s",mT2p->inputFilePath.c_str());
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		uint32 rowsPerStrip = 0;
+		TIFFGetFieldDefaulted(mT2p->input,TIFFTAG_ROWSPERSTRIP,&rowsPerStrip);
+		if(0 == rowsPerStrip || rowsPerStrip > mT2p->tiff_length)
+			rowsPerStrip = mT2p->tiff_length;
+
+		unsigned long long inputRowSize = (unsigned long long)TIFFScanlineSize(mT2p->input);
+		unsigned long long outputRowSize = (unsigned long long)TIFFScanlineSize(output);
+		unsigned long long rowBufferSize = readRGBA ? (unsigned long long)mT2p->tiff_width * 4 : inputRowSize * planesCount;
+		if(outputRowSize > rowBufferSize)
+			rowBufferSize = outputRowSize;
+
+		bool readStrips = rowBufferSize * rowsPerStrip <= mUserParameters.MaxImageBufferSize;
+		uint32 bandRows = readStrips ? rowsPerStrip : 1;
+		if(readRGBA && !readStrips)
+		{
+			// RGBA bands may start only at a subsampled block of rows
+			uint16 subsamplingHorizontal = 1;
+			uint16 subsamplingVertical = 1;
+			TIFFGetFieldDefaulted(mT2p->input,TIFFTAG_YCBCRSUBSAMPLING,&subsamplingHorizontal,&subsamplingVertical);
+			if(0 == subsamplingVertical)
+				subsamplingVertical = 1;
+
+			unsigned long long fittingRows = mUserParameters.MaxImageBufferSize / rowBufferSize;
+			bandRows = (uint32)(fittingRows - fittingRows % subsamplingVertical);
+			if(0 == bandRows)
+				bandRows = subsamplingVertical;
+		}
+
+		buffer = (unsigned char*)_TIFFmalloc((tsize_t)(rowBufferSize * bandRows));
+		if(separate)
+			samplebuffer = (unsigned char*)_TIFFmalloc((tsize_t)(inputRowSize * planesCount * bandRows));
+		if(!buffer || (separate && !samplebuffer))
+		{
+			TRACE_LOG2(
+				"TIFFImageHandler::WriteImageDataInBands, Can't allocate %llu bytes of memory for %s", 
+				rowBufferSize * bandRows, 
+				mT2p->inputFilePath.c_str());
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		for(uint32 row = 0; row < mT2p->tiff_length && PDFHummus::eSuccess == status; row+=bandRows)
+		{
+			uint32 rows = (mT2p->tiff_length - row < bandRows) ? (mT2p->tiff_length - row) : bandRows;
+
+			// read band
+			if(readRGBA)
+			{
+				// read the band top down with the TIFFRGBAImage interface (TIFFReadRGBAStrip reads bottom up, and fails with subsampled YCbCr images)
+				char errorMessage[1024];
+				TIFFRGBAImage image;
+				int readOK = 0;
+				if(TIFFRGBAImageBegin(&image,mT2p->input,0,errorMessage))
+				{
+					image.req_orientation = ORIENTATION_TOPLEFT;
+					image.row_offset = row;
+					image.col_offset = 0;
+					readOK = TIFFRGBAImageGet(&image,(uint32*)buffer,mT2p->tiff_width,rows);
+					TIFFRGBAImageEnd(&image);
+				}
+				if(!readOK)
+				{
+					TRACE_LOG2("TIFFImageHandler::WriteImageDataInBands, Can't extract RGB band at row %u of %s",row,mT2p->inputFilePath.c_str());
+					status = PDFHummus::eFailure;
+					break;
+				}
+				SampleABGRToRGB((tdata_t)buffer,mT2p->tiff_width*rows);
+			}
+			else 
+			{
+				unsigned char* target = separate ? samplebuffer : buffer;
+				tsize_t planeSize = (tsize_t)(inputRowSize * rows);
+				// decoders may leave damaged rows partially unwritten, so clear the band like the in-memory path clears the image
+				memset(target,0,planeSize*planesCount);
+				for(uint16 j = 0; j < planesCount && PDFHummus::eSuccess == status; ++j)
+				{
+					bool readOK = readStrips ? 
+						TIFFReadEncodedStrip(mT2p->input,TIFFComputeStrip(mT2p->input,row,j),(tdata_t)(target + j*planeSize),planeSize) != -1 :
+						TIFFReadScanline(mT2p->input,(tdata_t)(target + j*planeSize),row,j) != -1;
+					if(!readOK)
+					{
+						TRACE_LOG2("TIFFImageHandler::WriteImageDataInBands, Error on decoding row %u of %s",row,mT2p->inputFilePath.c_str());
+						status = PDFHummus::eFailure;
+					}
+				}
+				if(status != PDFHummus::eSuccess)
+					break;
+
+				// convert band, same as WriteImageData does for the whole image
+				if(separate)
+				{
+					SamplePlanarSeparateToContig(buffer,samplebuffer,planeSize*planesCount);
+				}
+				else
+				{
+					if(mT2p->pdf_sample & T2P_SAMPLE_REALIZE_PALETTE)
+						SampleRealizePalette(buffer,mT2p->tiff_width*rows);
+					if(mT2p->pdf_sample & T2P_SAMPLE_RGBA_TO_RGB)
+						SampleRGBAToRGB((tdata_t)buffer,mT2p->tiff_width*rows);
+					if(mT2p->pdf_sample & T2P_SAMPLE_RGBAA_TO_RGB)
+						SampleRGBAAToRGB((tdata_t)buffer,mT2p->tiff_width*rows);
+					if(mT2p->pdf_sample & T2P_SAMPLE_LAB_SIGNED_TO_UNSIGNED)
+						SampleLABSignedToUnsigned((tdata_t)buffer,mT2p->tiff_width*rows);
+				}
+			}
+
+			// write band
+			for(uint32 i = 0; i < rows; ++i)
+			{
+				if(TIFFWriteScanline(output,(tdata_t)(buffer + i*outputRowSize),row + i,0) == -1)
+				{
+					TRACE_LOG2("TIFFImageHandler::WriteImageDataInBands, Error encoding row %u to output PDF %s",row + i,mT2p->inputFilePath.c_str());
+					status = PDFHummus::eFailure;
+					break;
+				}
+			}
+		}
+		if(status != PDFHummus::eSuccess)
+			break;
+
+		// complete encoding, and write what's left
+		if(!TIFFFlushData(output))
+		{
+			TRACE_LOG1("TIFFImageHandler::WriteImageDataInBands, Error writing encoded data to output PDF %s",mT2p->inputFilePath.c_str());
+			status = PDFHummus::eFailure;
+			break;
+		}
+	}while(false);
+
+	if(output)
+		EndImageStreamEncoding(output);
+	if(buffer)
+		_TIFFfree(buffer);
+	if(samplebuffer)
+		_TIFFfree(samplebuffer);
+	return status;
+}
+
+void TIFFImageHandler::SampleRealizePalette(unsigned char* inBuffer, uint32 inSampleCount)
 {
 	uint32 sample_count=0;
 	uint16 component_count=0;
@@ -3092,7 +3496,7 @@ void TIFFImageHandler::SampleRealizePalette(unsigned char* inBuffer)
 	uint32 sample_offset=0;
 	uint32 i=0;
 	uint32 j=0;
-	sample_count=mT2p->tiff_width*mT2p->tiff_length;
+	sample_count=inSampleCount;
 	component_count=mT2p->tiff_samplesperpixel;
 	
 	for(i=sample_count;i>0;i--)
@@ -3120,7 +3524,7 @@ tsize_t TIFFImageHandler::SampleABGRToRGB(tdata_t inData, uint32 inSampleCount)
 	return(i*3);	
 }
 
-EStatusCode TIFFImageHandler::WriteImageBufferToStream(PDFStream* inPDFStream,
+EStatusCode TIFFImageHandler::WriteImageBufferToStream(IByteWriter* inImageStream,
 														uint32 inImageWidth,
 														uint32 inImageLength,
 														unsigned char* inBuffer,
@@ -3129,58 +3533,17 @@ EStatusCode TIFFImageHandler::WriteImageBufferToStream(PDFStream* inPDFStream,
 	EStatusCode status = PDFHummus::eSuccess;
 	do
 	{
-		mT2p->pdfStream = NULL;
-
-		/* hopefully here is good enough, and that dummy is good. 
-			basically the only allowed action is to write */
-		TIFF* output = TIFFClientOpen("dummy.txt", "w", (thandle_t)mT2p,
-					t2p_readproc, t2p_writeproc, t2p_seekproc, 
-					t2p_closeproc, t2p_sizeproc, 
-					t2p_mapproc, t2p_unmapproc );
-
-		TIFFSetField(output, TIFFTAG_PHOTOMETRIC, mT2p->tiff_photometric);
-		TIFFSetField(output, TIFFTAG_BITSPERSAMPLE, mT2p->tiff_bitspersample);
-		TIFFSetField(output, TIFFTAG_SAMPLESPERPIXEL, mT2p->tiff_samplesperpixel);
-		TIFFSetField(output, TIFFTAG_IMAGEWIDTH, inImageWidth);
-		TIFFSetField(output, TIFFTAG_IMAGELENGTH, inImageLength);
-		TIFFSetField(output, TIFFTAG_ROWSPERSTRIP, inImageLength); // equal to image length in both usages...
-		TIFFSetField(output, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-		TIFFSetField(output, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
-
-		switch(mT2p->pdf_compression)
+		TIFF* output = StartImageStreamEncoding(inImageStream,inImageWidth,inImageLength,mT2p->tiff_samplesperpixel,mT2p->tiff_photometric);
+		if(!output)
 		{
-		case T2P_COMPRESS_NONE:
-			TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
-			break;
-		case T2P_COMPRESS_G4:
-			TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_CCITTFAX4);
-			break;
-		case T2P_COMPRESS_ZIP:
-			TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_DEFLATE);
-			if(mT2p->pdf_defaultcompressionquality%100 != 0)
-			{
-				TIFFSetField(output, 
-					TIFFTAG_PREDICTOR, 
-					mT2p->pdf_defaultcompressionquality % 100);
-			}
-			if(mT2p->pdf_defaultcompressionquality/100 != 0)
-			{
-				TIFFSetField(output, 
-					TIFFTAG_ZIPQUALITY, 
-					(mT2p->pdf_defaultcompressionquality / 100));
-			}
+			TRACE_LOG1("Error creating encoder for output PDF %s",mT2p->inputFilePath.c_str());
+			status = PDFHummus::eFailure;
 			break;
 		}
 
-		mT2p->pdfStream = inPDFStream;
-		mT2p->output = output; // dirty trick so i can use the inBufferSizeFunction function by getting info from output (sometimes)
-
 		tsize_t bufferoffset = TIFFWriteEncodedStrip(output, (tstrip_t)0,inBuffer,inBufferSizeFunction(mT2p)); 
 
-		mT2p->output = NULL;
-		mT2p->pdfStream = NULL;
-		if (output != NULL)
-			TIFFClose(output);
+		EndImageStreamEncoding(output);
 
 		if (bufferoffset == (tsize_t)-1) 
 		{
@@ -3193,6 +3556,85 @@ EStatusCode TIFFImageHandler::WriteImageBufferToStream(PDFStream* inPDFStream,
 	return status;
 }
 
+TIFF* TIFFImageHandler::StartImageStreamEncoding(IByteWriter* inImageStream,
+												uint32 inImageWidth,
+												uint32 inImageLength,
+												uint16 inSamplesPerPixel,
+												uint16 inPhotometric)
+{
+	mT2p->imageStream = NULL;
+
+	/* hopefully here is good enough, and that dummy is good. 
+		basically the only allowed action is to write */
+	TIFF* output = TIFFClientOpen("dummy.txt", "w", (thandle_t)mT2p,
+				t2p_readproc, t2p_writeproc, t2p_seekproc, 
+				t2p_closeproc, t2p_sizeproc, 
+				t2p_mapproc, t2p_unmapproc );
+	if(!output)
+		return NULL;
+
+	TIFFSetField(output, TIFFTAG_PHOTOMETRIC, inPhotometric);
+	TIFFSetField(output, TIFFTAG_BITSPERSAMPLE, mT2p->tiff_bitspersample);
+	TIFFSetField(output, TIFFTAG_SAMPLESPERPIXEL, inSamplesPerPixel);
+	TIFFSetField(output, TIFFTAG_IMAGEWIDTH, inImageWidth);
+	TIFFSetField(output, TIFFTAG_IMAGELENGTH, inImageLength);
+	TIFFSetField(output, TIFFTAG_ROWSPERSTRIP, inImageLength); // equal to image length in both usages...
+	TIFFSetField(output, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+	TIFFSetField(output, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
+
+	switch(mT2p->pdf_compression)
+	{
+	case T2P_COMPRESS_NONE:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
+		break;
+	case T2P_COMPRESS_G4:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_CCITTFAX4);
+		break;
+	// G3 and LZW are only used for passthrough, encoding here is for edge tiles, which match the rest of the tiles
+	case T2P_COMPRESS_G3:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, mT2p->tiff_compression);
+		if(COMPRESSION_CCITTFAX3 == mT2p->tiff_compression)
+			TIFFSetField(output, TIFFTAG_GROUP3OPTIONS, mT2p->tiff_g3options);
+		break;
+	case T2P_COMPRESS_LZW:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+		if(mT2p->pdf_compressionquality%100 != 0)
+		{
+			TIFFSetField(output, 
+				TIFFTAG_PREDICTOR, 
+				mT2p->pdf_compressionquality % 100);
+		}
+		break;
+	case T2P_COMPRESS_ZIP:
+		TIFFSetField(output, TIFFTAG_COMPRESSION, COMPRESSION_DEFLATE);
+		if(mT2p->pdf_compressionquality%100 != 0)
+		{
+			TIFFSetField(output, 
+				TIFFTAG_PREDICTOR, 
+				mT2p->pdf_compressionquality % 100);
+		}
+		if(mT2p->pdf_defaultcompressionquality/100 != 0)
+		{
+			TIFFSetField(output, 
+				TIFFTAG_ZIPQUALITY, 
+				(mT2p->pdf_defaultcompressionquality / 100));
+		}
+		break;
+	}
+
+	mT2p->imageStream = inImageStream;
+	mT2p->output = output; // dirty trick so i can use the inBufferSizeFunction function by getting info from output (sometimes)
+	return output;
+}
+
+void TIFFImageHandler::EndImageStreamEncoding(TIFF* inOutput)
+{
+	// stop writing to the PDF stream before closing, so the output directory written on close is discarded
+	mT2p->output = NULL;
+	mT2p->imageStream = NULL;
+	TIFFClose(inOutput);
+}
+
 PDFFormXObject* TIFFImageHandler::WriteImagesFormXObject(const PDFImageXObjectList& inImages,ObjectIDType inFormXObjectID)
 {
 	EStatusCode status = PDFHummus::eSuccess;
@@ -3513,6 +3955,197 @@ PDFFormXObject* TIFFImageHandler::CreateFormXObjectFromTIFFStream(	IByteReaderWi
 	return imageFormXObject;
 }
 
+// the input of a page prepared by a CreateFormXObjectsFromTIFFFile worker. kept open till the page is written,
+// as some of the page information is read from the tiff directory when writing
+struct TIFFPreparedPageInput
+{
+	InputFile mFile;
+	StreamWithPos mStreamInfo;
+	TIFF* mInput;
+
+	TIFFPreparedPageInput(){mInput = NULL;}
+};
+
+typedef std::pair<TIFFImageHandler*,std::future<EStatusCode> > TIFFImageHandlerAndPreparation;
+typedef std::list<TIFFImageHandlerAndPreparation> TIFFImageHandlerAndPreparationList;
+
+EStatusCodeAndPDFFormXObjectVector TIFFImageHandler::CreateFormXObjectsFromTIFFFile(const std::string& inTIFFFilePath,
+																	  const UIntVector& inPageIndexes,
+																	  const TIFFUsageParameters& inTIFFUsageParameters)
+{
+	PDFFormXObjectVector imageFormXObjects;
+	TIFFImageHandlerAndPreparationList pendingPages;
+	EStatusCode status = PDFHummus::eSuccess;
+
+	if(!mObjectsContext || !mContainerDocumentContext)
+	{
+		TRACE_LOG("TIFFImageHandler::CreateFormXObjectsFromTIFFFile. Unexpected Error, mObjectsContext or mContainerDocumentContext not initialized");
+		return EStatusCodeAndPDFFormXObjectVector(PDFHummus::eFailure,imageFormXObjects);
+	}
+
+	// check the pages up front, so that a bad page index does not leave earlier pages written
+	InputFile tiffFile;
+	if(tiffFile.OpenFile(inTIFFFilePath) != PDFHummus::eSuccess)
+	{
+		TRACE_LOG1("TIFFImageHandler::CreateFormXObjectsFromTIFFFile. cannot open file for reading - %s",inTIFFFilePath.c_str());
+		return EStatusCodeAndPDFFormXObjectVector(PDFHummus::eFailure,imageFormXObjects);
+	}
+	unsigned long pagesCount = ReadImagePageCount(tiffFile.GetInputStream());
+	tiffFile.CloseFile();
+	UIntVector::const_iterator itPages = inPageIndexes.begin();
+	for(; itPages != inPageIndexes.end(); ++itPages)
+	{
+		if(*itPages >= pagesCount)
+		{
+			TRACE_LOG3(
+				"TIFFImageHandler::CreateFormXObjectsFromTIFFFile, Requested tiff page %u where the tiff only has %lu pages. Tiff file name - %s",
+				*itPages,
+				pagesCount,
+				inTIFFFilePath.c_str());
+			return EStatusCodeAndPDFFormXObjectVector(PDFHummus::eFailure,imageFormXObjects);
+		}
+	}
+
+	// set the handlers before starting the workers, they are global to libtiff
+	TIFFSetErrorHandler(ReportError);
+	TIFFSetWarningHandler(ReportWarning);
+
+	// limit the pages in work, to bound the memory held by encoded pages waiting to be written
+	unsigned int maxParallelPages = std::max<unsigned int>(std::thread::hardware_concurrency(),1);
+	itPages = inPageIndexes.begin();
+
+	while(PDFHummus::eSuccess == status && imageFormXObjects.size() < inPageIndexes.size())
+	{
+		for(; itPages != inPageIndexes.end() && pendingPages.size() < maxParallelPages; ++itPages)
+		{
+			TIFFImageHandler* pageHandler = new TIFFImageHandler();
+			std::future<EStatusCode> preparation;
+			try
+			{
+				preparation = std::async(std::launch::async,&TIFFImageHandler::PrepareTIFFPage,pageHandler,inTIFFFilePath,*itPages,inTIFFUsageParameters);
+			}
+			catch(std::system_error&)
+			{
+				// no thread to prepare the page on, so prepare it serially, when it is to be written
+				preparation = std::async(std::launch::deferred,&TIFFImageHandler::PrepareTIFFPage,pageHandler,inTIFFFilePath,*itPages,inTIFFUsageParameters);
+			}
+			pendingPages.push_back(TIFFImageHandlerAndPreparation(pageHandler,std::move(preparation)));
+		}
+
+		// write the next page in order, once ready
+		TIFFImageHandler* pageHandler = pendingPages.front().first;
+		status = pendingPages.front().second.get();
+		pendingPages.pop_front();
+		if(PDFHummus::eSuccess == status)
+		{
+			pageHandler->SetOperationsContexts(mContainerDocumentContext,mObjectsContext);
+			pageHandler->SetDocumentContextExtender(mExtender);
+			PDFFormXObject* imageFormXObject = pageHandler->WriteTIFFPage(mObjectsContext->GetInDirectObjectsRegistry().AllocateNewObjectID());
+			if(imageFormXObject)
+				imageFormXObjects.push_back(imageFormXObject);
+			else
+				status = PDFHummus::eFailure;
+		}
+		delete pageHandler;
+	}
+
+	// on failure, wait for pages still in work before dropping them. deferred pages were never started, so they are just dropped
+	TIFFImageHandlerAndPreparationList::iterator itPending = pendingPages.begin();
+	for(; itPending != pendingPages.end(); ++itPending)
+	{
+		if(itPending->second.wait_for(std::chrono::seconds(0)) != std::future_status::deferred)
+			itPending->second.wait();
+		delete itPending->first;
+	}
+
+	// pages written before a failure are kept, as their objects are already in the output
+	if(status != PDFHummus::eSuccess)
+		TRACE_LOG2("TIFFImageHandler::CreateFormXObjectsFromTIFFFile. failed to convert pages of %s, after writing %lu pages",inTIFFFilePath.c_str(),(unsigned long)imageFormXObjects.size());
+
+	return EStatusCodeAndPDFFormXObjectVector(status,imageFormXObjects);
+}
+
+EStatusCode TIFFImageHandler::PrepareTIFFPage(const std::string& inTIFFFilePath,unsigned int inPageIndex,const TIFFUsageParameters& inTIFFUsageParameters)
+{
+	EStatusCode status = PDFHummus::eFailure;
+
+	do
+	{
+		mPreparedPageInput = new TIFFPreparedPageInput();
+		if(mPreparedPageInput->mFile.OpenFile(inTIFFFilePath) != PDFHummus::eSuccess)
+		{
+			TRACE_LOG1("TIFFImageHandler::PrepareTIFFPage. cannot open file for reading - %s",inTIFFFilePath.c_str());
+			break;
+		}
+
+		mPreparedPageInput->mStreamInfo.mStream = mPreparedPageInput->mFile.GetInputStream();
+		mPreparedPageInput->mStreamInfo.mOriginalPosition = mPreparedPageInput->mStreamInfo.mStream->GetCurrentPosition();
+		mPreparedPageInput->mInput = TIFFClientOpen("Stream","r",(thandle_t)&(mPreparedPageInput->mStreamInfo),STATIC_streamRead,
+																	STATIC_streamWrite,
+																	STATIC_streamSeek,
+																	STATIC_streamClose,
+																	STATIC_tiffSize,
+																	STATIC_tiffMap,
+																	STATIC_tiffUnmap);
+		if(!mPreparedPageInput->mInput)
+		{
+			TRACE_LOG1("TIFFImageHandler::PrepareTIFFPage. cannot open %s as tiff",inTIFFFilePath.c_str());
+			break;
+		}
+
+		InitializeConversionState();
+		mT2p->input = mPreparedPageInput->mInput;
+		mT2p->inputFilePath = inTIFFFilePath;
+		mT2p->pdf_page = inPageIndex;
+		mUserParameters = inTIFFUsageParameters;
+
+		if(ReadTIFFPage() != PDFHummus::eSuccess)
+			break;
+
+		// decode and encode the page images, so that writing them is just copying
+		status = PDFHummus::eSuccess;
+		int imagesCount = mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilecount != 0 ? (int)mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilecount : 1;
+		mPreparedImagesData.reserve(imagesCount);
+		for(int i=0; i < imagesCount && PDFHummus::eSuccess == status; ++i)
+		{
+			OutputStringBufferStream imageData;
+
+			if(mT2p->tiff_tiles[mT2p->pdf_page].tiles_tilecount != 0)
+			{
+				CalculateTiffTileSize(i);
+				status = WriteImageTileData(&imageData,i);
+			}
+			else
+			{
+				CalculateTiffSizeNoTiles();
+				status = WriteImageData(&imageData);
+			}
+			mPreparedImagesData.push_back(imageData.ToString());
+		}
+	}while(false);
+
+	return status;
+}
+
+void TIFFImageHandler::DestroyPreparedPage()
+{
+	if(mPreparedPageInput)
+	{
+		if(mPreparedPageInput->mInput)
+			TIFFClose(mPreparedPageInput->mInput);
+		delete mPreparedPageInput;
+		mPreparedPageInput = NULL;
+	}
+	mPreparedImagesData.clear();
+}
+
+void TIFFImageHandler::WritePreparedImageData(PDFStream* inImageStream,int inImageIndex)
+{
+	const std::string& imageData = mPreparedImagesData[inImageIndex];
+
+	inImageStream->GetWriteStream()->Write((const IOBasicTypes::Byte*)imageData.c_str(),imageData.size());
+}
+
 DoubleAndDoublePair TIFFImageHandler::ReadImageDimensions(IByteReaderWithPosition* inTIFFStream,unsigned long inImageIndex)
 {
     return ReadImageInfo(inTIFFStream,inImageIndex).dimensions;
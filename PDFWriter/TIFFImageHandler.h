@@ -80,6 +80,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include <utility>
 
 
@@ -87,6 +88,9 @@
 
 struct T2P;
 struct T2P_BOX;
+struct TIFFPreparedPageInput;
+struct tiff;
+typedef struct tiff TIFF;
 class DictionaryContext;
 class PDFImageXObject;
 class PDFStream;
@@ -94,6 +98,7 @@ class PDFFormXObject;
 class ObjectsContext;
 class IDocumentContextExtender;
 class IByteReaderWithPosition;
+class IByteWriter;
 
 namespace PDFHummus
 {
@@ -106,6 +111,10 @@ using namespace PDFHummus;
 typedef std::list<ObjectIDType> ObjectIDTypeList;
 typedef std::list<PDFImageXObject*> PDFImageXObjectList;
 typedef std::list<std::string> StringList;
+typedef std::vector<std::string> StringVector;
+typedef std::vector<unsigned int> UIntVector;
+typedef std::vector<PDFFormXObject*> PDFFormXObjectVector;
+typedef std::pair<PDFHummus::EStatusCode,PDFFormXObjectVector> EStatusCodeAndPDFFormXObjectVector;
 typedef std::pair<double,double> DoubleAndDoublePair;
 
 //  tiff.h extracted defs [prefer to avoid including too much here]
@@ -189,6 +198,15 @@ public:
 													ObjectIDType inFormXObjectID,
 													const TIFFUsageParameters& inTIFFUsageParameters = TIFFUsageParameters::DefaultTIFFUsageParameters());
 
+	// create form XObjects for multiple pages of a tiff file, one per page index (the PageIndex of the usage parameters is ignored).
+	// pages are decoded and encoded concurrently, each on a worker with its own handle to the file, and their objects are
+	// written in the order of inPageIndexes, so the result is the same as creating them one by one.
+	// if a page fails, returns the failure status with the forms of the pages before it. those are already written to the
+	// output, so the caller may still use them, and should delete them like on success. a bad page index fails before writing anything
+	EStatusCodeAndPDFFormXObjectVector CreateFormXObjectsFromTIFFFile(const std::string& inTIFFFilePath,
+														const UIntVector& inPageIndexes,
+														const TIFFUsageParameters& inTIFFUsageParameters = TIFFUsageParameters::DefaultTIFFUsageParameters());
+
 
 	void SetOperationsContexts(PDFHummus::DocumentContext* inContainerDocumentContext,ObjectsContext* inObjectsContext);
 	void SetDocumentContextExtender(IDocumentContextExtender* inExtender);
@@ -207,13 +225,23 @@ private:
 	T2P* mT2p; // state for tiff->pdf
 	TIFFUsageParameters mUserParameters;
 	IDocumentContextExtender* mExtender;
+	// for pages prepared by CreateFormXObjectsFromTIFFFile workers - the page input and its images encoded data
+	TIFFPreparedPageInput* mPreparedPageInput;
+	StringVector mPreparedImagesData;
 
 
 	void InitializeConversionState();
 	void DestroyConversionState();
 	PDFFormXObject* ConvertTiff2PDF(ObjectIDType inFormXObjectID);
+	PDFHummus::EStatusCode ReadTIFFPage();
+	PDFFormXObject* WriteTIFFPage(ObjectIDType inFormXObjectID);
+	PDFHummus::EStatusCode PrepareTIFFPage(const std::string& inTIFFFilePath,unsigned int inPageIndex,const TIFFUsageParameters& inTIFFUsageParameters);
+	void DestroyPreparedPage();
+	void WritePreparedImageData(PDFStream* inImageStream,int inImageIndex);
 	PDFHummus::EStatusCode ReadTopLevelTiffInformation();
 	PDFHummus::EStatusCode ReadTIFFPageInformation();
+	bool CanPassthroughPredictedData();
+	bool G3StripsEndWithRTC();
 	PDFHummus::EStatusCode ReadPhotometricPalette();
 	PDFHummus::EStatusCode ReadPhotometricPaletteCMYK();
 	void ComposePDFPage();
@@ -231,7 +259,7 @@ private:
 	void WriteImageXObjectDecode(DictionaryContext* inImageDictionary);
 	void WriteImageXObjectFilter(DictionaryContext* inImageDictionary,int inTileIndex);
 	void CalculateTiffTileSize(int inTileIndex);
-	PDFHummus::EStatusCode WriteImageTileData(PDFStream* inImageStream,int inTileIndex);
+	PDFHummus::EStatusCode WriteImageTileData(IByteWriter* inImageStream,int inTileIndex);
 	void SamplePlanarSeparateToContig(unsigned char* inBuffer, 
 									  unsigned char* inSamplebuffer, 
 									  tsize_t inSamplebuffersize);
@@ -243,15 +271,22 @@ private:
 							uint32 inTileLength);
 	PDFImageXObject* WriteUntiledImageXObject();
 	void WriteCommonImageDictionaryProperties(DictionaryContext* inImageContext);
-	PDFHummus::EStatusCode WriteImageData(PDFStream* inImageStream);
+	PDFHummus::EStatusCode WriteImageData(IByteWriter* inImageStream);
 	void CalculateTiffSizeNoTiles();
-	void SampleRealizePalette(unsigned char* inBuffer);
+	void SampleRealizePalette(unsigned char* inBuffer, uint32 inSampleCount);
 	tsize_t SampleABGRToRGB(tdata_t inData, uint32 inSampleCount);
-	PDFHummus::EStatusCode WriteImageBufferToStream(	PDFStream* inPDFStream,
+	PDFHummus::EStatusCode WriteImageBufferToStream(	IByteWriter* inImageStream,
 											uint32 inImageWidth,
 											uint32 inImageLength,
 											unsigned char* inBuffer,
 											ImageSizeProc inBufferSizeFunction);
+	TIFF* StartImageStreamEncoding(IByteWriter* inImageStream,
+									uint32 inImageWidth,
+									uint32 inImageLength,
+									uint16 inSamplesPerPixel,
+									uint16 inPhotometric);
+	void EndImageStreamEncoding(TIFF* inOutput);
+	PDFHummus::EStatusCode WriteImageDataInBands(IByteWriter* inImageStream);
 	PDFFormXObject* WriteImagesFormXObject(const PDFImageXObjectList& inImages,ObjectIDType inFormXObjectID);
 	void AddImagesProcsets(PDFImageXObject* inImageXObject);
 	void WriteIndexedCSForBiLevelColorMap();
@@ -22,6 +22,8 @@
 
 #include "CMYKRGBColor.h"
 
+#include <stddef.h>
+
 // Options for TIFF image usage.
 // by default the image drawn would be the first page of the input tiff (either one page or multipage)
 // for bilevel images, will be drawn either as grayscale or black and white.
@@ -69,11 +71,34 @@ struct TIFFBiLevelGrayscaleColorTreatment
 
 
 
+#define TIFF_DEFAULT_MAX_IMAGE_BUFFER_SIZE 32*1024*1024
+
+// how the image data was written to the PDF
+enum ETIFFImageDataPath
+{
+	// image data was decoded, and encoded again (or written uncompressed)
+	eTIFFImageDataReencoded,
+	// compressed image data was copied as is. for tiled images, edge tiles may still be re-encoded
+	eTIFFImageDataPassedThrough
+};
+
 struct TIFFUsageParameters
 {
 	// PageIndex - For multipage tiffs, use 0 to n-1 index to get the relevant page, where n is the total number of pages in the tiff file.
 	unsigned int PageIndex;
 
+	// MaxImageBufferSize - maximum size, in bytes, of decoded image data to hold in memory. images that require more are 
+	// read, converted and written strip by strip (or row by row, when a strip is too large as well). 0 means no limit.
+	unsigned long long MaxImageBufferSize;
+
+	// UsePassthrough - when the image compression has an equivalent PDF filter (CCITT G3 and G4, LZW and deflate), copy
+	// the compressed data as is, without decoding it. Images that require conversion of their samples are always re-encoded.
+	bool UsePassthrough;
+
+	// OutImageDataPath - if not NULL, receives how the image data was written. When creating multiple pages with
+	// CreateFormXObjectsFromTIFFFile, it's set for each page in turn, ending with the last one
+	ETIFFImageDataPath* OutImageDataPath;
+
 	//	Black and white options
 	TIFFBiLevelBWColorTreatment BWTreatment;
 
@@ -81,12 +106,12 @@ struct TIFFUsageParameters
 	TIFFBiLevelGrayscaleColorTreatment GrayscaleTreatment;
 
 	TIFFUsageParameters():BWTreatment(TIFFBiLevelBWColorTreatment::DefaultTIFFBiLevelBWColorTreatment()),GrayscaleTreatment(TIFFBiLevelGrayscaleColorTreatment::DefaultTIFFBiLevelGrayscaleColorTreatment())
-						{PageIndex = 0;}
+						{PageIndex = 0;MaxImageBufferSize = TIFF_DEFAULT_MAX_IMAGE_BUFFER_SIZE;UsePassthrough = true;OutImageDataPath = NULL;}
 
 	TIFFUsageParameters(unsigned int inPageIndex,
 						TIFFBiLevelBWColorTreatment inBWTreatment,
 						TIFFBiLevelGrayscaleColorTreatment inGrayscaleTreatment):BWTreatment(inBWTreatment),GrayscaleTreatment(inGrayscaleTreatment)
-						{PageIndex = inPageIndex;}
+						{PageIndex = inPageIndex;MaxImageBufferSize = TIFF_DEFAULT_MAX_IMAGE_BUFFER_SIZE;UsePassthrough = true;OutImageDataPath = NULL;}
 
 	// default treatment is 0 page index, and defaults for black & white and Grayscale
 	static const TIFFUsageParameters& DefaultTIFFUsageParameters();
@@ -74,6 +74,8 @@ void Trace::SetLogSettings(IByteWriter* inLogStream,bool inShouldLog)
 
 void Trace::TraceToLog(const char* inFormat,...)
 {
+	std::lock_guard<std::mutex> lock(mLock);
+
 	if(mShouldLog)
 	{
 		if(NULL == mLog)
@@ -96,6 +98,8 @@ void Trace::TraceToLog(const char* inFormat,...)
 
 void Trace::TraceToLog(const char* inFormat,va_list inList)
 {
+	std::lock_guard<std::mutex> lock(mLock);
+
 	if(mShouldLog)
 	{
 		if(NULL == mLog)
@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include <string>
+#include <mutex>
 
 
 
@@ -59,7 +60,8 @@ private:
 	bool mPlaceUTF8Bom;
 
 	// use the log
-	// make it lock safe
+	// lock, so that tracing from worker threads does not mix up the buffer and log
+	std::mutex mLock;
 };
 
 
@@ -62,11 +62,21 @@ EStatusCode TrueTypeANSIFontWriter::WriteFont(	FreeTypeFaceWrapper& inFontInfo,
 
 	if (inEmbedFont)
 	{
-		fontName = inObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName;
-		EStatusCode status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
+		// use the subset font name and program if prepared ahead
+		PreparedEmbeddedFont& preparedFont = inFontOccurrence->mPreparedEmbeddedFont;
+
+		fontName = preparedFont.mSubsetFontName.empty() ? 
+						inObjectsContext->GenerateSubsetFontPrefix() + scPlus + postscriptFontName :
+						preparedFont.mSubsetFontName;
+		EStatusCode status = preparedFont.mIsPrepared ?
+								embeddedFontWriter.WriteEmbeddedFont(preparedFont,
+																	inObjectsContext,
+																	mEmbeddedFontFileObjectID) :
+								embeddedFontWriter.WriteEmbeddedFont(inFontInfo,
 																	inFontOccurrence->GetGlyphIDsAsOrderedVector(),
 																	inObjectsContext,
 																	mEmbeddedFontFileObjectID);
+		preparedFont.Reset();
 		if (PDFHummus::eFailure == status)
 			return status;
 	}
@@ -78,6 +88,16 @@ EStatusCode TrueTypeANSIFontWriter::WriteFont(	FreeTypeFaceWrapper& inFontInfo,
 	return fontWriter.WriteFont(inFontInfo, inFontOccurrence, inObjectsContext, this, fontName);
 }
 
+EStatusCode TrueTypeANSIFontWriter::PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+														WrittenFontRepresentation* inFontOccurrence)
+{
+	TrueTypeEmbeddedFontWriter embeddedFontWriter;
+
+	return embeddedFontWriter.PrepareEmbeddedFont(inFontInfo,
+												inFontOccurrence->GetGlyphIDsAsOrderedVector(),
+												inFontOccurrence->mPreparedEmbeddedFont);
+}
+
 static const std::string scTrueType = "TrueType";
 
 void TrueTypeANSIFontWriter::WriteSubTypeValue(DictionaryContext* inDictionary)
@@ -40,6 +40,11 @@ public:
 							ObjectsContext* inObjectsContext,
 							bool inEmbedFont);
 
+	// create the embedded font program ahead of WriteFont, into inFontOccurrence prepared embedded font (which should have its subset font name set).
+	// does not use the objects context
+	PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+									WrittenFontRepresentation* inFontOccurrence);
+
 	// IANSIFontWriterHelper implementation
 	virtual void WriteSubTypeValue(DictionaryContext* inDictionary);
 	virtual IFontDescriptorHelper* GetCharsetWriter();
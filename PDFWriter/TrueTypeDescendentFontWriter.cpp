@@ -50,7 +50,8 @@ EStatusCode TrueTypeDescendentFontWriter::WriteFont(	ObjectIDType inDecendentObj
 														FreeTypeFaceWrapper& inFontInfo,
 														const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
 														ObjectsContext* inObjectsContext,
-														bool inEmbedFont)
+														bool inEmbedFont,
+														PreparedEmbeddedFont& inPreparedFont)
 {
 	// reset embedded font object ID (and flag...to whether it was actually embedded or not, which may 
 	// happen due to font embedding restrictions)
@@ -59,7 +60,9 @@ EStatusCode TrueTypeDescendentFontWriter::WriteFont(	ObjectIDType inDecendentObj
 	if (inEmbedFont)
 	{
 		TrueTypeEmbeddedFontWriter embeddedFontWriter;
-		EStatusCode status = embeddedFontWriter.WriteEmbeddedFont(inFontInfo, GetOrderedKeys(inEncodedGlyphs), inObjectsContext, mEmbeddedFontFileObjectID);
+		EStatusCode status = inPreparedFont.mIsPrepared ?
+								embeddedFontWriter.WriteEmbeddedFont(inPreparedFont, inObjectsContext, mEmbeddedFontFileObjectID) :
+								embeddedFontWriter.WriteEmbeddedFont(inFontInfo, GetOrderedKeys(inEncodedGlyphs), inObjectsContext, mEmbeddedFontFileObjectID);
 
 		if (PDFHummus::eFailure == status)
 			return status;
@@ -69,6 +72,15 @@ EStatusCode TrueTypeDescendentFontWriter::WriteFont(	ObjectIDType inDecendentObj
 	return descendentFontWriter.WriteFont(inDecendentObjectID,inFontName,inFontInfo,inEncodedGlyphs,inObjectsContext,this);
 }
 
+EStatusCode TrueTypeDescendentFontWriter::PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+																const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
+																PreparedEmbeddedFont& ioPreparedFont)
+{
+	TrueTypeEmbeddedFontWriter embeddedFontWriter;
+
+	return embeddedFontWriter.PrepareEmbeddedFont(inFontInfo, GetOrderedKeys(inEncodedGlyphs), ioPreparedFont);
+}
+
 static const std::string scCIDFontType2 = "CIDFontType2";
 
 void TrueTypeDescendentFontWriter::WriteSubTypeValue(DictionaryContext* inDescendentFontContext)
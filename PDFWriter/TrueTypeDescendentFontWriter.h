@@ -34,7 +34,11 @@ public:
 									FreeTypeFaceWrapper& inFontInfo,
 									const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
 									ObjectsContext* inObjectsContext,
-									bool inEmbedFont);
+									bool inEmbedFont,
+									PreparedEmbeddedFont& inPreparedFont);
+	virtual PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+												const UIntAndGlyphEncodingInfoVector& inEncodedGlyphs,
+												PreparedEmbeddedFont& ioPreparedFont);
 	virtual void WriteSubTypeValue(DictionaryContext* inDescendentFontContext);
 	virtual void WriteAdditionalKeys(DictionaryContext* inDescendentFontContext);
 	virtual void WriteFontFileReference(DictionaryContext* inDescriptorContext,
@@ -37,6 +37,8 @@ using namespace PDFHummus;
 
 TrueTypeEmbeddedFontWriter::TrueTypeEmbeddedFontWriter(void):mFontFileReaderStream(NULL)
 {
+	mTrueTypeInput = &mOwnTrueTypeInput;
+	mTrueTypeStream = NULL;
 }
 
 TrueTypeEmbeddedFontWriter::~TrueTypeEmbeddedFontWriter(void)
@@ -50,20 +52,39 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteEmbeddedFont(
 								ObjectsContext* inObjectsContext,
 								ObjectIDType& outEmbeddedFontObjectID)
 {
-	MyStringBuf rawFontProgram;
-	bool notEmbedded;
-	EStatusCode status;
+	PreparedEmbeddedFont preparedFont;
+
+	PrepareEmbeddedFont(inFontInfo,inSubsetGlyphIDs,preparedFont);
+	return WriteEmbeddedFont(preparedFont,inObjectsContext,outEmbeddedFontObjectID);
+}
+
+EStatusCode TrueTypeEmbeddedFontWriter::PrepareEmbeddedFont(
+								FreeTypeFaceWrapper& inFontInfo,
+								const UIntVector& inSubsetGlyphIDs,
+								PreparedEmbeddedFont& outPreparedFont)
+{
+	outPreparedFont.mStatus = CreateTrueTypeSubset(inFontInfo,inSubsetGlyphIDs,outPreparedFont.mNotEmbedded,outPreparedFont.mFontProgram);
+	outPreparedFont.mIsPrepared = true;
+	return outPreparedFont.mStatus;
+}
+
+EStatusCode TrueTypeEmbeddedFontWriter::WriteEmbeddedFont(
+								PreparedEmbeddedFont& inPreparedFont,
+								ObjectsContext* inObjectsContext,
+								ObjectIDType& outEmbeddedFontObjectID)
+{
+	MyStringBuf& rawFontProgram = inPreparedFont.mFontProgram;
+	EStatusCode status = inPreparedFont.mStatus;
 
 	do
 	{
-		status = CreateTrueTypeSubset(inFontInfo,inSubsetGlyphIDs,notEmbedded,rawFontProgram);
 		if(status != PDFHummus::eSuccess)
 		{
 			TRACE_LOG("TrueTypeEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
 			break;
 		}	
 
-		if(notEmbedded)
+		if(inPreparedFont.mNotEmbedded)
 		{
 			// can't embed. mark succesful, and go back empty
 			outEmbeddedFontObjectID = 0;
@@ -113,28 +134,43 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset(	FreeTypeFaceWrappe
 	{
 		UIntVector subsetGlyphIDs = inSubsetGlyphIDs;
 
-		status = mTrueTypeFile.OpenFile(inFontInfo.GetFontFilePath());
-		if(status != PDFHummus::eSuccess)
+		// use the font program that the face was opened from, or the shared one if the font program cache is enabled. otherwise read from the font file
+		mFontProgram = inFontInfo.GetFontProgram();
+		if(!mFontProgram)
+			mFontProgram = FontProgramCache::DefaultCache().GetFontProgram(inFontInfo.GetFontFilePath(),inFontInfo.GetFontIndex());
+		if(mFontProgram && mFontProgram->GetTrueTypeInput())
 		{
-			TRACE_LOG1("TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset, cannot open true type font file at %s",inFontInfo.GetFontFilePath().c_str());
-			break;
+			mFontProgramStream.Assign((Byte*)mFontProgram->GetData(),mFontProgram->GetSize());
+			mTrueTypeStream = &mFontProgramStream;
+			mTrueTypeInput = mFontProgram->GetTrueTypeInput();
 		}
-
-		status = mTrueTypeInput.ReadOpenTypeFile(mTrueTypeFile.GetInputStream(),(unsigned short)inFontInfo.GetFontIndex());
-		if(status != PDFHummus::eSuccess)
+		else
 		{
-			TRACE_LOG("TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset, failed to read true type file");
-			break;
+			status = mTrueTypeFile.OpenFile(inFontInfo.GetFontFilePath());
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG1("TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset, cannot open true type font file at %s",inFontInfo.GetFontFilePath().c_str());
+				break;
+			}
+			mTrueTypeStream = mTrueTypeFile.GetInputStream();
+
+			status = mOwnTrueTypeInput.ReadOpenTypeFile(mTrueTypeStream,(unsigned short)inFontInfo.GetFontIndex());
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG("TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset, failed to read true type file");
+				break;
+			}
+			mTrueTypeInput = &mOwnTrueTypeInput;
 		}
 
-		if(mTrueTypeInput.GetOpenTypeFontType() != EOpenTypeTrueType)
+		if(mTrueTypeInput->GetOpenTypeFontType() != EOpenTypeTrueType)
 		{
 			TRACE_LOG("TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset, font file is not true type, so there is an exceptions here. expecting true types only");
 			break;
 		}
 	
 		// see if font may be embedded
-		if(mTrueTypeInput.mOS2Exists && !FSType(mTrueTypeInput.mOS2.fsType).CanEmbed())
+		if(mTrueTypeInput->mOS2Exists && !FSType(mTrueTypeInput->mOS2.fsType).CanEmbed())
 		{
 			outNotEmbedded = true;
 			return PDFHummus::eSuccess;
@@ -199,7 +235,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset(	FreeTypeFaceWrappe
 			break;
 		}
 
-		if(mTrueTypeInput.mCVTExists)
+		if(mTrueTypeInput->mCVTExists)
 		{
 			status = WriteCVT();
 			if(status != PDFHummus::eSuccess)
@@ -209,7 +245,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset(	FreeTypeFaceWrappe
 			}
 		}
 
-		if(mTrueTypeInput.mFPGMExists)
+		if(mTrueTypeInput->mFPGMExists)
 		{
 			status = WriteFPGM();
 			if(status != PDFHummus::eSuccess)
@@ -219,7 +255,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset(	FreeTypeFaceWrappe
 			}
 		}
 
-		if(mTrueTypeInput.mPREPExists)
+		if(mTrueTypeInput->mPREPExists)
 		{
 			status = WritePREP();
 			if(status != PDFHummus::eSuccess)
@@ -236,7 +272,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset(	FreeTypeFaceWrappe
 			break;	
 		}
 
-        if(mTrueTypeInput.mOS2Exists)
+        if(mTrueTypeInput->mOS2Exists)
         {
             status = WriteOS2();
             if(status != PDFHummus::eSuccess)
@@ -274,6 +310,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTrueTypeSubset(	FreeTypeFaceWrappe
 
 	delete[] locaTable;
 	mTrueTypeFile.CloseFile();
+	mTrueTypeStream = NULL;
 	return status;
 }
 
@@ -307,13 +344,13 @@ bool TrueTypeEmbeddedFontWriter::AddComponentGlyphs(unsigned int inGlyphID,UIntS
 	UIntList::iterator itComponentGlyphs;
 	bool isComposite = false;
 
-	if(inGlyphID >= mTrueTypeInput.mMaxp.NumGlyphs)
+	if(inGlyphID >= mTrueTypeInput->mMaxp.NumGlyphs)
 	{
-		TRACE_LOG2("TrueTypeEmbeddedFontWriter::AddComponentGlyphs, error, requested glyph index %ld is larger than the maximum glyph index for this font which is %ld. ",inGlyphID,mTrueTypeInput.mMaxp.NumGlyphs-1);
+		TRACE_LOG2("TrueTypeEmbeddedFontWriter::AddComponentGlyphs, error, requested glyph index %ld is larger than the maximum glyph index for this font which is %ld. ",inGlyphID,mTrueTypeInput->mMaxp.NumGlyphs-1);
 		return false;
 	}
 
-	glyfTableEntry = mTrueTypeInput.mGlyf[inGlyphID];
+	glyfTableEntry = mTrueTypeInput->mGlyf[inGlyphID];
 	if(glyfTableEntry != NULL && glyfTableEntry->mComponentGlyphs.size() > 0)
 	{
 		isComposite = true;
@@ -353,9 +390,9 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteTrueTypeHeader()
 	unsigned short tableCount = 
 		9	// needs - cmap, glyf, head, hhea, hmtx, loca, maxp, name, OS/2
 		+
-		(mTrueTypeInput.mCVTExists ? 1:0) + // cvt
-		(mTrueTypeInput.mPREPExists ? 1:0) + // prep
-		(mTrueTypeInput.mFPGMExists ? 1:0); // fpgm
+		(mTrueTypeInput->mCVTExists ? 1:0) + // cvt
+		(mTrueTypeInput->mPREPExists ? 1:0) + // prep
+		(mTrueTypeInput->mFPGMExists ? 1:0); // fpgm
 
 	// here we go....
 	mPrimitivesWriter.WriteULONG(0x10000);
@@ -365,12 +402,12 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteTrueTypeHeader()
 	mPrimitivesWriter.WriteUSHORT(smallerPowerTwo);
 	mPrimitivesWriter.WriteUSHORT((tableCount - (1<<smallerPowerTwo)) << 4);
 
-	if (mTrueTypeInput.mOS2Exists)
+	if (mTrueTypeInput->mOS2Exists)
 		WriteEmptyTableEntry("OS/2", mOS2EntryWritingOffset);
 	WriteEmptyTableEntry("cmap", mCMAPEntryWritingOffset);
-	if(mTrueTypeInput.mCVTExists)
+	if(mTrueTypeInput->mCVTExists)
 		WriteEmptyTableEntry("cvt ",mCVTEntryWritingOffset);
-	if(mTrueTypeInput.mFPGMExists)
+	if(mTrueTypeInput->mFPGMExists)
 		WriteEmptyTableEntry("fpgm",mFPGMEntryWritingOffset);
 	WriteEmptyTableEntry("glyf",mGLYFEntryWritingOffset);
 	WriteEmptyTableEntry("head",mHEADEntryWritingOffset);
@@ -379,7 +416,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteTrueTypeHeader()
 	WriteEmptyTableEntry("loca",mLOCAEntryWritingOffset);
 	WriteEmptyTableEntry("maxp",mMAXPEntryWritingOffset);
 	WriteEmptyTableEntry("name",mNAMEEntryWritingOffset);
-	if(mTrueTypeInput.mPREPExists)
+	if(mTrueTypeInput->mPREPExists)
 		WriteEmptyTableEntry("prep",mPREPEntryWritingOffset);
 
 	mPrimitivesWriter.PadTo4();
@@ -415,7 +452,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteHead()
 	// set the checksum
 	// and store the offset to the checksum
 
-	TableEntry* tableEntry = mTrueTypeInput.GetTableEntry("head");
+	TableEntry* tableEntry = mTrueTypeInput->GetTableEntry("head");
 	LongFilePositionType startTableOffset;
 	OutputStreamTraits streamCopier(&mFontFileStream);
 	LongFilePositionType endOfStream;
@@ -423,8 +460,8 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteHead()
 	startTableOffset = mFontFileStream.GetCurrentPosition();
 
 	// copy and save the current position
-	mTrueTypeFile.GetInputStream()->SetPosition(tableEntry->Offset);
-	streamCopier.CopyToOutputStream(mTrueTypeFile.GetInputStream(),tableEntry->Length);
+	mTrueTypeStream->SetPosition(tableEntry->Offset);
+	streamCopier.CopyToOutputStream(mTrueTypeStream,tableEntry->Length);
 	mPrimitivesWriter.PadTo4();
 	endOfStream = mFontFileStream.GetCurrentPosition();
 
@@ -484,7 +521,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteHHea()
 	// copy as is, then possibly adjust the hmtx NumberOfHMetrics field, if the glyphs
 	// count is lower
 
-	TableEntry* tableEntry = mTrueTypeInput.GetTableEntry("hhea");
+	TableEntry* tableEntry = mTrueTypeInput->GetTableEntry("hhea");
 	LongFilePositionType startTableOffset;
 	OutputStreamTraits streamCopier(&mFontFileStream);
 	LongFilePositionType endOfStream;
@@ -492,13 +529,13 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteHHea()
 	startTableOffset = mFontFileStream.GetCurrentPosition();
 
 	// copy and save the current position
-	mTrueTypeFile.GetInputStream()->SetPosition(tableEntry->Offset);
-	streamCopier.CopyToOutputStream(mTrueTypeFile.GetInputStream(),tableEntry->Length);
+	mTrueTypeStream->SetPosition(tableEntry->Offset);
+	streamCopier.CopyToOutputStream(mTrueTypeStream,tableEntry->Length);
 	mPrimitivesWriter.PadTo4();
 	endOfStream = mFontFileStream.GetCurrentPosition();
 
 	// adjust the NumberOfHMetrics if necessary
-	if(mTrueTypeInput.mHHea.NumberOfHMetrics > mSubsetFontGlyphsCount)
+	if(mTrueTypeInput->mHHea.NumberOfHMetrics > mSubsetFontGlyphsCount)
 	{
 		mFontFileStream.SetPosition(startTableOffset + tableEntry->Length - 2);
 		mPrimitivesWriter.WriteUSHORT(mSubsetFontGlyphsCount);
@@ -526,15 +563,15 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteHMtx()
 
 	// write the table. write pairs until min(numberofhmetrics,mSubsetFontGlyphsCount)
 	// then if mSubsetFontGlyphsCount > numberofhmetrics writh the width metrics as well
-	unsigned numberOfHMetrics = std::min(mTrueTypeInput.mHHea.NumberOfHMetrics,mSubsetFontGlyphsCount);
+	unsigned numberOfHMetrics = std::min(mTrueTypeInput->mHHea.NumberOfHMetrics,mSubsetFontGlyphsCount);
 	unsigned short i=0;
 	for(;i<numberOfHMetrics;++i)
 	{
-		mPrimitivesWriter.WriteUSHORT(mTrueTypeInput.mHMtx[i].AdvanceWidth);
-		mPrimitivesWriter.WriteSHORT(mTrueTypeInput.mHMtx[i].LeftSideBearing);
+		mPrimitivesWriter.WriteUSHORT(mTrueTypeInput->mHMtx[i].AdvanceWidth);
+		mPrimitivesWriter.WriteSHORT(mTrueTypeInput->mHMtx[i].LeftSideBearing);
 	}
 	for(;i<mSubsetFontGlyphsCount;++i)
-		mPrimitivesWriter.WriteSHORT(mTrueTypeInput.mHMtx[i].LeftSideBearing);
+		mPrimitivesWriter.WriteSHORT(mTrueTypeInput->mHMtx[i].LeftSideBearing);
 
 	LongFilePositionType endOfTable = mFontFileStream.GetCurrentPosition();
 	mPrimitivesWriter.PadTo4();
@@ -555,7 +592,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteMaxp()
 {
 	// copy as is, then adjust the glyphs count
 
-	TableEntry* tableEntry = mTrueTypeInput.GetTableEntry("maxp");
+	TableEntry* tableEntry = mTrueTypeInput->GetTableEntry("maxp");
 	LongFilePositionType startTableOffset;
 	OutputStreamTraits streamCopier(&mFontFileStream);
 	LongFilePositionType endOfStream;
@@ -563,8 +600,8 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteMaxp()
 	startTableOffset = mFontFileStream.GetCurrentPosition();
 
 	// copy and save the current position
-	mTrueTypeFile.GetInputStream()->SetPosition(tableEntry->Offset);
-	streamCopier.CopyToOutputStream(mTrueTypeFile.GetInputStream(),tableEntry->Length);
+	mTrueTypeStream->SetPosition(tableEntry->Offset);
+	streamCopier.CopyToOutputStream(mTrueTypeStream,tableEntry->Length);
 	mPrimitivesWriter.PadTo4();
 	endOfStream = mFontFileStream.GetCurrentPosition();
 
@@ -601,7 +638,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteGlyf(const UIntVector& inSubsetGlyp
 	// k. write the glyphs table. you only need to write the glyphs you are actually using.
 	// while at it...update the locaTable
 
-	TableEntry* tableEntry = mTrueTypeInput.GetTableEntry("glyf");
+	TableEntry* tableEntry = mTrueTypeInput->GetTableEntry("glyf");
 	LongFilePositionType startTableOffset = mFontFileStream.GetCurrentPosition();
 	UIntVector::const_iterator it = inSubsetGlyphIDs.begin();
 	OutputStreamTraits streamCopier(&mFontFileStream);
@@ -612,21 +649,21 @@ EStatusCode TrueTypeEmbeddedFontWriter::WriteGlyf(const UIntVector& inSubsetGlyp
 	for(;it != inSubsetGlyphIDs.end() && eSuccess == status; ++it)
 	{
 		glyphIndex = *it;
-		if(glyphIndex >= mTrueTypeInput.mMaxp.NumGlyphs)
+		if(glyphIndex >= mTrueTypeInput->mMaxp.NumGlyphs)
 		{
-			TRACE_LOG2("TrueTypeEmbeddedFontWriter::WriteGlyf, error, requested glyph index %ld is larger than the maximum glyph index for this font which is %ld. ",glyphIndex,mTrueTypeInput.mMaxp.NumGlyphs-1);
+			TRACE_LOG2("TrueTypeEmbeddedFontWriter::WriteGlyf, error, requested glyph index %ld is larger than the maximum glyph index for this font which is %ld. ",glyphIndex,mTrueTypeInput->mMaxp.NumGlyphs-1);
 			status = eFailure;
 			break;
 		}
 
 		for(unsigned short i= previousGlyphIndexEnd + 1; i<=glyphIndex;++i)
 			inLocaTable[i] = inLocaTable[previousGlyphIndexEnd];
-		if(mTrueTypeInput.mGlyf[glyphIndex] != NULL)
+		if(mTrueTypeInput->mGlyf[glyphIndex] != NULL)
 		{
-			mTrueTypeFile.GetInputStream()->SetPosition(tableEntry->Offset + 
-															mTrueTypeInput.mLoca[glyphIndex]);
-			streamCopier.CopyToOutputStream(mTrueTypeFile.GetInputStream(),
-				mTrueTypeInput.mLoca[(glyphIndex) + 1] - mTrueTypeInput.mLoca[glyphIndex]);
+			mTrueTypeStream->SetPosition(tableEntry->Offset + 
+															mTrueTypeInput->mLoca[glyphIndex]);
+			streamCopier.CopyToOutputStream(mTrueTypeStream,
+				mTrueTypeInput->mLoca[(glyphIndex) + 1] - mTrueTypeInput->mLoca[glyphIndex]);
 		}
 		inLocaTable[glyphIndex + 1] = (unsigned long)(mFontFileStream.GetCurrentPosition() - startTableOffset);
 		previousGlyphIndexEnd = glyphIndex + 1;
@@ -705,7 +742,7 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTableCopy(const char* inTableName,
 {
 	// copy as is, no adjustments required
 
-	TableEntry* tableEntry = mTrueTypeInput.GetTableEntry(inTableName);
+	TableEntry* tableEntry = mTrueTypeInput->GetTableEntry(inTableName);
 	LongFilePositionType startTableOffset;
 	OutputStreamTraits streamCopier(&mFontFileStream);
 	LongFilePositionType endOfStream;
@@ -713,8 +750,8 @@ EStatusCode TrueTypeEmbeddedFontWriter::CreateTableCopy(const char* inTableName,
 	startTableOffset = mFontFileStream.GetCurrentPosition();
 
 	// copy and save the current position
-	mTrueTypeFile.GetInputStream()->SetPosition(tableEntry->Offset);
-	streamCopier.CopyToOutputStream(mTrueTypeFile.GetInputStream(),tableEntry->Length);
+	mTrueTypeStream->SetPosition(tableEntry->Offset);
+	streamCopier.CopyToOutputStream(mTrueTypeStream,tableEntry->Length);
 	mPrimitivesWriter.PadTo4();
 	endOfStream = mFontFileStream.GetCurrentPosition();
 
@@ -29,6 +29,9 @@
 #include "InputStringBufferStream.h"
 #include "OpenTypePrimitiveReader.h"
 #include "MyStringBuf.h"
+#include "FontProgramCache.h"
+#include "InputByteArrayStream.h"
+#include "WrittenFontRepresentation.h"
 
 #include <vector>
 #include <set>
@@ -52,9 +55,22 @@ public:
 									ObjectsContext* inObjectsContext,
 									ObjectIDType& outEmbeddedFontObjectID);
 
+	// split version of WriteEmbeddedFont. PrepareEmbeddedFont only creates the subset font program, and does not use the objects context,
+	// so fonts may be prepared in parallel (a writer per font). the second WriteEmbeddedFont writes the prepared program
+	PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+									const UIntVector& inSubsetGlyphIDs,
+									PreparedEmbeddedFont& outPreparedFont);
+	PDFHummus::EStatusCode WriteEmbeddedFont(	PreparedEmbeddedFont& inPreparedFont,
+									ObjectsContext* inObjectsContext,
+									ObjectIDType& outEmbeddedFontObjectID);
+
 private:
-	OpenTypeFileInput mTrueTypeInput;
+	OpenTypeFileInput* mTrueTypeInput; // either the shared font program tables, or mOwnTrueTypeInput
+	OpenTypeFileInput mOwnTrueTypeInput;
+	FontProgramSharedPtr mFontProgram;
+	InputByteArrayStream mFontProgramStream;
 	InputFile mTrueTypeFile;
+	IByteReaderWithPosition* mTrueTypeStream; // either mFontProgramStream, or mTrueTypeFile stream
 	OutputStringBufferStream mFontFileStream;
 	TrueTypePrimitiveWriter mPrimitivesWriter;
 	InputStringBufferStream mFontFileReaderStream; // now this might be confusing - i'm using a reader
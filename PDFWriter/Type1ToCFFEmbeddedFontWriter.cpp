@@ -37,6 +37,7 @@ using namespace PDFHummus;
 Type1ToCFFEmbeddedFontWriter::Type1ToCFFEmbeddedFontWriter(void)
 {
 	mCharset = NULL;
+	mType1Stream = NULL;
 }
 
 Type1ToCFFEmbeddedFontWriter::~Type1ToCFFEmbeddedFontWriter(void)
@@ -143,22 +144,43 @@ EStatusCode Type1ToCFFEmbeddedFontWriter::WriteEmbeddedFont(
 															ObjectsContext* inObjectsContext,
 															ObjectIDType& outEmbeddedFontObjectID)
 {
-	MyStringBuf rawFontProgram; 
-	bool notEmbedded;
-		// as oppose to true type, the reason for using a memory stream here is mainly peformance - i don't want to start
-		// setting file pointers and move in a file stream
-	EStatusCode status;
+	PreparedEmbeddedFont preparedFont;
+
+	PrepareEmbeddedFont(inFontInfo,inSubsetGlyphIDs,inSubsetFontName,preparedFont);
+	return WriteEmbeddedFont(preparedFont,inFontFile3SubType,inObjectsContext,outEmbeddedFontObjectID);
+}
+
+EStatusCode Type1ToCFFEmbeddedFontWriter::PrepareEmbeddedFont(
+															FreeTypeFaceWrapper& inFontInfo,
+															const UIntVector& inSubsetGlyphIDs,
+															const std::string& inSubsetFontName,
+															PreparedEmbeddedFont& outPreparedFont)
+{
+	// as oppose to true type, the reason for using a memory stream here is mainly peformance - i don't want to start
+	// setting file pointers and move in a file stream
+	outPreparedFont.mStatus = CreateCFFSubset(inFontInfo,inSubsetGlyphIDs,inSubsetFontName,outPreparedFont.mNotEmbedded,outPreparedFont.mFontProgram);
+	outPreparedFont.mIsPrepared = true;
+	return outPreparedFont.mStatus;
+}
+
+EStatusCode Type1ToCFFEmbeddedFontWriter::WriteEmbeddedFont(
+															PreparedEmbeddedFont& inPreparedFont,
+															const std::string& inFontFile3SubType,
+															ObjectsContext* inObjectsContext,
+															ObjectIDType& outEmbeddedFontObjectID)
+{
+	MyStringBuf& rawFontProgram = inPreparedFont.mFontProgram;
+	EStatusCode status = inPreparedFont.mStatus;
 
 	do
 	{
-		status = CreateCFFSubset(inFontInfo,inSubsetGlyphIDs,inSubsetFontName,notEmbedded,rawFontProgram);
 		if(status != PDFHummus::eSuccess)
 		{
 			TRACE_LOG("Type1ToCFFEmbeddedFontWriter::WriteEmbeddedFont, failed to write embedded font program");
 			break;
 		}	
 
-		if(notEmbedded)
+		if(inPreparedFont.mNotEmbedded)
 		{
 			// can't embed. mark succesful, and go back empty
 			outEmbeddedFontObjectID = 0;
@@ -213,14 +235,25 @@ EStatusCode Type1ToCFFEmbeddedFontWriter::CreateCFFSubset(
 		if(subsetGlyphIDs.front() != 0) // make sure 0 glyph is in
 			subsetGlyphIDs.insert(subsetGlyphIDs.begin(),0);
 
-		status = mType1File.OpenFile(inFontInfo.GetFontFilePath());
-		if(status != PDFHummus::eSuccess)
+		// read from the bytes that the face was opened from, if loaded to memory. otherwise read from the font file
+		mFontProgram = inFontInfo.GetFontProgram();
+		if(mFontProgram)
 		{
-			TRACE_LOG1("Type1ToCFFEmbeddedFontWriter::CreateCFFSubset, cannot open Type 1 font file at %s",inFontInfo.GetFontFilePath().c_str());
-			break;
+			mFontProgramStream.Assign((IOBasicTypes::Byte*)mFontProgram->GetData(),mFontProgram->GetSize());
+			mType1Stream = &mFontProgramStream;
+		}
+		else
+		{
+			status = mType1File.OpenFile(inFontInfo.GetFontFilePath());
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG1("Type1ToCFFEmbeddedFontWriter::CreateCFFSubset, cannot open Type 1 font file at %s",inFontInfo.GetFontFilePath().c_str());
+				break;
+			}
+			mType1Stream = mType1File.GetInputStream();
 		}
 
-		status = mType1Input.ReadType1File(mType1File.GetInputStream());
+		status = mType1Input.ReadType1File(mType1Stream);
 		if(status != PDFHummus::eSuccess)
 		{
 			TRACE_LOG("Type1ToCFFEmbeddedFontWriter::CreateCFFSubset, failed to read Type 1 file");
@@ -336,6 +369,7 @@ EStatusCode Type1ToCFFEmbeddedFontWriter::CreateCFFSubset(
 	}while(false);
 
 	mType1File.CloseFile();
+	mFontProgram.reset();
 	FreeTemporaryStructs();
 	return status;	
 }
@@ -26,6 +26,9 @@
 #include "CFFPrimitiveWriter.h"
 #include "OutputStringBufferStream.h"
 #include "MyStringBuf.h"
+#include "WrittenFontRepresentation.h"
+#include "FontProgramCache.h"
+#include "InputByteArrayStream.h"
 
 
 #include <vector>
@@ -60,9 +63,23 @@ public:
 									ObjectsContext* inObjectsContext,
 									ObjectIDType& outEmbeddedFontObjectID);
 
+	// split version of WriteEmbeddedFont. PrepareEmbeddedFont only creates the subset font program, and does not use the objects context,
+	// so fonts may be prepared in parallel (a writer per font). the second WriteEmbeddedFont writes the prepared program
+	PDFHummus::EStatusCode PrepareEmbeddedFont(	FreeTypeFaceWrapper& inFontInfo,
+									const UIntVector& inSubsetGlyphIDs,
+									const std::string& inSubsetFontName,
+									PreparedEmbeddedFont& outPreparedFont);
+	PDFHummus::EStatusCode WriteEmbeddedFont(	PreparedEmbeddedFont& inPreparedFont,
+									const std::string& inFontFile3SubType,
+									ObjectsContext* inObjectsContext,
+									ObjectIDType& outEmbeddedFontObjectID);
+
 private:
 	Type1Input mType1Input;
 	InputFile mType1File;
+	FontProgramSharedPtr mFontProgram;
+	InputByteArrayStream mFontProgramStream;
+	IByteReaderWithPosition* mType1Stream;
 	CFFPrimitiveWriter mPrimitivesWriter;
 	OutputStringBufferStream mFontFileStream;
 	StringVector mStrings;
@@ -36,6 +36,11 @@
 
 
 #include <list>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <system_error>
+#include <algorithm>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -47,6 +52,8 @@ UsedFontsRepository::UsedFontsRepository(void)
 	mInputFontsInformation = NULL;
 	mObjectsContext = NULL;
 	mEmbedFonts = true;
+	mSubsetFontsInParallel = false;
+	mLoadFontsToMemory = false;
 }
 
 UsedFontsRepository::~UsedFontsRepository(void)
@@ -63,6 +70,18 @@ void UsedFontsRepository::SetEmbedFonts(bool inEmbedFonts) {
 	mEmbedFonts = inEmbedFonts;
 }
 
+void UsedFontsRepository::SetSubsetFontsInParallel(bool inSubsetFontsInParallel)
+{
+	mSubsetFontsInParallel = inSubsetFontsInParallel;
+}
+
+void UsedFontsRepository::SetLoadFontsToMemory(bool inLoadFontsToMemory)
+{
+	mLoadFontsToMemory = inLoadFontsToMemory;
+	if(mInputFontsInformation)
+		mInputFontsInformation->SetLoadFontsToMemory(inLoadFontsToMemory);
+}
+
 PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePath,const std::string& inOptionalMetricsFile,long inFontIndex)
 {
 	if(!mObjectsContext)
@@ -75,7 +94,10 @@ PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePa
 	if(it == mUsedFonts.end())
 	{
 		if(!mInputFontsInformation)
+		{
 			mInputFontsInformation = new FreeTypeWrapper();
+			mInputFontsInformation->SetLoadFontsToMemory(mLoadFontsToMemory);
+		}
 
 
 		FT_Face face;
@@ -102,6 +124,8 @@ PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePa
 				delete usedFont;
 				usedFont = NULL;
 			}
+			else
+				usedFont->GetFreeTypeFont()->SetFontProgram(mInputFontsInformation->GetFontProgram(face));
 			it = mUsedFonts.insert(StringAndLongToPDFUsedFontMap::value_type(StringAndLong(inFontFilePath,inFontIndex),usedFont)).first;
 
 		}
@@ -110,14 +134,74 @@ PDFUsedFont* UsedFontsRepository::GetFontForFile(const std::string& inFontFilePa
 }
 
 EStatusCode UsedFontsRepository::WriteUsedFontsDefinitions()
+{
+	if(mSubsetFontsInParallel && mEmbedFonts && mUsedFonts.size() > 1)
+		return WriteUsedFontsDefinitionsInParallel();
+
+	StringAndLongToPDFUsedFontMap::iterator it = mUsedFonts.begin();
+	EStatusCode status = PDFHummus::eSuccess;
+
+	for(; it != mUsedFonts.end() && PDFHummus::eSuccess == status; ++it)
+		status = it->second ?
+                    it->second->WriteFontDefinition():
+                    eFailure;
+
+	return status;
+}
+
+typedef std::list<std::future<EStatusCode> > EStatusCodeFutureList;
+EStatusCode UsedFontsRepository::WriteUsedFontsDefinitionsInParallel()
 {
 	StringAndLongToPDFUsedFontMap::iterator it = mUsedFonts.begin();
 	EStatusCode status = PDFHummus::eSuccess;
 
+	// generate the subset font names first, serially and in the order of writing, so they are the same as when generated while writing
+	for(; it != mUsedFonts.end(); ++it)
+		if(it->second)
+			it->second->NameEmbeddedFonts();
+
+	// now create the subsets with worker threads, and write each font definition in order once its subsets are ready.
+	// limit the fonts in work, to bound the memory held by subsets waiting to be written
+	unsigned int maxParallelFonts = std::max<unsigned int>(std::thread::hardware_concurrency(),1);
+	StringAndLongToPDFUsedFontMap::iterator itPreparing = mUsedFonts.begin();
+	EStatusCodeFutureList pendingFonts;
+
+	it = mUsedFonts.begin();
 	for(; it != mUsedFonts.end() && PDFHummus::eSuccess == status; ++it)
+	{
+		for(; itPreparing != mUsedFonts.end() && pendingFonts.size() < maxParallelFonts; ++itPreparing)
+		{
+			std::future<EStatusCode> preparation;
+			if(itPreparing->second)
+			{
+				try
+				{
+					preparation = std::async(std::launch::async,&PDFUsedFont::PrepareEmbeddedFonts,itPreparing->second);
+				}
+				catch(std::system_error&)
+				{
+					// no thread to prepare the font on, so prepare it serially, before it is written
+					preparation = std::async(std::launch::deferred,&PDFUsedFont::PrepareEmbeddedFonts,itPreparing->second);
+				}
+			}
+			pendingFonts.push_back(std::move(preparation));
+		}
+
+		// preparation failures are left for the font writing to report, same as when not preparing
+		if(pendingFonts.front().valid())
+			pendingFonts.front().wait();
+		pendingFonts.pop_front();
+
 		status = it->second ?
                     it->second->WriteFontDefinition():
                     eFailure;
+	}
+
+	// on failure, wait for fonts still in work. deferred fonts were never started, so they are just dropped
+	EStatusCodeFutureList::iterator itPending = pendingFonts.begin();
+	for(; itPending != pendingFonts.end(); ++itPending)
+		if(itPending->valid() && itPending->wait_for(std::chrono::seconds(0)) != std::future_status::deferred)
+			itPending->wait();
 
 	return status;
 }
@@ -237,7 +321,10 @@ EStatusCode UsedFontsRepository::ReadState(PDFParser* inStateReader,ObjectIDType
 	PDFObjectCastPtr<PDFIndirectObjectReference> valueItem;
 
 	if(!mInputFontsInformation)
+	{
 		mInputFontsInformation = new FreeTypeWrapper();
+		mInputFontsInformation->SetLoadFontsToMemory(mLoadFontsToMemory);
+	}
 
 	while(it.MoveNext() && PDFHummus::eSuccess == status)
 	{
@@ -277,6 +364,7 @@ EStatusCode UsedFontsRepository::ReadState(PDFParser* inStateReader,ObjectIDType
 			status = PDFHummus::eFailure;
 			break;
 		}
+		usedFont->GetFreeTypeFont()->SetFontProgram(mInputFontsInformation->GetFontProgram(face));
 
 		usedFont->ReadState(inStateReader,valueItem->mObjectID);
 		mUsedFonts.insert(StringAndLongToPDFUsedFontMap::value_type(StringAndLong(filePath,fontIndex),usedFont));
@@ -296,4 +384,6 @@ void UsedFontsRepository::Reset()
 	mInputFontsInformation = NULL;
 	mOptionaMetricsFiles.clear();
 	mEmbedFonts = true;
+	mSubsetFontsInParallel = false;
+	mLoadFontsToMemory = false;
 }
\ No newline at end of file
@@ -46,6 +46,10 @@ public:
 
 	void SetObjectsContext(ObjectsContext* inObjectsContext);
 	void SetEmbedFonts(bool inEmbedFonts);
+	// create the embedded fonts subsets in parallel, by worker threads, when writing the fonts definitions. output is the same
+	void SetSubsetFontsInParallel(bool inSubsetFontsInParallel);
+	// open font faces from font files loaded to memory, and share the loaded files with the embedded font writers
+	void SetLoadFontsToMemory(bool inLoadFontsToMemory);
 
 
 	PDFUsedFont* GetFontForFile(const std::string& inFontFilePath,long inFontIndex);
@@ -66,4 +70,8 @@ private:
 	StringAndLongToPDFUsedFontMap mUsedFonts;
 	StringToStringMap mOptionaMetricsFiles;
 	bool mEmbedFonts;
+	bool mSubsetFontsInParallel;
+	bool mLoadFontsToMemory;
+
+	PDFHummus::EStatusCode WriteUsedFontsDefinitionsInParallel();
 };
@@ -197,6 +197,41 @@ EStatusCode WrittenFontCFF::WriteFontDefinition(FreeTypeFaceWrapper& inFontInfo,
 	return status;
 }
 
+EStatusCode WrittenFontCFF::PrepareEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	do
+	{
+		if(ShouldWriteRepresentation(mANSIRepresentation))
+		{
+			CFFANSIFontWriter fontWriter;
+
+			status = fontWriter.PrepareEmbeddedFont(inFontInfo, mANSIRepresentation);
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG("WrittenFontCFF::PrepareEmbeddedFonts, Failed to prepare Ansi embedded font");
+				break;
+			}
+		}
+
+		if(ShouldWriteRepresentation(mCIDRepresentation))
+		{
+			CIDFontWriter fontWriter;
+			CFFDescendentFontWriter descendentFontWriter;
+
+			status = fontWriter.PrepareEmbeddedFont(inFontInfo, mCIDRepresentation, &descendentFontWriter);
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG("WrittenFontCFF::PrepareEmbeddedFonts, Failed to prepare CID embedded font");
+				break;
+			}
+		}
+
+	} while(false);
+
+	return status;
+}
+
 bool WrittenFontCFF::AddToANSIRepresentation(	const GlyphUnicodeMappingListList& inGlyphsList,
 												UShortListList& outEncodedCharacters)
 {
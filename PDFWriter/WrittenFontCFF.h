@@ -38,6 +38,7 @@ public:
 
 
 	virtual PDFHummus::EStatusCode WriteFontDefinition(FreeTypeFaceWrapper& inFontInfo, bool inEmbedFont);
+	virtual PDFHummus::EStatusCode PrepareEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo);
 
 	virtual PDFHummus::EStatusCode WriteState(ObjectsContext* inStateWriter,ObjectIDType inObjectId);
 	virtual PDFHummus::EStatusCode ReadState(PDFParser* inStateReader,ObjectIDType inObjectID);
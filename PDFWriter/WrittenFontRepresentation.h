@@ -21,7 +21,10 @@
 #pragma once
 
 #include "ObjectsBasicTypes.h"
+#include "EStatusCode.h"
+#include "MyStringBuf.h"
 
+#include <string>
 #include <map>
 #include <algorithm>
 #include <vector>
@@ -57,12 +60,41 @@ static UIntVector GetOrderedKeys(const UIntToGlyphEncodingInfoMap& inMap)
 }
 
 
+/*
+	Embedded font program of a representation, created ahead of writing the font definition. this allows creating the subsets
+	of multiple fonts in parallel, and then writing them in order. font writers use the prepared subset font name and program
+	when available, and create them otherwise.
+*/
+struct PreparedEmbeddedFont
+{
+	PreparedEmbeddedFont(){mIsPrepared = false; mStatus = PDFHummus::eSuccess; mNotEmbedded = false;}
+
+	// subset prefix + postscript font name. empty if not generated yet
+	std::string mSubsetFontName;
+
+	// font program creation results
+	bool mIsPrepared;
+	PDFHummus::EStatusCode mStatus;
+	bool mNotEmbedded;
+	MyStringBuf mFontProgram;
+
+	void Reset()
+	{
+		mSubsetFontName.clear();
+		mIsPrepared = false;
+		mStatus = PDFHummus::eSuccess;
+		mNotEmbedded = false;
+		mFontProgram.str(std::string());
+	}
+};
+
 struct WrittenFontRepresentation
 {	
 	WrittenFontRepresentation(){mWrittenObjectID = 0;}
 
 	UIntToGlyphEncodingInfoMap mGlyphIDToEncodedChar;
 	ObjectIDType mWrittenObjectID;
+	PreparedEmbeddedFont mPreparedEmbeddedFont;
 
 	bool isEmpty() {
 		return mGlyphIDToEncodedChar.empty();
@@ -144,6 +144,41 @@ EStatusCode WrittenFontTrueType::WriteFontDefinition(FreeTypeFaceWrapper& inFont
 	return status;
 }
 
+EStatusCode WrittenFontTrueType::PrepareEmbeddedFonts(FreeTypeFaceWrapper& inFontInfo)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	do
+	{
+		if(ShouldWriteRepresentation(mANSIRepresentation))
+		{
+			TrueTypeANSIFontWriter fontWriter;
+
+			status = fontWriter.PrepareEmbeddedFont(inFontInfo, mANSIRepresentation);
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG("WrittenFontTrueType::PrepareEmbeddedFonts, Failed to prepare Ansi embedded font");
+				break;
+			}
+		}
+
+		if(ShouldWriteRepresentation(mCIDRepresentation))
+		{
+			CIDFontWriter fontWriter;
+			TrueTypeDescendentFontWriter descendentFontWriter;
+
+			status = fontWriter.PrepareEmbeddedFont(inFontInfo, mCIDRepresentation, &descendentFontWriter);
+			if(status != PDFHummus::eSuccess)
+			{
+				TRACE_LOG("WrittenFontTrueType::PrepareEmbeddedFonts, Failed to prepare CID embedded font");
+				break;
+			}
+		}
+
+	} while(false);
+
+	return status;
+}
+
 bool WrittenFontTrueType::AddToANSIRepresentation(	const GlyphUnicodeMappingListList& inGlyphsList,
 													UShortListList& outEncodedCharacters)
 {
@@ -21,8 +21,11 @@ limitations under the License.
 #include "XCryptionCommon.h"
 #include "RC4.h"
 #include "MD5Generator.h"
+#include "PortableCryptoBackend.h"
+#include "AESNICryptoBackend.h"
 
 #include <algorithm>
+#include <atomic>
 #include <stdint.h>
 
 using namespace std;
@@ -374,4 +377,23 @@ bool XCryptionCommon::algorithm3_7(unsigned int inRevision,
 
 bool XCryptionCommon::IsUsingAES() {
 	return mUsingAES;
+}
+
+static std::atomic<ICryptoBackend*> sCryptoBackendOverride(NULL);
+
+ICryptoBackend* XCryptionCommon::GetDefaultCryptoBackend() {
+	ICryptoBackend* backend = sCryptoBackendOverride.load();
+	if (backend)
+		return backend;
+
+	static PortableCryptoBackend portableBackend;
+	static AESNICryptoBackend aesniBackend;
+	if (AESNICryptoBackend::IsSupported())
+		return &aesniBackend;
+	else
+		return &portableBackend;
+}
+
+void XCryptionCommon::SetDefaultCryptoBackend(ICryptoBackend* inCryptoBackend) {
+	sCryptoBackendOverride.store(inCryptoBackend);
 }
\ No newline at end of file
@@ -28,6 +28,7 @@ limitations under the License.
 #include <map>
 
 class XCryptionCommon;
+class ICryptoBackend;
 
 typedef std::list<IOBasicTypes::Byte> ByteList;
 typedef std::list<ByteList> ByteListList;
@@ -130,6 +131,14 @@ public:
 
 	bool IsUsingAES();
 
+	/*
+		Crypto backend for the encryption and decryption streams. process wide. by default AES-NI is used when the processor supports it,
+		and the portable implementation otherwise. Set a backend to override, or NULL to go back to the default. The backend must
+		outlive its use, and should be set before documents are created or parsed.
+	*/
+	static ICryptoBackend* GetDefaultCryptoBackend();
+	static void SetDefaultCryptoBackend(ICryptoBackend* inCryptoBackend);
+
 private:
 	ByteList mPaddingFiller;
 	ByteListList mEncryptionKeysStack;
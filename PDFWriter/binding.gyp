@@ -31,6 +31,7 @@
            'sources': [
                'AbstractContentContext.cpp',
                'AbstractWrittenFont.cpp',
+               'AESNICryptoBackend.cpp',
                'ANSIFontWriter.cpp',
 			   'ArrayOfInputStreamsStream.cpp',
                'Ascii7Encoding.cpp',
@@ -55,12 +56,14 @@
                'EncryptionHelper.cpp',
                'EncryptionOptions.cpp',
                'FontDescriptorWriter.cpp',
+               'FontProgramCache.cpp',
                'FreeTypeFaceWrapper.cpp',
                'FreeTypeOpenTypeWrapper.cpp',
                'FreeTypeType1Wrapper.cpp',
                'FreeTypeWrapper.cpp',
                'GraphicState.cpp',
                'GraphicStateStack.cpp',
+               'ImageContentRegistry.cpp',
                'IndirectObjectsReferenceRegistry.cpp',
                'InfoDictionary.cpp',
                'InputAESDecodeStream.cpp',
@@ -73,6 +76,7 @@
                'InputFile.cpp',
                'InputFileStream.cpp',
                'InputFlateDecodeStream.cpp',
+               'InputMemoryMappedFileStream.cpp',
                'InputLimitedStream.cpp',
                'InputPFBDecodeStream.cpp',
                'InputPredictorPNGOptimumStream.cpp',
@@ -86,6 +90,8 @@
                'JPEGImageParser.cpp',
                'Log.cpp',
                'MD5Generator.cpp',
+               'ObjectIDTypeDenseMap.cpp',
+               'ObjectIDTypeDenseSet.cpp',
                'ObjectsContext.cpp',
                'OpenTypeFileInput.cpp',
                'OpenTypePrimitiveReader.cpp',
@@ -95,6 +101,7 @@
                'OutputFileStream.cpp',
                'OutputFlateDecodeStream.cpp',
                'OutputFlateEncodeStream.cpp',
+               'OutputOrderedCompressionStream.cpp',
                'OutputRC4XcodeStream.cpp',
                'OutputStreamTraits.cpp',
                'OutputStringBufferStream.cpp',
@@ -117,8 +124,11 @@
                'PDFLiteralString.cpp',
                'PDFModifiedPage.cpp',
                'PDFName.cpp',
+               'PDFNameAtoms.cpp',
+               'PDFNameToPDFObjectMap.cpp',
                'PDFNull.cpp',
                'PDFObject.cpp',
+               'PDFObjectArena.cpp',
                'PDFObjectParser.cpp',
                'PDFPage.cpp',
                'PDFPageInput.cpp',
@@ -138,6 +148,7 @@
                'PDFWriter.cpp',
                'PFMFileReader.cpp',
                'PNGImageHandler.cpp',
+               'PortableCryptoBackend.cpp',
                'PrimitiveObjectsWriter.cpp',
                'PSBool.cpp',
                'RC4.cpp',
@@ -173,6 +184,7 @@
                'AbstractContentContext.h',
                'AbstractWrittenFont.h',
                'AdapterIByteReaderWithPositionToIReadPositionProvider.h',
+               'AESNICryptoBackend.h',
                'ANSIFontWriter.h',
 			   'ArrayOfInputStreamsStream.h',
                'Ascii7Encoding.h',
@@ -208,6 +220,7 @@
                'EStatusCode.h',
                'ETokenSeparator.h',
                'FontDescriptorWriter.h',
+               'FontProgramCache.h',
                'FreeTypeFaceWrapper.h',
                'FreeTypeOpenTypeWrapper.h',
                'FreeTypeType1Wrapper.h',
@@ -222,12 +235,14 @@
                'IByteWriter.h',
                'IByteWriterWithPosition.h',
                'IContentContextListener.h',
+               'ICryptoBackend.h',
                'IDescendentFontWriter.h',
                'IDocumentContextExtender.h',
                'IFontDescriptorHelper.h',
                'IFormEndWritingTask.h',
                'ITiledPatternEndWritingTask.h',
                'IFreeTypeFaceExtender.h',
+               'ImageContentRegistry.h',
                'IndirectObjectsReferenceRegistry.h',
                'InfoDictionary.h',
                'InputAESDecodeStream.h',
@@ -240,6 +255,7 @@
                'InputFile.h',
                'InputFileStream.h',
                'InputFlateDecodeStream.h',
+               'InputMemoryMappedFileStream.h',
                'InputLimitedStream.h',
                'InputPFBDecodeStream.h',
                'InputPredictorPNGOptimumStream.h',
@@ -265,6 +281,8 @@
                'MD5Generator.h',
                'MyStringBuf.h',
                'ObjectsBasicTypes.h',
+               'ObjectIDTypeDenseMap.h',
+               'ObjectIDTypeDenseSet.h',
                'ObjectsContext.h',
                'ObjectsContextExtenderAdapter.h',
                'OpenTypeFileInput.h',
@@ -275,6 +293,7 @@
                'OutputFileStream.h',
                'OutputFlateDecodeStream.h',
                'OutputFlateEncodeStream.h',
+               'OutputOrderedCompressionStream.h',
                'OutputRC4XcodeStream.h',
                'OutputStreamTraits.h',
                'OutputStringBufferStream.h',
@@ -300,8 +319,11 @@
                'PDFLiteralString.h',
                'PDFModifiedPage.h',
                'PDFName.h',
+               'PDFNameAtoms.h',
+               'PDFNameToPDFObjectMap.h',
                'PDFNull.h',
                'PDFObject.h',
+               'PDFObjectArena.h',
                'PDFObjectCast.h',
                'PDFObjectParser.h',
                'PDFPage.h',
@@ -321,6 +343,7 @@
                'PDFWriter.h',
                'PFMFileReader.h',
                'PNGImageHandler.cpp',
+               'PortableCryptoBackend.h',
                'PrimitiveObjectsWriter.h',
                'ProcsetResourcesConstants.h',
                'PSBool.h',
@@ -0,0 +1,140 @@
+/*
+   Source File : AESStreamsTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "AESStreamsTest.h"
+#include "TestsRunner.h"
+#include "OutputAESEncodeStream.h"
+#include "InputAESDecodeStream.h"
+#include "OutputStringBufferStream.h"
+#include "InputByteArrayStream.h"
+
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+AESStreamsTest::AESStreamsTest(void)
+{
+}
+
+AESStreamsTest::~AESStreamsTest(void)
+{
+}
+
+static const unsigned char scKey[] = {0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c};
+
+/*
+	Encrypts texts of various lengths with the AES streams, using different chunk sizes and write\read sizes. 
+	Checks that the encrypted data is the same as encrypting block by block, and that decrypting gets the original text.
+*/
+EStatusCode AESStreamsTest::Run(const TestConfiguration& /*inTestConfiguration*/)
+{
+	EStatusCode status = eSuccess;
+	const size_t textLengths[] = {0,1,15,16,17,31,32,33,1000,100000};
+	const size_t chunkSizes[] = {1,16,40,1024,DEFAULT_AES_ENCODE_CHUNK_SIZE};
+	const size_t transferSizes[] = {1,7,16,4096,1000000};
+
+	for(size_t i=0; i < sizeof(textLengths)/sizeof(size_t) && eSuccess == status; ++i)
+	{
+		string plainText;
+		for(size_t j=0; j < textLengths[i]; ++j)
+			plainText.push_back((char)((j*31 + j/7) & 0xff));
+
+		for(size_t j=0; j < sizeof(chunkSizes)/sizeof(size_t) && eSuccess == status; ++j)
+			for(size_t k=0; k < sizeof(transferSizes)/sizeof(size_t) && eSuccess == status; ++k)
+				status = CheckRoundTrip(plainText,chunkSizes[j],transferSizes[k],
+										chunkSizes[sizeof(chunkSizes)/sizeof(size_t) - 1 - j],transferSizes[sizeof(transferSizes)/sizeof(size_t) - 1 - k]);
+	}
+
+	return status;
+}
+
+EStatusCode AESStreamsTest::CheckRoundTrip(const string& inPlainText,size_t inEncodeChunkSize,size_t inWriteSize,
+											size_t inDecodeChunkSize,size_t inReadSize)
+{
+	EStatusCode status = eSuccess;
+	ByteList key(scKey,scKey + sizeof(scKey));
+
+	do
+	{
+		// encrypt
+		OutputStringBufferStream encryptedStream;
+		OutputAESEncodeStream* encodeStream = new OutputAESEncodeStream(&encryptedStream,key,false,inEncodeChunkSize);
+		for(size_t i=0; i < inPlainText.size(); i+=inWriteSize)
+			encodeStream->Write((const Byte*)inPlainText.c_str() + i,min(inWriteSize,inPlainText.size() - i));
+		delete encodeStream;
+		string encrypted = encryptedStream.ToString();
+
+		size_t expectedSize = AES_BLOCK_SIZE + (inPlainText.size() / AES_BLOCK_SIZE + 1) * AES_BLOCK_SIZE;
+		if(encrypted.size() != expectedSize)
+		{
+			cout<<"AES encrypted length of "<<inPlainText.size()<<" bytes with chunk size "<<inEncodeChunkSize<<" is "<<encrypted.size()<<", expected "<<expectedSize<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// encrypt block by block with the same IV, and compare
+		string padded = inPlainText + string(AES_BLOCK_SIZE - inPlainText.size() % AES_BLOCK_SIZE,(char)(AES_BLOCK_SIZE - inPlainText.size() % AES_BLOCK_SIZE));
+		unsigned char iv[AES_BLOCK_SIZE];
+		unsigned char block[AES_BLOCK_SIZE];
+		memcpy(iv,encrypted.c_str(),AES_BLOCK_SIZE);
+		AESencrypt encrypt;
+		encrypt.key(scKey,sizeof(scKey));
+		string expected = encrypted.substr(0,AES_BLOCK_SIZE);
+		for(size_t i=0; i < padded.size(); i+=AES_BLOCK_SIZE)
+		{
+			encrypt.cbc_encrypt((const unsigned char*)padded.c_str() + i,block,AES_BLOCK_SIZE,iv);
+			expected.append((const char*)block,AES_BLOCK_SIZE);
+		}
+		if(encrypted != expected)
+		{
+			cout<<"AES encrypted data of "<<inPlainText.size()<<" bytes with chunk size "<<inEncodeChunkSize<<" and write size "<<inWriteSize<<" differs from block by block encryption\n";
+			status = eFailure;
+			break;
+		}
+
+		// decrypt
+		InputAESDecodeStream decodeStream(new InputByteArrayStream((Byte*)encrypted.c_str(),encrypted.size()),key,inDecodeChunkSize);
+		string decrypted;
+		Byte* buffer = new Byte[inReadSize];
+		while(decodeStream.NotEnded())
+		{
+			LongBufferSizeType readAmount = decodeStream.Read(buffer,inReadSize);
+			if(0 == readAmount)
+				break;
+			decrypted.append((const char*)buffer,readAmount);
+		}
+		delete[] buffer;
+
+		if(decrypted != inPlainText)
+		{
+			cout<<"AES decrypted data of "<<inPlainText.size()<<" bytes with chunk size "<<inDecodeChunkSize<<" and read size "<<inReadSize<<" differs from the original, got "<<decrypted.size()<<" bytes\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(AESStreamsTest,"IO")
@@ -0,0 +1,320 @@
+/*
+   Source File : CryptoBackendsBenchmark.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "CryptoBackendsBenchmark.h"
+#include "TestsRunner.h"
+#include "ICryptoBackend.h"
+#include "PortableCryptoBackend.h"
+#include "AESNICryptoBackend.h"
+#include "XCryptionCommon.h"
+#include "OutputAESEncodeStream.h"
+#include "InputAESDecodeStream.h"
+#include "OutputRC4XcodeStream.h"
+#include "InputRC4XcodeStream.h"
+#include "OutputStringBufferStream.h"
+#include "InputByteArrayStream.h"
+#include "InputFile.h"
+#include "IByteReaderWithPosition.h"
+
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string.h>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+CryptoBackendsBenchmark::CryptoBackendsBenchmark(void)
+{
+}
+
+CryptoBackendsBenchmark::~CryptoBackendsBenchmark(void)
+{
+}
+
+// the Xcryption tests materials
+static const char* scBenchmarkFiles[] = {"PDFWithPassword.pdf","china.pdf",NULL};
+
+// minimum amount of data to xcrypt per measurement, so that timings are meaningful
+static const size_t scMinimumBenchmarkBytes = 16*1024*1024;
+
+static const Byte scKey128[] = {0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c};
+
+/*
+	Checks the crypto backends available on this machine, and measures AES and RC4 encryption and decryption speed with the
+	encryption streams, over the Xcryption tests materials. Speeds are printed, and not checked.
+*/
+EStatusCode CryptoBackendsBenchmark::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	PortableCryptoBackend portableBackend;
+	AESNICryptoBackend aesniBackend;
+	vector<ICryptoBackend*> backends;
+
+	backends.push_back(&portableBackend);
+	if(AESNICryptoBackend::IsSupported())
+		backends.push_back(&aesniBackend);
+	else
+		cout<<"AES-NI is not supported on this machine, benchmarking the portable backend only\n";
+	cout<<"Default crypto backend is "<<XCryptionCommon::GetDefaultCryptoBackend()->GetName()<<"\n";
+
+	do
+	{
+		for(size_t i=0; i < backends.size() && eSuccess == status; ++i)
+		{
+			status = CheckTestVectors(backends[i]);
+			if(eSuccess == status && backends[i] != &portableBackend)
+				status = CheckAgainstReference(backends[i],&portableBackend);
+		}
+		if(status != eSuccess)
+			break;
+
+		for(size_t i=0; scBenchmarkFiles[i] && eSuccess == status; ++i)
+		{
+			string data;
+			status = ReadFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/") + scBenchmarkFiles[i]),data);
+			if(status != eSuccess)
+				break;
+
+			for(size_t j=0; j < backends.size() && eSuccess == status; ++j)
+				status = BenchmarkAES(scBenchmarkFiles[i],data,backends[j]);
+			if(eSuccess == status)
+				status = BenchmarkRC4(scBenchmarkFiles[i],data);
+		}
+	}while(false);
+
+	return status;
+}
+
+struct AESTestVector
+{
+	const char* mKey;
+	const char* mCipherText;
+};
+
+static const char* scTestVectorsIV = "000102030405060708090a0b0c0d0e0f";
+static const char* scTestVectorsPlainText = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e5130c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+
+// NIST SP 800-38A CBC examples
+static const AESTestVector scTestVectors[] =
+{
+	{"2b7e151628aed2a6abf7158809cf4f3c","7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b273bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7"},
+	{"8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b","4f021db243bc633d7178183a9fa071e8b4d9ada9ad7dedf4e5e738763f69145a571b242012fb7ae07fa9baac3df102e008b0e27988598881d920a9e64f5615cd"},
+	{"603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4","f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d39f23369a9d9bacfa530e26304231461b2eb05e2c39be9fcda6c19078c6a9d1b"},
+	{NULL,NULL}
+};
+
+static string HexToBytes(const char* inHex)
+{
+	string result;
+	for(size_t i=0; inHex[i] && inHex[i+1]; i+=2)
+	{
+		char byteHex[3] = {inHex[i],inHex[i+1],0};
+		result.push_back((char)strtol(byteHex,NULL,16));
+	}
+	return result;
+}
+
+EStatusCode CryptoBackendsBenchmark::CheckTestVectors(ICryptoBackend* inBackend)
+{
+	EStatusCode status = eSuccess;
+	string plainText = HexToBytes(scTestVectorsPlainText);
+
+	for(size_t i=0; scTestVectors[i].mKey && eSuccess == status; ++i)
+	{
+		string key = HexToBytes(scTestVectors[i].mKey);
+		string expected = HexToBytes(scTestVectors[i].mCipherText);
+		unique_ptr<IAESCipher> cipher(inBackend->CreateAESCipher((const Byte*)key.c_str(),key.size()));
+		if(!cipher)
+		{
+			cout<<inBackend->GetName()<<" failed to create AES cipher with "<<key.size()*8<<" bits key\n";
+			status = eFailure;
+			break;
+		}
+
+		string iv = HexToBytes(scTestVectorsIV);
+		string encrypted(plainText.size(),0);
+		cipher->EncryptCBC((const Byte*)plainText.c_str(),(Byte*)&(encrypted[0]),plainText.size(),(Byte*)&(iv[0]));
+		if(encrypted != expected)
+		{
+			cout<<inBackend->GetName()<<" AES-"<<key.size()*8<<" CBC encryption differs from the test vector\n";
+			status = eFailure;
+			break;
+		}
+
+		// decrypt in place, in two calls, to check that the chain continues
+		iv = HexToBytes(scTestVectorsIV);
+		cipher->DecryptCBC((const Byte*)&(encrypted[0]),(Byte*)&(encrypted[0]),16,(Byte*)&(iv[0]));
+		cipher->DecryptCBC((const Byte*)&(encrypted[16]),(Byte*)&(encrypted[16]),encrypted.size() - 16,(Byte*)&(iv[0]));
+		if(encrypted != plainText)
+		{
+			cout<<inBackend->GetName()<<" AES-"<<key.size()*8<<" CBC decryption differs from the test vector\n";
+			status = eFailure;
+			break;
+		}
+	}
+
+	return status;
+}
+
+EStatusCode CryptoBackendsBenchmark::CheckAgainstReference(ICryptoBackend* inBackend,ICryptoBackend* inReferenceBackend)
+{
+	// lengths around the 4 blocks parallel decryption of AES-NI
+	const size_t lengths[] = {16,48,64,80,112,128,4096 + 48};
+	string data;
+	for(size_t i=0; i < 4096 + 48; ++i)
+		data.push_back((char)((i * 131) >> 3));
+
+	unique_ptr<IAESCipher> cipher(inBackend->CreateAESCipher(scKey128,sizeof(scKey128)));
+	unique_ptr<IAESCipher> referenceCipher(inReferenceBackend->CreateAESCipher(scKey128,sizeof(scKey128)));
+	if(!cipher || !referenceCipher)
+	{
+		cout<<"failed to create AES ciphers for comparing "<<inBackend->GetName()<<" with "<<inReferenceBackend->GetName()<<"\n";
+		return eFailure;
+	}
+
+	for(size_t i=0; i < sizeof(lengths)/sizeof(size_t); ++i)
+	{
+		Byte iv[16],referenceIV[16];
+		memset(iv,7,16);
+		memset(referenceIV,7,16);
+		string encrypted(lengths[i],0),referenceEncrypted(lengths[i],0);
+		cipher->EncryptCBC((const Byte*)data.c_str(),(Byte*)&(encrypted[0]),lengths[i],iv);
+		referenceCipher->EncryptCBC((const Byte*)data.c_str(),(Byte*)&(referenceEncrypted[0]),lengths[i],referenceIV);
+		if(encrypted != referenceEncrypted || memcmp(iv,referenceIV,16) != 0)
+		{
+			cout<<inBackend->GetName()<<" encryption of "<<lengths[i]<<" bytes differs from "<<inReferenceBackend->GetName()<<"\n";
+			return eFailure;
+		}
+
+		string decrypted(lengths[i],0),referenceDecrypted(lengths[i],0);
+		memset(iv,7,16);
+		memset(referenceIV,7,16);
+		cipher->DecryptCBC((const Byte*)encrypted.c_str(),(Byte*)&(decrypted[0]),lengths[i],iv);
+		referenceCipher->DecryptCBC((const Byte*)encrypted.c_str(),(Byte*)&(referenceDecrypted[0]),lengths[i],referenceIV);
+		if(decrypted != referenceDecrypted || decrypted != data.substr(0,lengths[i]) || memcmp(iv,referenceIV,16) != 0)
+		{
+			cout<<inBackend->GetName()<<" decryption of "<<lengths[i]<<" bytes differs from "<<inReferenceBackend->GetName()<<"\n";
+			return eFailure;
+		}
+	}
+	return eSuccess;
+}
+
+static double MegabytesPerSecond(size_t inBytes,chrono::steady_clock::duration inDuration)
+{
+	double seconds = chrono::duration<double>(inDuration).count();
+	return seconds > 0 ? (inBytes / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+EStatusCode CryptoBackendsBenchmark::BenchmarkAES(const string& inFileName,const string& inData,ICryptoBackend* inBackend)
+{
+	ByteList key(scKey128,scKey128 + sizeof(scKey128));
+	size_t repeats = scMinimumBenchmarkBytes / inData.size() + 1;
+	vector<string> encrypted(repeats);
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(size_t i=0; i < repeats; ++i)
+	{
+		OutputStringBufferStream encryptedStream;
+		OutputAESEncodeStream* encodeStream = new OutputAESEncodeStream(&encryptedStream,key,false,DEFAULT_AES_ENCODE_CHUNK_SIZE,inBackend);
+		encodeStream->Write((const Byte*)inData.c_str(),inData.size());
+		delete encodeStream;
+		encrypted[i] = encryptedStream.ToString();
+	}
+	chrono::steady_clock::duration encryptionTime = chrono::steady_clock::now() - start;
+
+	string decrypted(inData.size(),0);
+	start = chrono::steady_clock::now();
+	for(size_t i=0; i < repeats; ++i)
+	{
+		InputAESDecodeStream decodeStream(new InputByteArrayStream((Byte*)encrypted[i].c_str(),encrypted[i].size()),key,DEFAULT_AES_DECODE_CHUNK_SIZE,inBackend);
+		LongBufferSizeType readAmount = decodeStream.Read((Byte*)&(decrypted[0]),decrypted.size());
+		if(readAmount != inData.size() || decrypted != inData)
+		{
+			cout<<inBackend->GetName()<<" AES round trip of "<<inFileName<<" failed\n";
+			return eFailure;
+		}
+	}
+	chrono::steady_clock::duration decryptionTime = chrono::steady_clock::now() - start;
+
+	cout<<"AES-128 "<<inBackend->GetName()<<", "<<inFileName<<": encrypt "<<MegabytesPerSecond(repeats * inData.size(),encryptionTime)<<
+		" MB/s, decrypt "<<MegabytesPerSecond(repeats * inData.size(),decryptionTime)<<" MB/s\n";
+	return eSuccess;
+}
+
+EStatusCode CryptoBackendsBenchmark::BenchmarkRC4(const string& inFileName,const string& inData)
+{
+	ByteList key(scKey128,scKey128 + sizeof(scKey128));
+	size_t repeats = scMinimumBenchmarkBytes / inData.size() + 1;
+	vector<string> encrypted(repeats);
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for(size_t i=0; i < repeats; ++i)
+	{
+		OutputStringBufferStream encryptedStream;
+		OutputRC4XcodeStream encodeStream(&encryptedStream,key,false);
+		encodeStream.Write((const Byte*)inData.c_str(),inData.size());
+		encrypted[i] = encryptedStream.ToString();
+	}
+	chrono::steady_clock::duration encryptionTime = chrono::steady_clock::now() - start;
+
+	string decrypted(inData.size(),0);
+	start = chrono::steady_clock::now();
+	for(size_t i=0; i < repeats; ++i)
+	{
+		InputRC4XcodeStream decodeStream(new InputByteArrayStream((Byte*)encrypted[i].c_str(),encrypted[i].size()),key);
+		LongBufferSizeType readAmount = decodeStream.Read((Byte*)&(decrypted[0]),decrypted.size());
+		if(readAmount != inData.size() || decrypted != inData)
+		{
+			cout<<"RC4 round trip of "<<inFileName<<" failed\n";
+			return eFailure;
+		}
+	}
+	chrono::steady_clock::duration decryptionTime = chrono::steady_clock::now() - start;
+
+	cout<<"RC4-128, "<<inFileName<<": encrypt "<<MegabytesPerSecond(repeats * inData.size(),encryptionTime)<<
+		" MB/s, decrypt "<<MegabytesPerSecond(repeats * inData.size(),decryptionTime)<<" MB/s\n";
+	return eSuccess;
+}
+
+EStatusCode CryptoBackendsBenchmark::ReadFile(const string& inFilePath,string& outData)
+{
+	InputFile file;
+	EStatusCode status = file.OpenFile(inFilePath);
+	if(status != eSuccess)
+	{
+		cout<<"failed to open "<<inFilePath<<"\n";
+		return status;
+	}
+
+	Byte buffer[4096];
+	while(file.GetInputStream()->NotEnded())
+	{
+		LongBufferSizeType readAmount = file.GetInputStream()->Read(buffer,sizeof(buffer));
+		if(0 == readAmount)
+			break;
+		outData.append((const char*)buffer,readAmount);
+	}
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(CryptoBackendsBenchmark,"Xcryption")
@@ -0,0 +1,44 @@
+/*
+   Source File : CryptoBackendsBenchmark.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ITestUnit.h"
+
+#include <string>
+#include <vector>
+
+class ICryptoBackend;
+
+class CryptoBackendsBenchmark : public ITestUnit
+{
+public:
+	CryptoBackendsBenchmark(void);
+	virtual ~CryptoBackendsBenchmark(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode CheckTestVectors(ICryptoBackend* inBackend);
+	PDFHummus::EStatusCode CheckAgainstReference(ICryptoBackend* inBackend,ICryptoBackend* inReferenceBackend);
+	PDFHummus::EStatusCode BenchmarkAES(const std::string& inFileName,const std::string& inData,ICryptoBackend* inBackend);
+	PDFHummus::EStatusCode BenchmarkRC4(const std::string& inFileName,const std::string& inData);
+	PDFHummus::EStatusCode ReadFile(const std::string& inFilePath,std::string& outData);
+};
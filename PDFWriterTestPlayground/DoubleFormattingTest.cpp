@@ -0,0 +1,118 @@
+/*
+   Source File : DoubleFormattingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "DoubleFormattingTest.h"
+#include "PrimitiveObjectsWriter.h"
+#include "OutputStringBufferStream.h"
+#include "TimersRegistry.h"
+#include "Trace.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace PDFHummus;
+
+DoubleFormattingTest::DoubleFormattingTest(void)
+{
+}
+
+DoubleFormattingTest::~DoubleFormattingTest(void)
+{
+}
+
+static const double scSpecialValues[] = {0,-0.0,1,-1,0.5,-0.5,0.1,0.0000005,0.0000015,-0.0000004,1.0000005,2.5e-7,
+										 123456.789,-98765.4321,595.276,841.89,1e9,1e12,1e15,-1e18,1.7976931348623157e308,
+										 4.9e-324,12.3456785,0.1234565,99999.9999995};
+
+EStatusCode DoubleFormattingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+
+	// values to format. the special ones, and a pseudo random (but repeatable) set of typical coordinates
+	vector<double> values(scSpecialValues,scSpecialValues + sizeof(scSpecialValues)/sizeof(double));
+	unsigned int seed = 12345;
+	for(int i=0;i<200000;++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		double aValue = (double)(seed % 2000000) / (1 << (seed % 12)) - 1000.0;
+		values.push_back(aValue);
+	}
+
+	TimersRegistry timersRegistry;
+	int precisions[] = {DEFAULT_DOUBLE_PRECISION,0,2,4,9,12};
+
+	for(int i=0; i < 6 && eSuccess == status; ++i)
+	{
+		// expected output, with the stream based formatting
+		timersRegistry.StartMeasure("StreamFormatting");
+		string expected;
+		for(vector<double>::iterator it = values.begin(); it != values.end(); ++it)
+		{
+			expected.append(PrimitiveObjectsWriter::FormatDoubleWithStream(*it,precisions[i]));
+			expected.append(" ");
+		}
+		timersRegistry.StopMeasureAndAccumulate("StreamFormatting");
+
+		// actual output, with the writer
+		OutputStringBufferStream stringStream;
+		PrimitiveObjectsWriter primitiveWriter(&stringStream);
+		primitiveWriter.SetDoublePrecision(precisions[i]);
+		timersRegistry.StartMeasure("WriteDouble");
+		for(vector<double>::iterator it = values.begin(); it != values.end(); ++it)
+			primitiveWriter.WriteDouble(*it);
+		timersRegistry.StopMeasureAndAccumulate("WriteDouble");
+
+		if(stringStream.ToString() != expected)
+		{
+			status = PDFHummus::eFailure;
+			cout<<"WriteDouble output differs from stream formatting for precision "<<precisions[i]<<"\n";
+		}
+	}
+
+	// integers. compare with stream formatting
+	{
+		long long integers[] = {0,1,-1,10,-10,123456789,-2147483648LL,9223372036854775807LL,-9223372036854775807LL-1};
+		OutputStringBufferStream stringStream;
+		PrimitiveObjectsWriter primitiveWriter(&stringStream);
+		stringstream expected;
+		for(int i=0; i < 9; ++i)
+		{
+			primitiveWriter.WriteInteger(integers[i]);
+			expected<<integers[i]<<" ";
+		}
+		if(stringStream.ToString() != expected.str())
+		{
+			status = PDFHummus::eFailure;
+			cout<<"WriteInteger output differs from stream formatting - "<<stringStream.ToString()<<"\n";
+		}
+	}
+
+	// benchmark results
+	Trace::DefaultTrace().SetLogSettings(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DoubleFormattingTest.txt"),true,true);
+	timersRegistry.TraceAndReleaseAll();
+	Trace::DefaultTrace().SetLogSettings(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"DoubleFormattingTest.txt"),false,false);
+
+	return status;
+}
+
+
+ADD_CATEGORIZED_TEST(DoubleFormattingTest,"ObjectContext")
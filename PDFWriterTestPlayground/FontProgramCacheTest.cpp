@@ -0,0 +1,291 @@
+/*
+   Source File : FontProgramCacheTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "FontProgramCacheTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "FontProgramCache.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+
+#include <iostream>
+#include <future>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+FontProgramCacheTest::FontProgramCacheTest(void)
+{
+}
+
+FontProgramCacheTest::~FontProgramCacheTest(void)
+{
+}
+
+// two true type fonts and a CFF font
+static const char* scFontProgramCacheFonts[] = {"arial.ttf","KozGoPro-Regular.otf","couri.ttf",NULL};
+static const unsigned long scFontProgramCacheFontsCount = 3;
+
+EStatusCode FontProgramCacheTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateDocument(inTestConfiguration,"FontProgramCacheTestUncached.pdf");
+		if(status != eSuccess)
+			break;
+
+		FontProgramCache::DefaultCache().SetEnabled(true);
+		status = RunWithCache(inTestConfiguration);
+		// the cache is process wide, don't leave it on for other tests
+		FontProgramCache::DefaultCache().SetEnabled(false);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode FontProgramCacheTest::RunWithCache(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		// first document loads the fonts
+		status = CreateDocument(inTestConfiguration,"FontProgramCacheTestCached1.pdf");
+		if(status != eSuccess)
+			break;
+
+		if(FontProgramCache::DefaultCache().GetMisses() != scFontProgramCacheFontsCount || FontProgramCache::DefaultCache().GetHits() != 0)
+		{
+			cout<<"expected "<<scFontProgramCacheFontsCount<<" font programs to be loaded for the first document, got "<<
+				FontProgramCache::DefaultCache().GetMisses()<<" loaded and "<<FontProgramCache::DefaultCache().GetHits()<<" shared\n";
+			status = eFailure;
+			break;
+		}
+
+		// next documents share them, also when created concurrently
+		future<EStatusCode> secondDocument = async(launch::async,&FontProgramCacheTest::CreateDocument,this,inTestConfiguration,string("FontProgramCacheTestCached2.pdf"));
+		status = CreateDocument(inTestConfiguration,"FontProgramCacheTestCached3.pdf");
+		if(secondDocument.get() != eSuccess)
+			status = eFailure;
+		if(status != eSuccess)
+			break;
+
+		if(FontProgramCache::DefaultCache().GetMisses() != scFontProgramCacheFontsCount || FontProgramCache::DefaultCache().GetHits() != 2*scFontProgramCacheFontsCount)
+		{
+			cout<<"expected "<<2*scFontProgramCacheFontsCount<<" shared font programs for the next documents, got "<<
+				FontProgramCache::DefaultCache().GetHits()<<" shared and "<<FontProgramCache::DefaultCache().GetMisses()<<" loaded\n";
+			status = eFailure;
+			break;
+		}
+
+		// embedded fonts should be the same as when reading the font files
+		status = CompareDocumentsStreams(inTestConfiguration,"FontProgramCacheTestUncached.pdf","FontProgramCacheTestCached1.pdf");
+		if(status != eSuccess)
+			break;
+		status = CompareDocumentsStreams(inTestConfiguration,"FontProgramCacheTestUncached.pdf","FontProgramCacheTestCached2.pdf");
+		if(status != eSuccess)
+			break;
+		status = CompareDocumentsStreams(inTestConfiguration,"FontProgramCacheTestUncached.pdf","FontProgramCacheTestCached3.pdf");
+	}while(false);
+
+	return status;
+}
+
+EStatusCode FontProgramCacheTest::CreateDocument(const TestConfiguration& inTestConfiguration,const string& inFileName)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inFileName<<"\n";
+			break;
+		}	
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		if(NULL == contentContext)
+		{
+			status = eFailure;
+			cout<<"failed to create content context for page\n";
+			delete page;
+			break;
+		}
+
+		for(int i=0;scFontProgramCacheFonts[i] && eSuccess == status;++i)
+		{
+			PDFUsedFont* font = pdfWriter.GetFontForFile(
+				RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/fonts/") + scFontProgramCacheFonts[i]));
+			if(!font)
+			{
+				status = eFailure;
+				cout<<"failed to create font object for "<<scFontProgramCacheFonts[i]<<"\n";
+				break;
+			}
+
+			contentContext->BT();
+			contentContext->k(0,0,0,1);
+			contentContext->Tf(font,1);
+			contentContext->Tm(30,0,0,30,78.4252,662.8997 - i*100);
+			status = contentContext->Tj("Hello World");
+			if(status != eSuccess)
+				cout<<"failed to write text with "<<scFontProgramCacheFonts[i]<<"\n";
+			contentContext->ET();
+		}
+		if(status != eSuccess)
+		{
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inFileName<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+static EStatusCode ReadStreamContent(PDFParser& inParser,PDFStreamInput* inStream,string& outContent)
+{
+	IByteReader* reader = inParser.StartReadingFromStreamForPlainCopying(inStream);
+	if(!reader)
+		return eFailure;
+
+	MyStringBuf buffer;
+	OutputStringBufferStream contentStream(&buffer);
+	OutputStreamTraits traits(&contentStream);
+	EStatusCode status = traits.CopyToOutputStream(reader);
+	delete reader;
+	outContent = contentStream.ToString();
+	return status;
+}
+
+EStatusCode FontProgramCacheTest::CompareDocumentsStreams(const TestConfiguration& inTestConfiguration,const string& inFileNameA,const string& inFileNameB)
+{
+	EStatusCode status = eSuccess;
+	InputFile fileA,fileB;
+	PDFParser parserA,parserB;
+
+	do
+	{
+		if(fileA.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileNameA)) != eSuccess ||
+			fileB.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileNameB)) != eSuccess)
+		{
+			cout<<"failed to open "<<inFileNameA<<" or "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parserA.StartPDFParsing(fileA.GetInputStream()) != eSuccess ||
+			parserB.StartPDFParsing(fileB.GetInputStream()) != eSuccess)
+		{
+			cout<<"failed to parse "<<inFileNameA<<" or "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parserA.GetObjectsCount() != parserB.GetObjectsCount())
+		{
+			cout<<"different objects count in "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// the documents are written the same, so same objects should have the same streams
+		unsigned long streamsCount = 0;
+		for(ObjectIDType i=1;i<parserA.GetObjectsCount() && eSuccess == status;++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> streamA(parserA.ParseNewObject(i));
+			PDFObjectCastPtr<PDFStreamInput> streamB(parserB.ParseNewObject(i));
+			if(!streamA != !streamB)
+			{
+				cout<<"object "<<i<<" is a stream in only one of "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+				status = eFailure;
+				break;
+			}
+			if(!streamA)
+				continue;
+
+			string contentA,contentB;
+			if(ReadStreamContent(parserA,streamA.GetPtr(),contentA) != eSuccess ||
+				ReadStreamContent(parserB,streamB.GetPtr(),contentB) != eSuccess)
+			{
+				cout<<"failed to read stream of object "<<i<<"\n";
+				status = eFailure;
+				break;
+			}
+			if(contentA != contentB)
+			{
+				cout<<"stream of object "<<i<<" differs between "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+				status = eFailure;
+				break;
+			}
+			++streamsCount;
+		}
+		if(status != eSuccess)
+			break;
+
+		if(0 == streamsCount)
+		{
+			cout<<"no streams found in "<<inFileNameA<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(FontProgramCacheTest,"Text")
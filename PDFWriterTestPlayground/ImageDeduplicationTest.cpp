@@ -0,0 +1,374 @@
+/*
+   Source File : ImageDeduplicationTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ImageDeduplicationTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFFormXObject.h"
+#include "PDFImageXObject.h"
+#include "PageContentContext.h"
+#include "DocumentContext.h"
+#include "ImageContentRegistry.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "OutputStreamTraits.h"
+#include "PDFParser.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+ImageDeduplicationTest::ImageDeduplicationTest(void)
+{
+}
+
+ImageDeduplicationTest::~ImageDeduplicationTest(void)
+{
+}
+
+/*
+	Writes the same images several times, from files, streams and under different file paths, with and without image deduplication.
+	With deduplication, repeated images should reuse the written objects, and the file should be smaller.
+*/
+EStatusCode ImageDeduplicationTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	LongFilePositionType deduplicatedSize = 0;
+	LongFilePositionType regularSize = 0;
+
+	do
+	{
+		status = CopyFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg"),
+							RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ImageDeduplicationTest_logo_copy.jpg"));
+		if(status != eSuccess)
+			break;
+
+		status = WriteDocument(inTestConfiguration,true,deduplicatedSize);
+		if(status != eSuccess)
+			break;
+
+		status = WriteDocument(inTestConfiguration,false,regularSize);
+		if(status != eSuccess)
+			break;
+
+		if(deduplicatedSize >= regularSize)
+		{
+			cout<<"expected deduplicated images file to be smaller. deduplicated is "<<deduplicatedSize<<" bytes, regular is "<<regularSize<<" bytes\n";
+			status = eFailure;
+			break;
+		}
+
+		status = TestSameKeyDifferentData();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ImageDeduplicationTest::TestSameKeyDifferentData()
+{
+	// keys only narrow down the images to compare, an image is found only when its data is the same as a registered image
+	ImageContentRegistry registry;
+	ImageContentKey key;
+	ByteVector registeredData(100,1);
+	ByteVector otherData(100,2);
+	ByteVector sameData(registeredData);
+
+	key.Usage = "Test";
+	key.Size = registeredData.size();
+	key.Hash = 1;
+
+	registry.SetEnabled(true);
+	registry.Register(key,registeredData,ImageContentEntry(10,0));
+
+	if(registry.Find(key,otherData) != NULL)
+	{
+		cout<<"expected image with the same key and different data not to be found\n";
+		return eFailure;
+	}
+
+	const ImageContentEntry* entry = registry.Find(key,sameData);
+	if(!entry || entry->ObjectID != 10)
+	{
+		cout<<"expected image with the same key and data to be found\n";
+		return eFailure;
+	}
+
+	ByteVector otherRegisteredData(otherData);
+	registry.Register(key,otherRegisteredData,ImageContentEntry(11,0));
+	entry = registry.Find(key,otherData);
+	if(!entry || entry->ObjectID != 11)
+	{
+		cout<<"expected image registered with the same key and different data to be found\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+EStatusCode ImageDeduplicationTest::WriteDocument(const TestConfiguration& inTestConfiguration,
+												bool inDeduplicateImages,
+												LongFilePositionType& outFileSize)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	PDFCreationSettings creationSettings(true,true);
+	string pdfFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,
+												inDeduplicateImages ? "ImageDeduplicationTest.pdf" : "ImageDeduplicationTestRegular.pdf");
+	ObjectIDTypeVector formIDs;
+	ObjectIDTypeVector imageIDs;
+	ImageDeduplicationFormsIndexes formsIndexes;
+
+	creationSettings.DeduplicateImages = inDeduplicateImages;
+
+	do
+	{
+		status = pdfWriter.StartPDF(pdfFilePath,ePDFVersion13,LogConfiguration::DefaultLogConfiguration(),creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		status = CreateImages(inTestConfiguration,pdfWriter,formIDs,imageIDs,formsIndexes);
+		if(status != eSuccess)
+			break;
+
+		// JPG forms are the same JPG, as form and from file, stream and a copy of the file
+		// PNG forms are the same PNG 3 times, and then another PNG
+		// TIFF forms are the same TIFF twice, and then the same TIFF with different parameters
+		// images 0-1 are the JPG, as image xobject
+		size_t jpg = formsIndexes.JPGForms;
+		status = CheckSameObject(formIDs,jpg,jpg+1,inDeduplicateImages,"JPG form from the same file");
+		if(eSuccess == status)
+			status = CheckSameObject(formIDs,jpg,jpg+2,inDeduplicateImages,"JPG form from a stream of a copy of the file");
+		if(eSuccess == status)
+			status = CheckSameObject(imageIDs,0,1,inDeduplicateImages,"JPG image from the same file");
+		if(eSuccess == status && formsIndexes.PNGForms != ImageDeduplicationFormsIndexes::scNotCreated)
+		{
+			size_t png = formsIndexes.PNGForms;
+			status = CheckSameObject(formIDs,png,png+1,inDeduplicateImages,"PNG form from the same file");
+			if(eSuccess == status)
+				status = CheckSameObject(formIDs,png,png+2,inDeduplicateImages,"PNG form from a stream of the file");
+			if(eSuccess == status)
+				status = CheckSameObject(formIDs,png,png+3,false,"PNG forms from different files");
+		}
+		if(eSuccess == status && formsIndexes.TIFFForms != ImageDeduplicationFormsIndexes::scNotCreated)
+		{
+			size_t tiff = formsIndexes.TIFFForms;
+			status = CheckSameObject(formIDs,tiff,tiff+1,inDeduplicateImages,"TIFF form from the same file");
+			if(eSuccess == status)
+				status = CheckSameObject(formIDs,tiff,tiff+2,false,"TIFF forms with different parameters");
+		}
+		if(status != eSuccess)
+			break;
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+		for(size_t i=0; i < formIDs.size(); ++i)
+		{
+			pageContentContext->q();
+			pageContentContext->cm(0.2,0,0,0.2,(double)(i%4)*140,(double)(i/4)*200);
+			pageContentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(formIDs[i]));
+			pageContentContext->Q();
+		}
+
+		// high level drawing of the same JPG from two paths
+		pageContentContext->DrawImage(10,600,RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg"));
+		pageContentContext->DrawImage(300,600,RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ImageDeduplicationTest_logo_copy.jpg"));
+
+		status = pdfWriter.EndPageContentContext(pageContentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		// the repeated images (not counting the different ones) are found in the registry. so is the high level drawing of the copy
+		// of the JPG file [the first drawing is with a different usage than the JPG forms, so it is not found]
+		ImageContentRegistry& registry = pdfWriter.GetDocumentContext().GetImageContentRegistry();
+		unsigned long expectedHits = inDeduplicateImages ? formsIndexes.RepeatedImagesCount + 1 : 0;
+		if(registry.GetHits() != expectedHits)
+		{
+			cout<<"expected "<<expectedHits<<" reused images, got "<<registry.GetHits()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF\n";
+			break;
+		}
+
+		InputFile pdfFile;
+		PDFParser parser;
+		status = pdfFile.OpenFile(pdfFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<pdfFilePath<<"\n";
+			break;
+		}
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess || parser.GetPagesCount() != 1)
+		{
+			cout<<"failed to parse "<<pdfFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+		outFileSize = pdfFile.GetFileSize();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ImageDeduplicationTest::CreateImages(const TestConfiguration& inTestConfiguration,
+												PDFWriter& inPDFWriter,
+												ObjectIDTypeVector& outFormIDs,
+												ObjectIDTypeVector& outImageIDs,
+												ImageDeduplicationFormsIndexes& outFormsIndexes)
+{
+	string jpgPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/soundcloud_logo.jpg");
+	string jpgCopyPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ImageDeduplicationTest_logo_copy.jpg");
+	string pngPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/png/rgb-8-opaque.png");
+	string otherPNGPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/png/gray-alpha-8.png");
+	string tiffPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/tiff/FLAG_T24.TIF");
+	vector<PDFFormXObject*> forms;
+	vector<PDFImageXObject*> images;
+	InputFile jpgCopyFile;
+	InputFile pngFile;
+
+	if(jpgCopyFile.OpenFile(jpgCopyPath) != eSuccess || pngFile.OpenFile(pngPath) != eSuccess)
+	{
+		cout<<"failed to open image files for streams\n";
+		return eFailure;
+	}
+
+	outFormsIndexes.JPGForms = forms.size();
+	forms.push_back(inPDFWriter.CreateFormXObjectFromJPGFile(jpgPath));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromJPGFile(jpgPath));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromJPGStream(jpgCopyFile.GetInputStream()));
+	images.push_back(inPDFWriter.CreateImageXObjectFromJPGFile(jpgPath));
+	images.push_back(inPDFWriter.CreateImageXObjectFromJPGFile(jpgPath));
+	outFormsIndexes.RepeatedImagesCount += 3;
+#ifndef PDFHUMMUS_NO_PNG
+	outFormsIndexes.PNGForms = forms.size();
+	forms.push_back(inPDFWriter.CreateFormXObjectFromPNGFile(pngPath));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromPNGFile(pngPath));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromPNGStream(pngFile.GetInputStream()));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromPNGFile(otherPNGPath));
+	outFormsIndexes.RepeatedImagesCount += 2;
+#endif
+#ifndef PDFHUMMUS_NO_TIFF
+	TIFFUsageParameters otherParameters;
+	otherParameters.UsePassthrough = false;
+	outFormsIndexes.TIFFForms = forms.size();
+	forms.push_back(inPDFWriter.CreateFormXObjectFromTIFFFile(tiffPath));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromTIFFFile(tiffPath));
+	forms.push_back(inPDFWriter.CreateFormXObjectFromTIFFFile(tiffPath,otherParameters));
+	outFormsIndexes.RepeatedImagesCount += 1;
+#endif
+
+	EStatusCode status = eSuccess;
+	for(size_t i=0; i < forms.size(); ++i)
+	{
+		if(!forms[i])
+		{
+			cout<<"failed to create form "<<i<<"\n";
+			status = eFailure;
+			continue;
+		}
+		outFormIDs.push_back(forms[i]->GetObjectID());
+		delete forms[i];
+	}
+	for(size_t i=0; i < images.size(); ++i)
+	{
+		if(!images[i])
+		{
+			cout<<"failed to create image "<<i<<"\n";
+			status = eFailure;
+			continue;
+		}
+		outImageIDs.push_back(images[i]->GetImageObjectID());
+		delete images[i];
+	}
+	return status;
+}
+
+EStatusCode ImageDeduplicationTest::CheckSameObject(const ObjectIDTypeVector& inIDs,size_t inFirst,size_t inSecond,bool inExpectSame,const string& inDescription)
+{
+	if(inFirst >= inIDs.size() || inSecond >= inIDs.size())
+	{
+		cout<<inDescription<<": missing objects "<<inFirst<<" and "<<inSecond<<" of "<<inIDs.size()<<"\n";
+		return eFailure;
+	}
+
+	if((inIDs[inFirst] == inIDs[inSecond]) != inExpectSame)
+	{
+		cout<<inDescription<<": expected "<<(inExpectSame ? "the same object":"different objects")<<", got "<<inIDs[inFirst]<<" and "<<inIDs[inSecond]<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+EStatusCode ImageDeduplicationTest::CopyFile(const string& inSourcePath,const string& inTargetPath)
+{
+	InputFile sourceFile;
+	OutputFile targetFile;
+	EStatusCode status;
+
+	do
+	{
+		status = sourceFile.OpenFile(inSourcePath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<inSourcePath<<"\n";
+			break;
+		}
+
+		status = targetFile.OpenFile(inTargetPath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<inTargetPath<<"\n";
+			break;
+		}
+
+		OutputStreamTraits traits(targetFile.GetOutputStream());
+		status = traits.CopyToOutputStream(sourceFile.GetInputStream());
+	}while(false);
+
+	targetFile.CloseFile();
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ImageDeduplicationTest,"PDF Images")
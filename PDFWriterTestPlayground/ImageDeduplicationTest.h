@@ -0,0 +1,69 @@
+/*
+   Source File : ImageDeduplicationTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ITestUnit.h"
+#include "ObjectsBasicTypes.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+#include <vector>
+
+class PDFWriter;
+
+typedef std::vector<ObjectIDType> ObjectIDTypeVector;
+
+// where each group of created forms starts in the forms list, as recorded while creating them. groups of image types
+// that are disabled in the build are not created, and are left at scNotCreated
+struct ImageDeduplicationFormsIndexes
+{
+	static const size_t scNotCreated = (size_t)-1;
+
+	size_t JPGForms;
+	size_t PNGForms;
+	size_t TIFFForms;
+	// count of created forms and images that repeat an earlier one
+	unsigned long RepeatedImagesCount;
+
+	ImageDeduplicationFormsIndexes() {JPGForms = scNotCreated; PNGForms = scNotCreated; TIFFForms = scNotCreated; RepeatedImagesCount = 0;}
+};
+
+class ImageDeduplicationTest : public ITestUnit
+{
+public:
+	ImageDeduplicationTest(void);
+	virtual ~ImageDeduplicationTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode WriteDocument(const TestConfiguration& inTestConfiguration,
+										bool inDeduplicateImages,
+										IOBasicTypes::LongFilePositionType& outFileSize);
+	PDFHummus::EStatusCode CreateImages(const TestConfiguration& inTestConfiguration,
+										PDFWriter& inPDFWriter,
+										ObjectIDTypeVector& outFormIDs,
+										ObjectIDTypeVector& outImageIDs,
+										ImageDeduplicationFormsIndexes& outFormsIndexes);
+	PDFHummus::EStatusCode CheckSameObject(const ObjectIDTypeVector& inIDs,size_t inFirst,size_t inSecond,bool inExpectSame,const std::string& inDescription);
+	PDFHummus::EStatusCode CopyFile(const std::string& inSourcePath,const std::string& inTargetPath);
+	PDFHummus::EStatusCode TestSameKeyDifferentData();
+};
@@ -0,0 +1,264 @@
+/*
+   Source File : MemoryFontFacesTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "MemoryFontFacesTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "InputFile.h"
+#include "IByteReaderWithPosition.h"
+#include "FontProgramCache.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+MemoryFontFacesTest::MemoryFontFacesTest(void)
+{
+}
+
+MemoryFontFacesTest::~MemoryFontFacesTest(void)
+{
+}
+
+/*
+	Creates the same document, using true type, CFF and type 1 fonts in both ANSI and CID representations, with font faces read
+	from the font files and with font faces opened from memory, and compares the documents. Then checks that the embedded font
+	writers use the font programs that the faces were opened from, rather than loading the fonts again.
+*/
+
+struct FontAndTexts
+{
+	const char* mFontFileName;
+	const char* mMetricsFileName;
+	const char* mANSIText;
+	const char* mCIDText; // text out of WinAnsiEncoding, to have a CID representation. NULL for none
+};
+
+static const FontAndTexts scMemoryFontFacesFonts[] = 
+{
+	{"arial.ttf",NULL,"Hello World","\xD7\xA9\xD7\x9C\xD7\x95\xD7\x9D"}, // hebrew
+	{"KozGoPro-Regular.otf",NULL,"abcd","\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E"}, // japanese
+	{"couri.ttf",NULL,"Hello World",NULL},
+	{"BrushScriptStd.otf",NULL,"Hello World",NULL},
+	{"HLB_____.PFB","HLB_____.PFM","Hello World",NULL},
+	{"texgyrepagella-math.otf",NULL,"Hello World",NULL},
+	{NULL,NULL,NULL,NULL}
+};
+
+EStatusCode MemoryFontFacesTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateDocument(inTestConfiguration,"MemoryFontFacesFromFiles.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = CreateDocument(inTestConfiguration,"MemoryFontFaces.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		// the documents should be the same, except for the document ID in the trailer
+		string fileFacesObjects;
+		status = ReadDocumentObjects(inTestConfiguration,"MemoryFontFacesFromFiles.pdf",fileFacesObjects);
+		if(status != eSuccess)
+			break;
+
+		string memoryFacesObjects;
+		status = ReadDocumentObjects(inTestConfiguration,"MemoryFontFaces.pdf",memoryFacesObjects);
+		if(status != eSuccess)
+			break;
+
+		if(fileFacesObjects != memoryFacesObjects)
+		{
+			status = eFailure;
+			cout<<"document written with font faces opened from memory differs from the one written with faces read from files\n";
+			break;
+		}
+
+		// with the font program cache enabled, faces are opened from the cached font programs (one miss per font), and the embedded
+		// font writers use the face font programs without going to the cache again
+		FontProgramCache::DefaultCache().SetEnabled(true);
+		status = CreateDocument(inTestConfiguration,"MemoryFontFacesCached.pdf",true);
+		unsigned long hits = FontProgramCache::DefaultCache().GetHits();
+		unsigned long misses = FontProgramCache::DefaultCache().GetMisses();
+		FontProgramCache::DefaultCache().SetEnabled(false);
+		if(status != eSuccess)
+			break;
+
+		unsigned long fontsCount = sizeof(scMemoryFontFacesFonts)/sizeof(FontAndTexts) - 1;
+		if(hits != 0 || misses != fontsCount)
+		{
+			status = eFailure;
+			cout<<"unexpected font program cache use with font faces opened from memory. hits = "<<hits<<", misses = "<<misses<<
+				", expected 0 hits and "<<fontsCount<<" misses\n";
+			break;
+		}
+
+		string cachedObjects;
+		status = ReadDocumentObjects(inTestConfiguration,"MemoryFontFacesCached.pdf",cachedObjects);
+		if(status != eSuccess)
+			break;
+
+		if(fileFacesObjects != cachedObjects)
+		{
+			status = eFailure;
+			cout<<"document written with font faces opened from cached font programs differs from the one written with faces read from files\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MemoryFontFacesTest::CreateDocument(const TestConfiguration& inTestConfiguration,const string& inFileName,bool inLoadFontsToMemory)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		PDFCreationSettings creationSettings(true,true);
+		creationSettings.LoadFontsToMemory = inLoadFontsToMemory;
+
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13,
+									LogConfiguration::DefaultLogConfiguration(),creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inFileName<<"\n";
+			break;
+		}	
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		if(NULL == contentContext)
+		{
+			status = eFailure;
+			cout<<"failed to create content context for page\n";
+			delete page;
+			break;
+		}
+
+		for(int i=0;scMemoryFontFacesFonts[i].mFontFileName && eSuccess == status;++i)
+		{
+			const FontAndTexts& fontAndTexts = scMemoryFontFacesFonts[i];
+			string fontFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/fonts/") + fontAndTexts.mFontFileName);
+			PDFUsedFont* font = fontAndTexts.mMetricsFileName ?
+									pdfWriter.GetFontForFile(fontFilePath,
+															RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/fonts/") + fontAndTexts.mMetricsFileName)) :
+									pdfWriter.GetFontForFile(fontFilePath);
+			if(!font)
+			{
+				status = eFailure;
+				cout<<"failed to create font object for "<<fontAndTexts.mFontFileName<<"\n";
+				break;
+			}
+
+			contentContext->BT();
+			contentContext->k(0,0,0,1);
+			contentContext->Tf(font,1);
+			contentContext->Tm(30,0,0,30,78.4252,762.8997 - i*100);
+			status = contentContext->Tj(fontAndTexts.mANSIText);
+			if(eSuccess == status && fontAndTexts.mCIDText)
+			{
+				contentContext->Tm(30,0,0,30,78.4252,712.8997 - i*100);
+				status = contentContext->Tj(fontAndTexts.mCIDText);
+			}
+			if(status != eSuccess)
+				cout<<"failed to write text with "<<fontAndTexts.mFontFileName<<"\n";
+			contentContext->ET();
+		}
+		if(status != eSuccess)
+		{
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inFileName<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MemoryFontFacesTest::ReadDocumentObjects(const TestConfiguration& inTestConfiguration,const string& inFileName,string& outObjects)
+{
+	InputFile pdfFile;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName));
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<inFileName<<"\n";
+			break;
+		}
+
+		Byte buffer[1024];
+		string content;
+		while(pdfFile.GetInputStream()->NotEnded())
+		{
+			LongBufferSizeType readAmount = pdfFile.GetInputStream()->Read(buffer,1024);
+			content.append((const char*)buffer,readAmount);
+		}
+
+		// take everything up to the cross reference table. this covers all objects, and their positions
+		string::size_type xrefPosition = content.rfind("\nxref");
+		if(string::npos == xrefPosition)
+		{
+			status = eFailure;
+			cout<<"no cross reference table found in "<<inFileName<<"\n";
+			break;
+		}
+		outObjects = content.substr(0,xrefPosition);
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(MemoryFontFacesTest,"Text")
@@ -0,0 +1,393 @@
+/*
+   Source File : MemoryMappedParsingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "MemoryMappedParsingTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "InputMemoryMappedFileStream.h"
+#include "RefCountPtr.h"
+#include "PDFObject.h"
+#include "PDFBoolean.h"
+#include "PDFLiteralString.h"
+#include "PDFHexString.h"
+#include "PDFName.h"
+#include "PDFInteger.h"
+#include "PDFReal.h"
+#include "PDFArray.h"
+#include "PDFDictionary.h"
+#include "PDFIndirectObjectReference.h"
+#include "PDFStreamInput.h"
+#include "PDFSymbol.h"
+#include "IByteReader.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+MemoryMappedParsingTest::MemoryMappedParsingTest(void)
+{
+}
+
+MemoryMappedParsingTest::~MemoryMappedParsingTest(void)
+{
+}
+
+/*
+	Parse files through InputMemoryMappedFileStream, and compare with parsing them through the regular buffered file stream.
+	Then check that files that can't be mapped are read regularly.
+*/
+EStatusCode MemoryMappedParsingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CompareParsing(inTestConfiguration,"Original.pdf");
+		if(status != eSuccess)
+			break;
+
+		// objects in object streams, read from the mapped memory and decoded
+		status = CompareParsing(inTestConfiguration,"ObjectStreams.pdf");
+		if(status != eSuccess)
+			break;
+
+		status = CompareAppendedPages(inTestConfiguration,"ObjectStreams.pdf");
+		if(status != eSuccess)
+			break;
+
+		status = TestFallback(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MemoryMappedParsingTest::CompareParsing(const TestConfiguration& inTestConfiguration,const string& inSourceFileName)
+{
+	EStatusCode status = eSuccess;
+	string sourceFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/") + inSourceFileName);
+	InputMemoryMappedFileStream mappedStream;
+	InputFile mappedFile;
+	InputFile regularFile;
+	PDFParser mappedParser;
+	PDFParser regularParser;
+
+	do
+	{
+		status = mappedStream.Open(sourceFilePath);
+		if(status != eSuccess || !mappedStream.GetData() || mappedStream.GetFileSize() == 0)
+		{
+			cout<<"failed to map "<<inSourceFileName<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// the whole file is available as a single direct buffer
+		LongBufferSizeType availableSize = 0;
+		if(mappedStream.PeekDirectBuffer(availableSize) != mappedStream.GetData() || availableSize != (LongBufferSizeType)mappedStream.GetFileSize())
+		{
+			cout<<"expected the mapped stream of "<<inSourceFileName<<" to provide the whole file as direct buffer\n";
+			status = eFailure;
+			break;
+		}
+
+		status = mappedFile.OpenFile(sourceFilePath,true);
+		if(status != eSuccess || !mappedFile.IsMemoryMapped())
+		{
+			cout<<"expected "<<inSourceFileName<<" to be opened with memory mapping\n";
+			status = eFailure;
+			break;
+		}
+
+		status = regularFile.OpenFile(sourceFilePath);
+		if(status != eSuccess || regularFile.IsMemoryMapped())
+		{
+			cout<<"expected "<<inSourceFileName<<" to be opened without memory mapping\n";
+			status = eFailure;
+			break;
+		}
+
+		if(mappedFile.GetFileSize() != regularFile.GetFileSize())
+		{
+			cout<<"mapped file size "<<mappedFile.GetFileSize()<<" differs from file size "<<regularFile.GetFileSize()<<" for "<<inSourceFileName<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = mappedParser.StartPDFParsing(&mappedStream);
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse "<<inSourceFileName<<" through the mapped stream\n";
+			break;
+		}
+
+		status = regularParser.StartPDFParsing(regularFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse "<<inSourceFileName<<"\n";
+			break;
+		}
+
+		if(mappedParser.GetPagesCount() != regularParser.GetPagesCount() || mappedParser.GetObjectsCount() != regularParser.GetObjectsCount())
+		{
+			cout<<"mapped parsing of "<<inSourceFileName<<" found "<<mappedParser.GetPagesCount()<<" pages and "<<mappedParser.GetObjectsCount()<<
+				" objects, regular parsing found "<<regularParser.GetPagesCount()<<" pages and "<<regularParser.GetObjectsCount()<<" objects\n";
+			status = eFailure;
+			break;
+		}
+
+		// read the objects in reverse, to have the mapped stream seek back and forth
+		for(ObjectIDType i = mappedParser.GetObjectsCount(); i > 0 && eSuccess == status; --i)
+		{
+			RefCountPtr<PDFObject> mappedObject(mappedParser.ParseNewObject(i-1));
+			RefCountPtr<PDFObject> regularObject(regularParser.ParseNewObject(i-1));
+
+			if(ObjectToString(mappedParser,mappedObject.GetPtr()) != ObjectToString(regularParser,regularObject.GetPtr()))
+			{
+				cout<<"object "<<i-1<<" of "<<inSourceFileName<<" parsed differently through the mapped stream\n";
+				status = eFailure;
+			}
+		}
+	}while(false);
+
+	return status;
+}
+
+static string ReadAll(IByteReader* inReader)
+{
+	MyStringBuf buffer;
+	OutputStringBufferStream contentStream(&buffer);
+	OutputStreamTraits traits(&contentStream);
+	traits.CopyToOutputStream(inReader);
+	return contentStream.ToString();
+}
+
+string MemoryMappedParsingTest::ObjectToString(PDFParser& inParser,PDFObject* inObject)
+{
+	if(!inObject)
+		return "<missing>";
+
+	stringstream result;
+	result<<PDFObject::scPDFObjectTypeLabel(inObject->GetType())<<" ";
+
+	switch(inObject->GetType())
+	{
+		case PDFObject::ePDFObjectBoolean:
+			result<<((PDFBoolean*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectLiteralString:
+			result<<((PDFLiteralString*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectHexString:
+			result<<((PDFHexString*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectName:
+			result<<((PDFName*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectInteger:
+			result<<((PDFInteger*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectReal:
+			result<<((PDFReal*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectSymbol:
+			result<<((PDFSymbol*)inObject)->GetValue();
+			break;
+		case PDFObject::ePDFObjectIndirectObjectReference:
+			result<<((PDFIndirectObjectReference*)inObject)->mObjectID<<" "<<((PDFIndirectObjectReference*)inObject)->mVersion;
+			break;
+		case PDFObject::ePDFObjectArray:
+		{
+			SingleValueContainerIterator<PDFObjectVector> it(((PDFArray*)inObject)->GetIterator());
+			result<<"[";
+			while(it.MoveNext())
+				result<<ObjectToString(inParser,it.GetItem())<<",";
+			result<<"]";
+			break;
+		}
+		case PDFObject::ePDFObjectDictionary:
+		{
+			MapIterator<PDFNameToPDFObjectMap> it(((PDFDictionary*)inObject)->GetIterator());
+			result<<"<<";
+			while(it.MoveNext())
+				result<<it.GetKey()->GetValue()<<":"<<ObjectToString(inParser,it.GetValue())<<",";
+			result<<">>";
+			break;
+		}
+		case PDFObject::ePDFObjectStream:
+		{
+			PDFStreamInput* stream = (PDFStreamInput*)inObject;
+			RefCountPtr<PDFDictionary> streamDictionary(stream->QueryStreamDictionary());
+			result<<ObjectToString(inParser,streamDictionary.GetPtr())<<" position "<<stream->GetStreamContentStart();
+
+			// decoded content, or the encoded content for filters the parser does not support
+			IByteReader* reader = inParser.StartReadingFromStream(stream);
+			if(!reader)
+				reader = inParser.StartReadingFromStreamForPlainCopying(stream);
+			if(reader)
+			{
+				result<<" data "<<ReadAll(reader);
+				delete reader;
+			}
+			break;
+		}
+		default:
+			break;
+	}
+	return result.str();
+}
+
+EStatusCode MemoryMappedParsingTest::CompareAppendedPages(const TestConfiguration& inTestConfiguration,const string& inSourceFileName)
+{
+	EStatusCode status;
+	string sourceFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/") + inSourceFileName);
+	string mappedFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("MemoryMappedParsingTest_") + inSourceFileName + "_Mapped.pdf");
+	string regularFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("MemoryMappedParsingTest_") + inSourceFileName + "_Regular.pdf");
+
+	do
+	{
+		status = AppendPages(sourceFilePath,true,mappedFilePath);
+		if(status != eSuccess)
+			break;
+
+		status = AppendPages(sourceFilePath,false,regularFilePath);
+		if(status != eSuccess)
+			break;
+
+		ifstream mappedFile(mappedFilePath.c_str(),ios::binary);
+		ifstream regularFile(regularFilePath.c_str(),ios::binary);
+		vector<char> mappedData((istreambuf_iterator<char>(mappedFile)),istreambuf_iterator<char>());
+		vector<char> regularData((istreambuf_iterator<char>(regularFile)),istreambuf_iterator<char>());
+
+		// the trailer ID is computed from the file path, so compare everything up to the trailer
+		string trailerKeyword = "trailer";
+		vector<char>::iterator mappedTrailer = find_end(mappedData.begin(),mappedData.end(),trailerKeyword.begin(),trailerKeyword.end());
+		vector<char>::iterator regularTrailer = find_end(regularData.begin(),regularData.end(),trailerKeyword.begin(),trailerKeyword.end());
+
+		if(mappedData.size() == 0 ||
+			mappedTrailer - mappedData.begin() != regularTrailer - regularData.begin() ||
+			!equal(mappedData.begin(),mappedTrailer,regularData.begin()))
+		{
+			cout<<"pages appended from "<<inSourceFileName<<" through memory mapping differ from pages appended regularly\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MemoryMappedParsingTest::AppendPages(const string& inSourceFilePath,bool inMemoryMapInputFile,const string& inResultFilePath)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	PDFParsingOptions parsingOptions;
+
+	parsingOptions.MemoryMapInputFile = inMemoryMapInputFile;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inResultFilePath,ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inResultFilePath<<"\n";
+			break;
+		}
+
+		EStatusCodeAndObjectIDTypeList result = pdfWriter.AppendPDFPagesFromPDF(inSourceFilePath,PDFPageRange(),ObjectIDTypeList(),parsingOptions);
+		if(result.first != eSuccess)
+		{
+			cout<<"failed to append pages from "<<inSourceFilePath<<(inMemoryMapInputFile ? ", when reading through memory mapping":"")<<"\n";
+			status = result.first;
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inResultFilePath<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MemoryMappedParsingTest::TestFallback(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = eSuccess;
+	string emptyFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MemoryMappedParsingTest_Empty.txt");
+	string missingFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MemoryMappedParsingTest_Missing.txt");
+
+	do
+	{
+		OutputFile emptyFile;
+		status = emptyFile.OpenFile(emptyFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to create "<<emptyFilePath<<"\n";
+			break;
+		}
+		emptyFile.CloseFile();
+
+		// empty files can't be mapped
+		InputMemoryMappedFileStream mappedStream;
+		if(mappedStream.Open(emptyFilePath) == eSuccess)
+		{
+			cout<<"expected mapping an empty file to fail\n";
+			status = eFailure;
+			break;
+		}
+
+		// so they are read through the regular file stream
+		InputFile inputFile;
+		status = inputFile.OpenFile(emptyFilePath,true);
+		if(status != eSuccess || inputFile.IsMemoryMapped() || !inputFile.GetInputStream() || inputFile.GetFileSize() != 0)
+		{
+			cout<<"expected an empty file to be opened without memory mapping\n";
+			status = eFailure;
+			break;
+		}
+
+		// a regular open fails on the missing file, after mapping failed
+		InputFile missingFile;
+		if(missingFile.OpenFile(missingFilePath,true) == eSuccess)
+		{
+			cout<<"expected opening a missing file to fail\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(MemoryMappedParsingTest,"Parsing")
@@ -0,0 +1,393 @@
+/*
+ Source File : MergeContentRewritingTest.cpp
+ 
+ 
+ Copyright 2012 Gal Kahana PDFWriter
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ 
+ */
+#include "MergeContentRewritingTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFFormXObject.h"
+#include "PageContentContext.h"
+#include "XObjectContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "RefCountPtr.h"
+#include "PDFObjectCast.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFName.h"
+#include "PDFStreamInput.h"
+#include "PDFIndirectObjectReference.h"
+#include "ParsedPrimitiveHelper.h"
+#include "IByteReader.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+// matches the size of the buffer that merging reads page content with, to place names across its boundaries
+static const size_t scRewriteBufferSize = 4096;
+static const size_t scFormsCount = 4;
+// forms that the target page already uses, so that merged forms get different names than in the source page
+static const size_t scTargetPageFormsCount = 8;
+
+MergeContentRewritingTest::MergeContentRewritingTest(void)
+{
+}
+
+MergeContentRewritingTest::~MergeContentRewritingTest(void)
+{
+}
+
+EStatusCode MergeContentRewritingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	StringVector formNames;
+	string content;
+	string sourceFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MergeContentRewritingSource.pdf");
+	string resultFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MergeContentRewritingTest.pdf");
+
+	do
+	{
+		status = CreateSourcePDF(sourceFilePath,formNames,content);
+		if(status != eSuccess)
+			break;
+
+		status = MergeSourcePage(inTestConfiguration,sourceFilePath,resultFilePath);
+		if(status != eSuccess)
+			break;
+
+		// map the merged page forms names back to the source page forms names, via the forms bounding boxes [form i has a box of i+1 width]
+		InputFile resultFile;
+		PDFParser parser;
+		status = resultFile.OpenFile(resultFilePath);
+		if(status != eSuccess)
+		{
+			cout<<"failed to open merge result file\n";
+			break;
+		}
+		status = parser.StartPDFParsing(resultFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse merge result file\n";
+			break;
+		}
+
+		RefCountPtr<PDFDictionary> page(parser.ParsePage(0));
+		PDFObjectCastPtr<PDFDictionary> resources(!page ? NULL : parser.QueryDictionaryObject(page.GetPtr(),"Resources"));
+		PDFObjectCastPtr<PDFDictionary> xobjects(!resources ? NULL : parser.QueryDictionaryObject(resources.GetPtr(),"XObject"));
+		if(!xobjects)
+		{
+			cout<<"merged page has no xobjects resources\n";
+			status = eFailure;
+			break;
+		}
+
+		StringToStringMap mergedNames;
+		MapIterator<PDFNameToPDFObjectMap> it = xobjects->GetIterator();
+		while(it.MoveNext())
+		{
+			PDFObjectCastPtr<PDFIndirectObjectReference> formReference(it.GetValue());
+			PDFObjectCastPtr<PDFStreamInput> form(!formReference ? NULL : parser.ParseNewObject(formReference->mObjectID));
+			PDFObjectCastPtr<PDFArray> box(!form ? NULL : parser.QueryDictionaryObject(form->QueryStreamDictionary(),"BBox"));
+			RefCountPtr<PDFObject> width(!box ? NULL : parser.QueryArrayObject(box.GetPtr(),2));
+			if(!width)
+			{
+				cout<<"unexpected form resource "<<it.GetKey()->GetValue()<<" in merged page\n";
+				status = eFailure;
+				break;
+			}
+			size_t formIndex = (size_t)ParsedPrimitiveHelper(width.GetPtr()).GetAsInteger() - 1;
+			if(formIndex < scFormsCount)
+				mergedNames.insert(StringToStringMap::value_type(formNames[formIndex],it.GetKey()->GetValue()));
+		}
+		if(status != eSuccess)
+			break;
+		if(mergedNames.size() != scFormsCount)
+		{
+			cout<<"expected "<<scFormsCount<<" merged forms, got "<<mergedNames.size()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		string mergedContent;
+		status = ReadPageContent(parser,page.GetPtr(),mergedContent);
+		if(status != eSuccess)
+			break;
+
+		// the merged content should be the source content as is, with the forms names replaced. including names that were read
+		// partly in one buffer and partly in the next one
+		if(mergedContent.find(ReplaceNames(content,mergedNames)) == string::npos)
+		{
+			cout<<"merged page content is not the source page content with replaced resources names\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+string MergeContentRewritingTest::CreateContent(const StringVector& inFormNames)
+{
+	// form placements throughout, and at every boundary of the rewrite buffer a form name that starts 0 to 5 bytes before it
+	string content;
+	size_t nameIndex = 0;
+
+	for(size_t i = 1; i <= 6; ++i)
+	{
+		size_t nameStart = i*scRewriteBufferSize - (i - 1);
+
+		for(;;)
+		{
+			string placement = "q 1 0 0 1 10 10 cm /" + inFormNames[nameIndex % inFormNames.size()] + " Do Q\n";
+			if(content.size() + placement.size() >= nameStart)
+				break;
+			content.append(placement);
+			++nameIndex;
+		}
+		content.append(nameStart - 1 - content.size(),' ');
+		content.append("\n/" + inFormNames[i % inFormNames.size()] + " Do\n");
+	}
+	return content;
+}
+
+EStatusCode MergeContentRewritingTest::CreateSourcePDF(const string& inSourceFilePath,StringVector& outFormNames,string& outContent)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inSourceFilePath,ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start source PDF\n";
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		for(size_t i = 0; i < scFormsCount && eSuccess == status; ++i)
+		{
+			PDFFormXObject* form = pdfWriter.StartFormXObject(PDFRectangle(0,0,(double)(i+1),(double)(i+1)));
+			form->GetContentContext()->re(0,0,(double)(i+1),(double)(i+1));
+			form->GetContentContext()->f();
+			outFormNames.push_back(page->GetResourcesDictionary().AddFormXObjectMapping(form->GetObjectID()));
+			status = pdfWriter.EndFormXObjectAndRelease(form);
+		}
+		if(status != eSuccess)
+		{
+			cout<<"failed to create source forms\n";
+			delete page;
+			break;
+		}
+
+		outContent = CreateContent(outFormNames);
+		PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+		pageContentContext->WriteFreeCode(outContent);
+		status = pdfWriter.EndPageContentContext(pageContentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end source page content\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write source page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed to end source PDF\n";
+			break;
+		}
+
+		// names are placed by their positions in the page content stream, so make sure it's just the written content
+		InputFile sourceFile;
+		PDFParser parser;
+		string sourceContent;
+		status = sourceFile.OpenFile(inSourceFilePath);
+		if(status != eSuccess || parser.StartPDFParsing(sourceFile.GetInputStream()) != eSuccess)
+		{
+			cout<<"failed to parse source PDF\n";
+			status = eFailure;
+			break;
+		}
+		RefCountPtr<PDFDictionary> sourcePage(parser.ParsePage(0));
+		status = ReadPageContent(parser,sourcePage.GetPtr(),sourceContent);
+		if(status != eSuccess)
+			break;
+		if(sourceContent != outContent)
+		{
+			cout<<"expected source page content to be the written content\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MergeContentRewritingTest::MergeSourcePage(const TestConfiguration& inTestConfiguration,const string& inSourceFilePath,const string& inResultFilePath)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inResultFilePath,
+									ePDFVersion13,
+									LogConfiguration(true,true,RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"MergeContentRewritingTest.txt")));
+		if(status != eSuccess)
+			break;
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+		for(size_t i = 0; i < scTargetPageFormsCount && eSuccess == status; ++i)
+		{
+			PDFFormXObject* form = pdfWriter.StartFormXObject(PDFRectangle(0,0,100,100));
+			form->GetContentContext()->re(0,0,100,100);
+			form->GetContentContext()->f();
+			pageContentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(form->GetObjectID()));
+			status = pdfWriter.EndFormXObjectAndRelease(form);
+		}
+		if(status != eSuccess)
+		{
+			cout<<"failed to create target page forms\n";
+			delete page;
+			break;
+		}
+
+		PDFPageRange singlePageRange;
+		singlePageRange.mType = PDFPageRange::eRangeTypeSpecific;
+		singlePageRange.mSpecificRanges.push_back(ULongAndULong(0,0));
+
+		status = pdfWriter.MergePDFPagesToPage(page,inSourceFilePath,singlePageRange);
+		if(status != eSuccess)
+		{
+			cout<<"failed to merge source page\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.EndPageContentContext(pageContentContext);
+		if(status != eSuccess)
+		{
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+	}while(false);
+
+	return status;
+}
+
+EStatusCode MergeContentRewritingTest::ReadPageContent(PDFParser& inParser,PDFDictionary* inPage,string& outContent)
+{
+	RefCountPtr<PDFObject> contents(!inPage ? NULL : inParser.QueryDictionaryObject(inPage,"Contents"));
+	PDFObjectVector streams;
+
+	if(!contents)
+	{
+		cout<<"page has no content\n";
+		return eFailure;
+	}
+	if(contents->GetType() == PDFObject::ePDFObjectArray)
+	{
+		PDFArray* contentsArray = (PDFArray*)contents.GetPtr();
+		for(unsigned long i = 0; i < contentsArray->GetLength(); ++i)
+			streams.push_back(inParser.QueryArrayObject(contentsArray,i));
+	}
+	else
+	{
+		contents->AddRef();
+		streams.push_back(contents.GetPtr());
+	}
+
+	EStatusCode status = eSuccess;
+	for(PDFObjectVector::iterator it = streams.begin(); it != streams.end(); ++it)
+	{
+		IByteReader* reader = (eSuccess == status && *it && (*it)->GetType() == PDFObject::ePDFObjectStream) ? 
+									inParser.StartReadingFromStream((PDFStreamInput*)*it) : 
+									NULL;
+		if(!reader)
+		{
+			if(eSuccess == status)
+				cout<<"unable to read page content stream\n";
+			status = eFailure;
+		}
+		else
+		{
+			IOBasicTypes::Byte buffer[1024];
+			while(reader->NotEnded())
+			{
+				IOBasicTypes::LongBufferSizeType readBytes = reader->Read(buffer,sizeof(buffer));
+				if(0 == readBytes)
+					break;
+				outContent.append((const char*)buffer,readBytes);
+			}
+			delete reader;
+		}
+		if(*it)
+			(*it)->Release();
+	}
+	return status;
+}
+
+string MergeContentRewritingTest::ReplaceNames(const string& inContent,const StringToStringMap& inNames)
+{
+	string result;
+	size_t position = 0;
+
+	while(position < inContent.size())
+	{
+		size_t nameStart = inContent.find('/',position);
+		if(string::npos == nameStart)
+		{
+			result.append(inContent,position,string::npos);
+			break;
+		}
+		size_t nameEnd = inContent.find_first_of(" \r\n",nameStart);
+		if(string::npos == nameEnd)
+			nameEnd = inContent.size();
+
+		StringToStringMap::const_iterator it = inNames.find(inContent.substr(nameStart + 1,nameEnd - nameStart - 1));
+		result.append(inContent,position,nameStart + 1 - position);
+		result.append(it == inNames.end() ? inContent.substr(nameStart + 1,nameEnd - nameStart - 1) : it->second);
+		position = nameEnd;
+	}
+	return result;
+}
+
+ADD_CATEGORIZED_TEST(MergeContentRewritingTest,"PDFEmbedding")
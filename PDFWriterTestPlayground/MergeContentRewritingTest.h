@@ -0,0 +1,48 @@
+/*
+ Source File : MergeContentRewritingTest.h
+ 
+ 
+ Copyright 2012 Gal Kahana PDFWriter
+ 
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+ 
+ http://www.apache.org/licenses/LICENSE-2.0
+ 
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+ 
+ 
+ */
+#pragma once
+#include "ITestUnit.h"
+
+#include <string>
+#include <vector>
+#include <map>
+
+class PDFParser;
+class PDFDictionary;
+
+typedef std::vector<std::string> StringVector;
+typedef std::map<std::string,std::string> StringToStringMap;
+
+class MergeContentRewritingTest : public ITestUnit
+{
+public:
+	MergeContentRewritingTest(void);
+	virtual ~MergeContentRewritingTest(void);
+    
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	std::string CreateContent(const StringVector& inFormNames);
+	PDFHummus::EStatusCode CreateSourcePDF(const std::string& inSourceFilePath,StringVector& outFormNames,std::string& outContent);
+	PDFHummus::EStatusCode MergeSourcePage(const TestConfiguration& inTestConfiguration,const std::string& inSourceFilePath,const std::string& inResultFilePath);
+	PDFHummus::EStatusCode ReadPageContent(PDFParser& inParser,PDFDictionary* inPage,std::string& outContent);
+	std::string ReplaceNames(const std::string& inContent,const StringToStringMap& inNames);
+};
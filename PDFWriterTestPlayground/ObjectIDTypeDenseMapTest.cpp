@@ -0,0 +1,176 @@
+/*
+   Source File : ObjectIDTypeDenseMapTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ObjectIDTypeDenseMapTest.h"
+#include "TestsRunner.h"
+#include "ObjectIDTypeDenseMap.h"
+#include "ObjectIDTypeDenseSet.h"
+#include "MapIterator.h"
+
+#include <iostream>
+#include <map>
+
+using namespace std;
+using namespace PDFHummus;
+
+ObjectIDTypeDenseMapTest::ObjectIDTypeDenseMapTest(void)
+{
+}
+
+ObjectIDTypeDenseMapTest::~ObjectIDTypeDenseMapTest(void)
+{
+}
+
+EStatusCode ObjectIDTypeDenseMapTest::Run(const TestConfiguration& /*inTestConfiguration*/)
+{
+	EStatusCode status = RunMapTest();
+	if(status != eSuccess)
+		return status;
+	return RunSetTest();
+}
+
+EStatusCode ObjectIDTypeDenseMapTest::RunMapTest()
+{
+	ObjectIDTypeDenseMap denseMap;
+	map<ObjectIDType,ObjectIDType> expected;
+
+	denseMap.Reset(100);
+
+	if(denseMap.begin() != denseMap.end())
+	{
+		cout<<"new map is not empty\n";
+		return eFailure;
+	}
+
+	// dense entries, sparse entries beyond the dense size, a mapping to 0, and a mapping to the maximal ID [which is kept
+	// in the sparse entries, though its key is in the dense range]
+	ObjectIDType keys[] = {50,3,1000,99,100,0,7,20};
+	ObjectIDType values[] = {1,2,3,4,5,6,0,~((ObjectIDType)0)};
+	for(size_t i=0; i < sizeof(keys)/sizeof(ObjectIDType); ++i)
+	{
+		pair<ObjectIDTypeDenseMap::iterator,bool> result = denseMap.insert(ObjectIDTypeDenseMap::value_type(keys[i],values[i]));
+		if(!result.second || result.first->first != keys[i] || result.first->second != values[i])
+		{
+			cout<<"failed to insert "<<keys[i]<<"\n";
+			return eFailure;
+		}
+		expected.insert(map<ObjectIDType,ObjectIDType>::value_type(keys[i],values[i]));
+	}
+
+	// existing mappings are not replaced
+	pair<ObjectIDTypeDenseMap::iterator,bool> result = denseMap.insert(ObjectIDTypeDenseMap::value_type(50,10));
+	if(result.second || result.first->second != 1)
+	{
+		cout<<"insert replaced an existing mapping\n";
+		return eFailure;
+	}
+
+	for(ObjectIDType i=0; i < 1100; ++i)
+	{
+		map<ObjectIDType,ObjectIDType>::iterator itExpected = expected.find(i);
+		ObjectIDTypeDenseMap::iterator it = denseMap.find(i);
+		if((itExpected == expected.end()) != (it == denseMap.end()) ||
+			(it != denseMap.end() && it->second != itExpected->second))
+		{
+			cout<<"wrong find result for "<<i<<"\n";
+			return eFailure;
+		}
+	}
+
+	// iteration is in ascending order, like std::map
+	MapIterator<ObjectIDTypeDenseMap> it(denseMap);
+	map<ObjectIDType,ObjectIDType>::iterator itExpected = expected.begin();
+	while(it.MoveNext())
+	{
+		if(itExpected == expected.end() || it.GetKey() != itExpected->first || it.GetValue() != itExpected->second)
+		{
+			cout<<"wrong iteration at "<<it.GetKey()<<"\n";
+			return eFailure;
+		}
+		++itExpected;
+	}
+	if(itExpected != expected.end())
+	{
+		cout<<"iteration ended early, missing "<<itExpected->first<<"\n";
+		return eFailure;
+	}
+
+	// iterating from any found entry continues in ascending order
+	for(itExpected = expected.begin(); itExpected != expected.end(); ++itExpected)
+	{
+		ObjectIDTypeDenseMap::iterator itFound = denseMap.find(itExpected->first);
+		map<ObjectIDType,ObjectIDType>::iterator itExpectedNext = itExpected;
+		for(; itFound != denseMap.end() && itExpectedNext != expected.end(); ++itFound,++itExpectedNext)
+		{
+			if(itFound->first != itExpectedNext->first)
+				break;
+		}
+		if(itFound != denseMap.end() || itExpectedNext != expected.end())
+		{
+			cout<<"wrong iteration from "<<itExpected->first<<"\n";
+			return eFailure;
+		}
+	}
+
+	denseMap.clear();
+	if(denseMap.begin() != denseMap.end() || denseMap.find(50) != denseMap.end())
+	{
+		cout<<"cleared map is not empty\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+EStatusCode ObjectIDTypeDenseMapTest::RunSetTest()
+{
+	ObjectIDTypeDenseSet denseSet;
+
+	denseSet.Reset(100);
+
+	if(!denseSet.Insert(5) || !denseSet.Insert(500) || denseSet.Insert(5) || denseSet.Insert(500))
+	{
+		cout<<"wrong set insert result\n";
+		return eFailure;
+	}
+
+	if(!denseSet.Contains(5) || !denseSet.Contains(500) || denseSet.Contains(6) || denseSet.Contains(501))
+	{
+		cout<<"wrong set contents\n";
+		return eFailure;
+	}
+
+	denseSet.Clear();
+	if(denseSet.Contains(5) || denseSet.Contains(500))
+	{
+		cout<<"cleared set is not empty\n";
+		return eFailure;
+	}
+
+	if(!denseSet.Insert(5) || !denseSet.Contains(5))
+	{
+		cout<<"failed to insert to cleared set\n";
+		return eFailure;
+	}
+
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(ObjectIDTypeDenseMapTest,"Patterns")
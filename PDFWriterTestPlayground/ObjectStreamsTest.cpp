@@ -0,0 +1,256 @@
+/*
+   Source File : ObjectStreamsTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ObjectStreamsTest.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "PDFFormXObject.h"
+#include "XObjectContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "BoxingBase.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+ObjectStreamsTest::ObjectStreamsTest(void)
+{
+}
+
+ObjectStreamsTest::~ObjectStreamsTest(void)
+{
+}
+
+/*
+	Creates the same document with and without object streams, and compares the pages contents.
+	The object streams version should be smaller, and have objects placed in object streams
+*/
+
+static const int scPagesCount = 250;
+
+EStatusCode ObjectStreamsTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateDocument(inTestConfiguration,"ObjectStreamsNone.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = CreateDocument(inTestConfiguration,"ObjectStreams.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		StringList plainContents;
+		ObjectIDType plainCompressedObjectsCount;
+		status = ReadPagesContents(inTestConfiguration,"ObjectStreamsNone.pdf",plainContents,plainCompressedObjectsCount);
+		if(status != eSuccess)
+			break;
+
+		StringList packedContents;
+		ObjectIDType packedCompressedObjectsCount;
+		status = ReadPagesContents(inTestConfiguration,"ObjectStreams.pdf",packedContents,packedCompressedObjectsCount);
+		if(status != eSuccess)
+			break;
+
+		if(plainContents.size() != scPagesCount || plainContents != packedContents)
+		{
+			status = eFailure;
+			cout<<"pages contents of document written with object streams differ from the regular one\n";
+			break;
+		}
+
+		if(plainCompressedObjectsCount != 0 || packedCompressedObjectsCount == 0)
+		{
+			status = eFailure;
+			cout<<"unexpected objects in object streams count. regular document has "<<plainCompressedObjectsCount<<", object streams document has "<<packedCompressedObjectsCount<<"\n";
+			break;
+		}
+
+		InputFile plainFile;
+		InputFile packedFile;
+		plainFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ObjectStreamsNone.pdf"));
+		packedFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ObjectStreams.pdf"));
+		if(packedFile.GetFileSize() >= plainFile.GetFileSize())
+		{
+			status = eFailure;
+			cout<<"document written with object streams is not smaller than the regular one. "<<packedFile.GetFileSize()<<" vs. "<<plainFile.GetFileSize()<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsTest::CreateDocument(const TestConfiguration& inTestConfiguration,const std::string& inFileName,bool inWriteObjectStreams)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		PDFCreationSettings creationSettings(true,true);
+		creationSettings.WriteObjectStreams = inWriteObjectStreams;
+
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13,
+									LogConfiguration::DefaultLogConfiguration(),creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			status = eFailure;
+			cout<<"failed to create font object\n";
+			break;
+		}
+
+		// a form shared by all pages
+		PDFFormXObject* form = pdfWriter.StartFormXObject(PDFRectangle(0,0,100,100));
+		XObjectContentContext* formContext = form->GetContentContext();
+		formContext->rg(0,0,1);
+		formContext->re(0,0,100,100);
+		formContext->f();
+		status = pdfWriter.EndFormXObject(form);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end form\n";
+			break;
+		}
+		ObjectIDType formID = form->GetObjectID();
+		delete form;
+
+		for(int i=0; i < scPagesCount && eSuccess == status; ++i)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+
+			contentContext->q();
+			contentContext->cm(1,0,0,1,10 + i,700);
+			contentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(formID));
+			contentContext->Q();
+
+			AbstractContentContext::TextOptions textOptions(font,14,AbstractContentContext::eGray,0);
+			contentContext->WriteText(10,100,"Page number " + Int(i+1).ToString(),textOptions);
+
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end page content context\n";
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+			{
+				cout<<"failed to write page\n";
+				break;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ObjectStreamsTest::ReadPagesContents(const TestConfiguration& inTestConfiguration,
+												const std::string& inFileName,
+												StringList& outPagesContents,
+												ObjectIDType& outCompressedObjectsCount)
+{
+	PDFParser parser;
+	InputFile pdfFile;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName));
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<inFileName<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse "<<inFileName<<"\n";
+			break;
+		}
+
+		outCompressedObjectsCount = 0;
+		for(ObjectIDType i=0; i < parser.GetXrefSize(); ++i)
+		{
+			XrefEntryInput* xrefEntry = parser.GetXrefEntry(i);
+			if(xrefEntry && eXrefEntryStreamObject == xrefEntry->mType)
+				++outCompressedObjectsCount;
+		}
+
+		for(unsigned long i=0; i < parser.GetPagesCount() && eSuccess == status; ++i)
+		{
+			RefCountPtr<PDFDictionary> page(parser.ParsePage(i));
+			PDFObjectCastPtr<PDFStreamInput> contentStream(!page ? NULL : parser.QueryDictionaryObject(page.GetPtr(),"Contents"));
+			IByteReader* reader = !contentStream ? NULL : parser.StartReadingFromStream(contentStream.GetPtr());
+			if(!reader)
+			{
+				status = eFailure;
+				cout<<"failed to read content stream of page "<<i<<" of "<<inFileName<<"\n";
+				break;
+			}
+
+			std::string pageContent;
+			Byte buffer[1024];
+			while(reader->NotEnded())
+			{
+				LongBufferSizeType readAmount = reader->Read(buffer,1024);
+				pageContent.append((const char*)buffer,readAmount);
+			}
+			delete reader;
+			outPagesContents.push_back(pageContent);
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ObjectStreamsTest,"PDF")
@@ -0,0 +1,119 @@
+/*
+   Source File : PDFDictionaryTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "PDFDictionaryTest.h"
+#include "PDFObject.h"
+#include "PDFName.h"
+#include "PDFInteger.h"
+#include "PDFDictionary.h"
+#include "PDFObjectCast.h"
+#include "RefCountPtr.h"
+#include "BoxingBase.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+PDFDictionaryTest::PDFDictionaryTest(void)
+{
+}
+
+PDFDictionaryTest::~PDFDictionaryTest(void)
+{
+}
+
+EStatusCode PDFDictionaryTest::Run(const TestConfiguration& /*inTestConfiguration*/)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+
+	// check lookup and insertion order iteration, with few keys (scanned) and many keys (hashed)
+	int sizes[2] = {5,100};
+	for(int i=0; i < 2; ++i)
+	{
+		RefCountPtr<PDFDictionary> aDictionary(new PDFDictionary());
+
+		for(int j=0; j < sizes[i]; ++j)
+		{
+			// descending names, so that insertion order is not the names order
+			RefCountPtr<PDFName> key(new PDFName("Key" + Int(sizes[i] - j).ToString()));
+			RefCountPtr<PDFInteger> value(new PDFInteger(j));
+			aDictionary->Insert(key.GetPtr(),value.GetPtr());
+		}
+
+		// duplicate key should not replace the existing value
+		RefCountPtr<PDFName> duplicateKey(new PDFName("Key1"));
+		RefCountPtr<PDFInteger> duplicateValue(new PDFInteger(-1));
+		aDictionary->Insert(duplicateKey.GetPtr(),duplicateValue.GetPtr());
+
+		for(int j=0; j < sizes[i] && eSuccess == status; ++j)
+		{
+			PDFObjectCastPtr<PDFInteger> value(aDictionary->QueryDirectObject("Key" + Int(sizes[i] - j).ToString()));
+			if(!value || value->GetValue() != j)
+			{
+				cout<<"wrong value for key Key"<<(sizes[i] - j)<<" in dictionary of size "<<sizes[i]<<"\n";
+				status = PDFHummus::eFailure;
+			}
+		}
+
+		if(aDictionary->Exists("Key0") || aDictionary->Exists("") || !aDictionary->Exists("Key1"))
+		{
+			cout<<"wrong existance check in dictionary of size "<<sizes[i]<<"\n";
+			status = PDFHummus::eFailure;
+		}
+
+		MapIterator<PDFNameToPDFObjectMap> it = aDictionary->GetIterator();
+		int index = 0;
+		while(it.MoveNext() && eSuccess == status)
+		{
+			if(it.GetKey()->GetValue() != "Key" + Int(sizes[i] - index).ToString())
+			{
+				cout<<"wrong iteration order in dictionary of size "<<sizes[i]<<", got "<<it.GetKey()->GetValue()<<" at "<<index<<"\n";
+				status = PDFHummus::eFailure;
+			}
+			++index;
+		}
+		if(index != sizes[i])
+		{
+			cout<<"wrong iteration count in dictionary of size "<<sizes[i]<<", got "<<index<<"\n";
+			status = PDFHummus::eFailure;
+		}
+	}
+
+	// standard names share interned values, other names have their own
+	RefCountPtr<PDFName> aType(new PDFName("Type"));
+	RefCountPtr<PDFName> anotherType(new PDFName(std::string("/Type").c_str() + 1,4));
+	RefCountPtr<PDFName> aCustomName(new PDFName("MyCustomKey"));
+	RefCountPtr<PDFName> anotherCustomName(new PDFName("MyCustomKey"));
+	if(!aType->IsInterned() || &(aType->GetValue()) != &(anotherType->GetValue()) || !aType->Equals(anotherType.GetPtr()))
+	{
+		cout<<"standard name Type should be interned\n";
+		status = PDFHummus::eFailure;
+	}
+	if(aCustomName->IsInterned() || !aCustomName->Equals(anotherCustomName.GetPtr()) || aCustomName->Equals(aType.GetPtr()))
+	{
+		cout<<"wrong handling of non standard name\n";
+		status = PDFHummus::eFailure;
+	}
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(PDFDictionaryTest,"PDFEmbedding")
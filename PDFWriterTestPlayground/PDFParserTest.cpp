@@ -22,6 +22,7 @@
 #include "PDFParser.h"
 #include "InputFile.h"
 #include "PDFObject.h"
+#include "PDFName.h"
 #include "PDFDictionary.h"
 #include "PDFObjectCast.h"
 #include "PDFIndirectObjectReference.h"
@@ -31,8 +32,13 @@
 #include "OutputFile.h"
 #include "IByteWriterWithPosition.h"
 #include "PrimitiveObjectsWriter.h"
+#include "PDFWriter.h"
+#include "PDFDocumentCopyingContext.h"
+#include "PDFObjectArena.h"
+#include "IByteReader.h"
 
 #include <iostream>
+#include <map>
 
 using namespace std;
 using namespace PDFHummus;
@@ -103,15 +109,380 @@ EStatusCode PDFParserTest::Run(const TestConfiguration& inTestConfiguration)
 			break;
 		}
 
+		status = TestParsedObjectsCache(inTestConfiguration);
+		if(status != PDFHummus::eSuccess)
+			break;
+
+		status = TestObjectsArena(inTestConfiguration);
+		if(status != PDFHummus::eSuccess)
+			break;
+
+		status = TestObjectsArenaWithRetainedObject(inTestConfiguration);
+		if(status != PDFHummus::eSuccess)
+			break;
+
+		status = TestDecodedObjectStreamsCache(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PDFParserTest::TestParsedObjectsCache(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ObjectStreams.pdf"));
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"unable to open file for reading. should be in TestMaterials/ObjectStreams.pdf\n";
+			break;
+		}
+
+		options.ParsedObjectsCacheSize = 100;
+		status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"unable to parse input file with parsed objects cache";
+			break;
+		}
+
+		unsigned long hitsBefore = parser.GetParsedObjectsCacheHits();
+		RefCountPtr<PDFDictionary> firstParse(parser.ParsePage(0));
+		RefCountPtr<PDFDictionary> secondParse(parser.ParsePage(0));
+		if(!firstParse || firstParse.GetPtr() != secondParse.GetPtr())
+		{
+			cout<<"expected parsed objects cache to return the same page object for repeated parsing\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		if(parser.GetParsedObjectsCacheHits() <= hitsBefore)
+		{
+			cout<<"expected parsed objects cache hits count to increase on repeated parsing\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode PDFParserTest::TestDecodedObjectStreamsCache(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	map<ObjectIDType,ObjectIDType> objectStreamsFirstObjects;
+	ObjectIDTypeVector objectStreams;
+	IOBasicTypes::LongBufferSizeType objectStreamsSizes[3];
+	unsigned long decodingsCount;
+	string pdfFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ObjectStreams.pdf");
+
+	do
+	{
+		status = pdfFile.OpenFile(pdfFilePath);
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"unable to open file for reading. should be in TestMaterials/ObjectStreams.pdf\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"unable to parse ObjectStreams.pdf\n";
+			break;
+		}
+
+		// pick an object of each of the first 3 object streams, and get the object streams decoded sizes
+		for(ObjectIDType i = 0; i < parser.GetObjectsCount(); ++i)
+		{
+			XrefEntryInput* xrefEntry = parser.GetXrefEntry(i);
+			if(xrefEntry->mType == eXrefEntryStreamObject && objectStreamsFirstObjects.find((ObjectIDType)xrefEntry->mObjectPosition) == objectStreamsFirstObjects.end())
+			{
+				objectStreamsFirstObjects.insert(map<ObjectIDType,ObjectIDType>::value_type((ObjectIDType)xrefEntry->mObjectPosition,i));
+				objectStreams.push_back(i);
+			}
+		}
+		if(objectStreams.size() < 3)
+		{
+			cout<<"expected ObjectStreams.pdf to have at least 3 object streams, found "<<objectStreams.size()<<"\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		// starting to parse may already decode object streams [e.g. of the catalog], so find those and use them last
+		ObjectIDTypeVector decodedFirst;
+		ObjectIDTypeVector decodedLater;
+		for(size_t i = 0; i < 3; ++i)
+		{
+			unsigned long decodingsBefore = parser.GetObjectStreamsDecodingsCount();
+			RefCountPtr<PDFObject> anObject(parser.ParseNewObject(objectStreams[i]));
+			if(parser.GetObjectStreamsDecodingsCount() == decodingsBefore)
+				decodedFirst.push_back(objectStreams[i]);
+			else
+				decodedLater.push_back(objectStreams[i]);
+		}
+		if(decodedFirst.size() > 1)
+		{
+			cout<<"expected at most 1 object stream to be decoded when starting to parse, got "<<decodedFirst.size()<<"\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+		objectStreams = decodedLater;
+		objectStreams.insert(objectStreams.end(),decodedFirst.begin(),decodedFirst.end());
+
+		for(size_t i = 0; i < 3 && PDFHummus::eSuccess == status; ++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> objectStream(parser.ParseNewObject((ObjectIDType)parser.GetXrefEntry(objectStreams[i])->mObjectPosition));
+			IByteReader* reader = !objectStream ? NULL : parser.StartReadingFromStream(objectStream.GetPtr());
+			if(!reader)
+			{
+				cout<<"unable to read object stream "<<parser.GetXrefEntry(objectStreams[i])->mObjectPosition<<"\n";
+				status = PDFHummus::eFailure;
+				break;
+			}
+
+			IOBasicTypes::Byte buffer[1024];
+			objectStreamsSizes[i] = 0;
+			while(reader->NotEnded())
+			{
+				IOBasicTypes::LongBufferSizeType readBytes = reader->Read(buffer,sizeof(buffer));
+				if(0 == readBytes)
+					break;
+				objectStreamsSizes[i] += readBytes;
+			}
+			delete reader;
+		}
+		if(status != PDFHummus::eSuccess)
+			break;
+
+		// objects of streams A,B,C in this order: A, B, A, C, A, B. C may be decoded already when starting to parse
+		ObjectIDTypeVector objectIDs;
+		objectIDs.push_back(objectStreams[0]);
+		objectIDs.push_back(objectStreams[1]);
+		objectIDs.push_back(objectStreams[0]);
+		objectIDs.push_back(objectStreams[2]);
+		objectIDs.push_back(objectStreams[0]);
+		objectIDs.push_back(objectStreams[1]);
+
+		// with room for all, each stream is decoded once
+		status = CountObjectStreamsDecodings(pdfFilePath,DEFAULT_DECODED_OBJECT_STREAMS_CACHE_SIZE,objectIDs,decodingsCount);
+		if(status != PDFHummus::eSuccess)
+			break;
+		if(decodingsCount != 3 - decodedFirst.size())
+		{
+			cout<<"expected each object stream to be decoded once, got "<<decodingsCount<<" decodings for "<<3 - decodedFirst.size()<<" object streams not decoded yet\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		// with no cache, each object requires decoding its stream
+		status = CountObjectStreamsDecodings(pdfFilePath,0,objectIDs,decodingsCount);
+		if(status != PDFHummus::eSuccess)
+			break;
+		if(decodingsCount != objectIDs.size())
+		{
+			cout<<"expected no decoded object streams caching with 0 cache size, got "<<decodingsCount<<" decodings for "<<objectIDs.size()<<" objects\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		// with room for any 2 streams but not 3, C evicts the least recently used B [and not A, which is older but was used again].
+		// so A is still cached when parsed again, while B is decoded again. if C was decoded when starting to parse, B evicts it
+		// [as least recently used] and then C evicts B, so it's the same 4 decodings
+		IOBasicTypes::LongBufferSizeType smallestSize = std::min(objectStreamsSizes[0],std::min(objectStreamsSizes[1],objectStreamsSizes[2]));
+		status = CountObjectStreamsDecodings(pdfFilePath,objectStreamsSizes[0] + objectStreamsSizes[1] + objectStreamsSizes[2] - smallestSize,objectIDs,decodingsCount);
+		if(status != PDFHummus::eSuccess)
+			break;
+		if(decodingsCount != 4)
+		{
+			cout<<"expected least recently used object stream to be evicted, with 4 decodings, got "<<decodingsCount<<" decodings\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
 	}while(false);
 
 	return status;
 }
 
+EStatusCode PDFParserTest::CountObjectStreamsDecodings(const std::string& inPDFFilePath,
+														IOBasicTypes::LongBufferSizeType inCacheSize,
+														const ObjectIDTypeVector& inObjectIDs,
+														unsigned long& outDecodingsCount)
+{
+	InputFile pdfFile;
+	PDFParser parser;
+	PDFParsingOptions options;
+
+	options.DecodedObjectStreamsCacheSize = inCacheSize;
+	if(pdfFile.OpenFile(inPDFFilePath) != PDFHummus::eSuccess || parser.StartPDFParsing(pdfFile.GetInputStream(),options) != PDFHummus::eSuccess)
+	{
+		cout<<"unable to parse ObjectStreams.pdf with decoded object streams cache size "<<inCacheSize<<"\n";
+		return PDFHummus::eFailure;
+	}
+
+	unsigned long decodingsBefore = parser.GetObjectStreamsDecodingsCount();
+	for(size_t i = 0; i < inObjectIDs.size(); ++i)
+	{
+		RefCountPtr<PDFObject> anObject(parser.ParseNewObject(inObjectIDs[i]));
+		if(!anObject)
+		{
+			cout<<"unable to parse object "<<inObjectIDs[i]<<" from object stream\n";
+			return PDFHummus::eFailure;
+		}
+	}
+	outDecodingsCount = parser.GetObjectStreamsDecodingsCount() - decodingsBefore;
+	return PDFHummus::eSuccess;
+}
+
 static const char* scIndirectStart = "Indirect object reference:\r\n";
 static const char* scParsedAlready = "was parsed already\r\n";
 static const char* scIteratingStreamDict = "Stream . iterating stream dictionary:\r\n";
 
+EStatusCode PDFParserTest::TestObjectsArena(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status = PDFHummus::eSuccess;
+	RefCountPtr<PDFDictionary> escapingPage;
+
+	do
+	{
+		InputFile pdfFile;
+		PDFParser parser;
+		PDFParsingOptions options;
+
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/ObjectStreams.pdf"));
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"unable to open file for reading. should be in TestMaterials/ObjectStreams.pdf\n";
+			break;
+		}
+
+		options.AllocateObjectsFromArena = true;
+		status = parser.StartPDFParsing(pdfFile.GetInputStream(),options);
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"unable to parse input file with objects arena";
+			break;
+		}
+
+		for(unsigned long i=0; i < parser.GetPagesCount() && PDFHummus::eSuccess == status; ++i)
+		{
+			RefCountPtr<PDFDictionary> page(parser.ParsePage(i));
+			PDFObjectCastPtr<PDFDictionary> resources(!page ? NULL : parser.QueryDictionaryObject(page.GetPtr(),"Resources"));
+			if(!resources)
+			{
+				cout<<"expected page "<<i<<" with resources, when parsing with objects arena\n";
+				status = PDFHummus::eFailure;
+			}
+		}
+
+		// keep one page after the parser (and its arena) are gone
+		escapingPage = parser.ParsePage(0);
+	}while(false);
+
+	if(PDFHummus::eSuccess == status)
+	{
+		PDFObjectCastPtr<PDFName> type(!escapingPage ? NULL : escapingPage->QueryDirectObject("Type"));
+		if(!type || type->GetValue() != "Page")
+		{
+			cout<<"expected page parsed with objects arena to remain valid after the parser is destroyed\n";
+			status = PDFHummus::eFailure;
+		}
+	}
+
+	return status;
+}
+
+EStatusCode PDFParserTest::TestObjectsArenaWithRetainedObject(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+	PDFWriter pdfWriter;
+	PDFDocumentCopyingContext* copyingContext = NULL;
+	PDFParsingOptions options;
+	RefCountPtr<PDFDictionary> retainedPage;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ObjectsArenaRetainedObject.pdf"),ePDFVersion13);
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		options.AllocateObjectsFromArena = true;
+		copyingContext = pdfWriter.CreatePDFCopyingContext(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/XObjectContent.pdf"),options);
+		if(!copyingContext)
+		{
+			cout<<"failed to initialize copying context with objects arena, from XObjectContent.pdf\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		PDFParser* parser = copyingContext->GetSourceDocumentParser();
+		PDFObjectArena* arena = parser->GetObjectsArena();
+		if(!arena)
+		{
+			cout<<"expected copying context parser to allocate objects from an arena\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		// keep an object for the whole session, while copying pages over and over
+		retainedPage = parser->ParsePage(0);
+
+		for(int i=0; i < 500 && PDFHummus::eSuccess == status; ++i)
+		{
+			for(unsigned long j=0; j < parser->GetPagesCount() && PDFHummus::eSuccess == status; ++j)
+			{
+				EStatusCodeAndObjectIDType result = copyingContext->AppendPDFPageFromPDF(j);
+				if(result.first != PDFHummus::eSuccess)
+				{
+					cout<<"failed to append page "<<j<<" from XObjectContent.pdf\n";
+					status = result.first;
+				}
+			}
+		}
+		if(status != PDFHummus::eSuccess)
+			break;
+
+		// the retained object holds only the chunk it was allocated from, the rest are freed or reused
+		if(arena->GetChunksCount() > 2)
+		{
+			cout<<"expected objects arena to hold at most 2 chunks while an object is retained, holding "<<arena->GetChunksCount()<<"\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		PDFObjectCastPtr<PDFName> type(retainedPage->QueryDirectObject("Type"));
+		if(!type || type->GetValue() != "Page")
+		{
+			cout<<"expected retained page to remain valid while copying\n";
+			status = PDFHummus::eFailure;
+			break;
+		}
+
+		delete copyingContext;
+		copyingContext = NULL;
+
+		status = pdfWriter.EndPDF();
+		if(status != PDFHummus::eSuccess)
+		{
+			cout<<"failed in end PDF\n";
+			break;
+		}
+	}while(false);
+
+	delete copyingContext;
+	return status;
+}
+
 EStatusCode PDFParserTest::IterateObjectTypes(PDFObject* inObject,PDFParser& inParser,IByteWriter* inOutput)
 {
 	PrimitiveObjectsWriter primitivesWriter;
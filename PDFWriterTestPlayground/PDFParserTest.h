@@ -22,15 +22,19 @@
 
 #include "TestsRunner.h"
 #include "ObjectsBasicTypes.h"
+#include "IOBasicTypes.h"
 
 
 #include <set>
+#include <vector>
+#include <string>
 
 class PDFObject;
 class PDFParser;
 class IByteWriter;
 
 typedef set<ObjectIDType> ObjectIDTypeSet;
+typedef vector<ObjectIDType> ObjectIDTypeVector;
 
 class PDFParserTest : public ITestUnit
 {
@@ -43,6 +47,14 @@ public:
 private:
 
 	PDFHummus::EStatusCode IterateObjectTypes(PDFObject* inObject,PDFParser& inParser,IByteWriter* inOutput);
+	PDFHummus::EStatusCode TestParsedObjectsCache(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode TestObjectsArena(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode TestObjectsArenaWithRetainedObject(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode TestDecodedObjectStreamsCache(const TestConfiguration& inTestConfiguration);
+	PDFHummus::EStatusCode CountObjectStreamsDecodings(const std::string& inPDFFilePath,
+														IOBasicTypes::LongBufferSizeType inCacheSize,
+														const ObjectIDTypeVector& inObjectIDs,
+														unsigned long& outDecodingsCount);
 
 	int mTabLevel;
 	ObjectIDTypeSet mIteratedObjectIDs;
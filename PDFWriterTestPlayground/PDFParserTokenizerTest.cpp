@@ -0,0 +1,190 @@
+/*
+Source File : PDFParserTokenizerTest.cpp
+
+
+Copyright 2011 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#include "PDFParserTokenizerTest.h"
+#include "PDFParserTokenizer.h"
+#include "IByteReader.h"
+#include "InputByteArrayStream.h"
+#include "InputBufferedStream.h"
+
+#include <iostream>
+#include <sstream>
+#include <string.h>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+// reader with no direct buffer access, returning at most a few bytes per read
+class SmallReadsByteReader : public IByteReader
+{
+public:
+	SmallReadsByteReader(const string& inInput)
+		: mInput(inInput)
+		, mPos(0)
+	{}
+
+	virtual LongBufferSizeType Read(Byte* inBuffer,LongBufferSizeType inBufferSize)
+	{
+		size_t size = mInput.size() - mPos;
+		if(size > inBufferSize) size = inBufferSize;
+		if(size > 3) size = 3;
+		memcpy(inBuffer,mInput.data() + mPos,size);
+		mPos += size;
+		return size;
+	}
+
+	virtual bool NotEnded() {return mPos < mInput.size();}
+
+private:
+	string mInput;
+	size_t mPos;
+};
+
+PDFParserTokenizerTest::PDFParserTokenizerTest()
+{
+}
+
+PDFParserTokenizerTest::~PDFParserTokenizerTest()
+{
+}
+
+/*
+	Tokenizes the same input from a contiguous direct buffer [InputByteArrayStream], from direct buffers of all small sizes
+	[InputBufferedStream], so that each token straddles a buffer end at every possible point, and from a reader with no direct
+	buffer. Tokens and their positions should be the same.
+*/
+EStatusCode PDFParserTokenizerTest::Run(const TestConfiguration& /*inTestConfiguration*/)
+{
+	EStatusCode status = eSuccess;
+
+	// tokens, what separates them from the next one, and the token that the tokenizer returns when it's different from the input
+	// [whitespaces in hex strings, and escaped end of lines in literal strings, are dropped]
+	const char* tokensAndSeparators[][3] = {
+		{"%PDF-1.7","\r\n",NULL},
+		{"%a comment, with (string) <and> [delimiters]","\n",NULL},
+		{"1","",NULL},
+		{"%comment right after a number","\r",NULL},
+		{"0"," ",NULL},
+		{"obj","\n",NULL},
+		{"<<","",NULL},
+		{"/Type","",NULL},
+		{"/Catalog"," ",NULL},
+		{"/Kids","",NULL},
+		{"[","",NULL},
+		{"1"," ",NULL},
+		{"2.5"," ",NULL},
+		{"-3","",NULL},
+		{"]","",NULL},
+		{"/Hex","",NULL},
+		{"<48656C6C6F2C20776F726C6421204C6F6E67657220686578>","",NULL},
+		{"<a 1 B2\n c>"," ","<a1B2c>"},
+		{"/Literal","",NULL},
+		{"(literal with (nested (parentheses)) and escaped \\) \\( \\\\ chars)","",NULL},
+		{"(multi\r\nline\\\nstring)","","(multi\r\nlinestring)"},
+		{"()","",NULL},
+		{"<>","\t",NULL},
+		{"/Name#20With#20Spaces","\f",NULL},
+		{">>","\n",NULL},
+		{"{","",NULL},
+		{"add","",NULL},
+		{"}"," ",NULL},
+		{"endobj","\n",NULL},
+		{"%last comment, at the end","",NULL}
+	};
+	size_t tokensCount = sizeof(tokensAndSeparators) / sizeof(tokensAndSeparators[0]);
+
+	string input;
+	StringAndLongFilePositionTypeVector expected;
+	for(size_t repeat = 0; repeat < 3; ++repeat)
+	{
+		for(size_t i = 0; i < tokensCount; ++i)
+		{
+			expected.push_back(StringAndLongFilePositionType(tokensAndSeparators[i][2] ? tokensAndSeparators[i][2] : tokensAndSeparators[i][0],input.size()));
+			input.append(tokensAndSeparators[i][0]);
+			input.append(tokensAndSeparators[i][1]);
+		}
+		// separate the last comment from the next repeat
+		input.append("\n");
+	}
+	vector<Byte> inputBytes(input.begin(),input.end());
+
+	do
+	{
+		InputByteArrayStream contiguousStream(&(inputBytes[0]),inputBytes.size());
+		status = CompareTokens(expected,Tokenize(&contiguousStream),"contiguous buffer");
+		if(status != eSuccess)
+			break;
+
+		for(LongBufferSizeType bufferSize = 1; bufferSize <= 16 && eSuccess == status; ++bufferSize)
+		{
+			InputBufferedStream bufferedStream(new InputByteArrayStream(&(inputBytes[0]),inputBytes.size()),bufferSize);
+			stringstream description;
+			description<<"buffer of "<<bufferSize<<" bytes";
+			status = CompareTokens(expected,Tokenize(&bufferedStream),description.str());
+		}
+		if(status != eSuccess)
+			break;
+
+		SmallReadsByteReader smallReadsReader(input);
+		status = CompareTokens(expected,Tokenize(&smallReadsReader),"no direct buffer");
+	}while(false);
+
+	return status;
+}
+
+StringAndLongFilePositionTypeVector PDFParserTokenizerTest::Tokenize(IByteReader* inStream)
+{
+	PDFParserTokenizer tokenizer;
+	StringAndLongFilePositionTypeVector tokens;
+
+	tokenizer.SetReadStream(inStream);
+	for(;;)
+	{
+		BoolAndString token = tokenizer.GetNextToken();
+		if(!token.first)
+			break;
+		tokens.push_back(StringAndLongFilePositionType(token.second,tokenizer.GetRecentTokenPosition()));
+	}
+	return tokens;
+}
+
+EStatusCode PDFParserTokenizerTest::CompareTokens(const StringAndLongFilePositionTypeVector& inExpected,
+												const StringAndLongFilePositionTypeVector& inTokens,
+												const string& inReaderDescription)
+{
+	for(size_t i = 0; i < inExpected.size() && i < inTokens.size(); ++i)
+	{
+		if(inExpected[i] != inTokens[i])
+		{
+			cout<<"tokenizing with "<<inReaderDescription<<", expected token "<<inExpected[i].first<<" at "<<inExpected[i].second<<
+				", got "<<inTokens[i].first<<" at "<<inTokens[i].second<<"\n";
+			return eFailure;
+		}
+	}
+	if(inExpected.size() != inTokens.size())
+	{
+		cout<<"tokenizing with "<<inReaderDescription<<", expected "<<inExpected.size()<<" tokens, got "<<inTokens.size()<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(PDFParserTokenizerTest, "Parsing")
@@ -0,0 +1,46 @@
+/*
+Source File : PDFParserTokenizerTest.h
+
+
+Copyright 2011 Gal Kahana PDFWriter
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+*/
+#pragma once
+#include "TestsRunner.h"
+#include "IOBasicTypes.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+class IByteReader;
+
+typedef std::pair<std::string,IOBasicTypes::LongFilePositionType> StringAndLongFilePositionType;
+typedef std::vector<StringAndLongFilePositionType> StringAndLongFilePositionTypeVector;
+
+class PDFParserTokenizerTest : public ITestUnit
+{
+public:
+	PDFParserTokenizerTest();
+	virtual ~PDFParserTokenizerTest();
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	StringAndLongFilePositionTypeVector Tokenize(IByteReader* inStream);
+	PDFHummus::EStatusCode CompareTokens(const StringAndLongFilePositionTypeVector& inExpected,
+										const StringAndLongFilePositionTypeVector& inTokens,
+										const std::string& inReaderDescription);
+};
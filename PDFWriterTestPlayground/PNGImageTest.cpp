@@ -27,8 +27,16 @@
 #include "PDFPage.h"
 #include "PageContentContext.h"
 #include "PDFFormXObject.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "PDFName.h"
 
 #include <iostream>
+#include <string.h>
 
 using namespace std;
 using namespace PDFHummus;
@@ -104,6 +112,119 @@ EStatusCode RunImageTest(const TestConfiguration& inTestConfiguration, const str
 	return status;
 }
 
+typedef void (*PixelFunction)(int inX, int inY, IOBasicTypes::Byte* outPixel);
+
+static PDFObject* QueryFirstXObject(PDFParser& inParser, PDFDictionary* inResourcesOwner) {
+	PDFObjectCastPtr<PDFDictionary> resources(inParser.QueryDictionaryObject(inResourcesOwner, "Resources"));
+	PDFObjectCastPtr<PDFDictionary> xobjects(!resources ? NULL : inParser.QueryDictionaryObject(resources.GetPtr(), "XObject"));
+	if (!xobjects)
+		return NULL;
+	MapIterator<PDFNameToPDFObjectMap> it = xobjects->GetIterator();
+	return it.MoveNext() ? inParser.QueryDictionaryObject(xobjects.GetPtr(), it.GetKey()->GetValue()) : NULL;
+}
+
+static EStatusCode VerifyStreamPixels(PDFParser& inParser, PDFStreamInput* inStream, int inWidth, int inHeight, int inComponents, PixelFunction inPixelFunction) {
+	IByteReader* reader = inParser.StartReadingFromStream(inStream);
+	if (!reader) {
+		cout << "failed to start reading image stream\n";
+		return eFailure;
+	}
+
+	EStatusCode status = eSuccess;
+	IOBasicTypes::Byte pixel[3];
+	IOBasicTypes::Byte expected[3];
+	for (int y = 0; y < inHeight && eSuccess == status; ++y) {
+		for (int x = 0; x < inWidth && eSuccess == status; ++x) {
+			inPixelFunction(x, y, expected);
+			if (reader->Read(pixel, inComponents) != (IOBasicTypes::LongBufferSizeType)inComponents || memcmp(pixel, expected, inComponents) != 0) {
+				cout << "wrong pixel value at " << x << "," << y << "\n";
+				status = eFailure;
+			}
+		}
+	}
+	delete reader;
+	return status;
+}
+
+// verify that the image placed by RunImageTest holds the expected pixels, once decoded by the parser. optionally verify its soft mask as well
+EStatusCode VerifyImagePixels(const TestConfiguration& inTestConfiguration, const string& inImageName, int inWidth, int inHeight, int inComponents, PixelFunction inPixelFunction, PixelFunction inAlphaFunction = NULL) {
+	EStatusCode status = eSuccess;
+	PDFParser parser;
+	InputFile pdfFile;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase, "PNGTest_" + inImageName + ".pdf"));
+		if (status != eSuccess) {
+			cout << "failed to open PNGTest_" << inImageName << ".pdf\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if (status != eSuccess) {
+			cout << "failed to parse PNGTest_" << inImageName << ".pdf\n";
+			break;
+		}
+
+		RefCountPtr<PDFDictionary> page(parser.ParsePage(0));
+		PDFObjectCastPtr<PDFStreamInput> form(!page ? NULL : QueryFirstXObject(parser, page.GetPtr()));
+		RefCountPtr<PDFDictionary> formDictionary(!form ? NULL : form->QueryStreamDictionary());
+		PDFObjectCastPtr<PDFStreamInput> image(!formDictionary ? NULL : QueryFirstXObject(parser, formDictionary.GetPtr()));
+		if (!image) {
+			cout << "failed to find image object in PNGTest_" << inImageName << ".pdf\n";
+			status = eFailure;
+			break;
+		}
+
+		status = VerifyStreamPixels(parser, image.GetPtr(), inWidth, inHeight, inComponents, inPixelFunction);
+		if (status != eSuccess) {
+			cout << "wrong image data in PNGTest_" << inImageName << ".pdf\n";
+			break;
+		}
+
+		if (!inAlphaFunction)
+			break;
+
+		RefCountPtr<PDFDictionary> imageDictionary(image->QueryStreamDictionary());
+		PDFObjectCastPtr<PDFStreamInput> softMask(parser.QueryDictionaryObject(imageDictionary.GetPtr(), "SMask"));
+		if (!softMask) {
+			cout << "failed to find soft mask in PNGTest_" << inImageName << ".pdf\n";
+			status = eFailure;
+			break;
+		}
+
+		status = VerifyStreamPixels(parser, softMask.GetPtr(), inWidth, inHeight, 1, inAlphaFunction);
+		if (status != eSuccess) {
+			cout << "wrong soft mask data in PNGTest_" << inImageName << ".pdf\n";
+			break;
+		}
+	} while (false);
+
+	return status;
+}
+
+static void RGB8OpaquePixel(int inX, int inY, IOBasicTypes::Byte* outPixel) {
+	outPixel[0] = (IOBasicTypes::Byte)((inX * 3) % 256);
+	outPixel[1] = (IOBasicTypes::Byte)((inY * 5) % 256);
+	outPixel[2] = (IOBasicTypes::Byte)((inX + inY) % 256);
+}
+
+static void Palette8Pixel(int inX, int inY, IOBasicTypes::Byte* outPixel) {
+	outPixel[0] = (IOBasicTypes::Byte)((inX + inY) % 16);
+}
+
+static void RGBAlpha8Alpha(int inX, int inY, IOBasicTypes::Byte* outPixel) {
+	outPixel[0] = (IOBasicTypes::Byte)((inX * inY) % 256);
+}
+
+static void GrayAlpha8Pixel(int inX, int /*inY*/, IOBasicTypes::Byte* outPixel) {
+	outPixel[0] = (IOBasicTypes::Byte)((inX * 7) % 256);
+}
+
+static void GrayAlpha8Alpha(int inX, int inY, IOBasicTypes::Byte* outPixel) {
+	outPixel[0] = (IOBasicTypes::Byte)((inX + inY * 3) % 256);
+}
+
 EStatusCode PNGImageTest::Run(const TestConfiguration& inTestConfiguration)
 {
 	EStatusCode status;
@@ -136,6 +257,48 @@ EStatusCode PNGImageTest::Run(const TestConfiguration& inTestConfiguration)
 			cout << "failed in original.png test" << "\n";
 		}
 
+		// the following are passed through without decoding, verify that the image data is intact
+		status = RunImageTest(inTestConfiguration, "rgb-8-opaque");
+		if (status != eSuccess) {
+			cout << "failed in rgb-8-opaque.png test" << "\n";
+			break;
+		}
+
+		status = VerifyImagePixels(inTestConfiguration, "rgb-8-opaque", 301, 211, 3, RGB8OpaquePixel);
+		if (status != eSuccess)
+			break;
+
+		status = RunImageTest(inTestConfiguration, "palette-8");
+		if (status != eSuccess) {
+			cout << "failed in palette-8.png test" << "\n";
+			break;
+		}
+
+		status = VerifyImagePixels(inTestConfiguration, "palette-8", 301, 211, 1, Palette8Pixel);
+		if (status != eSuccess)
+			break;
+
+		// images with alpha are split to color image and soft mask, verify both
+		status = RunImageTest(inTestConfiguration, "rgb-alpha-8");
+		if (status != eSuccess) {
+			cout << "failed in rgb-alpha-8.png test" << "\n";
+			break;
+		}
+
+		status = VerifyImagePixels(inTestConfiguration, "rgb-alpha-8", 77, 45, 3, RGB8OpaquePixel, RGBAlpha8Alpha);
+		if (status != eSuccess)
+			break;
+
+		status = RunImageTest(inTestConfiguration, "gray-alpha-8");
+		if (status != eSuccess) {
+			cout << "failed in gray-alpha-8.png test" << "\n";
+			break;
+		}
+
+		status = VerifyImagePixels(inTestConfiguration, "gray-alpha-8", 77, 45, 1, GrayAlpha8Pixel, GrayAlpha8Alpha);
+		if (status != eSuccess)
+			break;
+
 	} while (false);
 	return status;
 }
@@ -0,0 +1,241 @@
+/*
+   Source File : ParallelCompressionTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+#include "ParallelCompressionTest.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFDictionary.h"
+#include "PDFArray.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "BoxingBase.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+ParallelCompressionTest::ParallelCompressionTest(void)
+{
+}
+
+ParallelCompressionTest::~ParallelCompressionTest(void)
+{
+}
+
+/*
+	Creates the same document with and without parallel compression, and compares the pages contents
+*/
+
+static const int scPagesCount = 40;
+
+EStatusCode ParallelCompressionTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateDocument(inTestConfiguration,"ParallelCompressionSerial.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = CreateDocument(inTestConfiguration,"ParallelCompression.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		StringList serialContents;
+		status = ReadPagesContents(inTestConfiguration,"ParallelCompressionSerial.pdf",serialContents);
+		if(status != eSuccess)
+			break;
+
+		StringList parallelContents;
+		status = ReadPagesContents(inTestConfiguration,"ParallelCompression.pdf",parallelContents);
+		if(status != eSuccess)
+			break;
+
+		if(serialContents.size() != scPagesCount || serialContents != parallelContents)
+		{
+			status = eFailure;
+			cout<<"pages contents of document written with parallel compression differ from the serially written one\n";
+			break;
+		}
+
+		// compressed streams should be the same, so same file size is expected too
+		InputFile serialFile;
+		InputFile parallelFile;
+		serialFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ParallelCompressionSerial.pdf"));
+		parallelFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"ParallelCompression.pdf"));
+		if(serialFile.GetFileSize() != parallelFile.GetFileSize())
+		{
+			status = eFailure;
+			cout<<"size of document written with parallel compression differs from the serially written one\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelCompressionTest::CreateDocument(const TestConfiguration& inTestConfiguration,const std::string& inFileName,bool inCompressStreamsInParallel)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		PDFCreationSettings creationSettings(true,true);
+		creationSettings.CompressStreamsInParallel = inCompressStreamsInParallel;
+
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13,
+									LogConfiguration::DefaultLogConfiguration(),creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF\n";
+			break;
+		}
+
+		PDFUsedFont* font = pdfWriter.GetFontForFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/fonts/arial.ttf"));
+		if(!font)
+		{
+			status = eFailure;
+			cout<<"failed to create font object\n";
+			break;
+		}
+
+		for(int i=0; i < scPagesCount && eSuccess == status; ++i)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+
+			// a path heavy part, a stream break, and then some text
+			contentContext->q();
+			contentContext->G(0.5);
+			contentContext->m(0,421);
+			for(int j=0; j < 2000; ++j)
+				contentContext->l(j * 0.2975,421 + 300 * ((j*(i+7)) % 101) / 101.0);
+			contentContext->S();
+			contentContext->Q();
+
+			status = pdfWriter.PausePageContentContext(contentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to pause page content context\n";
+				break;
+			}
+
+			AbstractContentContext::TextOptions textOptions(font,14,AbstractContentContext::eGray,0);
+			contentContext->WriteText(10,100,"Page number " + Int(i+1).ToString(),textOptions);
+
+			status = pdfWriter.EndPageContentContext(contentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end page content context\n";
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+			{
+				cout<<"failed to write page\n";
+				break;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelCompressionTest::ReadPagesContents(const TestConfiguration& inTestConfiguration,const std::string& inFileName,StringList& outPagesContents)
+{
+	PDFParser parser;
+	InputFile pdfFile;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName));
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<inFileName<<"\n";
+			break;
+		}
+
+		status = parser.StartPDFParsing(pdfFile.GetInputStream());
+		if(status != eSuccess)
+		{
+			cout<<"failed to parse "<<inFileName<<"\n";
+			break;
+		}
+
+		for(unsigned long i=0; i < parser.GetPagesCount() && eSuccess == status; ++i)
+		{
+			RefCountPtr<PDFDictionary> page(parser.ParsePage(i));
+			PDFObjectCastPtr<PDFArray> contents(parser.QueryDictionaryObject(page.GetPtr(),"Contents"));
+			if(!contents)
+			{
+				status = eFailure;
+				cout<<"expected contents array for page "<<i<<" of "<<inFileName<<"\n";
+				break;
+			}
+
+			std::string pageContent;
+			for(unsigned long j=0; j < contents->GetLength() && eSuccess == status; ++j)
+			{
+				PDFObjectCastPtr<PDFStreamInput> contentStream(parser.QueryArrayObject(contents.GetPtr(),j));
+				IByteReader* reader = !contentStream ? NULL : parser.StartReadingFromStream(contentStream.GetPtr());
+				if(!reader)
+				{
+					status = eFailure;
+					cout<<"failed to read content stream of page "<<i<<" of "<<inFileName<<"\n";
+					break;
+				}
+
+				Byte buffer[1024];
+				while(reader->NotEnded())
+				{
+					LongBufferSizeType readAmount = reader->Read(buffer,1024);
+					pageContent.append((const char*)buffer,readAmount);
+				}
+				delete reader;
+			}
+			outPagesContents.push_back(pageContent);
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ParallelCompressionTest,"PDF")
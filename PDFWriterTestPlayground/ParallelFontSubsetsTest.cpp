@@ -0,0 +1,231 @@
+/*
+   Source File : ParallelFontSubsetsTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ParallelFontSubsetsTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFPage.h"
+#include "PDFRectangle.h"
+#include "PageContentContext.h"
+#include "InputFile.h"
+#include "IByteReaderWithPosition.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+ParallelFontSubsetsTest::ParallelFontSubsetsTest(void)
+{
+}
+
+ParallelFontSubsetsTest::~ParallelFontSubsetsTest(void)
+{
+}
+
+/*
+	Creates the same document, using true type, CFF and type 1 fonts in both ANSI and CID representations, with and without
+	creating the fonts subsets in parallel, and compares the documents.
+*/
+
+struct FontAndTexts
+{
+	const char* mFontFileName;
+	const char* mMetricsFileName;
+	const char* mANSIText;
+	const char* mCIDText; // text out of WinAnsiEncoding, to have a CID representation. NULL for none
+};
+
+static const FontAndTexts scParallelFontSubsetsFonts[] = 
+{
+	{"arial.ttf",NULL,"Hello World","\xD7\xA9\xD7\x9C\xD7\x95\xD7\x9D"}, // hebrew
+	{"KozGoPro-Regular.otf",NULL,"abcd","\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E"}, // japanese
+	{"couri.ttf",NULL,"Hello World",NULL},
+	{"BrushScriptStd.otf",NULL,"Hello World",NULL},
+	{"HLB_____.PFB","HLB_____.PFM","Hello World",NULL},
+	{"texgyrepagella-math.otf",NULL,"Hello World",NULL},
+	{NULL,NULL,NULL,NULL}
+};
+
+EStatusCode ParallelFontSubsetsTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateDocument(inTestConfiguration,"ParallelFontSubsetsSerial.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = CreateDocument(inTestConfiguration,"ParallelFontSubsets.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		// the documents should be the same, except for the document ID in the trailer
+		string serialObjects;
+		status = ReadDocumentObjects(inTestConfiguration,"ParallelFontSubsetsSerial.pdf",serialObjects);
+		if(status != eSuccess)
+			break;
+
+		string parallelObjects;
+		status = ReadDocumentObjects(inTestConfiguration,"ParallelFontSubsets.pdf",parallelObjects);
+		if(status != eSuccess)
+			break;
+
+		if(serialObjects != parallelObjects)
+		{
+			status = eFailure;
+			cout<<"document written with parallel font subsetting differs from the serially written one\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelFontSubsetsTest::CreateDocument(const TestConfiguration& inTestConfiguration,const string& inFileName,bool inSubsetFontsInParallel)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+
+	do
+	{
+		PDFCreationSettings creationSettings(true,true);
+		creationSettings.SubsetFontsInParallel = inSubsetFontsInParallel;
+
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13,
+									LogConfiguration::DefaultLogConfiguration(),creationSettings);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inFileName<<"\n";
+			break;
+		}	
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* contentContext = pdfWriter.StartPageContentContext(page);
+		if(NULL == contentContext)
+		{
+			status = eFailure;
+			cout<<"failed to create content context for page\n";
+			delete page;
+			break;
+		}
+
+		for(int i=0;scParallelFontSubsetsFonts[i].mFontFileName && eSuccess == status;++i)
+		{
+			const FontAndTexts& fontAndTexts = scParallelFontSubsetsFonts[i];
+			string fontFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/fonts/") + fontAndTexts.mFontFileName);
+			PDFUsedFont* font = fontAndTexts.mMetricsFileName ?
+									pdfWriter.GetFontForFile(fontFilePath,
+															RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/fonts/") + fontAndTexts.mMetricsFileName)) :
+									pdfWriter.GetFontForFile(fontFilePath);
+			if(!font)
+			{
+				status = eFailure;
+				cout<<"failed to create font object for "<<fontAndTexts.mFontFileName<<"\n";
+				break;
+			}
+
+			contentContext->BT();
+			contentContext->k(0,0,0,1);
+			contentContext->Tf(font,1);
+			contentContext->Tm(30,0,0,30,78.4252,762.8997 - i*100);
+			status = contentContext->Tj(fontAndTexts.mANSIText);
+			if(eSuccess == status && fontAndTexts.mCIDText)
+			{
+				contentContext->Tm(30,0,0,30,78.4252,712.8997 - i*100);
+				status = contentContext->Tj(fontAndTexts.mCIDText);
+			}
+			if(status != eSuccess)
+				cout<<"failed to write text with "<<fontAndTexts.mFontFileName<<"\n";
+			contentContext->ET();
+		}
+		if(status != eSuccess)
+		{
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.EndPageContentContext(contentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inFileName<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelFontSubsetsTest::ReadDocumentObjects(const TestConfiguration& inTestConfiguration,const string& inFileName,string& outObjects)
+{
+	InputFile pdfFile;
+	EStatusCode status;
+
+	do
+	{
+		status = pdfFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName));
+		if(status != eSuccess)
+		{
+			cout<<"failed to open "<<inFileName<<"\n";
+			break;
+		}
+
+		Byte buffer[1024];
+		string content;
+		while(pdfFile.GetInputStream()->NotEnded())
+		{
+			LongBufferSizeType readAmount = pdfFile.GetInputStream()->Read(buffer,1024);
+			content.append((const char*)buffer,readAmount);
+		}
+
+		// take everything up to the cross reference table. this covers all objects, and their positions
+		string::size_type xrefPosition = content.rfind("\nxref");
+		if(string::npos == xrefPosition)
+		{
+			status = eFailure;
+			cout<<"no cross reference table found in "<<inFileName<<"\n";
+			break;
+		}
+		outObjects = content.substr(0,xrefPosition);
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(ParallelFontSubsetsTest,"Text")
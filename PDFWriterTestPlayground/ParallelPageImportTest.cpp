@@ -0,0 +1,211 @@
+/*
+   Source File : ParallelPageImportTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "ParallelPageImportTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFDocumentCopyingContext.h"
+#include "PDFParser.h"
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace PDFHummus;
+
+ParallelPageImportTest::ParallelPageImportTest(void)
+{
+}
+
+ParallelPageImportTest::~ParallelPageImportTest(void)
+{
+}
+
+EStatusCode ParallelPageImportTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CompareImports(inTestConfiguration,"Original.pdf","");
+		if(status != eSuccess)
+			break;
+
+		// objects in object streams
+		status = CompareImports(inTestConfiguration,"ObjectStreams.pdf","");
+		if(status != eSuccess)
+			break;
+
+		// encrypted source, decrypted by each of the workers parsers
+		status = CompareImports(inTestConfiguration,"PDFWithPassword.pdf","user");
+		if(status != eSuccess)
+			break;
+
+		status = CompareImports(inTestConfiguration,"china.pdf","");
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelPageImportTest::CompareImports(const TestConfiguration& inTestConfiguration,const string& inSourceFileName,const string& inPassword)
+{
+	EStatusCode status = eSuccess;
+
+	// parallel import should write the very same objects, in the same order, as serial import.
+	// compare both through AppendPDFPagesFromPDF and through a copying context
+	for(int useCopyingContext = 0; useCopyingContext < 2 && eSuccess == status; ++useCopyingContext)
+	{
+		string baseName = string("ParallelPageImportTest_") + (useCopyingContext ? "CopyingContext_":"") + inSourceFileName;
+		string serialFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,baseName + "_Serial.pdf");
+		string parallelFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,baseName + "_Parallel.pdf");
+		ObjectIDTypeList serialPageIDs;
+		ObjectIDTypeList parallelPageIDs;
+
+		status = AppendPages(inTestConfiguration,inSourceFileName,inPassword,false,useCopyingContext != 0,serialFilePath,serialPageIDs);
+		if(status != eSuccess)
+			break;
+
+		status = AppendPages(inTestConfiguration,inSourceFileName,inPassword,true,useCopyingContext != 0,parallelFilePath,parallelPageIDs);
+		if(status != eSuccess)
+			break;
+
+		if(serialPageIDs != parallelPageIDs)
+		{
+			cout<<"pages imported in parallel from "<<inSourceFileName<<" got different object IDs than when imported serially\n";
+			status = eFailure;
+			break;
+		}
+
+		status = CompareResultFiles(serialFilePath,parallelFilePath);
+	}
+
+	return status;
+}
+
+EStatusCode ParallelPageImportTest::AppendPages(const TestConfiguration& inTestConfiguration,
+												const string& inSourceFileName,
+												const string& inPassword,
+												bool inImportPagesInParallel,
+												bool inUseCopyingContext,
+												const string& inResultFilePath,
+												ObjectIDTypeList& outPageIDs)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	string sourceFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/") + inSourceFileName);
+	PDFParsingOptions parsingOptions(inPassword);
+
+	parsingOptions.ImportPagesInParallel = inImportPagesInParallel;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inResultFilePath,ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inResultFilePath<<"\n";
+			break;
+		}
+
+		if(inUseCopyingContext)
+		{
+			PDFDocumentCopyingContext* copyingContext = pdfWriter.CreatePDFCopyingContext(sourceFilePath,parsingOptions);
+			if(!copyingContext)
+			{
+				cout<<"failed to create copying context for "<<inSourceFileName<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			// pages in reverse, and the first page again, to have some of the resources copied already
+			unsigned long pagesCount = copyingContext->GetSourceDocumentParser()->GetPagesCount();
+			PDFPageRange pageRange;
+			pageRange.mType = PDFPageRange::eRangeTypeSpecific;
+			for(unsigned long i = pagesCount; i > 0; --i)
+				pageRange.mSpecificRanges.push_back(ULongAndULong(i-1,i-1));
+			pageRange.mSpecificRanges.push_back(ULongAndULong(0,pagesCount-1));
+
+			EStatusCodeAndObjectIDTypeList result = copyingContext->AppendPDFPagesFromPDF(pageRange);
+			unsigned long prefetchedObjectsUsedCount = copyingContext->GetPrefetchedObjectsUsedCount();
+			delete copyingContext;
+			if(result.first != eSuccess)
+			{
+				cout<<"failed to append pages from "<<inSourceFileName<<" with copying context\n";
+				status = result.first;
+				break;
+			}
+			outPageIDs = result.second;
+
+			// same output alone would also be had if the import fell back to serial, so make sure that the copying used objects read by the workers
+			if(inImportPagesInParallel != (prefetchedObjectsUsedCount > 0))
+			{
+				cout<<"copying from "<<inSourceFileName<<" used "<<prefetchedObjectsUsedCount<<" prefetched objects, while importing "<<(inImportPagesInParallel ? "in parallel":"serially")<<"\n";
+				status = eFailure;
+				break;
+			}
+		}
+		else
+		{
+			EStatusCodeAndObjectIDTypeList result = pdfWriter.AppendPDFPagesFromPDF(sourceFilePath,PDFPageRange(),ObjectIDTypeList(),parsingOptions);
+			if(result.first != eSuccess)
+			{
+				cout<<"failed to append pages from "<<inSourceFileName<<"\n";
+				status = result.first;
+				break;
+			}
+			outPageIDs = result.second;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inResultFilePath<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode ParallelPageImportTest::CompareResultFiles(const string& inFirstFilePath,const string& inSecondFilePath)
+{
+	ifstream firstFile(inFirstFilePath.c_str(),ios::binary);
+	ifstream secondFile(inSecondFilePath.c_str(),ios::binary);
+	vector<char> firstData((istreambuf_iterator<char>(firstFile)),istreambuf_iterator<char>());
+	vector<char> secondData((istreambuf_iterator<char>(secondFile)),istreambuf_iterator<char>());
+
+	// the trailer ID is computed from the file path, so compare everything up to the trailer
+	string trailerKeyword = "trailer";
+	vector<char>::iterator firstTrailer = find_end(firstData.begin(),firstData.end(),trailerKeyword.begin(),trailerKeyword.end());
+	vector<char>::iterator secondTrailer = find_end(secondData.begin(),secondData.end(),trailerKeyword.begin(),trailerKeyword.end());
+
+	if(firstData.size() == 0 || 
+		firstTrailer - firstData.begin() != secondTrailer - secondData.begin() ||
+		!equal(firstData.begin(),firstTrailer,secondData.begin()))
+	{
+		cout<<"parallel import result "<<inSecondFilePath<<" differs from serial import result "<<inFirstFilePath<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+ADD_CATEGORIZED_TEST(ParallelPageImportTest,"PDFEmbedding")
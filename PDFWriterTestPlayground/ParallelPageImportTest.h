@@ -0,0 +1,46 @@
+/*
+   Source File : ParallelPageImportTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#include "ITestUnit.h"
+#include "PDFEmbedParameterTypes.h"
+
+#include <string>
+
+class ParallelPageImportTest : public ITestUnit
+{
+public:
+	ParallelPageImportTest(void);
+	virtual ~ParallelPageImportTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode CompareImports(const TestConfiguration& inTestConfiguration,const std::string& inSourceFileName,const std::string& inPassword);
+	PDFHummus::EStatusCode AppendPages(const TestConfiguration& inTestConfiguration,
+										const std::string& inSourceFileName,
+										const std::string& inPassword,
+										bool inImportPagesInParallel,
+										bool inUseCopyingContext,
+										const std::string& inResultFilePath,
+										ObjectIDTypeList& outPageIDs);
+	PDFHummus::EStatusCode CompareResultFiles(const std::string& inFirstFilePath,const std::string& inSecondFilePath);
+};
@@ -0,0 +1,221 @@
+/*
+   Source File : PredictorStreamsTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#include "PredictorStreamsTest.h"
+#include "TestsRunner.h"
+#include "InputPredictorPNGOptimumStream.h"
+#include "InputPredictorTIFFSubStream.h"
+#include "InputByteArrayStream.h"
+
+#include <iostream>
+#include <stdlib.h>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+PredictorStreamsTest::PredictorStreamsTest(void)
+{
+}
+
+PredictorStreamsTest::~PredictorStreamsTest(void)
+{
+}
+
+static const LongBufferSizeType scRowsCount = 23;
+
+/*
+	Encodes images with the PNG filters (all of them, changing per row) and the TIFF predictor, for various pixel formats and widths,
+	and checks that the predictor streams decode them back to the original image, reading in different sizes.
+*/
+EStatusCode PredictorStreamsTest::Run(const TestConfiguration& /*inTestConfiguration*/)
+{
+	EStatusCode status = eSuccess;
+	// colors and bits per component
+	const LongBufferSizeType formats[][2] = {{1,1},{1,2},{1,4},{1,8},{2,8},{3,8},{4,8},{5,8},{1,16},{3,16},{4,16},{3,4},{3,2}};
+	const LongBufferSizeType columns[] = {1,2,5,16,33,100};
+	const size_t readSizes[] = {1,7,4096};
+
+	for(size_t i=0; i < sizeof(formats)/sizeof(formats[0]) && eSuccess == status; ++i)
+		for(size_t j=0; j < sizeof(columns)/sizeof(LongBufferSizeType) && eSuccess == status; ++j)
+			for(size_t k=0; k < sizeof(readSizes)/sizeof(size_t) && eSuccess == status; ++k)
+			{
+				status = CheckPNGPredictor(formats[i][0],(Byte)formats[i][1],columns[j],readSizes[k]);
+				if(eSuccess == status)
+					status = CheckTIFFPredictor(formats[i][0],(Byte)formats[i][1],columns[j],readSizes[k]);
+			}
+
+	return status;
+}
+
+static string CreateImage(LongBufferSizeType inRowSize,LongBufferSizeType inSeed)
+{
+	string image;
+	unsigned long value = (unsigned long)inSeed*2654435761UL + 1;
+
+	for(LongBufferSizeType i=0; i < inRowSize*scRowsCount; ++i)
+	{
+		// mix of smooth and noisy rows, so the predictors see both small and large differences
+		value = value*1103515245UL + 12345;
+		if((i / inRowSize) % 3 == 0)
+			image.push_back((char)((i % inRowSize) * 3 + (value>>16) % 4));
+		else
+			image.push_back((char)((value>>16) & 0xff));
+	}
+	return image;
+}
+
+static Byte ReferencePaeth(int inLeft,int inUp,int inUpLeft)
+{
+	int p = inLeft + inUp - inUpLeft;
+	int pLeft = abs(p - inLeft);
+	int pUp = abs(p - inUp);
+	int pUpLeft = abs(p - inUpLeft);
+
+	if(pLeft <= pUp && pLeft <= pUpLeft)
+		return (Byte)inLeft;
+	else if(pUp <= pUpLeft)
+		return (Byte)inUp;
+	else
+		return (Byte)inUpLeft;
+}
+
+EStatusCode PredictorStreamsTest::CheckPNGPredictor(LongBufferSizeType inColors,Byte inBitsPerComponent,LongBufferSizeType inColumns,size_t inReadSize)
+{
+	LongBufferSizeType rowSize = (inColumns*inColors*inBitsPerComponent + 7)/8;
+	LongBufferSizeType bytesPerPixel = inColors*inBitsPerComponent/8 > 0 ? inColors*inBitsPerComponent/8 : 1;
+	string image = CreateImage(rowSize,inColors*inBitsPerComponent + inColumns);
+	string encoded;
+
+	for(LongBufferSizeType row=0; row < scRowsCount; ++row)
+	{
+		// all filters, including an unknown one that should be read as none
+		Byte filter = (Byte)(row % 6);
+		encoded.push_back((char)filter);
+		for(LongBufferSizeType i=0; i < rowSize; ++i)
+		{
+			int value = (Byte)image[row*rowSize + i];
+			int left = i >= bytesPerPixel ? (Byte)image[row*rowSize + i - bytesPerPixel] : 0;
+			int up = row > 0 ? (Byte)image[(row-1)*rowSize + i] : 0;
+			int upLeft = row > 0 && i >= bytesPerPixel ? (Byte)image[(row-1)*rowSize + i - bytesPerPixel] : 0;
+			int predictor = 0;
+
+			switch(filter)
+			{
+				case 1:
+					predictor = left;
+					break;
+				case 2:
+					predictor = up;
+					break;
+				case 3:
+					predictor = (left + up) / 2;
+					break;
+				case 4:
+					predictor = ReferencePaeth(left,up,upLeft);
+					break;
+			}
+			encoded.push_back((char)(value - predictor));
+		}
+	}
+
+	InputPredictorPNGOptimumStream predictorStream(new InputByteArrayStream((Byte*)encoded.c_str(),encoded.size()),inColors,inBitsPerComponent,inColumns);
+	string decoded = ReadAll(&predictorStream,inReadSize);
+	if(decoded != image)
+	{
+		cout<<"PNG predictor decoding failed for "<<inColors<<" colors, "<<(int)inBitsPerComponent<<" bits per component, "<<inColumns<<" columns, read size "<<inReadSize<<
+			", got "<<decoded.size()<<" bytes of "<<image.size()<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+EStatusCode PredictorStreamsTest::CheckTIFFPredictor(LongBufferSizeType inColors,Byte inBitsPerComponent,LongBufferSizeType inColumns,size_t inReadSize)
+{
+	LongBufferSizeType rowSize = (inColumns*inColors*inBitsPerComponent + 7)/8;
+	string image = CreateImage(rowSize,inColors*inBitsPerComponent*inColumns);
+	string encoded;
+	LongBufferSizeType componentsCount = inColumns*inColors;
+	unsigned long mask = (1UL<<inBitsPerComponent) - 1;
+
+	for(LongBufferSizeType row=0; row < scRowsCount; ++row)
+	{
+		const Byte* rowData = (const Byte*)image.c_str() + row*rowSize;
+		string encodedRow(rowSize,(char)0);
+
+		// components are packed from the high bits, and the trailing padding bits are 0
+		for(LongBufferSizeType i=0; i < componentsCount; ++i)
+		{
+			unsigned long value = 0;
+			unsigned long left = 0;
+			for(Byte bit=0; bit < inBitsPerComponent; ++bit)
+			{
+				LongBufferSizeType offset = i*inBitsPerComponent + bit;
+				value = (value<<1) | ((rowData[offset/8]>>(7 - offset%8)) & 1);
+				if(i >= inColors)
+				{
+					offset -= inColors*inBitsPerComponent;
+					left = (left<<1) | ((rowData[offset/8]>>(7 - offset%8)) & 1);
+				}
+			}
+			unsigned long difference = (value - left) & mask;
+			for(Byte bit=0; bit < inBitsPerComponent; ++bit)
+			{
+				LongBufferSizeType offset = i*inBitsPerComponent + bit;
+				if((difference>>(inBitsPerComponent - 1 - bit)) & 1)
+					encodedRow[offset/8] = (char)(encodedRow[offset/8] | (1<<(7 - offset%8)));
+			}
+		}
+		encoded.append(encodedRow);
+
+		// padding bits are 0 in the encoded row, and so in the decoded row
+		LongBufferSizeType paddingBits = rowSize*8 - componentsCount*inBitsPerComponent;
+		if(paddingBits > 0)
+			image[row*rowSize + rowSize - 1] = (char)(image[row*rowSize + rowSize - 1] & (0xff << paddingBits));
+	}
+
+	InputPredictorTIFFSubStream predictorStream(new InputByteArrayStream((Byte*)encoded.c_str(),encoded.size()),inColors,inBitsPerComponent,inColumns);
+	string decoded = ReadAll(&predictorStream,inReadSize);
+	if(decoded != image)
+	{
+		cout<<"TIFF predictor decoding failed for "<<inColors<<" colors, "<<(int)inBitsPerComponent<<" bits per component, "<<inColumns<<" columns, read size "<<inReadSize<<
+			", got "<<decoded.size()<<" bytes of "<<image.size()<<"\n";
+		return eFailure;
+	}
+	return eSuccess;
+}
+
+string PredictorStreamsTest::ReadAll(IByteReader* inStream,size_t inReadSize)
+{
+	string result;
+	Byte* buffer = new Byte[inReadSize];
+
+	while(inStream->NotEnded())
+	{
+		LongBufferSizeType readAmount = inStream->Read(buffer,inReadSize);
+		if(0 == readAmount)
+			break;
+		result.append((const char*)buffer,readAmount);
+	}
+	delete[] buffer;
+	return result;
+}
+
+ADD_CATEGORIZED_TEST(PredictorStreamsTest,"IO")
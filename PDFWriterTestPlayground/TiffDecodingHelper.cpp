@@ -0,0 +1,205 @@
+/*
+   Source File : TiffDecodingHelper.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+#include "TiffDecodingHelper.h"
+
+#include <tiffio.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+static EStatusCode WriteScratchTIFF(const string& inEncodedData,const TiffDecodingParameters& inParameters,const string& inScratchFilePath)
+{
+	EStatusCode status = eSuccess;
+	TIFF* output = TIFFOpen(inScratchFilePath.c_str(),"w");
+	if(!output)
+	{
+		cout<<"failed to create scratch tiff "<<inScratchFilePath<<"\n";
+		return eFailure;
+	}
+
+	do
+	{
+		bool isCCITT = inParameters.Filter == "CCITTFaxDecode";
+
+		TIFFSetField(output,TIFFTAG_IMAGEWIDTH,(uint32)inParameters.Columns);
+		TIFFSetField(output,TIFFTAG_IMAGELENGTH,(uint32)inParameters.Rows);
+		TIFFSetField(output,TIFFTAG_ROWSPERSTRIP,(uint32)inParameters.Rows);
+		TIFFSetField(output,TIFFTAG_BITSPERSAMPLE,(uint16)(isCCITT ? 1:inParameters.BitsPerComponent));
+		TIFFSetField(output,TIFFTAG_SAMPLESPERPIXEL,(uint16)(isCCITT ? 1:inParameters.Colors));
+		TIFFSetField(output,TIFFTAG_PLANARCONFIG,PLANARCONFIG_CONTIG);
+		TIFFSetField(output,TIFFTAG_FILLORDER,FILLORDER_MSB2LSB);
+
+		if(isCCITT)
+		{
+			TIFFSetField(output,TIFFTAG_PHOTOMETRIC,PHOTOMETRIC_MINISWHITE);
+			if(inParameters.K < 0)
+			{
+				TIFFSetField(output,TIFFTAG_COMPRESSION,COMPRESSION_CCITTFAX4);
+			}
+			else if(inParameters.EndOfLine)
+			{
+				TIFFSetField(output,TIFFTAG_COMPRESSION,COMPRESSION_CCITTFAX3);
+				TIFFSetField(output,TIFFTAG_GROUP3OPTIONS,
+					(uint32)((inParameters.K > 0 ? GROUP3OPT_2DENCODING:0) | (inParameters.EncodedByteAlign ? GROUP3OPT_FILLBITS:0)));
+			}
+			else if(0 == inParameters.K)
+			{
+				// rows with no EOLs are modified huffman
+				TIFFSetField(output,TIFFTAG_COMPRESSION,COMPRESSION_CCITTRLE);
+			}
+			else
+			{
+				cout<<"2D G3 data without EOLs can't be decoded with libtiff\n";
+				status = eFailure;
+				break;
+			}
+		}
+		else if(inParameters.Filter == "LZWDecode")
+		{
+			TIFFSetField(output,TIFFTAG_PHOTOMETRIC,inParameters.Colors == 1 ? PHOTOMETRIC_MINISBLACK:PHOTOMETRIC_RGB);
+			TIFFSetField(output,TIFFTAG_COMPRESSION,COMPRESSION_LZW);
+			if(2 == inParameters.Predictor)
+			{
+				TIFFSetField(output,TIFFTAG_PREDICTOR,PREDICTOR_HORIZONTAL);
+			}
+			else if(inParameters.Predictor != 1)
+			{
+				cout<<"unsupported LZW predictor "<<inParameters.Predictor<<"\n";
+				status = eFailure;
+				break;
+			}
+		}
+		else
+		{
+			cout<<"unsupported filter "<<inParameters.Filter<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(TIFFWriteRawStrip(output,0,(tdata_t)inEncodedData.c_str(),(tsize_t)inEncodedData.size()) == -1)
+		{
+			cout<<"failed to write scratch tiff data\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	TIFFClose(output);
+	return status;
+}
+
+EStatusCode DecodeImageDataWithLibTiff(const string& inEncodedData,
+									   const TiffDecodingParameters& inParameters,
+									   const string& inScratchFilePath,
+									   string& outSamples)
+{
+	EStatusCode status = WriteScratchTIFF(inEncodedData,inParameters,inScratchFilePath);
+	if(status != eSuccess)
+		return status;
+
+	TIFF* input = TIFFOpen(inScratchFilePath.c_str(),"r");
+	if(!input)
+	{
+		cout<<"failed to open scratch tiff "<<inScratchFilePath<<"\n";
+		return eFailure;
+	}
+
+	do
+	{
+		// the fax mode is not stored in the file. set the rows alignment of the PDF data
+		if(inParameters.Filter == "CCITTFaxDecode")
+		{
+			if(inParameters.K < 0)
+				TIFFSetField(input,TIFFTAG_FAXMODE,inParameters.EncodedByteAlign ? FAXMODE_BYTEALIGN:FAXMODE_CLASSIC);
+			else if(!inParameters.EndOfLine)
+				TIFFSetField(input,TIFFTAG_FAXMODE,FAXMODE_NORTC | FAXMODE_NOEOL | (inParameters.EncodedByteAlign ? FAXMODE_BYTEALIGN:0));
+		}
+
+		tsize_t stripSize = TIFFStripSize(input);
+		outSamples.assign((size_t)stripSize,'\0');
+		if(TIFFReadEncodedStrip(input,0,(tdata_t)&outSamples[0],stripSize) != stripSize)
+		{
+			cout<<"failed to decode "<<inParameters.Filter<<" data with libtiff\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	TIFFClose(input);
+	return status;
+}
+
+EStatusCode ReadTIFFPageSamples(const string& inTIFFFilePath,
+								unsigned int inPageIndex,
+								string& outSamples,
+								unsigned long& outWidth,
+								unsigned long& outLength,
+								bool& outMinIsWhite)
+{
+	EStatusCode status = eSuccess;
+	TIFF* input = TIFFOpen(inTIFFFilePath.c_str(),"r");
+	if(!input)
+	{
+		cout<<"failed to open "<<inTIFFFilePath<<"\n";
+		return eFailure;
+	}
+
+	do
+	{
+		if(!TIFFSetDirectory(input,(tdir_t)inPageIndex) || TIFFIsTiled(input))
+		{
+			cout<<"can't read page "<<inPageIndex<<" of "<<inTIFFFilePath<<" by rows\n";
+			status = eFailure;
+			break;
+		}
+
+		uint32 width = 0;
+		uint32 length = 0;
+		uint16 photometric = PHOTOMETRIC_MINISWHITE;
+		TIFFGetField(input,TIFFTAG_IMAGEWIDTH,&width);
+		TIFFGetField(input,TIFFTAG_IMAGELENGTH,&length);
+		TIFFGetFieldDefaulted(input,TIFFTAG_PHOTOMETRIC,&photometric);
+		outWidth = width;
+		outLength = length;
+		outMinIsWhite = PHOTOMETRIC_MINISWHITE == photometric;
+
+		tsize_t rowSize = TIFFScanlineSize(input);
+		outSamples.assign((size_t)(rowSize * length),'\0');
+		for(uint32 row = 0; row < length && eSuccess == status; ++row)
+		{
+			if(TIFFReadScanline(input,(tdata_t)&outSamples[(size_t)(rowSize * row)],row,0) == -1)
+			{
+				cout<<"failed to read row "<<row<<" of "<<inTIFFFilePath<<"\n";
+				status = eFailure;
+			}
+		}
+	}while(false);
+
+	TIFFClose(input);
+	return status;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+   Source File : TiffDecodingHelper.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+/*
+	Decoding image data with libtiff, for tests that compare images written to PDF with their TIFF source.
+	Kept in its own file, and without libtiff types in the interface, as tiffio.h and the library TIFFImageHandler.h
+	may define some of the tiff types differently.
+*/
+
+#include "EStatusCode.h"
+
+#include <string>
+
+// parameters of PDF image data encoded with CCITTFaxDecode or LZWDecode, the filters that libtiff can decode
+struct TiffDecodingParameters
+{
+	std::string Filter;
+	unsigned long Columns;
+	unsigned long Rows;
+	unsigned short Colors;
+	unsigned short BitsPerComponent;
+	// CCITTFaxDecode parameters
+	long long K;
+	bool EncodedByteAlign;
+	bool EndOfLine;
+	// LZWDecode parameters
+	long long Predictor;
+
+	TiffDecodingParameters() {Columns = 0; Rows = 0; Colors = 1; BitsPerComponent = 1; K = 0; EncodedByteAlign = false; EndOfLine = false; Predictor = 1;}
+};
+
+// decode PDF image data, by writing it as the single strip of a scratch tiff file and reading it back.
+// each row starts on a byte boundary. for CCITT data, 1 bits are black runs.
+PDFHummus::EStatusCode DecodeImageDataWithLibTiff(const std::string& inEncodedData,
+												  const TiffDecodingParameters& inParameters,
+												  const std::string& inScratchFilePath,
+												  std::string& outSamples);
+
+// read the decoded samples of a tiff page. each row starts on a byte boundary.
+// outMinIsWhite is true when 0 samples are white
+PDFHummus::EStatusCode ReadTIFFPageSamples(const std::string& inTIFFFilePath,
+										   unsigned int inPageIndex,
+										   std::string& outSamples,
+										   unsigned long& outWidth,
+										   unsigned long& outLength,
+										   bool& outMinIsWhite);
+
+#endif
@@ -0,0 +1,402 @@
+/*
+   Source File : TiffParallelPagesTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+#include "TiffParallelPagesTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFFormXObject.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "OutputFile.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+TiffParallelPagesTest::TiffParallelPagesTest(void)
+{
+}
+
+TiffParallelPagesTest::~TiffParallelPagesTest(void)
+{
+}
+
+EStatusCode TiffParallelPagesTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		status = CreateDocument(inTestConfiguration,"TiffParallelPagesTestSerial.pdf",false);
+		if(status != eSuccess)
+			break;
+
+		status = CreateDocument(inTestConfiguration,"TiffParallelPagesTestParallel.pdf",true);
+		if(status != eSuccess)
+			break;
+
+		// pages converted in parallel should be written exactly like pages converted one by one
+		status = CompareDocumentsStreams(inTestConfiguration,"TiffParallelPagesTestSerial.pdf","TiffParallelPagesTestParallel.pdf");
+		if(status != eSuccess)
+			break;
+
+		status = TestCorruptPage(inTestConfiguration);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TiffParallelPagesTest::CreateDocument(const TestConfiguration& inTestConfiguration,const string& inFileName,bool inParallel)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	PDFFormXObjectVector forms;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inFileName<<"\n";
+			break;
+		}	
+
+		// multipage tiff, out of order and with a repeated page
+		UIntVector multipagePages;
+		multipagePages.push_back(3);
+		multipagePages.push_back(1);
+		multipagePages.push_back(0);
+		multipagePages.push_back(2);
+		multipagePages.push_back(1);
+		status = CreateForms(inTestConfiguration,pdfWriter,"multipage.tif",multipagePages,inParallel,forms);
+		if(status != eSuccess)
+			break;
+
+		// tiled image
+		status = CreateForms(inTestConfiguration,pdfWriter,"cramps-tile.tif",UIntVector(1,0),inParallel,forms);
+		if(status != eSuccess)
+			break;
+
+		if(inParallel)
+		{
+			// a missing page should fail the whole call, without writing anything
+			UIntVector badPages;
+			badPages.push_back(0);
+			badPages.push_back(10);
+			EStatusCodeAndPDFFormXObjectVector badForms = pdfWriter.CreateFormXObjectsFromTIFFFile(
+				RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/tiff/multipage.tif"),badPages);
+			if(badForms.first == eSuccess || badForms.second.size() != 0)
+			{
+				cout<<"expected failure when converting a page that does not exist\n";
+				status = eFailure;
+				break;
+			}
+		}
+
+		// place each form on its own page
+		for(PDFFormXObjectVector::iterator it = forms.begin(); it != forms.end() && eSuccess == status; ++it)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+			pageContentContext->q();
+			pageContentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping((*it)->GetObjectID()));
+			pageContentContext->Q();
+
+			status = pdfWriter.EndPageContentContext(pageContentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end page content context\n";
+				delete page;
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+				cout<<"failed to write page\n";
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inFileName<<"\n";
+			break;
+		}
+	}while(false);
+
+	for(PDFFormXObjectVector::iterator it = forms.begin(); it != forms.end(); ++it)
+		delete *it;
+
+	return status;
+}
+
+// multipage.tif has a single strip per page. this is where the strip offset of its last page is stored
+static const LongFilePositionType scMultipageLastPageStripOffsetPosition = 730;
+
+EStatusCode TiffParallelPagesTest::TestCorruptPage(const TestConfiguration& inTestConfiguration)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	EStatusCodeAndPDFFormXObjectVector forms;
+	string corruptTIFFPath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TiffParallelPagesTestCorrupt.tif");
+
+	do
+	{
+		// copy multipage.tif, pointing the strip of its last page past the end of the file
+		{
+			InputFile sourceFile;
+			OutputFile targetFile;
+
+			status = sourceFile.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TestMaterials/images/tiff/multipage.tif"));
+			if(status != eSuccess)
+			{
+				cout<<"failed to open multipage.tif\n";
+				break;
+			}
+
+			MyStringBuf buffer;
+			OutputStringBufferStream contentStream(&buffer);
+			OutputStreamTraits traits(&contentStream);
+			traits.CopyToOutputStream(sourceFile.GetInputStream());
+			string content = contentStream.ToString();
+			for(int i=0; i < 4; ++i)
+				content[(size_t)scMultipageLastPageStripOffsetPosition + i] = (char)0x7f;
+
+			status = targetFile.OpenFile(corruptTIFFPath);
+			if(status != eSuccess)
+			{
+				cout<<"failed to open corrupt tiff for writing\n";
+				break;
+			}
+			targetFile.GetOutputStream()->Write((const Byte*)content.c_str(),content.size());
+			targetFile.CloseFile();
+		}
+
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TiffParallelPagesTestCorruptPage.pdf"),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF TiffParallelPagesTestCorruptPage.pdf\n";
+			break;
+		}
+
+		UIntVector pages;
+		pages.push_back(0);
+		pages.push_back(1);
+		pages.push_back(3);
+		pages.push_back(2);
+		forms = pdfWriter.CreateFormXObjectsFromTIFFFile(corruptTIFFPath,pages);
+		if(forms.first == eSuccess)
+		{
+			cout<<"expected failure when converting a corrupt tiff page\n";
+			status = eFailure;
+			break;
+		}
+
+		// the pages before the corrupt one are already written, and returned for use
+		if(forms.second.size() != 2)
+		{
+			cout<<"expected the 2 pages written before the corrupt page, got "<<forms.second.size()<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		for(PDFFormXObjectVector::iterator it = forms.second.begin(); it != forms.second.end() && eSuccess == status; ++it)
+		{
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+			pageContentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping((*it)->GetObjectID()));
+
+			status = pdfWriter.EndPageContentContext(pageContentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end page content context\n";
+				delete page;
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+				cout<<"failed to write page\n";
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF TiffParallelPagesTestCorruptPage.pdf\n";
+			break;
+		}
+	}while(false);
+
+	for(PDFFormXObjectVector::iterator it = forms.second.begin(); it != forms.second.end(); ++it)
+		delete *it;
+
+	return status;
+}
+
+EStatusCode TiffParallelPagesTest::CreateForms(const TestConfiguration& inTestConfiguration,
+												PDFWriter& inPDFWriter,
+												const string& inTIFFFileName,
+												const UIntVector& inPageIndexes,
+												bool inParallel,
+												PDFFormXObjectVector& outForms)
+{
+	string tiffFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/images/tiff/") + inTIFFFileName);
+
+	if(inParallel)
+	{
+		EStatusCodeAndPDFFormXObjectVector forms = inPDFWriter.CreateFormXObjectsFromTIFFFile(tiffFilePath,inPageIndexes);
+		outForms.insert(outForms.end(),forms.second.begin(),forms.second.end());
+		if(forms.first != eSuccess || forms.second.size() != inPageIndexes.size())
+		{
+			cout<<"failed to create image forms for "<<inTIFFFileName<<" in parallel\n";
+			return eFailure;
+		}
+	}
+	else
+	{
+		TIFFUsageParameters tiffParameters;
+		for(UIntVector::const_iterator it = inPageIndexes.begin(); it != inPageIndexes.end(); ++it)
+		{
+			tiffParameters.PageIndex = *it;
+			PDFFormXObject* form = inPDFWriter.CreateFormXObjectFromTIFFFile(tiffFilePath,tiffParameters);
+			if(!form)
+			{
+				cout<<"failed to create image form for "<<inTIFFFileName<<" page "<<*it<<"\n";
+				return eFailure;
+			}
+			outForms.push_back(form);
+		}
+	}
+	return eSuccess;
+}
+
+static EStatusCode ReadStreamContent(PDFParser& inParser,PDFStreamInput* inStream,string& outContent)
+{
+	IByteReader* reader = inParser.StartReadingFromStreamForPlainCopying(inStream);
+	if(!reader)
+		return eFailure;
+
+	MyStringBuf buffer;
+	OutputStringBufferStream contentStream(&buffer);
+	OutputStreamTraits traits(&contentStream);
+	EStatusCode status = traits.CopyToOutputStream(reader);
+	delete reader;
+	outContent = contentStream.ToString();
+	return status;
+}
+
+EStatusCode TiffParallelPagesTest::CompareDocumentsStreams(const TestConfiguration& inTestConfiguration,const string& inFileNameA,const string& inFileNameB)
+{
+	EStatusCode status = eSuccess;
+	InputFile fileA,fileB;
+	PDFParser parserA,parserB;
+
+	do
+	{
+		if(fileA.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileNameA)) != eSuccess ||
+			fileB.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileNameB)) != eSuccess)
+		{
+			cout<<"failed to open "<<inFileNameA<<" or "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parserA.StartPDFParsing(fileA.GetInputStream()) != eSuccess ||
+			parserB.StartPDFParsing(fileB.GetInputStream()) != eSuccess)
+		{
+			cout<<"failed to parse "<<inFileNameA<<" or "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parserA.GetObjectsCount() != parserB.GetObjectsCount())
+		{
+			cout<<"different objects count in "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// the documents are written the same, so same objects should have the same streams
+		unsigned long streamsCount = 0;
+		for(ObjectIDType i=1;i<parserA.GetObjectsCount() && eSuccess == status;++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> streamA(parserA.ParseNewObject(i));
+			PDFObjectCastPtr<PDFStreamInput> streamB(parserB.ParseNewObject(i));
+			if(!streamA != !streamB)
+			{
+				cout<<"object "<<i<<" is a stream in only one of "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+				status = eFailure;
+				break;
+			}
+			if(!streamA)
+				continue;
+
+			string contentA,contentB;
+			if(ReadStreamContent(parserA,streamA.GetPtr(),contentA) != eSuccess ||
+				ReadStreamContent(parserB,streamB.GetPtr(),contentB) != eSuccess)
+			{
+				cout<<"failed to read stream of object "<<i<<"\n";
+				status = eFailure;
+				break;
+			}
+			if(contentA != contentB)
+			{
+				cout<<"stream of object "<<i<<" differs between "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+				status = eFailure;
+				break;
+			}
+			++streamsCount;
+		}
+		if(status != eSuccess)
+			break;
+
+		if(0 == streamsCount)
+		{
+			cout<<"no streams found in "<<inFileNameA<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(TiffParallelPagesTest,"PDF Images")
+
+#endif
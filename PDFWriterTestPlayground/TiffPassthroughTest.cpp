@@ -0,0 +1,530 @@
+/*
+   Source File : TiffPassthroughTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+#include "TiffPassthroughTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFFormXObject.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFStreamInput.h"
+#include "PDFDictionary.h"
+#include "PDFName.h"
+#include "PDFInteger.h"
+#include "PDFBoolean.h"
+#include "PDFArray.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+#include "TiffDecodingHelper.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+
+TiffPassthroughTest::TiffPassthroughTest(void)
+{
+}
+
+TiffPassthroughTest::~TiffPassthroughTest(void)
+{
+}
+
+EStatusCode TiffPassthroughTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		// G3 1D with LSB2MSB fill order, copied as is (bits reversed)
+		status = CheckImage(inTestConfiguration,"g3test.tif",true,eTIFFImageDataPassedThrough,"CCITTFaxDecode",0);
+		if(status != eSuccess)
+			break;
+
+		status = CompareImagesData(inTestConfiguration,"g3test.tif");
+		if(status != eSuccess)
+			break;
+
+		// the same G3 image, when passthrough is disabled, is decoded and encoded again as G4
+		status = CheckImage(inTestConfiguration,"g3test.tif",false,eTIFFImageDataReencoded,"CCITTFaxDecode",-1);
+		if(status != eSuccess)
+			break;
+
+		// single strip G4
+		status = CheckImage(inTestConfiguration,"multipage.tif",true,eTIFFImageDataPassedThrough,"CCITTFaxDecode",-1);
+		if(status != eSuccess)
+			break;
+
+		status = CompareImagesData(inTestConfiguration,"multipage.tif");
+		if(status != eSuccess)
+			break;
+
+		// G3 2D with fill bits, so rows are byte aligned
+		status = CompareImagesData(inTestConfiguration,"fax2d.tif");
+		if(status != eSuccess)
+			break;
+
+		// G3 1D and 2D in multiple strips, joined when possible
+		status = CompareImagesData(inTestConfiguration,"G31DS.TIF");
+		if(status != eSuccess)
+			break;
+
+		status = CompareImagesData(inTestConfiguration,"G32DS.TIF");
+		if(status != eSuccess)
+			break;
+
+		// LZW tiles are each copied to their own image
+		status = CheckImage(inTestConfiguration,"quad-tile.tif",true,eTIFFImageDataPassedThrough,"LZWDecode",0);
+		if(status != eSuccess)
+			break;
+
+		status = CompareImagesData(inTestConfiguration,"quad-tile.tif");
+		if(status != eSuccess)
+			break;
+
+		// LZW strips are separate code streams and can't be joined, so the image is encoded again
+		status = CheckImage(inTestConfiguration,"quad-lzw.tif",true,eTIFFImageDataReencoded,"FlateDecode",0);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TiffPassthroughTest::CheckImage(const TestConfiguration& inTestConfiguration,
+											const string& inTIFFFileName,
+											bool inUsePassthrough,
+											ETIFFImageDataPath inExpectedPath,
+											const string& inExpectedFilter,
+											long long inExpectedK)
+{
+	EStatusCode status;
+	ETIFFImageDataPath imageDataPath = inExpectedPath == eTIFFImageDataReencoded ? eTIFFImageDataPassedThrough:eTIFFImageDataReencoded;
+	string pdfFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,
+												string("TiffPassthroughTest") + (inUsePassthrough ? "":"Reencoded") + "_" + inTIFFFileName + ".pdf");
+
+	do
+	{
+		status = CreateImageDocument(inTestConfiguration,inTIFFFileName,inUsePassthrough,pdfFilePath,imageDataPath);
+		if(status != eSuccess)
+			break;
+
+		if(imageDataPath != inExpectedPath)
+		{
+			cout<<"unexpected image data path for "<<inTIFFFileName<<", expected "<<
+				(eTIFFImageDataPassedThrough == inExpectedPath ? "passthrough":"reencoding")<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = CheckImagesFilter(pdfFilePath,inExpectedFilter,inExpectedK);
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TiffPassthroughTest::CreateImageDocument(const TestConfiguration& inTestConfiguration,
+													 const string& inTIFFFileName,
+													 bool inUsePassthrough,
+													 const string& inPDFFilePath,
+													 ETIFFImageDataPath& outImageDataPath)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	TIFFUsageParameters tiffParameters;
+
+	tiffParameters.UsePassthrough = inUsePassthrough;
+	tiffParameters.OutImageDataPath = &outImageDataPath;
+
+	do
+	{
+		status = pdfWriter.StartPDF(inPDFFilePath,ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inPDFFilePath<<"\n";
+			break;
+		}
+
+		PDFFormXObject* imageForm = pdfWriter.CreateFormXObjectFromTIFFFile(
+			RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/images/tiff/") + inTIFFFileName),
+			tiffParameters);
+		if(!imageForm)
+		{
+			cout<<"failed to create image form for "<<inTIFFFileName<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		PDFPage* page = new PDFPage();
+		page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+		PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+		pageContentContext->q();
+		pageContentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(imageForm->GetObjectID()));
+		pageContentContext->Q();
+		delete imageForm;
+
+		status = pdfWriter.EndPageContentContext(pageContentContext);
+		if(status != eSuccess)
+		{
+			cout<<"failed to end page content context\n";
+			delete page;
+			break;
+		}
+
+		status = pdfWriter.WritePageAndRelease(page);
+		if(status != eSuccess)
+		{
+			cout<<"failed to write page\n";
+			break;
+		}
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inPDFFilePath<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TiffPassthroughTest::CheckImagesFilter(const string& inPDFFilePath,const string& inExpectedFilter,long long inExpectedK)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+	unsigned long imagesCount = 0;
+
+	do
+	{
+		if(pdfFile.OpenFile(inPDFFilePath) != eSuccess)
+		{
+			cout<<"failed to open "<<inPDFFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parser.StartPDFParsing(pdfFile.GetInputStream()) != eSuccess)
+		{
+			cout<<"failed to parse "<<inPDFFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		for(ObjectIDType i=1;i<parser.GetObjectsCount() && eSuccess == status;++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> stream(parser.ParseNewObject(i));
+			if(!stream)
+				continue;
+
+			PDFObjectCastPtr<PDFDictionary> streamDictionary(stream->QueryStreamDictionary());
+			PDFObjectCastPtr<PDFName> subtype(streamDictionary->QueryDirectObject("Subtype"));
+			if(!subtype || subtype->GetValue() != "Image")
+				continue;
+			++imagesCount;
+
+			PDFObjectCastPtr<PDFName> filter(streamDictionary->QueryDirectObject("Filter"));
+			if(!filter || filter->GetValue() != inExpectedFilter)
+			{
+				cout<<"image in object "<<i<<" of "<<inPDFFilePath<<" has filter "<<(!filter ? "none":filter->GetValue())<<
+					", expected "<<inExpectedFilter<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			if(inExpectedFilter == "CCITTFaxDecode")
+			{
+				PDFObjectCastPtr<PDFDictionary> decodeParms(streamDictionary->QueryDirectObject("DecodeParms"));
+				PDFObjectCastPtr<PDFInteger> k(!decodeParms ? NULL:decodeParms->QueryDirectObject("K"));
+				long long kValue = !k ? 0:k->GetValue();
+				if(kValue != inExpectedK)
+				{
+					cout<<"image in object "<<i<<" of "<<inPDFFilePath<<" has K "<<kValue<<", expected "<<inExpectedK<<"\n";
+					status = eFailure;
+					break;
+				}
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		if(0 == imagesCount)
+		{
+			cout<<"no images found in "<<inPDFFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+/*
+	Decode the images of the tiff written with passthrough, and compare them with the images written when passthrough is disabled.
+	CCITT images are also compared with the tiff page, as decoded by libtiff.
+*/
+EStatusCode TiffPassthroughTest::CompareImagesData(const TestConfiguration& inTestConfiguration,const string& inTIFFFileName)
+{
+	EStatusCode status;
+	ETIFFImageDataPath imageDataPath;
+	string passthroughPDFFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TiffPassthroughTestData_") + inTIFFFileName + ".pdf");
+	string reencodedPDFFilePath = RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TiffPassthroughTestDataReencoded_") + inTIFFFileName + ".pdf");
+	TiffPassthroughImageSamplesList passthroughImages;
+	TiffPassthroughImageSamplesList reencodedImages;
+
+	do
+	{
+		status = CreateImageDocument(inTestConfiguration,inTIFFFileName,true,passthroughPDFFilePath,imageDataPath);
+		if(status != eSuccess)
+			break;
+
+		status = CreateImageDocument(inTestConfiguration,inTIFFFileName,false,reencodedPDFFilePath,imageDataPath);
+		if(status != eSuccess)
+			break;
+
+		status = ReadImagesSamples(inTestConfiguration,passthroughPDFFilePath,passthroughImages);
+		if(status != eSuccess)
+			break;
+
+		status = ReadImagesSamples(inTestConfiguration,reencodedPDFFilePath,reencodedImages);
+		if(status != eSuccess)
+			break;
+
+		if(passthroughImages.size() != reencodedImages.size())
+		{
+			cout<<inTIFFFileName<<" has "<<passthroughImages.size()<<" images with passthrough and "<<reencodedImages.size()<<" when reencoded\n";
+			status = eFailure;
+			break;
+		}
+
+		TiffPassthroughImageSamplesList::iterator itPassthrough = passthroughImages.begin();
+		TiffPassthroughImageSamplesList::iterator itReencoded = reencodedImages.begin();
+		for(; itPassthrough != passthroughImages.end() && eSuccess == status; ++itPassthrough,++itReencoded)
+		{
+			if(itPassthrough->Width != itReencoded->Width ||
+				itPassthrough->Height != itReencoded->Height ||
+				itPassthrough->Samples != itReencoded->Samples)
+			{
+				cout<<"image of "<<inTIFFFileName<<" decodes differently with passthrough and when reencoded\n";
+				status = eFailure;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		// compare CCITT images with the tiff pages themselves
+		unsigned int pageIndex = 0;
+		for(itPassthrough = passthroughImages.begin(); itPassthrough != passthroughImages.end() && eSuccess == status; ++itPassthrough,++pageIndex)
+		{
+			if(!itPassthrough->IsCCITT)
+				continue;
+
+			string tiffSamples;
+			unsigned long tiffWidth,tiffLength;
+			bool minIsWhite;
+			status = ReadTIFFPageSamples(
+				RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/images/tiff/") + inTIFFFileName),
+				pageIndex,
+				tiffSamples,
+				tiffWidth,
+				tiffLength,
+				minIsWhite);
+			if(status != eSuccess)
+				break;
+
+			unsigned long rowSize = (tiffWidth + 7) / 8;
+			unsigned char padMask = (tiffWidth % 8) ? (unsigned char)(0xFF << (8 - tiffWidth % 8)) : 0xFF;
+			for(unsigned long i = 0; i < tiffSamples.size(); ++i)
+			{
+				unsigned char blackSamples = minIsWhite ? (unsigned char)tiffSamples[i] : (unsigned char)~tiffSamples[i];
+				tiffSamples[i] = (char)((i % rowSize == rowSize - 1) ? (blackSamples & padMask) : blackSamples);
+			}
+
+			if(tiffWidth != itPassthrough->Width ||
+				tiffLength != itPassthrough->Height ||
+				tiffSamples != itPassthrough->Samples)
+			{
+				cout<<"page "<<pageIndex<<" of "<<inTIFFFileName<<" written with passthrough decodes differently than the tiff\n";
+				status = eFailure;
+			}
+		}
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TiffPassthroughTest::ReadImagesSamples(const TestConfiguration& inTestConfiguration,const string& inPDFFilePath,TiffPassthroughImageSamplesList& outImages)
+{
+	EStatusCode status = eSuccess;
+	InputFile pdfFile;
+	PDFParser parser;
+
+	do
+	{
+		if(pdfFile.OpenFile(inPDFFilePath) != eSuccess)
+		{
+			cout<<"failed to open "<<inPDFFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parser.StartPDFParsing(pdfFile.GetInputStream()) != eSuccess)
+		{
+			cout<<"failed to parse "<<inPDFFilePath<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		for(ObjectIDType i=1;i<parser.GetObjectsCount() && eSuccess == status;++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> stream(parser.ParseNewObject(i));
+			if(!stream)
+				continue;
+
+			PDFObjectCastPtr<PDFDictionary> streamDictionary(stream->QueryStreamDictionary());
+			PDFObjectCastPtr<PDFName> subtype(streamDictionary->QueryDirectObject("Subtype"));
+			if(!subtype || subtype->GetValue() != "Image")
+				continue;
+
+			outImages.push_back(TiffPassthroughImageSamples());
+			status = ReadImageSamples(inTestConfiguration,parser,stream.GetPtr(),outImages.back());
+			if(status != eSuccess)
+				cout<<"failed to read image in object "<<i<<" of "<<inPDFFilePath<<"\n";
+		}
+	}while(false);
+
+	return status;
+}
+
+static string ReadAll(IByteReader* inReader)
+{
+	MyStringBuf buffer;
+	OutputStringBufferStream contentStream(&buffer);
+	OutputStreamTraits traits(&contentStream);
+	traits.CopyToOutputStream(inReader);
+	return contentStream.ToString();
+}
+
+static long long QueryIntegerValue(PDFDictionary* inDictionary,const string& inKey,long long inDefault)
+{
+	PDFObjectCastPtr<PDFInteger> value(!inDictionary ? NULL:inDictionary->QueryDirectObject(inKey));
+	return !value ? inDefault:value->GetValue();
+}
+
+static bool QueryBooleanValue(PDFDictionary* inDictionary,const string& inKey,bool inDefault)
+{
+	PDFObjectCastPtr<PDFBoolean> value(!inDictionary ? NULL:inDictionary->QueryDirectObject(inKey));
+	return !value ? inDefault:value->GetValue();
+}
+
+EStatusCode TiffPassthroughTest::ReadImageSamples(const TestConfiguration& inTestConfiguration,PDFParser& inParser,PDFStreamInput* inStream,TiffPassthroughImageSamples& outImage)
+{
+	EStatusCode status = eSuccess;
+	PDFObjectCastPtr<PDFDictionary> streamDictionary(inStream->QueryStreamDictionary());
+	PDFObjectCastPtr<PDFName> filter(streamDictionary->QueryDirectObject("Filter"));
+	PDFObjectCastPtr<PDFDictionary> decodeParms(streamDictionary->QueryDirectObject("DecodeParms"));
+
+	outImage.Width = (unsigned long)QueryIntegerValue(streamDictionary.GetPtr(),"Width",0);
+	outImage.Height = (unsigned long)QueryIntegerValue(streamDictionary.GetPtr(),"Height",0);
+
+	do
+	{
+		if(!filter || filter->GetValue() == "FlateDecode")
+		{
+			IByteReader* reader = inParser.StartReadingFromStream(inStream);
+			if(!reader)
+			{
+				status = eFailure;
+				break;
+			}
+			outImage.Samples = ReadAll(reader);
+			delete reader;
+			break;
+		}
+
+		IByteReader* reader = inParser.StartReadingFromStreamForPlainCopying(inStream);
+		if(!reader)
+		{
+			status = eFailure;
+			break;
+		}
+		string encodedData = ReadAll(reader);
+		delete reader;
+
+		TiffDecodingParameters parameters;
+		parameters.Filter = filter->GetValue();
+		parameters.Columns = (unsigned long)QueryIntegerValue(decodeParms.GetPtr(),"Columns",outImage.Width);
+		parameters.Rows = (unsigned long)QueryIntegerValue(decodeParms.GetPtr(),"Rows",outImage.Height);
+		parameters.BitsPerComponent = (unsigned short)QueryIntegerValue(streamDictionary.GetPtr(),"BitsPerComponent",1);
+		parameters.K = QueryIntegerValue(decodeParms.GetPtr(),"K",0);
+		parameters.EncodedByteAlign = QueryBooleanValue(decodeParms.GetPtr(),"EncodedByteAlign",false);
+		parameters.EndOfLine = QueryBooleanValue(decodeParms.GetPtr(),"EndOfLine",false);
+		parameters.Predictor = QueryIntegerValue(decodeParms.GetPtr(),"Predictor",1);
+		PDFObjectCastPtr<PDFName> colorSpace(streamDictionary->QueryDirectObject("ColorSpace"));
+		if(!!colorSpace && colorSpace->GetValue() == "DeviceRGB")
+			parameters.Colors = 3;
+		else if(!!colorSpace && colorSpace->GetValue() == "DeviceCMYK")
+			parameters.Colors = 4;
+		parameters.Colors = (unsigned short)QueryIntegerValue(decodeParms.GetPtr(),"Colors",parameters.Colors);
+
+		if(parameters.Columns != outImage.Width || parameters.Rows != outImage.Height)
+		{
+			cout<<"image filter columns and rows "<<parameters.Columns<<"x"<<parameters.Rows<<" don't match image size "<<outImage.Width<<"x"<<outImage.Height<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		status = DecodeImageDataWithLibTiff(
+			encodedData,
+			parameters,
+			RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,"TiffPassthroughTestScratch.tif"),
+			outImage.Samples);
+		if(status != eSuccess || parameters.Filter != "CCITTFaxDecode")
+			break;
+
+		outImage.IsCCITT = true;
+
+		// decoded CCITT data has 1 for black runs. PDF samples are the same if BlackIs1, and then the image Decode array
+		// tells whether 1 samples are black. normalize to 1 for black, and clear the bits padding the rows
+		PDFObjectCastPtr<PDFArray> decode(streamDictionary->QueryDirectObject("Decode"));
+		PDFObjectCastPtr<PDFInteger> decodeFirst(!decode ? NULL:decode->QueryObject(0));
+		bool oneIsBlack = QueryBooleanValue(decodeParms.GetPtr(),"BlackIs1",false) == (!!decodeFirst && 1 == decodeFirst->GetValue());
+		unsigned long rowSize = (outImage.Width + 7) / 8;
+		unsigned char padMask = (outImage.Width % 8) ? (unsigned char)(0xFF << (8 - outImage.Width % 8)) : 0xFF;
+		for(unsigned long i = 0; i < outImage.Samples.size(); ++i)
+		{
+			unsigned char blackSamples = oneIsBlack ? (unsigned char)outImage.Samples[i] : (unsigned char)~outImage.Samples[i];
+			outImage.Samples[i] = (char)((i % rowSize == rowSize - 1) ? (blackSamples & padMask) : blackSamples);
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(TiffPassthroughTest,"PDF Images")
+
+#endif
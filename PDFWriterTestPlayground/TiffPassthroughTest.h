@@ -0,0 +1,73 @@
+/*
+   Source File : TiffPassthroughTest.h
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+
+*/
+#pragma once
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+#include "ITestUnit.h"
+#include "TiffUsageParameters.h"
+
+#include <string>
+#include <list>
+
+class PDFParser;
+class PDFStreamInput;
+
+struct TiffPassthroughImageSamples
+{
+	unsigned long Width;
+	unsigned long Height;
+	bool IsCCITT;
+	// for CCITT images, 1 bit per pixel, where 1 is black
+	std::string Samples;
+
+	TiffPassthroughImageSamples() {Width = 0; Height = 0; IsCCITT = false;}
+};
+
+typedef std::list<TiffPassthroughImageSamples> TiffPassthroughImageSamplesList;
+
+class TiffPassthroughTest : public ITestUnit
+{
+public:
+	TiffPassthroughTest(void);
+	virtual ~TiffPassthroughTest(void);
+
+	virtual PDFHummus::EStatusCode Run(const TestConfiguration& inTestConfiguration);
+
+private:
+	PDFHummus::EStatusCode CheckImage(const TestConfiguration& inTestConfiguration,
+										const std::string& inTIFFFileName,
+										bool inUsePassthrough,
+										ETIFFImageDataPath inExpectedPath,
+										const std::string& inExpectedFilter,
+										long long inExpectedK);
+	PDFHummus::EStatusCode CreateImageDocument(const TestConfiguration& inTestConfiguration,
+												const std::string& inTIFFFileName,
+												bool inUsePassthrough,
+												const std::string& inPDFFilePath,
+												ETIFFImageDataPath& outImageDataPath);
+	PDFHummus::EStatusCode CheckImagesFilter(const std::string& inPDFFilePath,const std::string& inExpectedFilter,long long inExpectedK);
+	PDFHummus::EStatusCode CompareImagesData(const TestConfiguration& inTestConfiguration,const std::string& inTIFFFileName);
+	PDFHummus::EStatusCode ReadImagesSamples(const TestConfiguration& inTestConfiguration,const std::string& inPDFFilePath,TiffPassthroughImageSamplesList& outImages);
+	PDFHummus::EStatusCode ReadImageSamples(const TestConfiguration& inTestConfiguration,PDFParser& inParser,PDFStreamInput* inStream,TiffPassthroughImageSamples& outImage);
+};
+
+#endif
@@ -0,0 +1,285 @@
+/*
+   Source File : TiffStreamingTest.cpp
+
+
+   Copyright 2011 Gal Kahana PDFWriter
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+
+   
+*/
+
+#ifndef PDFHUMMUS_NO_TIFF
+
+#include "TiffStreamingTest.h"
+#include "TestsRunner.h"
+#include "PDFWriter.h"
+#include "PDFFormXObject.h"
+#include "PDFPage.h"
+#include "PageContentContext.h"
+#include "PDFParser.h"
+#include "InputFile.h"
+#include "PDFStreamInput.h"
+#include "PDFObjectCast.h"
+#include "IByteReader.h"
+#include "OutputStringBufferStream.h"
+#include "OutputStreamTraits.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace PDFHummus;
+using namespace IOBasicTypes;
+
+static const char* scTiffStreamingImages[] = {
+	"CCITT_1.TIF",
+	"fax2d.tif",
+	"FLAG_T24.TIF",
+	"GMARBLES.TIF",
+	"jello.tif",
+	"quad-lzw.tif",
+	"strike.tif",
+	"ycbcr-cat.tif",
+	"flower-minisblack-4.tif",
+	"flower-palette-8.tif",
+	"flower-rgb-contig-8.tif",
+	"flower-rgb-planar-8.tif",
+	"flower-separated-contig-8.tif",
+	"flower-separated-planar-8.tif",
+	NULL
+};
+
+// ycbcr images converted to RGB, with 10 and 15 rows per strip
+static const char* scTiffStreamingYCbCrImages[] = {
+	"ycbcr-cat.tif",
+	"dscf0013.tif",
+	NULL
+};
+
+TiffStreamingTest::TiffStreamingTest(void)
+{
+}
+
+TiffStreamingTest::~TiffStreamingTest(void)
+{
+}
+
+EStatusCode TiffStreamingTest::Run(const TestConfiguration& inTestConfiguration)
+{
+	EStatusCode status;
+
+	do
+	{
+		// no limit - whole images are converted in memory
+		status = CreateDocument(inTestConfiguration,"TiffStreamingTestInMemory.pdf",scTiffStreamingImages,0);
+		if(status != eSuccess)
+			break;
+
+		// 1 byte limit - images are converted row by row (and ycbcr ones by subsampled blocks of rows)
+		status = CreateDocument(inTestConfiguration,"TiffStreamingTestRows.pdf",scTiffStreamingImages,1);
+		if(status != eSuccess)
+			break;
+
+		// 64K limit - images are converted strip by strip
+		status = CreateDocument(inTestConfiguration,"TiffStreamingTestStrips.pdf",scTiffStreamingImages,64*1024);
+		if(status != eSuccess)
+			break;
+
+		status = CreateDocument(inTestConfiguration,"TiffStreamingTestYCbCrInMemory.pdf",scTiffStreamingYCbCrImages,0);
+		if(status != eSuccess)
+			break;
+
+		// limit of a few RGBA rows, less than a strip - ycbcr images are converted in bands that don't match the strips
+		status = CreateDocument(inTestConfiguration,"TiffStreamingTestYCbCrBands.pdf",scTiffStreamingYCbCrImages,8000);
+		if(status != eSuccess)
+			break;
+
+		// image data should be exactly the same
+		status = CompareDocumentsStreams(inTestConfiguration,"TiffStreamingTestInMemory.pdf","TiffStreamingTestRows.pdf");
+		if(status != eSuccess)
+			break;
+
+		status = CompareDocumentsStreams(inTestConfiguration,"TiffStreamingTestInMemory.pdf","TiffStreamingTestStrips.pdf");
+		if(status != eSuccess)
+			break;
+
+		status = CompareDocumentsStreams(inTestConfiguration,"TiffStreamingTestYCbCrInMemory.pdf","TiffStreamingTestYCbCrBands.pdf");
+	}while(false);
+
+	return status;
+}
+
+EStatusCode TiffStreamingTest::CreateDocument(const TestConfiguration& inTestConfiguration,const string& inFileName,const char** inImages,unsigned long long inMaxImageBufferSize)
+{
+	PDFWriter pdfWriter;
+	EStatusCode status;
+	TIFFUsageParameters tiffParameters;
+
+	tiffParameters.MaxImageBufferSize = inMaxImageBufferSize;
+	// force decoding, so that the banded path is the one being exercised, also for images that could be passed through
+	tiffParameters.UsePassthrough = false;
+
+	do
+	{
+		status = pdfWriter.StartPDF(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileName),ePDFVersion13);
+		if(status != eSuccess)
+		{
+			cout<<"failed to start PDF "<<inFileName<<"\n";
+			break;
+		}	
+
+		// place each image on its own page
+		for(int i=0;inImages[i] && eSuccess == status;++i)
+		{
+			PDFFormXObject* imageForm = pdfWriter.CreateFormXObjectFromTIFFFile(
+				RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,string("TestMaterials/images/tiff/") + inImages[i]),
+				tiffParameters);
+			if(!imageForm)
+			{
+				cout<<"failed to create image form for "<<inImages[i]<<" in "<<inFileName<<"\n";
+				status = eFailure;
+				break;
+			}
+
+			PDFPage* page = new PDFPage();
+			page->SetMediaBox(PDFRectangle(0,0,595,842));
+
+			PageContentContext* pageContentContext = pdfWriter.StartPageContentContext(page);
+			pageContentContext->q();
+			pageContentContext->Do(page->GetResourcesDictionary().AddFormXObjectMapping(imageForm->GetObjectID()));
+			pageContentContext->Q();
+			delete imageForm;
+
+			status = pdfWriter.EndPageContentContext(pageContentContext);
+			if(status != eSuccess)
+			{
+				cout<<"failed to end page content context\n";
+				delete page;
+				break;
+			}
+
+			status = pdfWriter.WritePageAndRelease(page);
+			if(status != eSuccess)
+			{
+				cout<<"failed to write page\n";
+				break;
+			}
+		}
+		if(status != eSuccess)
+			break;
+
+		status = pdfWriter.EndPDF();
+		if(status != eSuccess)
+		{
+			cout<<"failed in end PDF "<<inFileName<<"\n";
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+static EStatusCode ReadStreamContent(PDFParser& inParser,PDFStreamInput* inStream,string& outContent)
+{
+	IByteReader* reader = inParser.StartReadingFromStreamForPlainCopying(inStream);
+	if(!reader)
+		return eFailure;
+
+	MyStringBuf buffer;
+	OutputStringBufferStream contentStream(&buffer);
+	OutputStreamTraits traits(&contentStream);
+	EStatusCode status = traits.CopyToOutputStream(reader);
+	delete reader;
+	outContent = contentStream.ToString();
+	return status;
+}
+
+EStatusCode TiffStreamingTest::CompareDocumentsStreams(const TestConfiguration& inTestConfiguration,const string& inFileNameA,const string& inFileNameB)
+{
+	EStatusCode status = eSuccess;
+	InputFile fileA,fileB;
+	PDFParser parserA,parserB;
+
+	do
+	{
+		if(fileA.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileNameA)) != eSuccess ||
+			fileB.OpenFile(RelativeURLToLocalPath(inTestConfiguration.mSampleFileBase,inFileNameB)) != eSuccess)
+		{
+			cout<<"failed to open "<<inFileNameA<<" or "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parserA.StartPDFParsing(fileA.GetInputStream()) != eSuccess ||
+			parserB.StartPDFParsing(fileB.GetInputStream()) != eSuccess)
+		{
+			cout<<"failed to parse "<<inFileNameA<<" or "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		if(parserA.GetObjectsCount() != parserB.GetObjectsCount())
+		{
+			cout<<"different objects count in "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+			status = eFailure;
+			break;
+		}
+
+		// the documents are written the same, so same objects should have the same streams
+		unsigned long streamsCount = 0;
+		for(ObjectIDType i=1;i<parserA.GetObjectsCount() && eSuccess == status;++i)
+		{
+			PDFObjectCastPtr<PDFStreamInput> streamA(parserA.ParseNewObject(i));
+			PDFObjectCastPtr<PDFStreamInput> streamB(parserB.ParseNewObject(i));
+			if(!streamA != !streamB)
+			{
+				cout<<"object "<<i<<" is a stream in only one of "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+				status = eFailure;
+				break;
+			}
+			if(!streamA)
+				continue;
+
+			string contentA,contentB;
+			if(ReadStreamContent(parserA,streamA.GetPtr(),contentA) != eSuccess ||
+				ReadStreamContent(parserB,streamB.GetPtr(),contentB) != eSuccess)
+			{
+				cout<<"failed to read stream of object "<<i<<"\n";
+				status = eFailure;
+				break;
+			}
+			if(contentA != contentB)
+			{
+				cout<<"stream of object "<<i<<" differs between "<<inFileNameA<<" and "<<inFileNameB<<"\n";
+				status = eFailure;
+				break;
+			}
+			++streamsCount;
+		}
+		if(status != eSuccess)
+			break;
+
+		if(0 == streamsCount)
+		{
+			cout<<"no streams found in "<<inFileNameA<<"\n";
+			status = eFailure;
+			break;
+		}
+	}while(false);
+
+	return status;
+}
+
+ADD_CATEGORIZED_TEST(TiffStreamingTest,"PDF Images")
+
+#endif